@@ -31,12 +31,223 @@
 
 #include <weak_forms/ad_sd_functor_internal.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
 
 WEAK_FORMS_NAMESPACE_OPEN
 
 
 namespace WeakForms
 {
+  namespace internal
+  {
+    /**
+     * A handle to a slot of an AD_SD_CacheSlotTable, which is identified by
+     * a name.
+     *
+     * All handles that are created with the same name refer to the same
+     * slot, for as long as any of them exists. Once the last of them has
+     * been destroyed the slot index is released, and it may be given to a
+     * slot with a different name. Each registration of a slot carries a
+     * unique identifier, so that the objects that were stored for a released
+     * slot are never mistaken for those of the slot that reuses its index.
+     * The number of slot indices in use is therefore bounded by the number of
+     * distinct names that are alive at any one time.
+     */
+    class AD_SD_CacheSlot
+    {
+    public:
+      explicit AD_SD_CacheSlot(const std::string &name)
+        : registration(register_slot(name))
+      {}
+
+      /**
+       * Return the index of the slot in a AD_SD_CacheSlotTable.
+       */
+      unsigned int
+      index() const
+      {
+        return registration->index;
+      }
+
+      /**
+       * Return the identifier that is unique to this registration of the
+       * slot.
+       */
+      std::size_t
+      id() const
+      {
+        return registration->id;
+      }
+
+    private:
+      struct Registration
+      {
+        std::string  name;
+        unsigned int index;
+        std::size_t  id;
+      };
+
+      struct Registry
+      {
+        std::mutex                                          mutex;
+        std::map<std::string, std::weak_ptr<Registration>> registrations;
+        std::vector<unsigned int>                           free_indices;
+        unsigned int                                        n_indices = 0;
+        std::size_t                                         n_ids     = 0;
+      };
+
+      std::shared_ptr<const Registration> registration;
+
+      static Registry &
+      get_registry()
+      {
+        static Registry registry;
+        return registry;
+      }
+
+      static std::shared_ptr<const Registration>
+      register_slot(const std::string &name)
+      {
+        Registry &                  registry = get_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        std::weak_ptr<Registration> &existing = registry.registrations[name];
+        if (std::shared_ptr<Registration> shared = existing.lock())
+          return shared;
+
+        unsigned int index = registry.n_indices;
+        if (registry.free_indices.empty())
+          ++registry.n_indices;
+        else
+          {
+            index = registry.free_indices.back();
+            registry.free_indices.pop_back();
+          }
+
+        const std::shared_ptr<Registration> shared(
+          new Registration{name, index, ++registry.n_ids}, &release_slot);
+        existing = shared;
+        return shared;
+      }
+
+      static void
+      release_slot(Registration *registration)
+      {
+        Registry &registry = get_registry();
+        {
+          std::lock_guard<std::mutex> lock(registry.mutex);
+          registry.free_indices.push_back(registration->index);
+
+          // The name may have been registered anew in the meantime.
+          const auto it = registry.registrations.find(registration->name);
+          if (it != registry.registrations.end() && it->second.expired())
+            registry.registrations.erase(it);
+        }
+        delete registration;
+      }
+    };
+
+
+
+    /**
+     * A table of objects that are addressed by an integer slot index,
+     * rather than by name as is done by the GeneralDataStorage class.
+     *
+     * Copies of a table do not share any objects with the original; they
+     * are created empty instead.
+     */
+    class AD_SD_CacheSlotTable
+    {
+    public:
+      AD_SD_CacheSlotTable() = default;
+
+      AD_SD_CacheSlotTable(const AD_SD_CacheSlotTable &)
+        : AD_SD_CacheSlotTable()
+      {}
+
+      AD_SD_CacheSlotTable &
+      operator=(const AD_SD_CacheSlotTable &)
+      {
+        objects.clear();
+        object_types.clear();
+        object_ids.clear();
+        return *this;
+      }
+
+      bool
+      stores_object(const AD_SD_CacheSlot &slot) const
+      {
+        const unsigned int index = slot.index();
+        return index < objects.size() && objects[index] != nullptr &&
+               object_ids[index] == slot.id();
+      }
+
+      template <typename Type, typename... Args>
+      Type &
+      get_or_add_object(const AD_SD_CacheSlot &slot, Args &&...arguments)
+      {
+        if (!stores_object(slot))
+          {
+            const unsigned int index = slot.index();
+            if (index >= objects.size())
+              {
+                objects.resize(index + 1);
+                object_types.resize(index + 1, nullptr);
+                object_ids.resize(index + 1, 0);
+              }
+
+            // Any object that is still held belonged to a slot that has
+            // since been released, and is replaced.
+            objects[index] =
+              std::make_shared<Type>(std::forward<Args>(arguments)...);
+            object_types[index] = &typeid(Type);
+            object_ids[index]   = slot.id();
+          }
+
+        return get_object<Type>(slot);
+      }
+
+      template <typename Type>
+      Type &
+      get_object(const AD_SD_CacheSlot &slot)
+      {
+        Assert(stores_object(slot),
+               ExcMessage("No object is stored in this cache slot."));
+        Assert(*object_types[slot.index()] == typeid(Type),
+               ExcMessage("The object stored in this cache slot has a "
+                          "different type to the one requested."));
+        return *static_cast<Type *>(objects[slot.index()].get());
+      }
+
+      template <typename Type>
+      const Type &
+      get_object(const AD_SD_CacheSlot &slot) const
+      {
+        Assert(stores_object(slot),
+               ExcMessage("No object is stored in this cache slot."));
+        Assert(*object_types[slot.index()] == typeid(Type),
+               ExcMessage("The object stored in this cache slot has a "
+                          "different type to the one requested."));
+        return *static_cast<const Type *>(objects[slot.index()].get());
+      }
+
+    private:
+      std::vector<std::shared_ptr<void>>  objects;
+      std::vector<const std::type_info *> object_types;
+      std::vector<std::size_t>            object_ids;
+    };
+  } // namespace internal
+
+
+
   /**
    * @brief Persistent data for AD and SD calculations. The idea is that this
    * cache is initialised and stored in a user class, so that is not created
@@ -48,11 +259,17 @@ namespace WeakForms
   {
   public:
     // The queue_length matches that used by default for WorkStream::run(), and
-    // hence mesh_loop().
+    // hence mesh_loop(). The assemblers resize the cache to match the queue
+    // length that they actually use.
     AD_SD_Functor_Cache(
       const unsigned int queue_length = 2 * MultithreadInfo::n_threads())
-      : source_lock_and_cache(queue_length)
-    {}
+      : n_waiting_threads(0)
+      , n_bindings(0)
+      , n_redirected_bindings(0)
+      , n_blocked_bindings(0)
+    {
+      resize(queue_length);
+    }
 
     AD_SD_Functor_Cache(const AD_SD_Functor_Cache &) = delete;
     AD_SD_Functor_Cache(AD_SD_Functor_Cache &&)      = delete;
@@ -84,44 +301,37 @@ namespace WeakForms
       MeshWorker::ScratchData<dim, spacedim> &scratch_data)
     {
       if (has_user_cache(scratch_data) == false)
-        return;
+        {
+          set_active_slot_table(
+            scratch_data,
+            get_data_storage(scratch_data)
+              .template get_or_add_object_with_name<
+                internal::AD_SD_CacheSlotTable>(get_name_slot_table()));
+          return;
+        }
 
       // We must ensure that we do not try to evaluate from multiple threads
-      // at once.
+      // at once, so each thread claims an entry for its exclusive use.
       AD_SD_Functor_Cache &user_cache = get_user_cache(scratch_data);
+      CacheEntry &         cache_entry = user_cache.acquire_cache_entry();
 
-      // We use an infinite loop because we cannot be sure when the next
-      // entry will become free for use.
-      while (true)
-        {
-          for (auto &lock_and_cache : user_cache.source_lock_and_cache)
-            {
-              if (lock_and_cache.first.try_lock())
-                {
-                  // Now that we've marked this entry as no longer being
-                  // available for use, and point the current thread towards
-                  // its associated cache data.
-                  GeneralDataStorage &data_storage =
-                    get_data_storage(scratch_data);
+      // Point the current thread towards its associated cache data.
+      GeneralDataStorage &data_storage = get_data_storage(scratch_data);
 
 #ifdef DEBUG
-                  if (data_storage.stores_object_with_name(
-                        get_name_active_data_storage()))
-                    {
-                      Assert(
-                        data_storage.get_object_with_name<GeneralDataStorage *>(
-                          get_name_active_data_storage()) == nullptr,
-                        ExcMessage(
-                          "Expected to find an uninitialised pointer to an active data storage object."));
-                    }
+      if (data_storage.stores_object_with_name(get_name_active_data_storage()))
+        {
+          Assert(
+            data_storage.get_object_with_name<CacheEntry *>(
+              get_name_active_data_storage()) == nullptr,
+            ExcMessage(
+              "Expected to find an uninitialised pointer to an active data storage object."));
+        }
 #endif
 
-                  data_storage.add_or_overwrite_copy<GeneralDataStorage *>(
-                    get_name_active_data_storage(), &lock_and_cache.second);
-                  return;
-                }
-            }
-        }
+      data_storage.add_or_overwrite_copy<CacheEntry *>(
+        get_name_active_data_storage(), &cache_entry);
+      set_active_slot_table(scratch_data, cache_entry.slot_table);
     }
 
     template <int dim, int spacedim>
@@ -130,36 +340,23 @@ namespace WeakForms
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const GeneralDataStorage &              cache)
     {
+      clear_active_slot_table(scratch_data);
+
       if (has_user_cache(scratch_data) == false)
         return;
 
-      AD_SD_Functor_Cache &user_cache = get_user_cache(scratch_data);
-      for (auto &lock_and_cache : user_cache.source_lock_and_cache)
-        {
-          if (&cache == &lock_and_cache.second)
-            {
-              Assert(lock_and_cache.first.try_lock() == false,
-                     ExcMessage("Cache entry was not locked upon return."));
-
-              GeneralDataStorage &data_storage = get_data_storage(scratch_data);
-              Assert(
-                data_storage.stores_object_with_name(
-                  get_name_active_data_storage()),
-                ExcMessage(
-                  "Expected to find a pointer to an active data storage object."));
-
-
-              // Invalidate pointer in common storage and mark this entry as
-              // being available for re-use.
-              data_storage.add_or_overwrite_copy<GeneralDataStorage *>(
-                get_name_active_data_storage(), nullptr);
-              lock_and_cache.first.unlock();
-              return;
-            }
-        }
-
-      AssertThrow(false,
-                  ExcMessage("Source cache not found in this data structure."));
+      AD_SD_Functor_Cache &user_cache  = get_user_cache(scratch_data);
+      CacheEntry *const    cache_entry = get_active_cache_entry(scratch_data);
+      (void)cache;
+      Assert(&cache == &cache_entry->data_storage,
+             ExcMessage("Source cache not found in this data structure."));
+
+      // Invalidate pointer in common storage and mark this entry as
+      // being available for re-use.
+      GeneralDataStorage &data_storage = get_data_storage(scratch_data);
+      data_storage.add_or_overwrite_copy<CacheEntry *>(
+        get_name_active_data_storage(), nullptr);
+      user_cache.release_cache_entry(*cache_entry);
     }
 
     template <int dim, int spacedim>
@@ -167,28 +364,9 @@ namespace WeakForms
     get_cache(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
     {
       if (has_user_cache(scratch_data))
-        {
-          GeneralDataStorage &data_storage = get_data_storage(scratch_data);
-
-          Assert(
-            data_storage.stores_object_with_name(
-              get_name_active_data_storage()),
-            ExcMessage(
-              "Expected to find a pointer to an active data storage object."));
-          GeneralDataStorage *active_data_storage =
-            data_storage.get_object_with_name<GeneralDataStorage *>(
-              get_name_active_data_storage());
-
-          Assert(
-            active_data_storage != nullptr,
-            ExcMessage(
-              "Expected to find an initialised pointer to an active data storage object."));
-          return *active_data_storage;
-        }
+        return get_active_cache_entry(scratch_data)->data_storage;
       else
-        {
-          return get_data_storage(scratch_data);
-        }
+        return get_data_storage(scratch_data);
     }
 
     template <int dim, int spacedim>
@@ -196,55 +374,339 @@ namespace WeakForms
     get_cache(const MeshWorker::ScratchData<dim, spacedim> &scratch_data)
     {
       if (has_user_cache(scratch_data))
-        {
-          // GeneralDataStorage does not have any non-const member functions.
-          GeneralDataStorage &data_storage = get_data_storage(
-            const_cast<MeshWorker::ScratchData<dim, spacedim> &>(scratch_data));
+        return get_active_cache_entry(scratch_data)->data_storage;
+      else
+        return get_data_storage(scratch_data);
+    }
 
-          Assert(
-            data_storage.stores_object_with_name(
-              get_name_active_data_storage()),
-            ExcMessage(
-              "Expected to find a pointer to an active data storage object."));
+    /**
+     * Return the cache slot that objects with the given @p name are stored
+     * in. The same slot is returned for each call with the same @p name, so
+     * this need only be called once (e.g. upon construction of the object
+     * that uses the cache) rather than each time that the cache is accessed.
+     * The slot remains reserved for as long as the returned object, or any
+     * copy of it, exists.
+     */
+    static internal::AD_SD_CacheSlot
+    get_slot(const std::string &name)
+    {
+      return internal::AD_SD_CacheSlot(name);
+    }
 
-          const GeneralDataStorage *const active_data_storage =
-            data_storage.get_object_with_name<GeneralDataStorage *>(
-              get_name_active_data_storage());
-          Assert(
-            active_data_storage != nullptr,
-            ExcMessage(
-              "Expected to find an initialised pointer to an active data storage object."));
+    /**
+     * Return the table that holds the objects for each cache slot. This
+     * is the counterpart to get_cache(), with the difference that the
+     * objects are addressed by their slot.
+     *
+     * While the @p scratch_data is bound to the calling thread, the table
+     * is found without any lookup by name.
+     */
+    template <int dim, int spacedim>
+    static internal::AD_SD_CacheSlotTable &
+    get_slot_table(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+    {
+      const ActiveSlotTable &active = get_active_slot_table();
+      if (active.scratch_data == &scratch_data)
+        return *active.slot_table;
 
-          return *active_data_storage;
-        }
+      if (has_user_cache(scratch_data))
+        return get_active_cache_entry(scratch_data)->slot_table;
       else
-        {
-          return get_data_storage(scratch_data);
-        }
+        return get_data_storage(scratch_data)
+          .template get_or_add_object_with_name<
+            internal::AD_SD_CacheSlotTable>(get_name_slot_table());
+    }
+
+    template <int dim, int spacedim>
+    static const internal::AD_SD_CacheSlotTable &
+    get_slot_table(const MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+    {
+      const ActiveSlotTable &active = get_active_slot_table();
+      if (active.scratch_data == &scratch_data)
+        return *active.slot_table;
+
+      if (has_user_cache(scratch_data))
+        return get_active_cache_entry(scratch_data)->slot_table;
+      else
+        return get_data_storage(scratch_data)
+          .template get_object_with_name<internal::AD_SD_CacheSlotTable>(
+            get_name_slot_table());
     }
 
     std::size_t
     queue_length() const
     {
-      return source_lock_and_cache.size();
+      return cache_entries.size();
+    }
+
+    /**
+     * Change the number of entries in this cache to @p queue_length. The
+     * data held by the entries that are retained is preserved.
+     *
+     * This function is not thread-safe, and may not be called while any
+     * thread is bound to this cache.
+     */
+    void
+    resize(const unsigned int queue_length)
+    {
+      Assert(queue_length > 0,
+             ExcMessage("The queue length must be positive."));
+      Assert(!has_entry_in_use(),
+             ExcMessage("Cannot resize the cache while it is in use."));
+
+      const unsigned int n_entries = cache_entries.size();
+      cache_entries.resize(queue_length);
+      for (unsigned int i = n_entries; i < queue_length; ++i)
+        cache_entries[i] = std::make_unique<CacheEntry>();
+    }
+
+    /**
+     * Return the number of times that a thread has been bound to an entry
+     * of this cache.
+     */
+    std::size_t
+    get_n_bindings() const
+    {
+      return n_bindings;
+    }
+
+    /**
+     * Return the number of times that the entry associated with a thread
+     * was in use by another thread, so that it had to search for another
+     * entry.
+     */
+    std::size_t
+    get_n_redirected_bindings() const
+    {
+      return n_redirected_bindings;
+    }
+
+    /**
+     * Return the number of times that all entries were in use, so that a
+     * thread had to wait for one of them to be released. If this happens
+     * frequently, then the queue length should be increased.
+     */
+    std::size_t
+    get_n_blocked_bindings() const
+    {
+      return n_blocked_bindings;
+    }
+
+    /**
+     * Reset the counters that record how threads have been bound to the
+     * entries of this cache.
+     */
+    void
+    reset_binding_statistics()
+    {
+      n_bindings            = 0;
+      n_redirected_bindings = 0;
+      n_blocked_bindings    = 0;
     }
 
   private:
+    struct CacheEntry
+    {
+      CacheEntry()
+        : in_use(false)
+      {}
+
+      std::atomic<bool>              in_use;
+      GeneralDataStorage             data_storage;
+      internal::AD_SD_CacheSlotTable slot_table;
+    };
+
     // We need to be careful when a shared cache is used: We cannot evaluate
     // this operator in parallel; it must be done in a sequential fashion.
-    using CacheWithLock = std::pair<std::mutex, GeneralDataStorage>;
-    std::vector<CacheWithLock> source_lock_and_cache;
+    // So each entry may only be used by one thread at a time. The entries
+    // are held by pointer, so that they remain in place when the cache is
+    // resized.
+    std::vector<std::unique_ptr<CacheEntry>> cache_entries;
+
+    // Threads that find all entries in use wait until one is released.
+    std::mutex                wait_mutex;
+    std::condition_variable   cache_entry_released;
+    std::atomic<unsigned int> n_waiting_threads;
+
+    // Statistics on how the threads have been bound to the entries.
+    std::atomic<std::size_t> n_bindings;
+    std::atomic<std::size_t> n_redirected_bindings;
+    std::atomic<std::size_t> n_blocked_bindings;
+
+    // The slot table that the ScratchData object that is bound to a thread
+    // resolves to. A thread only ever works with one ScratchData object at
+    // a time, and it binds and unbinds that object itself.
+    struct ActiveSlotTable
+    {
+      const void *                    scratch_data = nullptr;
+      internal::AD_SD_CacheSlotTable *slot_table   = nullptr;
+    };
+
+    static ActiveSlotTable &
+    get_active_slot_table()
+    {
+      static thread_local ActiveSlotTable active;
+      return active;
+    }
+
+    template <int dim, int spacedim>
+    static void
+    set_active_slot_table(
+      const MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      internal::AD_SD_CacheSlotTable &              slot_table)
+    {
+      ActiveSlotTable &active = get_active_slot_table();
+      active.scratch_data     = &scratch_data;
+      active.slot_table       = &slot_table;
+    }
+
+    template <int dim, int spacedim>
+    static void
+    clear_active_slot_table(
+      const MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+    {
+      ActiveSlotTable &active = get_active_slot_table();
+      if (active.scratch_data == &scratch_data)
+        active = ActiveSlotTable();
+    }
+
+    /**
+     * Return a number that uniquely identifies the calling thread. The same
+     * threads are reused by the task scheduler in each assembly loop, so
+     * that each thread will usually find the same entry to be free.
+     */
+    static unsigned int
+    get_thread_index()
+    {
+      static std::atomic<unsigned int>       n_threads(0);
+      static thread_local const unsigned int thread_index = n_threads++;
+      return thread_index;
+    }
 
-    static std::string
+    bool
+    try_acquire_cache_entry(CacheEntry &cache_entry)
+    {
+      // Check before attempting to claim the entry, so as to not write to
+      // entries that are in use by other threads.
+      if (cache_entry.in_use.load(std::memory_order_relaxed))
+        return false;
+
+      bool expected = false;
+      return cache_entry.in_use.compare_exchange_strong(expected, true);
+    }
+
+    bool
+    has_free_cache_entry() const
+    {
+      for (const auto &cache_entry : cache_entries)
+        if (!cache_entry->in_use)
+          return true;
+      return false;
+    }
+
+    bool
+    has_entry_in_use() const
+    {
+      for (const auto &cache_entry : cache_entries)
+        if (cache_entry->in_use)
+          return true;
+      return false;
+    }
+
+    CacheEntry &
+    acquire_cache_entry()
+    {
+      const unsigned int n_entries       = cache_entries.size();
+      const unsigned int preferred_entry = get_thread_index() % n_entries;
+      ++n_bindings;
+
+      // First try the entry that the thread is associated with. If there
+      // are no more threads than entries, then this is typically free.
+      if (try_acquire_cache_entry(*cache_entries[preferred_entry]))
+        return *cache_entries[preferred_entry];
+      ++n_redirected_bindings;
+
+      while (true)
+        {
+          for (unsigned int i = 1; i < n_entries; ++i)
+            {
+              CacheEntry &cache_entry =
+                *cache_entries[(preferred_entry + i) % n_entries];
+              if (try_acquire_cache_entry(cache_entry))
+                return cache_entry;
+            }
+
+          // All entries are in use, so we wait until one is released
+          // instead of repeatedly polling the entries.
+          ++n_blocked_bindings;
+          std::unique_lock<std::mutex> lock(wait_mutex);
+          ++n_waiting_threads;
+          cache_entry_released.wait(lock,
+                                    [this]() { return has_free_cache_entry(); });
+          --n_waiting_threads;
+
+          if (try_acquire_cache_entry(*cache_entries[preferred_entry]))
+            return *cache_entries[preferred_entry];
+        }
+    }
+
+    void
+    release_cache_entry(CacheEntry &cache_entry)
+    {
+      Assert(cache_entry.in_use,
+             ExcMessage("Cache entry was not locked upon return."));
+      cache_entry.in_use = false;
+
+      if (n_waiting_threads > 0)
+        {
+          std::lock_guard<std::mutex> lock(wait_mutex);
+          cache_entry_released.notify_one();
+        }
+    }
+
+    static const std::string &
     get_name_ad_sd_cache()
     {
-      return Utilities::get_deal_II_prefix() + "AD_SD_Functor_Cache";
+      static const std::string name =
+        Utilities::get_deal_II_prefix() + "AD_SD_Functor_Cache";
+      return name;
     }
 
-    static std::string
+    static const std::string &
     get_name_active_data_storage()
     {
-      return get_name_ad_sd_cache() + "_active_data_storage";
+      static const std::string name =
+        get_name_ad_sd_cache() + "_active_data_storage";
+      return name;
+    }
+
+    static const std::string &
+    get_name_slot_table()
+    {
+      static const std::string name = get_name_ad_sd_cache() + "_slot_table";
+      return name;
+    }
+
+    template <int dim, int spacedim>
+    static CacheEntry *
+    get_active_cache_entry(
+      const MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+    {
+      const GeneralDataStorage &data_storage = get_data_storage(scratch_data);
+
+      Assert(
+        data_storage.stores_object_with_name(get_name_active_data_storage()),
+        ExcMessage(
+          "Expected to find a pointer to an active data storage object."));
+      CacheEntry *const active_cache_entry =
+        data_storage.get_object_with_name<CacheEntry *>(
+          get_name_active_data_storage());
+
+      Assert(
+        active_cache_entry != nullptr,
+        ExcMessage(
+          "Expected to find an initialised pointer to an active data storage object."));
+      return active_cache_entry;
     }
 
     template <int dim, int spacedim>
@@ -20,15 +20,20 @@
 
 #include <weak_forms/config.h>
 
-// #include <deal.II/algorithms/general_data_storage.h>
+#include <deal.II/algorithms/general_data_storage.h>
 
 #include <deal.II/base/aligned_vector.h>
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/numbers.h>
+#include <deal.II/base/table.h>
 #include <deal.II/base/template_constraints.h>
 #include <deal.II/base/types.h>
+#include <deal.II/base/utilities.h>
 #include <deal.II/base/vectorization.h>
 
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+
 #include <deal.II/fe/fe_values.h>
 
 #include <deal.II/lac/affine_constraints.h>
@@ -43,7 +48,9 @@
 #include <weak_forms/binary_integral_operators.h>
 #include <weak_forms/binary_operators.h>
 #include <weak_forms/linear_forms.h>
+#include <weak_forms/local_gemm_kernel.h>
 #include <weak_forms/numbers.h>
+#include <weak_forms/shape_function_cache.h>
 #include <weak_forms/solution_extraction_data.h>
 #include <weak_forms/solution_storage.h>
 #include <weak_forms/symbolic_integral.h>
@@ -53,8 +60,14 @@
 #include <weak_forms/unary_integral_operators.h>
 #include <weak_forms/unary_operators.h>
 
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <string>
+#include <tuple>
 #include <type_traits>
+#include <typeinfo>
+#include <utility>
 
 
 WEAK_FORMS_NAMESPACE_OPEN
@@ -166,6 +179,85 @@ namespace WeakForms
     };
 
 
+    /**
+     * The number of finite element components that are selected by an
+     * extractor.
+     */
+    template <typename ExtractorType, int spacedim>
+    struct ExtractorComponentCount;
+
+    template <int spacedim>
+    struct ExtractorComponentCount<FEValuesExtractors::Scalar, spacedim>
+    {
+      static constexpr unsigned int value = 1;
+    };
+
+    template <int spacedim>
+    struct ExtractorComponentCount<FEValuesExtractors::Vector, spacedim>
+    {
+      static constexpr unsigned int value = spacedim;
+    };
+
+    template <int rank, int spacedim>
+    struct ExtractorComponentCount<FEValuesExtractors::Tensor<rank>, spacedim>
+    {
+      static constexpr unsigned int value =
+        Tensor<rank, spacedim>::n_independent_components;
+    };
+
+    template <int rank, int spacedim>
+    struct ExtractorComponentCount<FEValuesExtractors::SymmetricTensor<rank>,
+                                   spacedim>
+    {
+      static constexpr unsigned int value =
+        SymmetricTensor<rank, spacedim>::n_independent_components;
+    };
+
+
+    /**
+     * The range of finite element components that an (underlying) test
+     * function or trial solution operation acts on. An operation on the full
+     * space acts on all components.
+     */
+    template <typename SpaceOp, typename T = void>
+    struct SpaceOpComponentRange
+    {
+      static std::pair<unsigned int, unsigned int>
+      get(const SpaceOp &, const unsigned int n_components)
+      {
+        return {0, n_components};
+      }
+    };
+
+
+    template <typename SubSpaceViewsType, enum Operators::SymbolicOpCodes OpCode>
+    struct SpaceOpComponentRange<
+      Operators::SymbolicOp<SubSpaceViewsType, OpCode>,
+      typename std::enable_if<
+        is_subspace_view<SubSpaceViewsType>::value>::type>
+    {
+      using extractor_t = typename SubSpaceViewsType::extractor_type;
+
+      template <typename SpaceOp>
+      static std::pair<unsigned int, unsigned int>
+      get(const SpaceOp &space_op, const unsigned int n_components)
+      {
+        const unsigned int first_component =
+          SubSpaceViews::internal::FEValuesExtractorHelper<
+            extractor_t>::first_component(space_op.get_extractor());
+        const unsigned int last_component =
+          first_component +
+          ExtractorComponentCount<extractor_t,
+                                  SubSpaceViewsType::space_dimension>::value;
+        (void)n_components;
+        Assert(last_component <= n_components,
+               ExcIndexRange(last_component - 1, 0, n_components));
+
+        return {first_component, last_component};
+      }
+    };
+
+
     enum class AccumulationSign
     {
       plus,
@@ -457,7 +549,76 @@ namespace WeakForms
     }
 
 
+    /**
+     * Return, in ascending order, the local DoFs whose shape functions are
+     * non-zero in at least one of the components that the test function or
+     * trial solution @p space_op acts on. This is the same component range
+     * that the coupling tables are built from. The shape functions of all
+     * other DoFs vanish in this (sub)space, so the fields that they belong
+     * to do not contribute to a bilinear form.
+     */
+    template <typename SpaceOp, int dim, int spacedim>
+    std::vector<unsigned int>
+    get_space_op_dof_indices(const SpaceOp &                    space_op,
+                             const FEValuesBase<dim, spacedim> &fe_values)
+    {
+      const FiniteElement<dim, spacedim> &fe = fe_values.get_fe();
+      const auto &op = TestTrialSpaceHelper<SpaceOp>::extract(space_op);
+      using OpType   = typename std::decay<decltype(op)>::type;
+      const std::pair<unsigned int, unsigned int> components =
+        SpaceOpComponentRange<OpType>::get(op, fe.n_components());
+
+      std::vector<unsigned int> dof_indices;
+      dof_indices.reserve(fe_values.dofs_per_cell);
+      for (const unsigned int k : fe_values.dof_indices())
+        {
+          const ComponentMask &nonzero_components =
+            fe.get_nonzero_components(k);
+          for (unsigned int c = components.first; c < components.second; ++c)
+            if (nonzero_components[c])
+              {
+                dof_indices.push_back(k);
+                break;
+              }
+        }
+      return dof_indices;
+    }
+
+
+    /**
+     * Return the range of the (sorted) @p test_dof_indices that are to be
+     * assembled for the trial DoF @p j: Only the diagonal entry if that is
+     * all that is required, or the diagonal plus upper half of the matrix if
+     * the symmetry flag is set.
+     */
+    inline std::pair<std::vector<unsigned int>::const_iterator,
+                     std::vector<unsigned int>::const_iterator>
+    get_test_dof_range(const std::vector<unsigned int> &test_dof_indices,
+                       const unsigned int               j,
+                       const bool symmetric_contribution,
+                       const bool diagonal_contribution)
+    {
+      if (diagonal_contribution)
+        {
+          const auto it = std::lower_bound(test_dof_indices.begin(),
+                                           test_dof_indices.end(),
+                                           j);
+          return {it,
+                  (it != test_dof_indices.end() && *it == j ? it + 1 : it)};
+        }
+      else if (symmetric_contribution)
+        return {test_dof_indices.begin(),
+                std::upper_bound(test_dof_indices.begin(),
+                                 test_dof_indices.end(),
+                                 j)};
+      else
+        return {test_dof_indices.begin(), test_dof_indices.end()};
+    }
+
+
     // Valid for cell and face assembly
+    // Only the entries that couple the @p test_dof_indices to the
+    // @p trial_dof_indices are computed; all others are zero.
     template <enum AccumulationSign Sign,
               typename ScalarType,
               int dim,
@@ -474,8 +635,11 @@ namespace WeakForms
       const std::vector<ValueTypeFunctor> &           values_functor,
       const std::vector<std::vector<ValueTypeTrial>> &shapes_trial,
       const std::vector<double> &                     JxW,
+      const std::vector<unsigned int> &               test_dof_indices,
+      const std::vector<unsigned int> &               trial_dof_indices,
       const bool                                      symmetric_contribution,
-      const bool equal_components_contribution)
+      const bool equal_components_contribution,
+      const bool diagonal_contribution = false)
     {
       Assert(shapes_test.size() == fe_values_dofs.dofs_per_cell,
              ExcDimensionMismatch(shapes_test.size(),
@@ -509,9 +673,6 @@ namespace WeakForms
       //       cell_matrix(i,j) += shapes_test[i][q] * values_functor[q] *
       //       shapes_trial[j][q]) * JxW[q]
       const auto qp_range = fe_values_q_points.quadrature_point_indices();
-      const auto dof_range_j =
-        (symmetric_contribution ? fe_values_dofs.dof_indices() :
-                                  fe_values_dofs.dof_indices());
       const std::vector<unsigned int> dof_component_index =
         (equal_components_contribution ?
            internal::get_dof_component_indices(fe_values_dofs) :
@@ -519,7 +680,7 @@ namespace WeakForms
 
       for (const unsigned int q : qp_range)
         {
-          for (const unsigned int j : dof_range_j)
+          for (const unsigned int j : trial_dof_indices)
             {
               using ContractionType_FS =
                 FullContraction<ValueTypeFunctor, ValueTypeTrial>;
@@ -529,14 +690,14 @@ namespace WeakForms
               using ContractionType_FS_t = typename std::decay<decltype(
                 functor_x_shape_trial_x_JxW)>::type;
 
-              // Assemble only the diagonal plus upper half of the matrix if
-              // the symmetry flag is set.
               const auto dof_range_i =
-                (symmetric_contribution ?
-                   fe_values_dofs.dof_indices_ending_at(j) :
-                   fe_values_dofs.dof_indices());
-              for (const unsigned int i : dof_range_i)
+                internal::get_test_dof_range(test_dof_indices,
+                                             j,
+                                             symmetric_contribution,
+                                             diagonal_contribution);
+              for (auto it = dof_range_i.first; it != dof_range_i.second; ++it)
                 {
+                  const unsigned int i = *it;
                   if (equal_components_contribution &&
                       (dof_component_index[i] != dof_component_index[j]))
                     {
@@ -564,6 +725,125 @@ namespace WeakForms
         }
     }
 
+    // Valid for cell and face assembly.
+    // Rather than the local matrix itself, only the sum of the entries in
+    // each of its rows is computed, and added to the diagonal entry of that
+    // row. Since the bilinear form is linear in the trial solution, the
+    // trial functions are summed at each quadrature point before they are
+    // contracted with the test functions. The cost is therefore linear,
+    // rather than quadratic, in the number of DoFs.
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim,
+              typename ValueTypeTest,
+              typename ValueTypeFunctor,
+              typename ValueTypeTrial>
+    void
+    assemble_cell_matrix_row_sum_contribution(
+      FullMatrix<ScalarType> &                        cell_matrix,
+      const FEValuesBase<dim, spacedim> &             fe_values_dofs,
+      const FEValuesBase<dim, spacedim> &             fe_values_q_points,
+      const std::vector<std::vector<ValueTypeTest>> & shapes_test,
+      const std::vector<ValueTypeFunctor> &           values_functor,
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial,
+      const std::vector<double> &                     JxW,
+      const std::vector<unsigned int> &               test_dof_indices,
+      const std::vector<unsigned int> &               trial_dof_indices,
+      const bool equal_components_contribution)
+    {
+      Assert(shapes_test.size() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(shapes_test.size(),
+                                  fe_values_dofs.dofs_per_cell));
+      Assert(shapes_trial.size() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(shapes_trial.size(),
+                                  fe_values_dofs.dofs_per_cell));
+      Assert(values_functor.size() == fe_values_q_points.n_quadrature_points,
+             ExcDimensionMismatch(values_functor.size(),
+                                  fe_values_q_points.n_quadrature_points));
+      Assert(JxW.size() == fe_values_q_points.n_quadrature_points,
+             ExcDimensionMismatch(JxW.size(),
+                                  fe_values_q_points.n_quadrature_points));
+
+      // This is the equivalent of
+      // for (q : q_points)
+      //   for (i : dof_indices)
+      //     for (j : dof_indices)
+      //       cell_matrix(i,i) += shapes_test[i][q] * values_functor[q] *
+      //       shapes_trial[j][q]) * JxW[q]
+      // If only the shape functions with equal components couple, then the
+      // trial functions of each component are summed up separately.
+      const unsigned int n_dofs = fe_values_dofs.dofs_per_cell;
+      const unsigned int n_sums =
+        (equal_components_contribution ?
+           fe_values_dofs.get_fe().n_components() :
+           1);
+      const std::vector<unsigned int> dof_sum_index =
+        (equal_components_contribution ?
+           internal::get_dof_component_indices(fe_values_dofs) :
+           std::vector<unsigned int>(n_dofs, 0));
+
+      using ContractionType_FS =
+        FullContraction<ValueTypeFunctor, ValueTypeTrial>;
+      using ContractionType_FS_t = typename std::decay<decltype(
+        std::declval<double>() *
+        ContractionType_FS::contract(std::declval<ValueTypeFunctor>(),
+                                     std::declval<ValueTypeTrial>()))>::type;
+      using ContractionType_SFS_JxW =
+        FullContraction<ValueTypeTest, ContractionType_FS_t>;
+
+      std::vector<ValueTypeTrial>       shapes_trial_sum(n_sums);
+      std::vector<ContractionType_FS_t> functor_x_shapes_trial_sum_x_JxW(
+        n_sums);
+      std::vector<bool> has_shapes_trial_sum(n_sums);
+
+      for (const unsigned int q :
+           fe_values_q_points.quadrature_point_indices())
+        {
+          std::fill(has_shapes_trial_sum.begin(),
+                    has_shapes_trial_sum.end(),
+                    false);
+          for (const unsigned int j : trial_dof_indices)
+            {
+              const unsigned int k = dof_sum_index[j];
+              if (has_shapes_trial_sum[k])
+                shapes_trial_sum[k] += shapes_trial[j][q];
+              else
+                {
+                  shapes_trial_sum[k]     = shapes_trial[j][q];
+                  has_shapes_trial_sum[k] = true;
+                }
+            }
+
+          for (unsigned int k = 0; k < n_sums; ++k)
+            if (has_shapes_trial_sum[k])
+              functor_x_shapes_trial_sum_x_JxW[k] =
+                JxW[q] * ContractionType_FS::contract(values_functor[q],
+                                                      shapes_trial_sum[k]);
+
+          for (const unsigned int i : test_dof_indices)
+            {
+              const unsigned int k = dof_sum_index[i];
+              if (!has_shapes_trial_sum[k])
+                continue;
+
+              const ScalarType integrated_contribution =
+                ContractionType_SFS_JxW::contract(
+                  shapes_test[i][q], functor_x_shapes_trial_sum_x_JxW[k]);
+
+              if (Sign == AccumulationSign::plus)
+                {
+                  cell_matrix(i, i) += integrated_contribution;
+                }
+              else
+                {
+                  Assert(Sign == AccumulationSign::minus, ExcInternalError());
+                  cell_matrix(i, i) -= integrated_contribution;
+                }
+            }
+        }
+    }
+
     // Valid for interface assembly
     template <enum AccumulationSign Sign,
               typename ScalarType,
@@ -683,8 +963,11 @@ namespace WeakForms
       const std::vector<ValueTypeFunctor> &           values_functor,
       const std::vector<std::vector<ValueTypeTrial>> &shapes_trial,
       const std::vector<double> &                     JxW,
+      const std::vector<unsigned int> &               test_dof_indices,
+      const std::vector<unsigned int> &               trial_dof_indices,
       const bool                                      symmetric_contribution,
-      const bool equal_components_contribution)
+      const bool equal_components_contribution,
+      const bool diagonal_contribution = false)
     {
       assemble_cell_matrix_contribution<Sign>(cell_matrix,
                                               fe_values,
@@ -693,8 +976,11 @@ namespace WeakForms
                                               values_functor,
                                               shapes_trial,
                                               JxW,
+                                              test_dof_indices,
+                                              trial_dof_indices,
                                               symmetric_contribution,
-                                              equal_components_contribution);
+                                              equal_components_contribution,
+                                              diagonal_contribution);
     }
 
     // Valid only for interface assembly
@@ -850,8 +1136,11 @@ namespace WeakForms
       const VectorizedValueTypeFunctor &             values_functor,
       const AlignedVector<VectorizedValueTypeTrial> &shapes_trial,
       const VectorizedArray<double, width> &         JxW,
+      const std::vector<unsigned int> &              test_dof_indices,
+      const std::vector<unsigned int> &              trial_dof_indices,
       const bool                                     symmetric_contribution,
-      const bool equal_components_contribution)
+      const bool equal_components_contribution,
+      const bool diagonal_contribution = false)
     {
       // This is the equivalent of
       // for (q : q_points) --> vectorized
@@ -859,15 +1148,12 @@ namespace WeakForms
       //     for (j : dof_indices)
       //       cell_matrix(i,j) += shapes_test[i][q] * values_functor[q] *
       //       shapes_trial[j][q]) * JxW[q]
-      const auto dof_range_j =
-        (symmetric_contribution ? fe_values_dofs.dof_indices() :
-                                  fe_values_dofs.dof_indices());
       const std::vector<unsigned int> dof_component_index =
         (equal_components_contribution ?
            internal::get_dof_component_indices(fe_values_dofs) :
            std::vector<unsigned int>());
 
-      for (const unsigned int j : dof_range_j)
+      for (const unsigned int j : trial_dof_indices)
         {
           using ContractionType_FS = FullContraction<VectorizedValueTypeFunctor,
                                                      VectorizedValueTypeTrial>;
@@ -876,13 +1162,14 @@ namespace WeakForms
           using ContractionType_FS_t =
             typename std::decay<decltype(functor_x_shape_trial_x_JxW)>::type;
 
-          // Assemble only the diagonal plus upper half of the matrix if
-          // the symmetry flag is set.
           const auto dof_range_i =
-            (symmetric_contribution ? fe_values_dofs.dof_indices_ending_at(j) :
-                                      fe_values_dofs.dof_indices());
-          for (const unsigned int i : dof_range_i)
+            internal::get_test_dof_range(test_dof_indices,
+                                         j,
+                                         symmetric_contribution,
+                                         diagonal_contribution);
+          for (auto it = dof_range_i.first; it != dof_range_i.second; ++it)
             {
+              const unsigned int i = *it;
               if (equal_components_contribution &&
                   (dof_component_index[i] != dof_component_index[j]))
                 {
@@ -918,6 +1205,99 @@ namespace WeakForms
     }
 
 
+    // Valid for cell and face assembly.
+    // Only the row sums of the local matrix are computed, as for
+    // assemble_cell_matrix_row_sum_contribution().
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim,
+              typename VectorizedValueTypeTest,
+              typename VectorizedValueTypeFunctor,
+              typename VectorizedValueTypeTrial,
+              std::size_t width>
+    void
+    assemble_cell_matrix_row_sum_vectorized_qp_batch_contribution(
+      FullMatrix<ScalarType> &                       cell_matrix,
+      const FEValuesBase<dim, spacedim> &            fe_values_dofs,
+      const AlignedVector<VectorizedValueTypeTest> & shapes_test,
+      const VectorizedValueTypeFunctor &             values_functor,
+      const AlignedVector<VectorizedValueTypeTrial> &shapes_trial,
+      const VectorizedArray<double, width> &         JxW,
+      const std::vector<unsigned int> &              test_dof_indices,
+      const std::vector<unsigned int> &              trial_dof_indices,
+      const bool equal_components_contribution)
+    {
+      const unsigned int n_dofs = fe_values_dofs.dofs_per_cell;
+      const unsigned int n_sums =
+        (equal_components_contribution ?
+           fe_values_dofs.get_fe().n_components() :
+           1);
+      const std::vector<unsigned int> dof_sum_index =
+        (equal_components_contribution ?
+           internal::get_dof_component_indices(fe_values_dofs) :
+           std::vector<unsigned int>(n_dofs, 0));
+
+      AlignedVector<VectorizedValueTypeTrial> shapes_trial_sum(n_sums);
+      std::vector<bool>                       has_shapes_trial_sum(n_sums);
+      for (const unsigned int j : trial_dof_indices)
+        {
+          const unsigned int k = dof_sum_index[j];
+          if (has_shapes_trial_sum[k])
+            shapes_trial_sum[k] += shapes_trial[j];
+          else
+            {
+              shapes_trial_sum[k]     = shapes_trial[j];
+              has_shapes_trial_sum[k] = true;
+            }
+        }
+
+      for (unsigned int k = 0; k < n_sums; ++k)
+        {
+          if (!has_shapes_trial_sum[k])
+            continue;
+
+          using ContractionType_FS = FullContraction<VectorizedValueTypeFunctor,
+                                                     VectorizedValueTypeTrial>;
+          const auto functor_x_shapes_trial_sum_x_JxW =
+            JxW *
+            ContractionType_FS::contract(values_functor, shapes_trial_sum[k]);
+          using ContractionType_FS_t = typename std::decay<decltype(
+            functor_x_shapes_trial_sum_x_JxW)>::type;
+
+          for (const unsigned int i : test_dof_indices)
+            {
+              if (dof_sum_index[i] != k)
+                continue;
+
+              using ContractionType_SFS_JxW =
+                FullContraction<VectorizedValueTypeTest, ContractionType_FS_t>;
+              const VectorizedArray<ScalarType, width>
+                vectorized_integrated_contribution =
+                  ContractionType_SFS_JxW::contract(
+                    shapes_test[i], functor_x_shapes_trial_sum_x_JxW);
+
+              // Reduce all QP contributions
+              ScalarType integrated_contribution =
+                dealii::internal::NumberType<ScalarType>::value(0.0);
+              for (unsigned int v = 0; v < width; v++)
+                integrated_contribution +=
+                  vectorized_integrated_contribution[v];
+
+              if (Sign == AccumulationSign::plus)
+                {
+                  cell_matrix(i, i) += integrated_contribution;
+                }
+              else
+                {
+                  Assert(Sign == AccumulationSign::minus, ExcInternalError());
+                  cell_matrix(i, i) -= integrated_contribution;
+                }
+            }
+        }
+    }
+
+
     // Valid for interface assembly
     template <enum AccumulationSign Sign,
               typename ScalarType,
@@ -1046,58 +1426,530 @@ namespace WeakForms
     }
 
 
+    // Cell batch counterparts of the cell matrix kernels
+    // ==================================================
 
-    // Utility functions to help with template arguments of the
-    // assemble_system() method being void / std::null_ptr_t.
 
-    template <typename ScratchDataType,
-              typename FiniteElementType,
-              typename CellQuadratureType>
-    ScratchDataType
-    construct_scratch_data(const FiniteElementType &        finite_element,
-                           const CellQuadratureType &       cell_quadrature,
-                           const UpdateFlags &              cell_update_flags,
-                           const AD_SD_Functor_Cache *const ad_sd_cache)
+    /**
+     * The data of a bilinear form, gathered from each of the cells in a
+     * batch, with each vectorization lane associated with a different cell.
+     * The shape function data is stored with the DoF index running fastest,
+     * i.e. the entry for DoF @p k at quadrature point @p q is at index
+     * <tt>q * n_dofs + k</tt>.
+     *
+     * The data is stored in the ScratchData, so that its memory is reused
+     * from one batch of cells to the next.
+     */
+    template <typename VectorizedValueTypeTest,
+              typename VectorizedValueTypeFunctor,
+              typename VectorizedValueTypeTrial,
+              std::size_t width>
+    struct CellBatchData
     {
-      ScratchDataType scratch(finite_element,
-                              cell_quadrature,
-                              cell_update_flags);
+      /**
+       * Get the data associated with the @p scratch_data.
+       */
+      template <int dim, int spacedim>
+      static CellBatchData &
+      get(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+      {
+        GeneralDataStorage &data_storage =
+          scratch_data.get_general_data_storage();
+        return data_storage.get_or_add_object_with_name<CellBatchData>(
+          get_name_cell_batch_data());
+      }
 
-      AD_SD_Functor_Cache::initialize(scratch, ad_sd_cache);
+      /**
+       * Prepare the data for a batch of cells with @p n_q_points quadrature
+       * points and @p n_dofs DoFs each.
+       */
+      void
+      reinit(const unsigned int n_q_points, const unsigned int n_dofs)
+      {
+        this->n_dofs = n_dofs;
+        shapes_test.resize_fast(n_q_points * n_dofs);
+        shapes_trial.resize_fast(n_q_points * n_dofs);
+        values_functor.resize_fast(n_q_points);
+        JxW.resize_fast(n_q_points);
+      }
 
-      return scratch;
-    }
+      unsigned int                                  n_dofs = 0;
+      AlignedVector<VectorizedValueTypeTest>        shapes_test;
+      AlignedVector<VectorizedValueTypeTrial>       shapes_trial;
+      AlignedVector<VectorizedValueTypeFunctor>     values_functor;
+      AlignedVector<VectorizedArray<double, width>> JxW;
 
+    private:
+      static const std::string &
+      get_name_cell_batch_data()
+      {
+        // The value types are part of the name, as the data for forms with
+        // different value types is stored side by side.
+        static const std::string name = Utilities::get_deal_II_prefix() +
+                                        "CellBatchData_" +
+                                        typeid(CellBatchData).name();
+        return name;
+      }
+    };
 
 
-    template <typename ScratchDataType,
-              typename FaceQuadratureType,
-              typename FiniteElementType,
-              typename CellQuadratureType>
-    typename std::enable_if<
-      std::is_same<typename std::decay<FaceQuadratureType>::type,
-                   std::nullptr_t>::value,
-      ScratchDataType>::type
-    construct_scratch_data(const FiniteElementType &        finite_element,
-                           const CellQuadratureType &       cell_quadrature,
-                           const UpdateFlags &              cell_update_flags,
-                           const FaceQuadratureType *const  face_quadrature,
-                           const UpdateFlags &              face_update_flags,
-                           const AD_SD_Functor_Cache *const ad_sd_cache)
+    // Valid for cell assembly, where each vectorization lane is associated
+    // with a different cell. All of the cells must share the same finite
+    // element and quadrature rule. The contribution of the cell in lane v
+    // is added to the local matrix of the cell with index lanes[v].
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim,
+              typename VectorizedValueTypeTest,
+              typename VectorizedValueTypeFunctor,
+              typename VectorizedValueTypeTrial,
+              std::size_t width>
+    void
+    assemble_cell_batch_matrix_contribution(
+      const std::vector<FullMatrix<ScalarType> *> &cell_matrices,
+      const std::vector<unsigned int> &            lanes,
+      const FEValuesBase<dim, spacedim> &          fe_values_dofs,
+      const CellBatchData<VectorizedValueTypeTest,
+                          VectorizedValueTypeFunctor,
+                          VectorizedValueTypeTrial,
+                          width> &                 batch_data,
+      const std::vector<unsigned int> &            test_dof_indices,
+      const std::vector<unsigned int> &            trial_dof_indices,
+      const bool                                   symmetric_contribution,
+      const bool equal_components_contribution)
     {
-      (void)face_quadrature;
-      (void)face_update_flags;
-      AssertThrow(false, ExcUnexpectedFunctionCall());
-      ScratchDataType scratch(finite_element,
-                              cell_quadrature,
-                              cell_update_flags);
+      const unsigned int n_lanes = lanes.size();
+      Assert(n_lanes > 0 && n_lanes <= width,
+             ExcIndexRange(n_lanes, 1, width + 1));
+      const unsigned int n_dofs = fe_values_dofs.dofs_per_cell;
+      Assert(batch_data.n_dofs == n_dofs,
+             ExcDimensionMismatch(batch_data.n_dofs, n_dofs));
+      Assert(batch_data.JxW.size() == fe_values_dofs.n_quadrature_points,
+             ExcDimensionMismatch(batch_data.JxW.size(),
+                                  fe_values_dofs.n_quadrature_points));
 
-      AD_SD_Functor_Cache::initialize(scratch, ad_sd_cache);
+      // This is the equivalent of
+      // for (c : cells) --> vectorized
+      //   for (q : q_points)
+      //     for (i : dof_indices)
+      //       for (j : dof_indices)
+      //         cell_matrix[c](i,j) += shapes_test[c][i][q] *
+      //         values_functor[c][q] * shapes_trial[c][j][q]) * JxW[c][q]
+      const auto qp_range = fe_values_dofs.quadrature_point_indices();
+      const std::vector<unsigned int> dof_component_index =
+        (equal_components_contribution ?
+           internal::get_dof_component_indices(fe_values_dofs) :
+           std::vector<unsigned int>());
 
-      return scratch;
-    }
+      for (const unsigned int q : qp_range)
+        {
+          const VectorizedValueTypeTest *const shapes_test =
+            &batch_data.shapes_test[q * n_dofs];
+          const VectorizedValueTypeTrial *const shapes_trial =
+            &batch_data.shapes_trial[q * n_dofs];
 
-    template <typename ScratchDataType,
+          for (const unsigned int j : trial_dof_indices)
+            {
+              using ContractionType_FS =
+                FullContraction<VectorizedValueTypeFunctor,
+                                VectorizedValueTypeTrial>;
+              const auto functor_x_shape_trial_x_JxW =
+                batch_data.JxW[q] *
+                ContractionType_FS::contract(batch_data.values_functor[q],
+                                             shapes_trial[j]);
+              using ContractionType_FS_t = typename std::decay<decltype(
+                functor_x_shape_trial_x_JxW)>::type;
+
+              const auto dof_range_i =
+                internal::get_test_dof_range(test_dof_indices,
+                                             j,
+                                             symmetric_contribution,
+                                             false);
+              for (auto it = dof_range_i.first; it != dof_range_i.second; ++it)
+                {
+                  const unsigned int i = *it;
+                  if (equal_components_contribution &&
+                      (dof_component_index[i] != dof_component_index[j]))
+                    {
+                      continue;
+                    }
+
+                  using ContractionType_SFS_JxW =
+                    FullContraction<VectorizedValueTypeTest,
+                                    ContractionType_FS_t>;
+                  const VectorizedArray<ScalarType, width>
+                    vectorized_integrated_contribution =
+                      ContractionType_SFS_JxW::contract(
+                        shapes_test[i], functor_x_shape_trial_x_JxW);
+
+                  // Scatter the contribution of each cell into its own
+                  // local matrix
+                  for (unsigned int v = 0; v < n_lanes; v++)
+                    {
+                      FullMatrix<ScalarType> &cell_matrix =
+                        *cell_matrices[lanes[v]];
+                      if (Sign == AccumulationSign::plus)
+                        {
+                          cell_matrix(i, j) +=
+                            vectorized_integrated_contribution[v];
+                        }
+                      else
+                        {
+                          Assert(Sign == AccumulationSign::minus,
+                                 ExcInternalError());
+                          cell_matrix(i, j) -=
+                            vectorized_integrated_contribution[v];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+    // GEMM counterparts of the cell matrix kernels
+    // ============================================
+
+
+    /**
+     * A trait that determines whether or not a bilinear form contribution
+     * can be computed with the LocalGEMMKernel. This is the case when the
+     * contraction of the test function values with those of the functor and
+     * trial solution is the sum of the products of their components.
+     */
+    template <typename ScalarType,
+              typename ValueTypeTest,
+              typename ValueTypeFunctor,
+              typename ValueTypeTrial>
+    struct GEMMKernelTraits
+    {
+      using ValueTypeWeightedTrial = typename std::decay<decltype(
+        FullContraction<ValueTypeFunctor, ValueTypeTrial>::contract(
+          std::declval<ValueTypeFunctor>(),
+          std::declval<ValueTypeTrial>()))>::type;
+
+      using AccessTest          = GEMMComponentAccess<ValueTypeTest>;
+      using AccessWeightedTrial = GEMMComponentAccess<ValueTypeWeightedTrial>;
+
+      static constexpr bool is_supported =
+        std::is_floating_point<ScalarType>::value && AccessTest::is_supported &&
+        AccessWeightedTrial::is_supported &&
+        AccessTest::rank == AccessWeightedTrial::rank &&
+        AccessTest::n_components == AccessWeightedTrial::n_components;
+
+      static constexpr unsigned int n_components = AccessTest::n_components;
+    };
+
+
+    // Valid for cell and face assembly
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim>
+    void
+    assemble_cell_matrix_gemm_product(
+      FullMatrix<ScalarType> &           cell_matrix,
+      const FEValuesBase<dim, spacedim> &fe_values_dofs,
+      const FullMatrix<ScalarType> &     local_matrix,
+      const bool                         symmetric_contribution,
+      const bool                         equal_components_contribution)
+    {
+      Assert(local_matrix.m() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(local_matrix.m(),
+                                  fe_values_dofs.dofs_per_cell));
+      Assert(local_matrix.n() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(local_matrix.n(),
+                                  fe_values_dofs.dofs_per_cell));
+
+      const std::vector<unsigned int> dof_component_index =
+        (equal_components_contribution ?
+           internal::get_dof_component_indices(fe_values_dofs) :
+           std::vector<unsigned int>());
+
+      for (const unsigned int j : fe_values_dofs.dof_indices())
+        {
+          // Assemble only the diagonal plus upper half of the matrix if
+          // the symmetry flag is set.
+          const auto dof_range_i =
+            (symmetric_contribution ? fe_values_dofs.dof_indices_ending_at(j) :
+                                      fe_values_dofs.dof_indices());
+          for (const unsigned int i : dof_range_i)
+            {
+              if (equal_components_contribution &&
+                  (dof_component_index[i] != dof_component_index[j]))
+                {
+                  continue;
+                }
+
+              if (Sign == AccumulationSign::plus)
+                {
+                  cell_matrix(i, j) += local_matrix(i, j);
+                }
+              else
+                {
+                  Assert(Sign == AccumulationSign::minus, ExcInternalError());
+                  cell_matrix(i, j) -= local_matrix(i, j);
+                }
+            }
+        }
+    }
+
+
+    // Valid for cell and face assembly
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim,
+              typename ValueTypeTest,
+              typename ValueTypeFunctor,
+              typename ValueTypeTrial>
+    typename std::enable_if<
+      GEMMKernelTraits<ScalarType,
+                       ValueTypeTest,
+                       ValueTypeFunctor,
+                       ValueTypeTrial>::is_supported>::type
+    assemble_cell_matrix_gemm_contribution(
+      FullMatrix<ScalarType> &                        cell_matrix,
+      LocalGEMMKernel<ScalarType> &                   gemm_kernel,
+      const FEValuesBase<dim, spacedim> &             fe_values_dofs,
+      const FEValuesBase<dim, spacedim> &             fe_values_q_points,
+      const std::vector<std::vector<ValueTypeTest>> & shapes_test,
+      const std::vector<ValueTypeFunctor> &           values_functor,
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial,
+      const std::vector<double> &                     JxW,
+      const std::vector<unsigned int> &               test_dof_indices,
+      const std::vector<unsigned int> &               trial_dof_indices,
+      const bool                                      symmetric_contribution,
+      const bool equal_components_contribution)
+    {
+      // The dense product is computed for all DoFs. The shape functions of
+      // the fields that the test and trial spaces don't act on are zero, so
+      // the entries that they contribute to vanish.
+      (void)test_dof_indices;
+      (void)trial_dof_indices;
+      using Traits = GEMMKernelTraits<ScalarType,
+                                      ValueTypeTest,
+                                      ValueTypeFunctor,
+                                      ValueTypeTrial>;
+      Assert(shapes_test.size() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(shapes_test.size(),
+                                  fe_values_dofs.dofs_per_cell));
+      Assert(shapes_trial.size() == fe_values_dofs.dofs_per_cell,
+             ExcDimensionMismatch(shapes_trial.size(),
+                                  fe_values_dofs.dofs_per_cell));
+      Assert(values_functor.size() == fe_values_q_points.n_quadrature_points,
+             ExcDimensionMismatch(values_functor.size(),
+                                  fe_values_q_points.n_quadrature_points));
+      Assert(JxW.size() == fe_values_q_points.n_quadrature_points,
+             ExcDimensionMismatch(JxW.size(),
+                                  fe_values_q_points.n_quadrature_points));
+
+      // This is the equivalent of
+      // for (q : q_points)
+      //   for (i : dof_indices)
+      //     for (j : dof_indices)
+      //       cell_matrix(i,j) += shapes_test[i][q] * values_functor[q] *
+      //       shapes_trial[j][q]) * JxW[q]
+      // but computed as B_test^T * (D * B_trial * JxW)
+      const auto qp_range = fe_values_q_points.quadrature_point_indices();
+      gemm_kernel.reinit(fe_values_q_points.n_quadrature_points,
+                         Traits::n_components,
+                         fe_values_dofs.dofs_per_cell);
+
+      for (const unsigned int j : fe_values_dofs.dof_indices())
+        for (const unsigned int q : qp_range)
+          {
+            using ContractionType_FS =
+              FullContraction<ValueTypeFunctor, ValueTypeTrial>;
+            gemm_kernel.set_weighted_trial_shape(
+              j,
+              q,
+              JxW[q] * ContractionType_FS::contract(values_functor[q],
+                                                    shapes_trial[j][q]));
+          }
+
+      for (const unsigned int i : fe_values_dofs.dof_indices())
+        for (const unsigned int q : qp_range)
+          gemm_kernel.set_test_shape(i, q, shapes_test[i][q]);
+
+      assemble_cell_matrix_gemm_product<Sign>(cell_matrix,
+                                              fe_values_dofs,
+                                              gemm_kernel.compute(),
+                                              symmetric_contribution,
+                                              equal_components_contribution);
+    }
+
+
+    // Valid for cell and face assembly
+    // Fall back to the standard kernel if the GEMM kernel cannot be used.
+    template <enum AccumulationSign Sign,
+              typename ScalarType,
+              int dim,
+              int spacedim,
+              typename ValueTypeTest,
+              typename ValueTypeFunctor,
+              typename ValueTypeTrial>
+    typename std::enable_if<
+      !GEMMKernelTraits<ScalarType,
+                        ValueTypeTest,
+                        ValueTypeFunctor,
+                        ValueTypeTrial>::is_supported>::type
+    assemble_cell_matrix_gemm_contribution(
+      FullMatrix<ScalarType> &                        cell_matrix,
+      LocalGEMMKernel<ScalarType> &                   gemm_kernel,
+      const FEValuesBase<dim, spacedim> &             fe_values_dofs,
+      const FEValuesBase<dim, spacedim> &             fe_values_q_points,
+      const std::vector<std::vector<ValueTypeTest>> & shapes_test,
+      const std::vector<ValueTypeFunctor> &           values_functor,
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial,
+      const std::vector<double> &                     JxW,
+      const std::vector<unsigned int> &               test_dof_indices,
+      const std::vector<unsigned int> &               trial_dof_indices,
+      const bool                                      symmetric_contribution,
+      const bool equal_components_contribution)
+    {
+      (void)gemm_kernel;
+      assemble_cell_matrix_contribution<Sign>(cell_matrix,
+                                              fe_values_dofs,
+                                              fe_values_q_points,
+                                              shapes_test,
+                                              values_functor,
+                                              shapes_trial,
+                                              JxW,
+                                              test_dof_indices,
+                                              trial_dof_indices,
+                                              symmetric_contribution,
+                                              equal_components_contribution);
+    }
+
+
+    // Valid for cell and face assembly
+    // Vectorized counterpart: This only gathers the data for one batch of
+    // quadrature points. The local matrix is computed once all batches have
+    // been processed.
+    template <typename ScalarType,
+              int dim,
+              int spacedim,
+              typename VectorizedValueTypeTest,
+              typename VectorizedValueTypeFunctor,
+              typename VectorizedValueTypeTrial,
+              std::size_t width>
+    typename std::enable_if<
+      GEMMKernelTraits<ScalarType,
+                       VectorizedValueTypeTest,
+                       VectorizedValueTypeFunctor,
+                       VectorizedValueTypeTrial>::is_supported>::type
+    add_cell_matrix_vectorized_qp_batch_gemm_data(
+      LocalGEMMKernel<ScalarType> &                  gemm_kernel,
+      const FEValuesBase<dim, spacedim> &            fe_values_dofs,
+      const AlignedVector<VectorizedValueTypeTest> & shapes_test,
+      const VectorizedValueTypeFunctor &             values_functor,
+      const AlignedVector<VectorizedValueTypeTrial> &shapes_trial,
+      const VectorizedArray<double, width> &         JxW,
+      const types::vectorized_qp_range_t &           q_point_range)
+    {
+      for (const unsigned int j : fe_values_dofs.dof_indices())
+        {
+          using ContractionType_FS = FullContraction<VectorizedValueTypeFunctor,
+                                                     VectorizedValueTypeTrial>;
+          const auto functor_x_shape_trial_x_JxW =
+            JxW * ContractionType_FS::contract(values_functor, shapes_trial[j]);
+
+          // Only the lanes that hold valid quadrature points are gathered,
+          // so there is no horizontal reduction over the lanes.
+          for (unsigned int v = 0; v < q_point_range.size(); ++v)
+            gemm_kernel.set_weighted_trial_shape(j,
+                                                 q_point_range[v],
+                                                 functor_x_shape_trial_x_JxW,
+                                                 v);
+        }
+
+      for (const unsigned int i : fe_values_dofs.dof_indices())
+        for (unsigned int v = 0; v < q_point_range.size(); ++v)
+          gemm_kernel.set_test_shape(i, q_point_range[v], shapes_test[i], v);
+    }
+
+
+    template <typename ScalarType,
+              int dim,
+              int spacedim,
+              typename VectorizedValueTypeTest,
+              typename VectorizedValueTypeFunctor,
+              typename VectorizedValueTypeTrial,
+              std::size_t width>
+    typename std::enable_if<
+      !GEMMKernelTraits<ScalarType,
+                        VectorizedValueTypeTest,
+                        VectorizedValueTypeFunctor,
+                        VectorizedValueTypeTrial>::is_supported>::type
+    add_cell_matrix_vectorized_qp_batch_gemm_data(
+      LocalGEMMKernel<ScalarType> &,
+      const FEValuesBase<dim, spacedim> &,
+      const AlignedVector<VectorizedValueTypeTest> &,
+      const VectorizedValueTypeFunctor &,
+      const AlignedVector<VectorizedValueTypeTrial> &,
+      const VectorizedArray<double, width> &,
+      const types::vectorized_qp_range_t &)
+    {
+      AssertThrow(false,
+                  ExcMessage("The GEMM kernel cannot be used for this "
+                             "bilinear form."));
+    }
+
+
+
+    // Utility functions to help with template arguments of the
+    // assemble_system() method being void / std::null_ptr_t.
+
+    template <typename ScratchDataType,
+              typename FiniteElementType,
+              typename CellQuadratureType>
+    ScratchDataType
+    construct_scratch_data(const FiniteElementType &        finite_element,
+                           const CellQuadratureType &       cell_quadrature,
+                           const UpdateFlags &              cell_update_flags,
+                           const AD_SD_Functor_Cache *const ad_sd_cache)
+    {
+      ScratchDataType scratch(finite_element,
+                              cell_quadrature,
+                              cell_update_flags);
+
+      AD_SD_Functor_Cache::initialize(scratch, ad_sd_cache);
+
+      return scratch;
+    }
+
+
+
+    template <typename ScratchDataType,
+              typename FaceQuadratureType,
+              typename FiniteElementType,
+              typename CellQuadratureType>
+    typename std::enable_if<
+      std::is_same<typename std::decay<FaceQuadratureType>::type,
+                   std::nullptr_t>::value,
+      ScratchDataType>::type
+    construct_scratch_data(const FiniteElementType &        finite_element,
+                           const CellQuadratureType &       cell_quadrature,
+                           const UpdateFlags &              cell_update_flags,
+                           const FaceQuadratureType *const  face_quadrature,
+                           const UpdateFlags &              face_update_flags,
+                           const AD_SD_Functor_Cache *const ad_sd_cache)
+    {
+      (void)face_quadrature;
+      (void)face_update_flags;
+      AssertThrow(false, ExcUnexpectedFunctionCall());
+      ScratchDataType scratch(finite_element,
+                              cell_quadrature,
+                              cell_update_flags);
+
+      AD_SD_Functor_Cache::initialize(scratch, ad_sd_cache);
+
+      return scratch;
+    }
+
+    template <typename ScratchDataType,
               typename FaceQuadratureType,
               typename FiniteElementType,
               typename CellQuadratureType>
@@ -1197,68 +2049,434 @@ namespace WeakForms
       const std::vector<dealii::types::global_dof_index> &local_dof_indices,
       MatrixType *const                                   system_matrix)
     {
-      Assert(system_matrix, ExcInternalError());
-      constraints.distribute_local_to_global(cell_matrix,
-                                             local_dof_indices,
-                                             *system_matrix);
-    }
+      Assert(system_matrix, ExcInternalError());
+      constraints.distribute_local_to_global(cell_matrix,
+                                             local_dof_indices,
+                                             *system_matrix);
+    }
+
+    template <typename VectorType, typename ScalarType>
+    typename std::enable_if<std::is_same<typename std::decay<VectorType>::type,
+                                         std::nullptr_t>::value>::type
+    distribute_local_to_global(
+      const AffineConstraints<ScalarType> &               constraints,
+      const Vector<ScalarType> &                          cell_vector,
+      const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+      VectorType *const                                   system_vector)
+    {
+      (void)constraints;
+      (void)cell_vector;
+      (void)local_dof_indices;
+      (void)system_vector;
+
+      // Void pointer; do nothing.
+      AssertThrow(false, ExcUnexpectedFunctionCall());
+    }
+
+    template <typename VectorType, typename ScalarType>
+    typename std::enable_if<!std::is_same<typename std::decay<VectorType>::type,
+                                          std::nullptr_t>::value>::type
+    distribute_local_to_global(
+      const AffineConstraints<ScalarType> &               constraints,
+      const Vector<ScalarType> &                          cell_vector,
+      const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+      VectorType *const                                   system_vector)
+    {
+      Assert(system_vector, ExcInternalError());
+      constraints.distribute_local_to_global(cell_vector,
+                                             local_dof_indices,
+                                             *system_vector);
+    }
+
+    template <typename MatrixOrVectorType>
+    typename std::enable_if<
+      std::is_same<typename std::decay<MatrixOrVectorType>::type,
+                   std::nullptr_t>::value>::type
+    compress(MatrixOrVectorType *const system_matrix_or_vector)
+    {
+      (void)system_matrix_or_vector;
+
+      // Void pointer; do nothing.
+      AssertThrow(false, ExcUnexpectedFunctionCall());
+    }
+
+    template <typename MatrixOrVectorType>
+    typename std::enable_if<
+      !std::is_same<typename std::decay<MatrixOrVectorType>::type,
+                    std::nullptr_t>::value>::type
+    compress(MatrixOrVectorType *const system_matrix_or_vector)
+    {
+      Assert(system_matrix_or_vector, ExcInternalError());
+      system_matrix_or_vector->compress(VectorOperation::add);
+    }
+
+
+    // Distributed vectors that support it may exchange their off-process
+    // contributions without blocking, while the assembly proceeds. Each of
+    // the exchanges that are in flight at the same time must use its own
+    // communication channel.
+
+    template <typename VectorType, typename = void>
+    struct HasNonBlockingCompress : std::false_type
+    {};
+
+    template <typename VectorType>
+    struct HasNonBlockingCompress<
+      VectorType,
+      decltype(std::declval<VectorType &>().compress_start(
+                 0u, VectorOperation::add),
+               void())> : std::true_type
+    {};
+
+    template <typename VectorType>
+    typename std::enable_if<HasNonBlockingCompress<VectorType>::value>::type
+    compress_start(VectorType *const   system_vector,
+                   const unsigned int communication_channel)
+    {
+      Assert(system_vector, ExcInternalError());
+      system_vector->compress_start(communication_channel,
+                                    VectorOperation::add);
+    }
+
+    template <typename VectorType>
+    typename std::enable_if<!HasNonBlockingCompress<VectorType>::value>::type
+    compress_start(VectorType *const   system_vector,
+                   const unsigned int communication_channel)
+    {
+      // The exchange only takes place upon compress_finish().
+      (void)system_vector;
+      (void)communication_channel;
+    }
+
+    template <typename VectorType>
+    typename std::enable_if<HasNonBlockingCompress<VectorType>::value>::type
+    compress_finish(VectorType *const system_vector)
+    {
+      Assert(system_vector, ExcInternalError());
+      system_vector->compress_finish(VectorOperation::add);
+    }
+
+    template <typename VectorType>
+    typename std::enable_if<!HasNonBlockingCompress<VectorType>::value>::type
+    compress_finish(VectorType *const system_vector)
+    {
+      compress(system_vector);
+    }
+
+
+    /**
+     * The entries of the local matrix that the cell and boundary face matrix
+     * operations are required to compute. This is decided by the assembler
+     * for each cell in turn, and is passed to each of these operations.
+     */
+    enum class LocalMatrixContribution
+    {
+      /**
+       * Compute all of the entries of the local matrix.
+       */
+      full,
+      /**
+       * Only compute the diagonal entries of the local matrix.
+       */
+      diagonal,
+      /**
+       * Only compute the sum of the entries in each row of the local matrix,
+       * and store it in the diagonal entry of that row.
+       */
+      row_sum
+    };
+
+
+    // Utilities to help fuse the contributions of several integrals into
+    // a single assembly operation.
+
+    constexpr AccumulationSign
+    opposite_sign(const AccumulationSign sign)
+    {
+      return (sign == AccumulationSign::plus ? AccumulationSign::minus :
+                                               AccumulationSign::plus);
+    }
+
+
+    /**
+     * The type of local contribution that an integral makes. This also
+     * determines the list of operations in which the assembler stores it.
+     */
+    enum class AssemblyOperationType
+    {
+      cell_matrix,
+      cell_vector,
+      boundary_face_matrix,
+      boundary_face_vector,
+      interface_face_matrix,
+      interface_face_vector,
+      // Self-linearizing forms, and anything else that cannot be fused
+      none
+    };
+
+    template <enum AssemblyOperationType Type>
+    using AssemblyOperationTypeTag =
+      std::integral_constant<enum AssemblyOperationType, Type>;
+
+    template <typename IntegralType, typename T = void>
+    struct AssemblyOperationTypeHelper
+    {
+      static constexpr enum AssemblyOperationType value =
+        AssemblyOperationType::none;
+    };
+
+    template <typename IntegralType>
+    struct AssemblyOperationTypeHelper<
+      IntegralType,
+      typename std::enable_if<
+        is_symbolic_integral_op<IntegralType>::value &&
+        (is_bilinear_form<typename IntegralType::IntegrandType>::value ||
+         is_linear_form<typename IntegralType::IntegrandType>::value)>::type>
+    {
+      static constexpr bool is_matrix =
+        is_bilinear_form<typename IntegralType::IntegrandType>::value;
+
+      static constexpr enum AssemblyOperationType value =
+        (is_volume_integral_op<IntegralType>::value ?
+           (is_matrix ? AssemblyOperationType::cell_matrix :
+                        AssemblyOperationType::cell_vector) :
+           (is_boundary_integral_op<IntegralType>::value ?
+              (is_matrix ? AssemblyOperationType::boundary_face_matrix :
+                           AssemblyOperationType::boundary_face_vector) :
+              (is_interface_integral_op<IntegralType>::value ?
+                 (is_matrix ? AssemblyOperationType::interface_face_matrix :
+                              AssemblyOperationType::interface_face_vector) :
+                 AssemblyOperationType::none)));
+    };
+
+
+    /**
+     * A trait that indicates whether or not the contribution of a bilinear
+     * form integral depends on the solution. This is the case if any of its
+     * operands involves a field solution, or is evaluated using data that is
+     * stored in the scratch data (e.g. the linearization of a
+     * self-linearizing form).
+     *
+     * @note The values returned by user-defined functors are assumed not to
+     * depend on the solution.
+     */
+    template <typename IntegralType, typename T = void>
+    struct IsSolutionDependentIntegral : std::true_type
+    {};
+
+    template <typename IntegralType>
+    struct IsSolutionDependentIntegral<
+      IntegralType,
+      typename std::enable_if<
+        is_symbolic_integral_op<IntegralType>::value &&
+        is_bilinear_form<typename IntegralType::IntegrandType>::value>::type>
+    {
+    private:
+      template <typename Op>
+      static constexpr bool
+      is_solution_dependent()
+      {
+        return is_field_solution_op<Op>::value ||
+               has_field_solution_op<Op>::value ||
+               is_evaluated_with_scratch_data<Op>::value ||
+               has_evaluated_with_scratch_data<Op>::value;
+      }
+
+      using Form = typename IntegralType::IntegrandType;
+
+    public:
+      static constexpr bool value =
+        is_solution_dependent<typename Form::TestSpaceOp>() ||
+        is_solution_dependent<typename Form::Functor>() ||
+        is_solution_dependent<typename Form::TrialSpaceOp>();
+    };
+
+
+    /**
+     * A trait that indicates whether or not the local contribution of an
+     * integral, which is assembled by an operation of the given @p Type, may
+     * be cached between assembly calls. This is only supported for the
+     * solution-independent cell matrix contributions.
+     */
+    template <enum AssemblyOperationType Type, typename IntegralType>
+    struct IsCacheableOperation
+      : std::integral_constant<
+          bool,
+          Type == AssemblyOperationType::cell_matrix &&
+            !IsSolutionDependentIntegral<IntegralType>::value>
+    {};
+
+
+    /**
+     * Visit all of the symbolic integrals at the leaves of a composite
+     * integral, keeping track of the sign with which each one is to be
+     * accumulated. The @p visitor is called with each leaf integral and
+     * its sign (encoded as a type), and must return a tuple. The result is
+     * the concatenation of all of these tuples.
+     */
+    template <typename IntegralType, typename T = void>
+    struct IntegralTreeVisitor
+    {
+      static_assert(is_symbolic_integral_op<IntegralType>::value,
+                    "Expected the leaf of a composite integral to be a "
+                    "symbolic integral.");
 
-    template <typename VectorType, typename ScalarType>
-    typename std::enable_if<std::is_same<typename std::decay<VectorType>::type,
-                                         std::nullptr_t>::value>::type
-    distribute_local_to_global(
-      const AffineConstraints<ScalarType> &               constraints,
-      const Vector<ScalarType> &                          cell_vector,
-      const std::vector<dealii::types::global_dof_index> &local_dof_indices,
-      VectorType *const                                   system_vector)
+      template <enum AccumulationSign Sign, typename VisitorType>
+      static auto
+      apply(const IntegralType &integral, const VisitorType &visitor)
+      {
+        return visitor(integral,
+                       std::integral_constant<enum AccumulationSign, Sign>());
+      }
+    };
+
+    template <typename IntegralType>
+    struct IntegralTreeVisitor<
+      IntegralType,
+      typename std::enable_if<is_binary_integral_op<IntegralType>::value>::type>
     {
-      (void)constraints;
-      (void)cell_vector;
-      (void)local_dof_indices;
-      (void)system_vector;
+      static_assert(IntegralType::op_code == Operators::BinaryOpCodes::add ||
+                      IntegralType::op_code ==
+                        Operators::BinaryOpCodes::subtract,
+                    "Only the addition and subtraction of integrals can be "
+                    "fused.");
 
-      // Void pointer; do nothing.
-      AssertThrow(false, ExcUnexpectedFunctionCall());
-    }
+      using LhsOpType = typename IntegralType::LhsOpType;
+      using RhsOpType = typename IntegralType::RhsOpType;
 
-    template <typename VectorType, typename ScalarType>
-    typename std::enable_if<!std::is_same<typename std::decay<VectorType>::type,
-                                          std::nullptr_t>::value>::type
-    distribute_local_to_global(
-      const AffineConstraints<ScalarType> &               constraints,
-      const Vector<ScalarType> &                          cell_vector,
-      const std::vector<dealii::types::global_dof_index> &local_dof_indices,
-      VectorType *const                                   system_vector)
+      template <enum AccumulationSign Sign, typename VisitorType>
+      static auto
+      apply(const IntegralType &integral, const VisitorType &visitor)
+      {
+        // For subtraction, the RHS of the composite operation swaps its sign.
+        constexpr enum AccumulationSign rhs_sign =
+          (IntegralType::op_code == Operators::BinaryOpCodes::add ?
+             Sign :
+             opposite_sign(Sign));
+
+        return std::tuple_cat(
+          IntegralTreeVisitor<LhsOpType>::template apply<Sign>(
+            integral.get_lhs_operand(), visitor),
+          IntegralTreeVisitor<RhsOpType>::template apply<rhs_sign>(
+            integral.get_rhs_operand(), visitor));
+      }
+    };
+
+    template <typename IntegralType>
+    struct IntegralTreeVisitor<
+      IntegralType,
+      typename std::enable_if<is_unary_integral_op<IntegralType>::value>::type>
     {
-      Assert(system_vector, ExcInternalError());
-      constraints.distribute_local_to_global(cell_vector,
-                                             local_dof_indices,
-                                             *system_vector);
-    }
+      static_assert(IntegralType::op_code == Operators::UnaryOpCodes::negate,
+                    "Only the negation of integrals can be fused.");
 
-    template <typename MatrixOrVectorType>
-    typename std::enable_if<
-      std::is_same<typename std::decay<MatrixOrVectorType>::type,
-                   std::nullptr_t>::value>::type
-    compress(MatrixOrVectorType *const system_matrix_or_vector)
+      using OpType = typename IntegralType::OpType;
+
+      template <enum AccumulationSign Sign, typename VisitorType>
+      static auto
+      apply(const IntegralType &integral, const VisitorType &visitor)
+      {
+        return IntegralTreeVisitor<OpType>::template apply<opposite_sign(
+          Sign)>(integral.get_operand(), visitor);
+      }
+    };
+
+
+    /**
+     * An assembly operation that invokes a fixed set of operations, one
+     * after the other. Since the type of each operation is known, the
+     * compiler is able to inline all of them into a single kernel.
+     */
+    template <typename... OperationTypes>
+    class FusedOperation
     {
-      (void)system_matrix_or_vector;
+    public:
+      explicit FusedOperation(const std::tuple<OperationTypes...> &operations)
+        : operations(operations)
+      {}
+
+      template <typename... Args>
+      void
+      operator()(Args &&...args) const
+      {
+        invoke(std::index_sequence_for<OperationTypes...>(), args...);
+      }
 
-      // Void pointer; do nothing.
-      AssertThrow(false, ExcUnexpectedFunctionCall());
-    }
+    private:
+      const std::tuple<OperationTypes...> operations;
 
-    template <typename MatrixOrVectorType>
-    typename std::enable_if<
-      !std::is_same<typename std::decay<MatrixOrVectorType>::type,
-                    std::nullptr_t>::value>::type
-    compress(MatrixOrVectorType *const system_matrix_or_vector)
+      template <std::size_t... I, typename... Args>
+      void
+      invoke(std::index_sequence<I...>, Args &...args) const
+      {
+        const int dummy[] = {0, (std::get<I>(operations)(args...), 0)...};
+        (void)dummy;
+      }
+    };
+
+  } // namespace internal
+
+
+
+  /**
+   * A wrapper for a (composite) integral, indicating that all of its
+   * contributions are to be fused by the assembler.
+   *
+   * By default, the assembler stores each of the integrals that it is given
+   * as a separate, type-erased operation, and invokes each of them in turn
+   * on every cell or face. When an integral is wrapped in this class, all of
+   * its leaf integrals that are integrated over the same domain and that
+   * make the same type of contribution (i.e. to the local matrix or vector)
+   * are combined into a single operation. As the type of each of these leaf
+   * operations is known at compile time, the compiler is able to inline
+   * them into one kernel and optimize across the individual forms. This
+   * typically pays off for low-order elements, for which the overhead of
+   * invoking each operation is a significant part of the cost of assembly.
+   *
+   * @code
+   * MatrixBasedAssembler<dim> assembler;
+   * assembler += fuse(bilinear_form(test_val, coeff_func, trial_val).dV() +
+   *                   bilinear_form(test_grad, coeff_func, trial_grad).dV() -
+   *                   linear_form(test_val, rhs_func).dV());
+   * @endcode
+   *
+   * @note Only the addition, subtraction and negation of integrals can be
+   * fused. Self-linearizing forms are not fused, but are added to the
+   * assembler as they would otherwise be.
+   */
+  template <typename IntegralType>
+  class FusedIntegral
+  {
+  public:
+    explicit FusedIntegral(const IntegralType &integral)
+      : integral(integral)
+    {}
+
+    const IntegralType &
+    get_integral() const
     {
-      Assert(system_matrix_or_vector, ExcInternalError());
-      system_matrix_or_vector->compress(VectorOperation::add);
+      return integral;
     }
 
-  } // namespace internal
+  private:
+    const IntegralType integral;
+  };
+
+
+  /**
+   * Mark a (composite) integral such that all of its contributions are fused
+   * by the assembler.
+   *
+   * @see FusedIntegral
+   */
+  template <typename IntegralType>
+  FusedIntegral<IntegralType>
+  fuse(const IntegralType &integral)
+  {
+    static_assert(is_integral_op<IntegralType>::value,
+                  "Only integrals can be fused.");
+    return FusedIntegral<IntegralType>(integral);
+  }
 
 
 
@@ -1301,8 +2519,17 @@ namespace WeakForms
       void(FullMatrix<ScalarType> &                cell_matrix,
            MeshWorker::ScratchData<dim, spacedim> &scratch_data,
            const std::vector<SolutionExtractionData<dim, spacedim>>
-             &                                solution_extraction_data,
-           const FEValuesBase<dim, spacedim> &fe_values)>;
+             &                                     solution_extraction_data,
+           const FEValuesBase<dim, spacedim> &     fe_values,
+           const internal::LocalMatrixContribution contribution)>;
+    using CellBatchMatrixOperation = std::function<
+      void(const std::vector<FullMatrix<ScalarType> *> &cell_matrices,
+           const std::vector<MeshWorker::ScratchData<dim, spacedim> *>
+             &scratch_data,
+           const std::vector<
+             const std::vector<SolutionExtractionData<dim, spacedim>> *>
+             &solution_extraction_data,
+           const std::vector<const FEValuesBase<dim, spacedim> *> &fe_values)>;
     using CellVectorOperation = std::function<
       void(Vector<ScalarType> &                    cell_vector,
            MeshWorker::ScratchData<dim, spacedim> &scratch_data,
@@ -1314,10 +2541,11 @@ namespace WeakForms
       void(FullMatrix<ScalarType> &                cell_matrix,
            MeshWorker::ScratchData<dim, spacedim> &scratch_data,
            const std::vector<SolutionExtractionData<dim, spacedim>>
-             &                                    solution_extraction_data,
-           const FEValuesBase<dim, spacedim> &    fe_values,
-           const FEFaceValuesBase<dim, spacedim> &fe_face_values,
-           const unsigned int                     face)>;
+             &                                     solution_extraction_data,
+           const FEValuesBase<dim, spacedim> &     fe_values,
+           const FEFaceValuesBase<dim, spacedim> & fe_face_values,
+           const unsigned int                      face,
+           const internal::LocalMatrixContribution contribution)>;
     using BoundaryVectorOperation = std::function<
       void(Vector<ScalarType> &                    cell_vector,
            MeshWorker::ScratchData<dim, spacedim> &scratch_data,
@@ -1568,7 +2796,7 @@ namespace WeakForms
                         internal::AccumulationSign::minus);
 
       add_ascii_latex_operations<print_sign>(volume_integral);
-      add_cell_operation<op_sign>(volume_integral);
+      add_operation<op_sign>(volume_integral);
 
       return *this;
     }
@@ -1600,7 +2828,7 @@ namespace WeakForms
                         internal::AccumulationSign::minus);
 
       add_ascii_latex_operations<print_sign>(boundary_integral);
-      add_boundary_face_operation<op_sign>(boundary_integral);
+      add_operation<op_sign>(boundary_integral);
 
       return *this;
     }
@@ -1632,7 +2860,7 @@ namespace WeakForms
                         internal::AccumulationSign::minus);
 
       add_ascii_latex_operations<print_sign>(interface_integral);
-      add_interface_face_operation<op_sign>(interface_integral);
+      add_operation<op_sign>(interface_integral);
 
       return *this;
     }
@@ -1720,7 +2948,7 @@ namespace WeakForms
                         internal::AccumulationSign::plus);
 
       add_ascii_latex_operations<print_sign>(volume_integral);
-      add_cell_operation<op_sign>(volume_integral);
+      add_operation<op_sign>(volume_integral);
 
       return *this;
     }
@@ -1752,7 +2980,7 @@ namespace WeakForms
                         internal::AccumulationSign::plus);
 
       add_ascii_latex_operations<print_sign>(boundary_integral);
-      add_boundary_face_operation<op_sign>(boundary_integral);
+      add_operation<op_sign>(boundary_integral);
 
       return *this;
     }
@@ -1784,8 +3012,71 @@ namespace WeakForms
                         internal::AccumulationSign::plus);
 
       add_ascii_latex_operations<print_sign>(interface_integral);
-      add_interface_face_operation<op_sign>(interface_integral);
+      add_operation<op_sign>(interface_integral);
+
+      return *this;
+    }
+
+
+    // For the cases:
+    //  assembler += fuse(().dV + ().dV + ...)
+    //  assembler += fuse(().dV - ().dA + ...)
+    //  ... etc.
+    template <typename IntegralType>
+    AssemblerBase &
+    operator+=(const FusedIntegral<IntegralType> &fused_integral)
+    {
+      add_fused_integral<internal::AccumulationSign::plus>(
+        fused_integral.get_integral());
+      return *this;
+    }
+
+
+    // For the cases:
+    //  assembler -= fuse(().dV + ().dV + ...)
+    //  assembler -= fuse(().dV - ().dA + ...)
+    //  ... etc.
+    template <typename IntegralType>
+    AssemblerBase &
+    operator-=(const FusedIntegral<IntegralType> &fused_integral)
+    {
+      add_fused_integral<internal::AccumulationSign::minus>(
+        fused_integral.get_integral());
+      return *this;
+    }
+
 
+    /**
+     * Add the @p integral to this assembler, such that its contributions
+     * are assembled into the output with the given @p slot. The integral
+     * may be anything that could otherwise be added with operator+=().
+     *
+     * Forms added with operator+=() are associated with the first slot.
+     * When several system matrices and vectors are assembled at once, the
+     * bilinear forms associated with each slot contribute to the system
+     * matrix with the same index, and the linear forms to the system vector
+     * with the same index. All other assembly functions require all forms
+     * to be associated with the first slot.
+     */
+    template <typename IntegralType>
+    AssemblerBase &
+    add(const IntegralType &integral, const unsigned int slot)
+    {
+      // The slot must be reset even if adding the integral fails, so that
+      // it does not affect any subsequently added integrals.
+      struct ActiveSlotGuard
+      {
+        ~ActiveSlotGuard()
+        {
+          active_slot = 0;
+        }
+
+        unsigned int &active_slot;
+      };
+      const ActiveSlotGuard guard{active_slot};
+      active_slot = slot;
+
+      *this += integral;
       return *this;
     }
 
@@ -1889,7 +3180,111 @@ namespace WeakForms
       set_global_system_symmetry_flag(true);
     }
 
+    /**
+     * Set whether or not the local matrix contributions of bilinear forms
+     * that are integrated over cells and boundary faces are computed as a
+     * dense matrix-matrix product (the "B^T D B" formulation), rather than
+     * by integrating each local matrix entry individually.
+     *
+     * This is typically much faster for elements with many DoFs per cell,
+     * e.g. higher-order vector-valued elements. Contributions for which this
+     * kernel is not applicable (e.g. complex-valued ones) are still assembled
+     * with the standard kernel.
+     */
+    void
+    set_local_gemm_kernel_flag(const bool flag)
+    {
+      local_gemm_kernel_flag = flag;
+    }
+
+    /**
+     * Return the table that indicates which components of the finite element
+     * of the @p dof_handler are coupled with one another by the bilinear
+     * forms that have been added to this assembler. Cell, boundary face and
+     * interface integrals couple the components of a single cell.
+     *
+     * If the global system is to be symmetric, then the table is
+     * symmetrized.
+     */
+    Table<2, DoFTools::Coupling>
+    compute_coupling_table(
+      const DoFHandler<dim, spacedim> &dof_handler) const
+    {
+      Table<2, DoFTools::Coupling> cell_couplings;
+      Table<2, DoFTools::Coupling> face_couplings;
+      compute_coupling_tables(dof_handler, cell_couplings, face_couplings);
+      return cell_couplings;
+    }
+
+    /**
+     * Return the table that indicates which components of the finite element
+     * of the @p dof_handler on either side of an interface are coupled with
+     * one another by the interface integrals of bilinear forms that have been
+     * added to this assembler.
+     */
+    Table<2, DoFTools::Coupling>
+    compute_face_coupling_table(
+      const DoFHandler<dim, spacedim> &dof_handler) const
+    {
+      Table<2, DoFTools::Coupling> cell_couplings;
+      Table<2, DoFTools::Coupling> face_couplings;
+      compute_coupling_tables(dof_handler, cell_couplings, face_couplings);
+      return face_couplings;
+    }
+
+    /**
+     * Build the @p sparsity_pattern for the system that this assembler
+     * computes, only including the entries for components that are actually
+     * coupled by the bilinear forms that have been added to it. If any
+     * interface integrals couple components then the flux sparsity pattern,
+     * which includes the couplings between neighboring cells, is built.
+     *
+     * This avoids the need to construct these coupling tables by hand, and
+     * eliminates all of the zero blocks from the system matrix.
+     */
+    template <typename SparsityPatternType, typename number>
+    void
+    make_sparsity_pattern(const DoFHandler<dim, spacedim> &dof_handler,
+                          const AffineConstraints<number> &constraints,
+                          SparsityPatternType &            sparsity_pattern,
+                          const bool keep_constrained_dofs = true) const
+    {
+      Table<2, DoFTools::Coupling> cell_couplings;
+      Table<2, DoFTools::Coupling> face_couplings;
+      compute_coupling_tables(dof_handler, cell_couplings, face_couplings);
+
+      const bool has_face_couplings =
+        std::any_of(face_couplings.begin(),
+                    face_couplings.end(),
+                    [](const DoFTools::Coupling coupling)
+                    { return coupling != DoFTools::none; });
+
+      if (has_face_couplings)
+        DoFTools::make_flux_sparsity_pattern(dof_handler,
+                                             sparsity_pattern,
+                                             constraints,
+                                             keep_constrained_dofs,
+                                             cell_couplings,
+                                             face_couplings,
+                                             numbers::invalid_subdomain_id);
+      else
+        DoFTools::make_sparsity_pattern(dof_handler,
+                                        cell_couplings,
+                                        sparsity_pattern,
+                                        constraints,
+                                        keep_constrained_dofs);
+    }
+
   protected:
+    /**
+     * An operation that marks the components that a bilinear form couples
+     * in the coupling tables for cell (and boundary face) contributions and
+     * interface contributions.
+     */
+    using CouplingOperation =
+      std::function<void(Table<2, DoFTools::Coupling> &cell_couplings,
+                         Table<2, DoFTools::Coupling> &face_couplings)>;
+
     std::vector<StringOperation> as_ascii_operations;
     std::vector<StringOperation> as_latex_operations;
 
@@ -1904,6 +3299,16 @@ namespace WeakForms
     std::vector<CellMatrixOperation> cell_matrix_operations;
     std::vector<CellVectorOperation> cell_vector_operations;
 
+    // The counterparts of the cell matrix operations that assemble a batch
+    // of cells at once. There is one entry for each of the cell matrix
+    // operations, and the two are stored in the same order.
+    std::vector<CellBatchMatrixOperation> cell_batch_matrix_operations;
+
+    // Whether or not each of the cell matrix operations depends on the
+    // solution. There is one entry for each of the cell matrix operations,
+    // and the two are stored in the same order.
+    std::vector<bool> cell_matrix_solution_dependence;
+
     // Boundary faces
     UpdateFlags                          boundary_face_update_flags;
     std::vector<BoundaryMatrixOperation> boundary_face_matrix_operations;
@@ -1914,6 +3319,19 @@ namespace WeakForms
     std::vector<InterfaceMatrixOperation> interface_face_matrix_operations;
     std::vector<InterfaceVectorOperation> interface_face_vector_operations;
 
+    // Component couplings of all bilinear forms
+    std::vector<CouplingOperation> coupling_operations;
+
+    // The output slot that each operation contributes to. For each type of
+    // operation there is one entry for each of the operations of that type,
+    // and the two are stored in the same order.
+    std::array<std::vector<unsigned int>,
+               static_cast<unsigned int>(internal::AssemblyOperationType::none)>
+      operation_slots;
+
+    // The slot that newly added operations are associated with.
+    unsigned int active_slot;
+
     /**
      * A flag to indicate whether or not the global system is to be assembled
      * in symmetric form, or not.
@@ -1924,6 +3342,12 @@ namespace WeakForms
      */
     bool global_system_symmetry_flag;
 
+    /**
+     * A flag to indicate whether or not the local matrix contributions of
+     * bilinear forms are computed with the LocalGEMMKernel.
+     */
+    bool local_gemm_kernel_flag;
+
 
     explicit AssemblerBase()
       : ad_sd_functor_cache(nullptr)
@@ -1931,6 +3355,8 @@ namespace WeakForms
       , boundary_face_update_flags(update_default)
       , interface_face_update_flags(update_default)
       , global_system_symmetry_flag(false)
+      , local_gemm_kernel_flag(false)
+      , active_slot(0)
     {}
 
 
@@ -1940,6 +3366,8 @@ namespace WeakForms
       , boundary_face_update_flags(update_default)
       , interface_face_update_flags(update_default)
       , global_system_symmetry_flag(false)
+      , local_gemm_kernel_flag(false)
+      , active_slot(0)
     {}
 
 
@@ -1992,8 +3420,8 @@ namespace WeakForms
               typename std::enable_if<is_bilinear_form<
                 typename SymbolicOpVolumeIntegral::IntegrandType>::value>::type
                 * = nullptr>
-    void
-    add_cell_operation(const SymbolicOpVolumeIntegral &volume_integral)
+    auto
+    make_cell_operation(const SymbolicOpVolumeIntegral &volume_integral)
     {
       static_assert(is_volume_integral_op<SymbolicOpVolumeIntegral>::value,
                     "Expected a volume integral type.");
@@ -2035,6 +3463,11 @@ namespace WeakForms
       const bool &global_system_symmetry_flag =
         this->global_system_symmetry_flag;
 
+      // The kernel that computes the local matrix can also be chosen at any
+      // point before the actual operation, so this flag also refers back to
+      // that stored in the assembler itself.
+      const bool &local_gemm_kernel_flag = this->local_gemm_kernel_flag;
+
       // Contribution shape function Kronecker delta property
       const bool local_contribution_delta_IJ_flag =
         form.has_kronecker_delta_property();
@@ -2111,13 +3544,15 @@ namespace WeakForms
                       trial_space_op,
                       local_contribution_symmetry_flag,
                       &global_system_symmetry_flag,
+                      &local_gemm_kernel_flag,
                       local_contribution_delta_IJ_flag,
                       skip_contribution_due_to_global_symmetry](
                        FullMatrix<ScalarType> &                cell_matrix,
                        MeshWorker::ScratchData<dim, spacedim> &scratch_data,
                        const std::vector<SolutionExtractionData<dim, spacedim>>
                          &solution_extraction_data,
-                       const FEValuesBase<dim, spacedim> &fe_values)
+                       const FEValuesBase<dim, spacedim> &     fe_values,
+                       const internal::LocalMatrixContribution contribution)
       {
         // Early exit: Don't form the cell contribution if it will add below
         // the diagonal.
@@ -2172,7 +3607,9 @@ namespace WeakForms
                                     trial_space_op,
                                     volume_integral,
                                     symmetric_contribution,
-                                    equal_components_contribution);
+                                    equal_components_contribution,
+                                    local_gemm_kernel_flag,
+                                    contribution);
 
         if (use_scratch_cell_matrix)
           {
@@ -2185,20 +3622,169 @@ namespace WeakForms
             // Symmetrize this contribution
             for (const unsigned int i : fe_values.dof_indices())
               {
-                // Accumulate into diagonal
-                cell_matrix(i, i) += scratch_cell_matrix(i, i);
-                for (const unsigned int j :
-                     fe_values.dof_indices_starting_at(i + 1))
+                // Accumulate into diagonal
+                cell_matrix(i, i) += scratch_cell_matrix(i, i);
+                for (const unsigned int j :
+                     fe_values.dof_indices_starting_at(i + 1))
+                  {
+                    // Accumulate into lower and upper halves from the lower
+                    // half contribution that we've just assembled.
+                    cell_matrix(i, j) += scratch_cell_matrix(j, i);
+                    cell_matrix(j, i) += scratch_cell_matrix(j, i);
+                  }
+              }
+          }
+      };
+      return f;
+    }
+
+
+    /**
+     * Cell operations for bilinear forms, that assemble the contributions
+     * for a batch of cells at once.
+     *
+     * Each vectorization lane is associated with one of the cells in the
+     * batch, and a separate local matrix is computed for each of them. All of
+     * the cells in the batch must share the same finite element and
+     * quadrature rule. The update flags are already set by the accompanying
+     * cell operation, i.e. that returned by make_cell_operation().
+     */
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpVolumeIntegral,
+              typename std::enable_if<is_bilinear_form<
+                typename SymbolicOpVolumeIntegral::IntegrandType>::value>::type
+                * = nullptr>
+    auto
+    make_cell_batch_operation(const SymbolicOpVolumeIntegral &volume_integral)
+    {
+      static_assert(is_volume_integral_op<SymbolicOpVolumeIntegral>::value,
+                    "Expected a volume integral type.");
+
+      const auto &form           = volume_integral.get_integrand();
+      const auto &test_space_op  = form.get_test_space_operation();
+      const auto &functor        = form.get_functor();
+      const auto &trial_space_op = form.get_trial_space_operation();
+
+      using TestSpaceOp  = typename std::decay<decltype(test_space_op)>::type;
+      using TrialSpaceOp = typename std::decay<decltype(trial_space_op)>::type;
+
+      // As for the single cell operation, the local symmetry flag is
+      // captured by copy, but the global symmetry flag refers back to that
+      // stored in the assembler itself.
+      const bool local_contribution_symmetry_flag =
+        false; // form.local_contribution_symmetry_flag()
+      const bool &global_system_symmetry_flag =
+        this->global_system_symmetry_flag;
+      const bool local_contribution_delta_IJ_flag =
+        form.has_kronecker_delta_property();
+
+      // The field indices are used to determine whether or not this
+      // contribution would occur in a "block" that is below the diagonal.
+      const types::field_index test_field_index =
+        internal::TestTrialSpaceHelper<TestSpaceOp>::extract(test_space_op)
+          .get_field_index();
+      const types::field_index trial_field_index =
+        internal::TestTrialSpaceHelper<TrialSpaceOp>::extract(trial_space_op)
+          .get_field_index();
+
+      // Important note: All operations must be captured by copy!
+      const auto f =
+        [volume_integral,
+         test_space_op,
+         functor,
+         trial_space_op,
+         local_contribution_symmetry_flag,
+         &global_system_symmetry_flag,
+         local_contribution_delta_IJ_flag,
+         test_field_index,
+         trial_field_index](
+          const std::vector<FullMatrix<ScalarType> *> &cell_matrices,
+          const std::vector<MeshWorker::ScratchData<dim, spacedim> *>
+            &scratch_data,
+          const std::vector<
+            const std::vector<SolutionExtractionData<dim, spacedim>> *>
+            &solution_extraction_data,
+          const std::vector<const FEValuesBase<dim, spacedim> *> &fe_values)
+      {
+        // Early exit: Don't form the cell contributions if they will add
+        // below the diagonal.
+        if (global_system_symmetry_flag &&
+            test_field_index > trial_field_index)
+          {
+            return;
+          }
+
+        // Only keep those cells that match the criteria set for the
+        // integration domain.
+        std::vector<unsigned int> lanes;
+        lanes.reserve(fe_values.size());
+        for (unsigned int lane = 0; lane < fe_values.size(); ++lane)
+          if (volume_integral.get_integral_operation().integrate_on_cell(
+                fe_values[lane]->get_cell()))
+            lanes.push_back(lane);
+
+        if (lanes.empty())
+          return;
+
+        // Decide whether or not to assemble in symmetry mode, i.e. Only
+        // assemble the upper half of the matrix plus the diagonal.
+        const bool symmetric_contribution =
+          local_contribution_symmetry_flag | global_system_symmetry_flag;
+
+        // If the local contribution is symmetric, but the global system is
+        // not, then we need to write our contributions into intermediate
+        // matrices, as for the single cell operation.
+        const bool use_scratch_cell_matrix =
+          local_contribution_symmetry_flag && !global_system_symmetry_flag;
+        std::vector<FullMatrix<ScalarType>>   scratch_cell_matrices;
+        std::vector<FullMatrix<ScalarType> *> scratch_cell_matrix_ptrs;
+        if (use_scratch_cell_matrix)
+          {
+            scratch_cell_matrices.resize(cell_matrices.size());
+            scratch_cell_matrix_ptrs.resize(cell_matrices.size());
+            for (const unsigned int lane : lanes)
+              {
+                scratch_cell_matrices[lane].reinit(
+                  {cell_matrices[lane]->m(), cell_matrices[lane]->n()});
+                scratch_cell_matrix_ptrs[lane] = &scratch_cell_matrices[lane];
+              }
+          }
+
+        do_add_cell_batch_operation<Sign>(
+          (use_scratch_cell_matrix ? scratch_cell_matrix_ptrs : cell_matrices),
+          scratch_data,
+          solution_extraction_data,
+          fe_values,
+          lanes,
+          test_space_op,
+          functor,
+          trial_space_op,
+          volume_integral,
+          symmetric_contribution,
+          local_contribution_delta_IJ_flag);
+
+        if (use_scratch_cell_matrix)
+          {
+            // Symmetrize the contribution of each cell, which was assembled
+            // into the upper half of its scratch matrix.
+            for (const unsigned int lane : lanes)
+              {
+                FullMatrix<ScalarType> &cell_matrix = *cell_matrices[lane];
+                const FullMatrix<ScalarType> &scratch_cell_matrix =
+                  scratch_cell_matrices[lane];
+                for (unsigned int i = 0; i < cell_matrix.m(); ++i)
                   {
-                    // Accumulate into lower and upper halves from the lower
-                    // half contribution that we've just assembled.
-                    cell_matrix(i, j) += scratch_cell_matrix(j, i);
-                    cell_matrix(j, i) += scratch_cell_matrix(j, i);
+                    cell_matrix(i, i) += scratch_cell_matrix(i, i);
+                    for (unsigned int j = i + 1; j < cell_matrix.n(); ++j)
+                      {
+                        cell_matrix(i, j) += scratch_cell_matrix(i, j);
+                        cell_matrix(j, i) += scratch_cell_matrix(i, j);
+                      }
                   }
               }
           }
       };
-      cell_matrix_operations.emplace_back(f);
+      return f;
     }
 
 
@@ -2208,8 +3794,8 @@ namespace WeakForms
       typename std::enable_if<is_bilinear_form<
         typename SymbolicOpBoundaryIntegral::IntegrandType>::value>::type * =
         nullptr>
-    void
-    add_boundary_face_operation(
+    auto
+    make_boundary_face_operation(
       const SymbolicOpBoundaryIntegral &boundary_integral)
     {
       static_assert(is_boundary_integral_op<SymbolicOpBoundaryIntegral>::value,
@@ -2250,6 +3836,11 @@ namespace WeakForms
       const bool &global_system_symmetry_flag =
         this->global_system_symmetry_flag;
 
+      // The kernel that computes the local matrix can also be chosen at any
+      // point before the actual operation, so this flag also refers back to
+      // that stored in the assembler itself.
+      const bool &local_gemm_kernel_flag = this->local_gemm_kernel_flag;
+
       // Contribution shape function Kronecker delta property
       const bool local_contribution_delta_IJ_flag =
         form.has_kronecker_delta_property();
@@ -2326,15 +3917,17 @@ namespace WeakForms
                       trial_space_op,
                       local_contribution_symmetry_flag,
                       &global_system_symmetry_flag,
+                      &local_gemm_kernel_flag,
                       local_contribution_delta_IJ_flag,
                       skip_contribution_due_to_global_symmetry](
                        FullMatrix<ScalarType> &                cell_matrix,
                        MeshWorker::ScratchData<dim, spacedim> &scratch_data,
                        const std::vector<SolutionExtractionData<dim, spacedim>>
                          &solution_extraction_data,
-                       const FEValuesBase<dim, spacedim> &    fe_values,
-                       const FEFaceValuesBase<dim, spacedim> &fe_face_values,
-                       const unsigned int                     face)
+                       const FEValuesBase<dim, spacedim> &     fe_values,
+                       const FEFaceValuesBase<dim, spacedim> & fe_face_values,
+                       const unsigned int                      face,
+                       const internal::LocalMatrixContribution contribution)
       {
         // Early exit: Don't form the cell contribution if it will add below
         // the diagonal.
@@ -2390,7 +3983,9 @@ namespace WeakForms
                                              trial_space_op,
                                              boundary_integral,
                                              symmetric_contribution,
-                                             equal_components_contribution);
+                                             equal_components_contribution,
+                                             local_gemm_kernel_flag,
+                                             contribution);
 
         if (use_scratch_cell_matrix)
           {
@@ -2416,7 +4011,7 @@ namespace WeakForms
               }
           }
       };
-      boundary_face_matrix_operations.emplace_back(f);
+      return f;
     }
 
 
@@ -2426,8 +4021,8 @@ namespace WeakForms
       typename std::enable_if<is_bilinear_form<
         typename SymbolicOpInterfaceIntegral::IntegrandType>::value>::type * =
         nullptr>
-    void
-    add_interface_face_operation(
+    auto
+    make_interface_face_operation(
       const SymbolicOpInterfaceIntegral &interface_integral)
     {
       static_assert(
@@ -2635,7 +4230,7 @@ namespace WeakForms
         //       }
         //   }
       };
-      interface_face_matrix_operations.emplace_back(f);
+      return f;
     }
 
 
@@ -2653,8 +4248,8 @@ namespace WeakForms
               typename std::enable_if<is_linear_form<
                 typename SymbolicOpVolumeIntegral::IntegrandType>::value>::type
                 * = nullptr>
-    void
-    add_cell_operation(const SymbolicOpVolumeIntegral &volume_integral)
+    auto
+    make_cell_operation(const SymbolicOpVolumeIntegral &volume_integral)
     {
       static_assert(is_volume_integral_op<SymbolicOpVolumeIntegral>::value,
                     "Expected a volume integral type.");
@@ -2711,7 +4306,7 @@ namespace WeakForms
                                     functor,
                                     volume_integral);
       };
-      cell_vector_operations.emplace_back(f);
+      return f;
     }
 
 
@@ -2721,8 +4316,8 @@ namespace WeakForms
       typename std::enable_if<is_linear_form<
         typename SymbolicOpBoundaryIntegral::IntegrandType>::value>::type * =
         nullptr>
-    void
-    add_boundary_face_operation(
+    auto
+    make_boundary_face_operation(
       const SymbolicOpBoundaryIntegral &boundary_integral)
     {
       static_assert(is_boundary_integral_op<SymbolicOpBoundaryIntegral>::value,
@@ -2787,87 +4382,582 @@ namespace WeakForms
                                              functor,
                                              boundary_integral);
       };
-      boundary_face_vector_operations.emplace_back(f);
+      return f;
+    }
+
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpInterfaceIntegral,
+              typename std::enable_if<
+                is_interface_integral_op<SymbolicOpInterfaceIntegral>::value &&
+                is_linear_form<typename SymbolicOpInterfaceIntegral::
+                                 IntegrandType>::value>::type * = nullptr>
+    auto
+    make_interface_face_operation(
+      const SymbolicOpInterfaceIntegral &interface_integral)
+    {
+      (void)interface_integral;
+      static_assert(
+        is_interface_integral_op<SymbolicOpInterfaceIntegral>::value,
+        "Expected an interface integral type.");
+      static_assert(
+        !is_or_has_boundary_op<SymbolicOpInterfaceIntegral>::value,
+        "A interface integral cannot operate with a boundary operator.");
+
+      // We need to update the flags that need to be set for
+      // cell operations. The flags from the composite operation
+      // that composes the integrand will be bubbled down to the
+      // integral itself.
+      interface_face_update_flags |= interface_integral.get_update_flags();
+
+      // Extract some information about the form that we'll be
+      // constructing and integrating
+      const auto &form = interface_integral.get_integrand();
+      static_assert(
+        is_linear_form<typename std::decay<decltype(form)>::type>::value,
+        "Incompatible integrand type.");
+
+      const auto &test_space_op = form.get_test_space_operation();
+      const auto &functor       = form.get_functor();
+
+      using TestSpaceOp = typename std::decay<decltype(test_space_op)>::type;
+      using Functor     = typename std::decay<decltype(functor)>::type;
+
+      // Now, compose all of this into a bespoke operation for this
+      // contribution.
+      //
+      // Important note: All operations must be captured by copy!
+      // We do this in case someone inlines a call to bilinear_form()
+      // with operator+= , e.g.
+      //   MatrixBasedAssembler<dim, spacedim> assembler;
+      //   assembler += linear_form(test_val, boundary_func).dA();
+      const auto f =
+        [interface_integral,
+         test_space_op,
+         functor](Vector<ScalarType> &                    cell_vector,
+                  MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+                  const std::vector<SolutionExtractionData<dim, spacedim>>
+                    &solution_extraction_data,
+                  const FEInterfaceValues<dim, spacedim> &fe_interface_values,
+                  const unsigned int                      face,
+                  const unsigned int                      neighbour_face)
+      {
+        // Skip this cell face if it doesn't match the criteria set for the
+        // integration domain.
+        if (!interface_integral.get_integral_operation().integrate_on_face(
+              fe_interface_values.get_fe_face_values(0).get_cell(),
+              face,
+              neighbour_face))
+          {
+            return;
+          }
+
+        // Perform the assembly, taking into account whether or not to
+        // utilise vectorisation.
+        do_add_interface_face_operation<Sign>(cell_vector,
+                                              scratch_data,
+                                              solution_extraction_data,
+                                              fe_interface_values,
+                                              test_space_op,
+                                              functor,
+                                              interface_integral);
+      };
+      return f;
+    }
+
+    /**
+     * Add the operation that assembles the contribution from a single
+     * symbolic integral to the list of operations for its integration
+     * domain and type of local contribution.
+     */
+    template <enum internal::AccumulationSign Sign, typename SymbolicOpIntegral>
+    void
+    add_operation(const SymbolicOpIntegral &integral)
+    {
+      constexpr auto operation_type =
+        internal::AssemblyOperationTypeHelper<SymbolicOpIntegral>::value;
+      static_assert(operation_type != internal::AssemblyOperationType::none,
+                    "Cannot add an operation for this integral type.");
+
+      get_operations(internal::AssemblyOperationTypeTag<operation_type>())
+        .emplace_back(make_operation<Sign>(integral));
+      add_operation_slot(operation_type);
+      add_solution_dependence(
+        internal::AssemblyOperationTypeTag<operation_type>(),
+        internal::IsSolutionDependentIntegral<SymbolicOpIntegral>::value);
+      add_cell_batch_operation<Sign>(integral);
+    }
+
+    /**
+     * Associate the operation that was most recently added for the given
+     * @p type of contribution with the active slot.
+     */
+    void
+    add_operation_slot(const internal::AssemblyOperationType type)
+    {
+      operation_slots[static_cast<unsigned int>(type)].push_back(active_slot);
+    }
+
+    /**
+     * Return the slot that each of the operations for the given @p type of
+     * contribution is associated with.
+     */
+    const std::vector<unsigned int> &
+    get_operation_slots(const internal::AssemblyOperationType type) const
+    {
+      return operation_slots[static_cast<unsigned int>(type)];
+    }
+
+    /**
+     * Return whether or not any of the operations are associated with a
+     * slot other than the first one.
+     */
+    bool
+    has_multiple_slots() const
+    {
+      for (const std::vector<unsigned int> &slots : operation_slots)
+        if (std::any_of(slots.begin(),
+                        slots.end(),
+                        [](const unsigned int slot) { return slot != 0; }))
+          return true;
+      return false;
+    }
+
+    /**
+     * Record whether or not the operation that was most recently added for
+     * cell matrix contributions depends on the solution. This is not tracked
+     * for any other type of operation.
+     */
+    void
+    add_solution_dependence(internal::AssemblyOperationTypeTag<
+                              internal::AssemblyOperationType::cell_matrix>,
+                            const bool is_solution_dependent)
+    {
+      cell_matrix_solution_dependence.push_back(is_solution_dependent);
+    }
+
+    template <enum internal::AssemblyOperationType Type>
+    void
+    add_solution_dependence(internal::AssemblyOperationTypeTag<Type>,
+                            const bool)
+    {}
+
+    /**
+     * Add the operation that assembles the contribution from a bilinear form
+     * integrated over a batch of cells, to accompany the cell operation for
+     * that same symbolic integral.
+     */
+    template <enum internal::AccumulationSign Sign, typename SymbolicOpIntegral>
+    typename std::enable_if<
+      internal::AssemblyOperationTypeHelper<SymbolicOpIntegral>::value ==
+      internal::AssemblyOperationType::cell_matrix>::type
+    add_cell_batch_operation(const SymbolicOpIntegral &volume_integral)
+    {
+      cell_batch_matrix_operations.emplace_back(
+        make_cell_batch_operation<Sign>(volume_integral));
+    }
+
+    template <enum internal::AccumulationSign Sign, typename SymbolicOpIntegral>
+    typename std::enable_if<
+      internal::AssemblyOperationTypeHelper<SymbolicOpIntegral>::value !=
+      internal::AssemblyOperationType::cell_matrix>::type
+    add_cell_batch_operation(const SymbolicOpIntegral &)
+    {}
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpIntegral,
+              typename std::enable_if<is_volume_integral_op<
+                SymbolicOpIntegral>::value>::type * = nullptr>
+    auto
+    make_operation(const SymbolicOpIntegral &volume_integral)
+    {
+      add_coupling_operation(volume_integral);
+      return make_cell_operation<Sign>(volume_integral);
+    }
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpIntegral,
+              typename std::enable_if<is_boundary_integral_op<
+                SymbolicOpIntegral>::value>::type * = nullptr>
+    auto
+    make_operation(const SymbolicOpIntegral &boundary_integral)
+    {
+      add_coupling_operation(boundary_integral);
+      return make_boundary_face_operation<Sign>(boundary_integral);
+    }
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpIntegral,
+              typename std::enable_if<is_interface_integral_op<
+                SymbolicOpIntegral>::value>::type * = nullptr>
+    auto
+    make_operation(const SymbolicOpIntegral &interface_integral)
+    {
+      add_coupling_operation(interface_integral);
+      return make_interface_face_operation<Sign>(interface_integral);
+    }
+
+    /**
+     * Record which components the bilinear form of the @p integral couples.
+     * Linear forms don't contribute to the system matrix, so they don't
+     * couple anything.
+     */
+    template <typename SymbolicOpIntegral>
+    typename std::enable_if<is_bilinear_form<
+      typename SymbolicOpIntegral::IntegrandType>::value>::type
+    add_coupling_operation(const SymbolicOpIntegral &integral)
+    {
+      const auto &form           = integral.get_integrand();
+      const auto &test_space_op  = form.get_test_space_operation();
+      const auto &trial_space_op = form.get_trial_space_operation();
+
+      using TestSpaceOp  = typename std::decay<decltype(test_space_op)>::type;
+      using TrialSpaceOp = typename std::decay<decltype(trial_space_op)>::type;
+
+      const auto &underlying_test_space_op =
+        internal::TestTrialSpaceHelper<TestSpaceOp>::extract(test_space_op);
+      const auto &underlying_trial_space_op =
+        internal::TestTrialSpaceHelper<TrialSpaceOp>::extract(trial_space_op);
+
+      using UnderlyingTestSpaceOp =
+        typename std::decay<decltype(underlying_test_space_op)>::type;
+      using UnderlyingTrialSpaceOp =
+        typename std::decay<decltype(underlying_trial_space_op)>::type;
+
+      constexpr bool is_interface_integral =
+        is_interface_integral_op<SymbolicOpIntegral>::value;
+
+      coupling_operations.emplace_back(
+        [underlying_test_space_op, underlying_trial_space_op](
+          Table<2, DoFTools::Coupling> &cell_couplings,
+          Table<2, DoFTools::Coupling> &face_couplings)
+        {
+          const unsigned int n_components = cell_couplings.size(0);
+          const std::pair<unsigned int, unsigned int> test_components =
+            internal::SpaceOpComponentRange<UnderlyingTestSpaceOp>::get(
+              underlying_test_space_op, n_components);
+          const std::pair<unsigned int, unsigned int> trial_components =
+            internal::SpaceOpComponentRange<UnderlyingTrialSpaceOp>::get(
+              underlying_trial_space_op, n_components);
+
+          for (unsigned int i = test_components.first;
+               i < test_components.second;
+               ++i)
+            for (unsigned int j = trial_components.first;
+                 j < trial_components.second;
+                 ++j)
+              {
+                // Interface integrals couple the DoFs of a cell with those
+                // of its neighbor, as well as with its own DoFs.
+                cell_couplings(i, j) = DoFTools::always;
+                if (is_interface_integral)
+                  face_couplings(i, j) = DoFTools::always;
+              }
+        });
+    }
+
+    template <typename SymbolicOpIntegral>
+    typename std::enable_if<!is_bilinear_form<
+      typename SymbolicOpIntegral::IntegrandType>::value>::type
+    add_coupling_operation(const SymbolicOpIntegral &)
+    {}
+
+    /**
+     * Fill the coupling tables for the cell and interface contributions of
+     * all of the bilinear forms, for the finite element of the
+     * @p dof_handler.
+     */
+    void
+    compute_coupling_tables(const DoFHandler<dim, spacedim> &dof_handler,
+                            Table<2, DoFTools::Coupling> &   cell_couplings,
+                            Table<2, DoFTools::Coupling> &face_couplings) const
+    {
+      const unsigned int n_components =
+        dof_handler.get_fe_collection().n_components();
+
+      cell_couplings.reinit(n_components, n_components);
+      face_couplings.reinit(n_components, n_components);
+      cell_couplings.fill(DoFTools::none);
+      face_couplings.fill(DoFTools::none);
+
+      for (const CouplingOperation &coupling_operation : coupling_operations)
+        coupling_operation(cell_couplings, face_couplings);
+
+      // Only the upper half of the system is assembled, and then mirrored
+      // into the lower half.
+      if (global_system_symmetry_flag)
+        for (unsigned int i = 0; i < n_components; ++i)
+          for (unsigned int j = i + 1; j < n_components; ++j)
+            {
+              if (cell_couplings(i, j) != DoFTools::none ||
+                  cell_couplings(j, i) != DoFTools::none)
+                cell_couplings(i, j) = cell_couplings(j, i) = DoFTools::always;
+              if (face_couplings(i, j) != DoFTools::none ||
+                  face_couplings(j, i) != DoFTools::none)
+                face_couplings(i, j) = face_couplings(j, i) = DoFTools::always;
+            }
+    }
+
+    std::vector<CellMatrixOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::cell_matrix>)
+    {
+      return cell_matrix_operations;
+    }
+
+    std::vector<CellVectorOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::cell_vector>)
+    {
+      return cell_vector_operations;
+    }
+
+    std::vector<BoundaryMatrixOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::boundary_face_matrix>)
+    {
+      return boundary_face_matrix_operations;
+    }
+
+    std::vector<BoundaryVectorOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::boundary_face_vector>)
+    {
+      return boundary_face_vector_operations;
+    }
+
+    std::vector<InterfaceMatrixOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::interface_face_matrix>)
+    {
+      return interface_face_matrix_operations;
+    }
+
+    std::vector<InterfaceVectorOperation> &
+    get_operations(internal::AssemblyOperationTypeTag<
+                   internal::AssemblyOperationType::interface_face_vector>)
+    {
+      return interface_face_vector_operations;
+    }
+
+    /**
+     * Add all of the leaf integrals of a composite integral, such that all
+     * of those that contribute to the same integration domain and type of
+     * local contribution are assembled by a single operation.
+     *
+     * The @p Sign is that with which the composite integral is added to
+     * the assembler, i.e. it is the printed sign and not the sign with
+     * which the contributions are accumulated. Self-linearizing forms
+     * cannot be fused, so they are added as they would be otherwise.
+     */
+    template <enum internal::AccumulationSign Sign, typename IntegralType>
+    void
+    add_fused_integral(const IntegralType &integral)
+    {
+      using Visitor = internal::IntegralTreeVisitor<IntegralType>;
+
+      // Add the string operations in order, as well as everything that
+      // cannot be fused.
+      Visitor::template apply<Sign>(
+        integral,
+        [this](const auto &leaf_integral, auto sign)
+        {
+          this->template add_unfused_components<decltype(sign)::value>(
+            leaf_integral);
+          return std::tuple<>();
+        });
+
+      add_fused_operations<internal::AssemblyOperationType::cell_matrix,
+                           Sign>(integral);
+      add_fused_cell_batch_operations<Sign>(integral);
+      add_fused_operations<internal::AssemblyOperationType::cell_vector,
+                           Sign>(integral);
+      add_fused_operations<
+        internal::AssemblyOperationType::boundary_face_matrix,
+        Sign>(integral);
+      add_fused_operations<
+        internal::AssemblyOperationType::boundary_face_vector,
+        Sign>(integral);
+      add_fused_operations<
+        internal::AssemblyOperationType::interface_face_matrix,
+        Sign>(integral);
+      add_fused_operations<
+        internal::AssemblyOperationType::interface_face_vector,
+        Sign>(integral);
+    }
+
+    template <enum internal::AccumulationSign Sign, typename SymbolicOpType>
+    typename std::enable_if<internal::AssemblyOperationTypeHelper<
+                              SymbolicOpType>::value !=
+                            internal::AssemblyOperationType::none>::type
+    add_unfused_components(const SymbolicOpType &integral)
+    {
+      add_ascii_latex_operations<Sign>(integral);
+    }
+
+    template <enum internal::AccumulationSign Sign, typename SymbolicOpType>
+    typename std::enable_if<internal::AssemblyOperationTypeHelper<
+                              SymbolicOpType>::value ==
+                            internal::AssemblyOperationType::none>::type
+    add_unfused_components(const SymbolicOpType &integral)
+    {
+      if (Sign == internal::AccumulationSign::plus)
+        *this += integral;
+      else
+        *this -= integral;
+    }
+
+    /**
+     * Add the fused operations for all of the leaf integrals that are
+     * assembled by operations of the given @p Type. Those contributions
+     * that may be cached are fused separately from the others.
+     */
+    template <enum internal::AssemblyOperationType Type,
+              enum internal::AccumulationSign      Sign,
+              typename IntegralType>
+    void
+    add_fused_operations(const IntegralType &integral)
+    {
+      add_fused_operation_group<Type, Sign, true>(integral);
+      add_fused_operation_group<Type, Sign, false>(integral);
+    }
+
+    template <enum internal::AssemblyOperationType Type,
+              enum internal::AccumulationSign      Sign,
+              bool                                 Cacheable,
+              typename IntegralType>
+    void
+    add_fused_operation_group(const IntegralType &integral)
+    {
+      const auto operations =
+        internal::IntegralTreeVisitor<IntegralType>::template apply<Sign>(
+          integral,
+          [this](const auto &leaf_integral, auto sign)
+          {
+            return this->template make_fused_operation<Type,
+                                                       decltype(sign)::value,
+                                                       Cacheable>(
+              leaf_integral);
+          });
+
+      add_fused_operation(
+        get_operations(internal::AssemblyOperationTypeTag<Type>()),
+        operations);
+      if (std::tuple_size<decltype(operations)>::value > 0)
+        {
+          add_operation_slot(Type);
+          add_solution_dependence(internal::AssemblyOperationTypeTag<Type>(),
+                                  !Cacheable);
+        }
+    }
+
+    /**
+     * Add the fused cell batch operations, grouped in the same way as the
+     * cell matrix operations that they accompany.
+     */
+    template <enum internal::AccumulationSign Sign, typename IntegralType>
+    void
+    add_fused_cell_batch_operations(const IntegralType &integral)
+    {
+      add_fused_cell_batch_operation_group<Sign, true>(integral);
+      add_fused_cell_batch_operation_group<Sign, false>(integral);
+    }
+
+    template <enum internal::AccumulationSign Sign,
+              bool                            Cacheable,
+              typename IntegralType>
+    void
+    add_fused_cell_batch_operation_group(const IntegralType &integral)
+    {
+      const auto operations =
+        internal::IntegralTreeVisitor<IntegralType>::template apply<Sign>(
+          integral,
+          [this](const auto &leaf_integral, auto sign)
+          {
+            return this->template make_fused_cell_batch_operation<
+              decltype(sign)::value,
+              Cacheable>(leaf_integral);
+          });
+
+      add_fused_operation(cell_batch_matrix_operations, operations);
+    }
+
+    template <typename OperationType, typename... FusedOperationTypes>
+    static void
+    add_fused_operation(
+      std::vector<OperationType> &                  operations,
+      const std::tuple<FusedOperationTypes...> &fused_operations)
+    {
+      if (sizeof...(FusedOperationTypes) > 0)
+        operations.emplace_back(
+          internal::FusedOperation<FusedOperationTypes...>(fused_operations));
+    }
+
+    template <enum internal::AssemblyOperationType Type,
+              enum internal::AccumulationSign      Sign,
+              bool                                 Cacheable,
+              typename SymbolicOpType,
+              typename std::enable_if<
+                internal::AssemblyOperationTypeHelper<SymbolicOpType>::value ==
+                  Type &&
+                internal::IsCacheableOperation<Type, SymbolicOpType>::value ==
+                  Cacheable>::type * = nullptr>
+    auto
+    make_fused_operation(const SymbolicOpType &integral)
+    {
+      // Linear forms go on the RHS, bilinear forms go on the LHS.
+      // So we switch the sign based on this.
+      constexpr bool keep_op_sign =
+        is_bilinear_form<typename SymbolicOpType::IntegrandType>::value;
+      constexpr auto op_sign =
+        (keep_op_sign ? Sign : internal::opposite_sign(Sign));
+
+      return std::make_tuple(make_operation<op_sign>(integral));
     }
 
+    template <enum internal::AssemblyOperationType Type,
+              enum internal::AccumulationSign      Sign,
+              bool                                 Cacheable,
+              typename SymbolicOpType,
+              typename std::enable_if<
+                internal::AssemblyOperationTypeHelper<SymbolicOpType>::value !=
+                  Type ||
+                internal::IsCacheableOperation<Type, SymbolicOpType>::value !=
+                  Cacheable>::type * = nullptr>
+    std::tuple<>
+    make_fused_operation(const SymbolicOpType &)
+    {
+      return std::tuple<>();
+    }
 
     template <enum internal::AccumulationSign Sign,
-              typename SymbolicOpInterfaceIntegral,
+              bool                            Cacheable,
+              typename SymbolicOpType,
               typename std::enable_if<
-                is_interface_integral_op<SymbolicOpInterfaceIntegral>::value &&
-                is_linear_form<typename SymbolicOpInterfaceIntegral::
-                                 IntegrandType>::value>::type * = nullptr>
-    void
-    add_interface_face_operation(
-      const SymbolicOpInterfaceIntegral &interface_integral)
+                internal::AssemblyOperationTypeHelper<SymbolicOpType>::value ==
+                  internal::AssemblyOperationType::cell_matrix &&
+                internal::IsCacheableOperation<
+                  internal::AssemblyOperationType::cell_matrix,
+                  SymbolicOpType>::value == Cacheable>::type * = nullptr>
+    auto
+    make_fused_cell_batch_operation(const SymbolicOpType &integral)
     {
-      (void)interface_integral;
-      static_assert(
-        is_interface_integral_op<SymbolicOpInterfaceIntegral>::value,
-        "Expected an interface integral type.");
-      static_assert(
-        !is_or_has_boundary_op<SymbolicOpInterfaceIntegral>::value,
-        "A interface integral cannot operate with a boundary operator.");
-
-      // We need to update the flags that need to be set for
-      // cell operations. The flags from the composite operation
-      // that composes the integrand will be bubbled down to the
-      // integral itself.
-      interface_face_update_flags |= interface_integral.get_update_flags();
-
-      // Extract some information about the form that we'll be
-      // constructing and integrating
-      const auto &form = interface_integral.get_integrand();
-      static_assert(
-        is_linear_form<typename std::decay<decltype(form)>::type>::value,
-        "Incompatible integrand type.");
-
-      const auto &test_space_op = form.get_test_space_operation();
-      const auto &functor       = form.get_functor();
-
-      using TestSpaceOp = typename std::decay<decltype(test_space_op)>::type;
-      using Functor     = typename std::decay<decltype(functor)>::type;
-
-      // Now, compose all of this into a bespoke operation for this
-      // contribution.
-      //
-      // Important note: All operations must be captured by copy!
-      // We do this in case someone inlines a call to bilinear_form()
-      // with operator+= , e.g.
-      //   MatrixBasedAssembler<dim, spacedim> assembler;
-      //   assembler += linear_form(test_val, boundary_func).dA();
-      const auto f =
-        [interface_integral,
-         test_space_op,
-         functor](Vector<ScalarType> &                    cell_vector,
-                  MeshWorker::ScratchData<dim, spacedim> &scratch_data,
-                  const std::vector<SolutionExtractionData<dim, spacedim>>
-                    &solution_extraction_data,
-                  const FEInterfaceValues<dim, spacedim> &fe_interface_values,
-                  const unsigned int                      face,
-                  const unsigned int                      neighbour_face)
-      {
-        // Skip this cell face if it doesn't match the criteria set for the
-        // integration domain.
-        if (!interface_integral.get_integral_operation().integrate_on_face(
-              fe_interface_values.get_fe_face_values(0).get_cell(),
-              face,
-              neighbour_face))
-          {
-            return;
-          }
+      return std::make_tuple(make_cell_batch_operation<Sign>(integral));
+    }
 
-        // Perform the assembly, taking into account whether or not to
-        // utilise vectorisation.
-        do_add_interface_face_operation<Sign>(cell_vector,
-                                              scratch_data,
-                                              solution_extraction_data,
-                                              fe_interface_values,
-                                              test_space_op,
-                                              functor,
-                                              interface_integral);
-      };
-      interface_face_vector_operations.emplace_back(f);
+    template <enum internal::AccumulationSign Sign,
+              bool                            Cacheable,
+              typename SymbolicOpType,
+              typename std::enable_if<
+                internal::AssemblyOperationTypeHelper<SymbolicOpType>::value !=
+                  internal::AssemblyOperationType::cell_matrix ||
+                internal::IsCacheableOperation<
+                  internal::AssemblyOperationType::cell_matrix,
+                  SymbolicOpType>::value != Cacheable>::type * = nullptr>
+    std::tuple<>
+    make_fused_cell_batch_operation(const SymbolicOpType &)
+    {
+      return std::tuple<>();
     }
 
     UpdateFlags
@@ -2906,15 +4996,27 @@ namespace WeakForms
       FullMatrix<ScalarType> &                cell_matrix,
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const std::vector<SolutionExtractionData<dim, spacedim>>
-        &                                solution_extraction_data,
-      const FEValuesBase<dim, spacedim> &fe_values,
-      const TestSpaceOp &                test_space_op,
-      const Functor &                    functor,
-      const TrialSpaceOp &               trial_space_op,
-      const SymbolicOpVolumeIntegral &   volume_integral,
-      const bool                         symmetric_contribution,
-      const bool                         equal_components_contribution)
+        &                                     solution_extraction_data,
+      const FEValuesBase<dim, spacedim> &     fe_values,
+      const TestSpaceOp &                     test_space_op,
+      const Functor &                         functor,
+      const TrialSpaceOp &                    trial_space_op,
+      const SymbolicOpVolumeIntegral &        volume_integral,
+      const bool                              symmetric_contribution,
+      const bool                              equal_components_contribution,
+      const bool                              use_gemm_kernel,
+      const internal::LocalMatrixContribution contribution)
     {
+      const bool diagonal_contribution =
+        (contribution == internal::LocalMatrixContribution::diagonal);
+
+      // Only the DoFs of the fields that the test function and trial
+      // solution act on contribute to the local matrix.
+      const std::vector<unsigned int> test_dof_indices =
+        internal::get_space_op_dof_indices(test_space_op, fe_values);
+      const std::vector<unsigned int> trial_dof_indices =
+        internal::get_space_op_dof_indices(trial_space_op, fe_values);
+
       // Shape functions are always real-valued
       using UnderlyingScalarType =
         typename numbers::UnderlyingScalar<ScalarType>::type;
@@ -2927,6 +5029,28 @@ namespace WeakForms
         template vectorized_value_type<UnderlyingScalarType, width>;
 
       const unsigned int n_q_points = fe_values.n_quadrature_points;
+
+      // If the local matrix is computed as a dense matrix-matrix product, then
+      // the data for all batches of quadrature points is gathered before the
+      // local matrix is computed.
+      using GEMMTraits =
+        internal::GEMMKernelTraits<ScalarType,
+                                   VectorizedValueTypeTest,
+                                   VectorizedValueTypeFunctor,
+                                   VectorizedValueTypeTrial>;
+      const bool use_gemm =
+        (use_gemm_kernel && GEMMTraits::is_supported &&
+         contribution == internal::LocalMatrixContribution::full);
+      internal::LocalGEMMKernel<ScalarType> *gemm_kernel = nullptr;
+      if (use_gemm)
+        {
+          gemm_kernel =
+            &internal::LocalGEMMKernel<ScalarType>::get(scratch_data);
+          gemm_kernel->reinit(n_q_points,
+                              GEMMTraits::n_components,
+                              fe_values.dofs_per_cell);
+        }
+
       for (unsigned int batch_start = 0; batch_start < n_q_points;
            batch_start += width)
         {
@@ -2938,8 +5062,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_values,
               fe_values,
@@ -2947,8 +5071,8 @@ namespace WeakForms
               solution_extraction_data,
               q_point_range);
 
-          const AlignedVector<VectorizedValueTypeTrial> shapes_trial =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTrial> &shapes_trial =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               trial_space_op,
               fe_values,
               fe_values,
@@ -2990,16 +5114,55 @@ namespace WeakForms
             }
 
           // Do the assembly for the current batch of quadrature points
-          internal::assemble_cell_matrix_vectorized_qp_batch_contribution<Sign>(
-            cell_matrix,
-            fe_values,
-            shapes_test,
-            values_functor,
-            shapes_trial,
-            JxW,
-            symmetric_contribution,
-            equal_components_contribution);
+          if (use_gemm)
+            {
+              internal::add_cell_matrix_vectorized_qp_batch_gemm_data(
+                *gemm_kernel,
+                fe_values,
+                shapes_test,
+                values_functor,
+                shapes_trial,
+                JxW,
+                q_point_range);
+            }
+          else if (contribution == internal::LocalMatrixContribution::row_sum)
+            {
+              internal::
+                assemble_cell_matrix_row_sum_vectorized_qp_batch_contribution<
+                  Sign>(cell_matrix,
+                        fe_values,
+                        shapes_test,
+                        values_functor,
+                        shapes_trial,
+                        JxW,
+                        test_dof_indices,
+                        trial_dof_indices,
+                        equal_components_contribution);
+            }
+          else
+            {
+              internal::assemble_cell_matrix_vectorized_qp_batch_contribution<
+                Sign>(cell_matrix,
+                      fe_values,
+                      shapes_test,
+                      values_functor,
+                      shapes_trial,
+                      JxW,
+                      test_dof_indices,
+                      trial_dof_indices,
+                      symmetric_contribution,
+                      equal_components_contribution,
+                      diagonal_contribution);
+            }
         }
+
+      if (use_gemm)
+        internal::assemble_cell_matrix_gemm_product<Sign>(
+          cell_matrix,
+          fe_values,
+          gemm_kernel->compute(),
+          symmetric_contribution,
+          equal_components_contribution);
     }
 
 
@@ -3022,15 +5185,27 @@ namespace WeakForms
       FullMatrix<ScalarType> &                cell_matrix,
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const std::vector<SolutionExtractionData<dim, spacedim>>
-        &                                solution_extraction_data,
-      const FEValuesBase<dim, spacedim> &fe_values,
-      const TestSpaceOp &                test_space_op,
-      const Functor &                    functor,
-      const TrialSpaceOp &               trial_space_op,
-      const SymbolicOpVolumeIntegral &   volume_integral,
-      const bool                         symmetric_contribution,
-      const bool                         equal_components_contribution)
+        &                                     solution_extraction_data,
+      const FEValuesBase<dim, spacedim> &     fe_values,
+      const TestSpaceOp &                     test_space_op,
+      const Functor &                         functor,
+      const TrialSpaceOp &                    trial_space_op,
+      const SymbolicOpVolumeIntegral &        volume_integral,
+      const bool                              symmetric_contribution,
+      const bool                              equal_components_contribution,
+      const bool                              use_gemm_kernel,
+      const internal::LocalMatrixContribution contribution)
     {
+      const bool diagonal_contribution =
+        (contribution == internal::LocalMatrixContribution::diagonal);
+
+      // Only the DoFs of the fields that the test function and trial
+      // solution act on contribute to the local matrix.
+      const std::vector<unsigned int> test_dof_indices =
+        internal::get_space_op_dof_indices(test_space_op, fe_values);
+      const std::vector<unsigned int> trial_dof_indices =
+        internal::get_space_op_dof_indices(trial_space_op, fe_values);
+
       // Shape functions are always real-valued
       using UnderlyingScalarType =
         typename numbers::UnderlyingScalar<ScalarType>::type;
@@ -3045,16 +5220,16 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_values,
           fe_values,
           scratch_data,
           solution_extraction_data);
 
-      const std::vector<std::vector<ValueTypeTrial>> shapes_trial =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           trial_space_op,
           fe_values,
           fe_values,
@@ -3071,13 +5246,206 @@ namespace WeakForms
         volume_integral.template operator()<ScalarType>(fe_values);
 
       // Assemble for all DoFs and quadrature points
-      internal::assemble_cell_matrix_contribution<Sign>(
-        cell_matrix,
-        fe_values,
-        shapes_test,
-        values_functor,
-        shapes_trial,
-        JxW,
+      if (contribution == internal::LocalMatrixContribution::row_sum)
+        internal::assemble_cell_matrix_row_sum_contribution<Sign>(
+          cell_matrix,
+          fe_values,
+          fe_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          equal_components_contribution);
+      else if (use_gemm_kernel &&
+               contribution == internal::LocalMatrixContribution::full)
+        internal::assemble_cell_matrix_gemm_contribution<Sign>(
+          cell_matrix,
+          internal::LocalGEMMKernel<ScalarType>::get(scratch_data),
+          fe_values,
+          fe_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          symmetric_contribution,
+          equal_components_contribution);
+      else
+        internal::assemble_cell_matrix_contribution<Sign>(
+          cell_matrix,
+          fe_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          symmetric_contribution,
+          equal_components_contribution,
+          diagonal_contribution);
+    }
+
+
+    /**
+     * Method to add cell volume assembly operations for bilinear forms:
+     * Cell batch variant
+     *
+     * Vectorization is done over the cells that are listed in @p lanes,
+     * rather than over the quadrature points of a single cell.
+     */
+    template <enum internal::AccumulationSign Sign,
+              typename TestSpaceOp,
+              typename Functor,
+              typename TrialSpaceOp,
+              typename SymbolicOpVolumeIntegral,
+              typename std::enable_if<is_bilinear_form<
+                typename SymbolicOpVolumeIntegral::IntegrandType>::value>::type
+                * = nullptr>
+    static void
+    do_add_cell_batch_operation(
+      const std::vector<FullMatrix<ScalarType> *> &cell_matrices,
+      const std::vector<MeshWorker::ScratchData<dim, spacedim> *>
+        &scratch_data,
+      const std::vector<
+        const std::vector<SolutionExtractionData<dim, spacedim>> *>
+        &solution_extraction_data,
+      const std::vector<const FEValuesBase<dim, spacedim> *> &fe_values,
+      const std::vector<unsigned int> &                       lanes,
+      const TestSpaceOp &                                     test_space_op,
+      const Functor &                                         functor,
+      const TrialSpaceOp &                                    trial_space_op,
+      const SymbolicOpVolumeIntegral &                        volume_integral,
+      const bool symmetric_contribution,
+      const bool equal_components_contribution)
+    {
+      // Shape functions are always real-valued
+      using UnderlyingScalarType =
+        typename numbers::UnderlyingScalar<ScalarType>::type;
+      using ValueTypeTest =
+        typename TestSpaceOp::template value_type<UnderlyingScalarType>;
+      using ValueTypeFunctor =
+        typename Functor::template value_type<ScalarType>;
+      using ValueTypeTrial =
+        typename TrialSpaceOp::template value_type<UnderlyingScalarType>;
+      // Vectorization is done over the cells.
+      using VectorizedValueTypeTest = typename TestSpaceOp::
+        template vectorized_value_type<UnderlyingScalarType, width>;
+      using VectorizedValueTypeFunctor =
+        typename Functor::template vectorized_value_type<ScalarType, width>;
+      using VectorizedValueTypeTrial = typename TrialSpaceOp::
+        template vectorized_value_type<UnderlyingScalarType, width>;
+
+      using BatchData = internal::CellBatchData<VectorizedValueTypeTest,
+                                                VectorizedValueTypeFunctor,
+                                                VectorizedValueTypeTrial,
+                                                width>;
+
+      const unsigned int n_lanes = lanes.size();
+      Assert(n_lanes > 0 && n_lanes <= width,
+             ExcIndexRange(n_lanes, 1, width + 1));
+
+      // All cells in a batch share the same finite element and quadrature
+      // rule.
+      const FEValuesBase<dim, spacedim> &fe_values_dofs = *fe_values[lanes[0]];
+
+      const unsigned int n_dofs     = fe_values_dofs.dofs_per_cell;
+      const unsigned int n_q_points = fe_values_dofs.n_quadrature_points;
+
+      // The data for the batch is kept with the scratch data of the first
+      // cell, which is only ever used by the thread that works on this batch.
+      BatchData &batch_data = BatchData::get(*scratch_data[lanes[0]]);
+      batch_data.reinit(n_q_points, n_dofs);
+
+      // Gather the shape function data, functor values and integration
+      // weights of each cell directly into its vectorization lane. The
+      // entire vectorization lane might not be filled, so the unused lanes
+      // are given values that integrate to zero.
+      for (unsigned int v = 0; v < width; ++v)
+        {
+          if (v >= n_lanes)
+            {
+              for (unsigned int k = 0; k < n_q_points * n_dofs; ++k)
+                {
+                  numbers::set_vectorized_values(batch_data.shapes_test[k],
+                                                 v,
+                                                 ValueTypeTest{});
+                  numbers::set_vectorized_values(batch_data.shapes_trial[k],
+                                                 v,
+                                                 ValueTypeTrial{});
+                }
+              for (unsigned int q = 0; q < n_q_points; ++q)
+                {
+                  numbers::set_vectorized_values(batch_data.values_functor[q],
+                                                 v,
+                                                 ValueTypeFunctor{});
+                  numbers::set_vectorized_values(batch_data.JxW[q], v, 0.0);
+                }
+              continue;
+            }
+
+          const unsigned int                 lane = lanes[v];
+          const FEValuesBase<dim, spacedim> &lane_fe_values = *fe_values[lane];
+          MeshWorker::ScratchData<dim, spacedim> &lane_scratch_data =
+            *scratch_data[lane];
+
+          const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType>(
+              test_space_op,
+              lane_fe_values,
+              lane_fe_values,
+              lane_scratch_data,
+              *solution_extraction_data[lane]);
+          for (unsigned int k = 0; k < n_dofs; ++k)
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              numbers::set_vectorized_values(
+                batch_data.shapes_test[q * n_dofs + k], v, shapes_test[k][q]);
+
+          const std::vector<std::vector<ValueTypeTrial>> &shapes_trial =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType>(
+              trial_space_op,
+              lane_fe_values,
+              lane_fe_values,
+              lane_scratch_data,
+              *solution_extraction_data[lane]);
+          for (unsigned int k = 0; k < n_dofs; ++k)
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              numbers::set_vectorized_values(
+                batch_data.shapes_trial[q * n_dofs + k], v, shapes_trial[k][q]);
+
+          const std::vector<ValueTypeFunctor> values_functor =
+            internal::evaluate_functor<ScalarType>(
+              functor,
+              lane_fe_values,
+              lane_scratch_data,
+              *solution_extraction_data[lane]);
+          const std::vector<double> &JxW =
+            volume_integral.template operator()<ScalarType>(lane_fe_values);
+          for (unsigned int q = 0; q < n_q_points; ++q)
+            {
+              numbers::set_vectorized_values(batch_data.values_functor[q],
+                                             v,
+                                             values_functor[q]);
+              numbers::set_vectorized_values(batch_data.JxW[q], v, JxW[q]);
+            }
+        }
+
+      // Only the DoFs of the fields that the test function and trial
+      // solution act on contribute to the local matrices.
+      const std::vector<unsigned int> test_dof_indices =
+        internal::get_space_op_dof_indices(test_space_op, fe_values_dofs);
+      const std::vector<unsigned int> trial_dof_indices =
+        internal::get_space_op_dof_indices(trial_space_op, fe_values_dofs);
+
+      internal::assemble_cell_batch_matrix_contribution<Sign>(
+        cell_matrices,
+        lanes,
+        fe_values_dofs,
+        batch_data,
+        test_dof_indices,
+        trial_dof_indices,
         symmetric_contribution,
         equal_components_contribution);
     }
@@ -3102,16 +5470,28 @@ namespace WeakForms
       FullMatrix<ScalarType> &                cell_matrix,
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const std::vector<SolutionExtractionData<dim, spacedim>>
-        &                                    solution_extraction_data,
-      const FEValuesBase<dim, spacedim> &    fe_values,
-      const FEFaceValuesBase<dim, spacedim> &fe_face_values,
-      const TestSpaceOp &                    test_space_op,
-      const Functor &                        functor,
-      const TrialSpaceOp &                   trial_space_op,
-      const SymbolicOpBoundaryIntegral &     boundary_integral,
-      const bool                             symmetric_contribution,
-      const bool                             equal_components_contribution)
+        &                                     solution_extraction_data,
+      const FEValuesBase<dim, spacedim> &     fe_values,
+      const FEFaceValuesBase<dim, spacedim> & fe_face_values,
+      const TestSpaceOp &                     test_space_op,
+      const Functor &                         functor,
+      const TrialSpaceOp &                    trial_space_op,
+      const SymbolicOpBoundaryIntegral &      boundary_integral,
+      const bool                              symmetric_contribution,
+      const bool                              equal_components_contribution,
+      const bool                              use_gemm_kernel,
+      const internal::LocalMatrixContribution contribution)
     {
+      const bool diagonal_contribution =
+        (contribution == internal::LocalMatrixContribution::diagonal);
+
+      // Only the DoFs of the fields that the test function and trial
+      // solution act on contribute to the local matrix.
+      const std::vector<unsigned int> test_dof_indices =
+        internal::get_space_op_dof_indices(test_space_op, fe_values);
+      const std::vector<unsigned int> trial_dof_indices =
+        internal::get_space_op_dof_indices(trial_space_op, fe_values);
+
       // Shape functions are always real-valued
       using UnderlyingScalarType =
         typename numbers::UnderlyingScalar<ScalarType>::type;
@@ -3124,6 +5504,28 @@ namespace WeakForms
         template vectorized_value_type<UnderlyingScalarType, width>;
 
       const unsigned int n_q_points = fe_face_values.n_quadrature_points;
+
+      // If the local matrix is computed as a dense matrix-matrix product, then
+      // the data for all batches of quadrature points is gathered before the
+      // local matrix is computed.
+      using GEMMTraits =
+        internal::GEMMKernelTraits<ScalarType,
+                                   VectorizedValueTypeTest,
+                                   VectorizedValueTypeFunctor,
+                                   VectorizedValueTypeTrial>;
+      const bool use_gemm =
+        (use_gemm_kernel && GEMMTraits::is_supported &&
+         contribution == internal::LocalMatrixContribution::full);
+      internal::LocalGEMMKernel<ScalarType> *gemm_kernel = nullptr;
+      if (use_gemm)
+        {
+          gemm_kernel =
+            &internal::LocalGEMMKernel<ScalarType>::get(scratch_data);
+          gemm_kernel->reinit(n_q_points,
+                              GEMMTraits::n_components,
+                              fe_values.dofs_per_cell);
+        }
+
       for (unsigned int batch_start = 0; batch_start < n_q_points;
            batch_start += width)
         {
@@ -3135,8 +5537,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_values,
               fe_face_values,
@@ -3144,8 +5546,8 @@ namespace WeakForms
               solution_extraction_data,
               q_point_range);
 
-          const AlignedVector<VectorizedValueTypeTrial> shapes_trial =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTrial> &shapes_trial =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               trial_space_op,
               fe_values,
               fe_face_values,
@@ -3187,16 +5589,55 @@ namespace WeakForms
             }
 
           // Do the assembly for the current batch of quadrature points
-          internal::assemble_cell_matrix_vectorized_qp_batch_contribution<Sign>(
-            cell_matrix,
-            fe_values,
-            shapes_test,
-            values_functor,
-            shapes_trial,
-            JxW,
-            symmetric_contribution,
-            equal_components_contribution);
+          if (use_gemm)
+            {
+              internal::add_cell_matrix_vectorized_qp_batch_gemm_data(
+                *gemm_kernel,
+                fe_values,
+                shapes_test,
+                values_functor,
+                shapes_trial,
+                JxW,
+                q_point_range);
+            }
+          else if (contribution == internal::LocalMatrixContribution::row_sum)
+            {
+              internal::
+                assemble_cell_matrix_row_sum_vectorized_qp_batch_contribution<
+                  Sign>(cell_matrix,
+                        fe_values,
+                        shapes_test,
+                        values_functor,
+                        shapes_trial,
+                        JxW,
+                        test_dof_indices,
+                        trial_dof_indices,
+                        equal_components_contribution);
+            }
+          else
+            {
+              internal::assemble_cell_matrix_vectorized_qp_batch_contribution<
+                Sign>(cell_matrix,
+                      fe_values,
+                      shapes_test,
+                      values_functor,
+                      shapes_trial,
+                      JxW,
+                      test_dof_indices,
+                      trial_dof_indices,
+                      symmetric_contribution,
+                      equal_components_contribution,
+                      diagonal_contribution);
+            }
         }
+
+      if (use_gemm)
+        internal::assemble_cell_matrix_gemm_product<Sign>(
+          cell_matrix,
+          fe_values,
+          gemm_kernel->compute(),
+          symmetric_contribution,
+          equal_components_contribution);
     }
 
 
@@ -3219,16 +5660,28 @@ namespace WeakForms
       FullMatrix<ScalarType> &                cell_matrix,
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const std::vector<SolutionExtractionData<dim, spacedim>>
-        &                                    solution_extraction_data,
-      const FEValuesBase<dim, spacedim> &    fe_values,
-      const FEFaceValuesBase<dim, spacedim> &fe_face_values,
-      const TestSpaceOp &                    test_space_op,
-      const Functor &                        functor,
-      const TrialSpaceOp &                   trial_space_op,
-      const SymbolicOpBoundaryIntegral &     boundary_integral,
-      const bool                             symmetric_contribution,
-      const bool                             equal_components_contribution)
+        &                                     solution_extraction_data,
+      const FEValuesBase<dim, spacedim> &     fe_values,
+      const FEFaceValuesBase<dim, spacedim> & fe_face_values,
+      const TestSpaceOp &                     test_space_op,
+      const Functor &                         functor,
+      const TrialSpaceOp &                    trial_space_op,
+      const SymbolicOpBoundaryIntegral &      boundary_integral,
+      const bool                              symmetric_contribution,
+      const bool                              equal_components_contribution,
+      const bool                              use_gemm_kernel,
+      const internal::LocalMatrixContribution contribution)
     {
+      const bool diagonal_contribution =
+        (contribution == internal::LocalMatrixContribution::diagonal);
+
+      // Only the DoFs of the fields that the test function and trial
+      // solution act on contribute to the local matrix.
+      const std::vector<unsigned int> test_dof_indices =
+        internal::get_space_op_dof_indices(test_space_op, fe_values);
+      const std::vector<unsigned int> trial_dof_indices =
+        internal::get_space_op_dof_indices(trial_space_op, fe_values);
+
       // Shape functions are always real-valued
       using UnderlyingScalarType =
         typename numbers::UnderlyingScalar<ScalarType>::type;
@@ -3243,16 +5696,16 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_values,
           fe_face_values,
           scratch_data,
           solution_extraction_data);
 
-      const std::vector<std::vector<ValueTypeTrial>> shapes_trial =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           trial_space_op,
           fe_values,
           fe_face_values,
@@ -3270,16 +5723,47 @@ namespace WeakForms
         boundary_integral.template operator()<ScalarType>(fe_face_values);
 
       // Assemble for all DoFs and quadrature points
-      internal::assemble_cell_matrix_contribution<Sign>(
-        cell_matrix,
-        fe_values,
-        fe_face_values,
-        shapes_test,
-        values_functor,
-        shapes_trial,
-        JxW,
-        symmetric_contribution,
-        equal_components_contribution);
+      if (contribution == internal::LocalMatrixContribution::row_sum)
+        internal::assemble_cell_matrix_row_sum_contribution<Sign>(
+          cell_matrix,
+          fe_values,
+          fe_face_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          equal_components_contribution);
+      else if (use_gemm_kernel &&
+               contribution == internal::LocalMatrixContribution::full)
+        internal::assemble_cell_matrix_gemm_contribution<Sign>(
+          cell_matrix,
+          internal::LocalGEMMKernel<ScalarType>::get(scratch_data),
+          fe_values,
+          fe_face_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          symmetric_contribution,
+          equal_components_contribution);
+      else
+        internal::assemble_cell_matrix_contribution<Sign>(
+          cell_matrix,
+          fe_values,
+          fe_face_values,
+          shapes_test,
+          values_functor,
+          shapes_trial,
+          JxW,
+          test_dof_indices,
+          trial_dof_indices,
+          symmetric_contribution,
+          equal_components_contribution,
+          diagonal_contribution);
     }
 
 
@@ -3334,8 +5818,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_interface_values,
               fe_interface_values,
@@ -3343,8 +5827,8 @@ namespace WeakForms
               solution_extraction_data,
               q_point_range);
 
-          const AlignedVector<VectorizedValueTypeTrial> shapes_trial =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTrial> &shapes_trial =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               trial_space_op,
               fe_interface_values,
               fe_interface_values,
@@ -3441,16 +5925,16 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_interface_values,
           fe_interface_values,
           scratch_data,
           solution_extraction_data);
 
-      const std::vector<std::vector<ValueTypeTrial>> shapes_trial =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTrial>> &shapes_trial =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           trial_space_op,
           fe_interface_values,
           fe_interface_values,
@@ -3528,8 +6012,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_values,
               fe_values,
@@ -3613,8 +6097,8 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_values,
           fe_values,
@@ -3683,8 +6167,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_values,
               fe_face_values,
@@ -3769,8 +6253,8 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_values,
           fe_face_values,
@@ -3842,8 +6326,8 @@ namespace WeakForms
           const types::vectorized_qp_range_t q_point_range{batch_start,
                                                            batch_end};
 
-          const AlignedVector<VectorizedValueTypeTest> shapes_test =
-            internal::evaluate_fe_space<UnderlyingScalarType, width>(
+          const AlignedVector<VectorizedValueTypeTest> &shapes_test =
+            internal::evaluate_fe_space_cached<UnderlyingScalarType, width>(
               test_space_op,
               fe_interface_values,
               fe_interface_values,
@@ -3927,8 +6411,8 @@ namespace WeakForms
       // for all quadrature points at all DoFs. We construct it in this
       // manner (with the q_point indices fast) so that we can perform
       // contractions in an optimal manner.
-      const std::vector<std::vector<ValueTypeTest>> shapes_test =
-        internal::evaluate_fe_space<UnderlyingScalarType>(
+      const std::vector<std::vector<ValueTypeTest>> &shapes_test =
+        internal::evaluate_fe_space_cached<UnderlyingScalarType>(
           test_space_op,
           fe_interface_values,
           fe_interface_values,
@@ -18,22 +18,56 @@
 
 #include <deal.II/base/config.h>
 
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/mg_level_object.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/table.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/work_stream.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
 #include <deal.II/fe/fe_values.h>
 
 #include <deal.II/grid/filtered_iterator.h>
+#include <deal.II/grid/tria.h>
 
 #include <deal.II/lac/affine_constraints.h>
+#include <deal.II/lac/block_indices.h>
+#include <deal.II/lac/block_sparse_matrix.h>
+#include <deal.II/lac/block_vector.h>
 #include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/la_parallel_block_vector.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/sparse_matrix.h>
 #include <deal.II/lac/vector.h>
 
 #include <deal.II/meshworker/copy_data.h>
 #include <deal.II/meshworker/mesh_loop.h>
 #include <deal.II/meshworker/scratch_data.h>
 
+#include <deal.II/multigrid/mg_constrained_dofs.h>
+
 #include <weak_forms/assembler_base.h>
+#include <weak_forms/cell_coloring_cache.h>
+#include <weak_forms/cell_matrix_cache.h>
 #include <weak_forms/config.h>
+#include <weak_forms/scratch_data_pool.h>
+#include <weak_forms/shape_function_cache.h>
 #include <weak_forms/solution_extraction_data.h>
 #include <weak_forms/solution_storage.h>
+#include <weak_forms/work_stream_tuner.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
 
 
 
@@ -74,6 +108,8 @@ namespace WeakForms
       explicit CopyDataWithInterfaceSupport(const unsigned int size)
         : MeshWorker::
             CopyData<n_matrices, n_vectors, n_dof_indices, ScalarType>(size)
+        , active_cell_index(numbers::invalid_unsigned_int)
+        , n_active_interface_data(0)
       {}
 
       explicit CopyDataWithInterfaceSupport(
@@ -85,6 +121,8 @@ namespace WeakForms
               matrix_sizes,
               vector_sizes,
               dof_indices_sizes)
+        , active_cell_index(numbers::invalid_unsigned_int)
+        , n_active_interface_data(0)
       {}
 
       CopyDataWithInterfaceSupport(
@@ -93,11 +131,75 @@ namespace WeakForms
                                            n_vectors,
                                            n_dof_indices> &other) = default;
 
+      /**
+       * Reset all data to that of a newly constructed object of the given
+       * @p size. Unlike assigning a new object, this reuses the existing
+       * memory if the sizes of the matrices, vectors and DoF index arrays
+       * do not change.
+       */
+      void
+      reset(const unsigned int size)
+      {
+        for (FullMatrix<ScalarType> &matrix : this->matrices)
+          {
+            if (matrix.m() == size && matrix.n() == size)
+              matrix = 0;
+            else
+              matrix.reinit(size, size);
+          }
+
+        for (Vector<ScalarType> &vector : this->vectors)
+          vector.reinit(size);
+
+        for (std::vector<dealii::types::global_dof_index> &dof_indices :
+             this->local_dof_indices)
+          dof_indices.resize(size);
+
+        active_cell_index = numbers::invalid_unsigned_int;
+
+        // The interface data is kept for reuse on the next cell.
+        n_active_interface_data = 0;
+      }
+
       // Interface operators have a different number of local DoFs
       // than cell and boundary operators. So we extend CopyData in a
       // way analogous to that which step-74 does it.
       struct InterfaceData
       {
+        /**
+         * Reset all data to that of an interface with @p n_interface_dofs
+         * DoFs, reusing the existing memory where possible.
+         */
+        void
+        reset(const unsigned int n_interface_dofs)
+        {
+          for (FullMatrix<ScalarType> &matrix : matrices)
+            {
+              if (matrix.m() == n_interface_dofs &&
+                  matrix.n() == n_interface_dofs)
+                matrix = 0;
+              else
+                matrix.reinit(n_interface_dofs, n_interface_dofs);
+            }
+
+          for (Vector<ScalarType> &vector : vectors)
+            vector.reinit(n_interface_dofs);
+
+          for (std::vector<dealii::types::global_dof_index> &dof_indices :
+               local_dof_indices)
+            dof_indices.resize(n_interface_dofs);
+        }
+
+        /**
+         * The number of DoFs of the interface that this data was last
+         * used for.
+         */
+        unsigned int
+        n_dofs() const
+        {
+          return (n_matrices > 0 ? matrices[0].m() : vectors[0].size());
+        }
+
         /**
          * An array of local matrices.
          */
@@ -115,300 +217,2662 @@ namespace WeakForms
           local_dof_indices;
       };
 
-      std::vector<InterfaceData> interface_data;
-    };
-
+      /**
+       * Add the data for an interface with @p n_interface_dofs DoFs, and
+       * return it with all of its entries set to zero.
+       *
+       * The interface data is pooled: Entries that were used for a previous
+       * cell are reset rather than reallocated. Preference is given to
+       * entries that were last used for an interface with the same number
+       * of DoFs, so that no memory needs to be reallocated on meshes with
+       * several types of finite element.
+       */
+      InterfaceData &
+      add_interface_data(const unsigned int n_interface_dofs)
+      {
+        if (n_active_interface_data == interface_data.size())
+          interface_data.emplace_back();
+        else
+          for (unsigned int i = n_active_interface_data;
+               i < interface_data.size();
+               ++i)
+            if (interface_data[i].n_dofs() == n_interface_dofs)
+              {
+                if (i != n_active_interface_data)
+                  std::swap(interface_data[i],
+                            interface_data[n_active_interface_data]);
+                break;
+              }
 
+        InterfaceData &data = interface_data[n_active_interface_data];
+        ++n_active_interface_data;
+        data.reset(n_interface_dofs);
+        return data;
+      }
 
-    template <typename T>
-    struct is_hp_q_collection : std::false_type
-    {};
+      /**
+       * Make sure that this object can hold the data for @p n_interfaces
+       * interfaces with @p n_interface_dofs DoFs each, without having to
+       * allocate any further memory. Since the memory is carried over to
+       * copies of this object, this may be used to pre-size the copy data
+       * for a whole assembly loop.
+       */
+      void
+      reserve_interface_data(const unsigned int n_interfaces,
+                             const unsigned int n_interface_dofs)
+      {
+        while (interface_data.size() < n_interfaces)
+          {
+            interface_data.emplace_back();
+            interface_data.back().reset(n_interface_dofs);
+          }
+      }
 
+      /**
+       * The number of interfaces that data has been added for since the
+       * last call to reset().
+       */
+      unsigned int
+      n_interface_data() const
+      {
+        return n_active_interface_data;
+      }
 
-    template <int dim>
-    struct is_hp_q_collection<hp::QCollection<dim>> : std::true_type
-    {};
+      const InterfaceData &
+      get_interface_data(const unsigned int index) const
+      {
+        Assert(index < n_active_interface_data,
+               ExcIndexRange(index, 0, n_active_interface_data));
+        return interface_data[index];
+      }
 
+      /**
+       * The active cell index of the cell that the cell and boundary
+       * contributions were computed for, or an invalid value if there is no
+       * such cell.
+       */
+      unsigned int active_cell_index;
 
-    template <typename CellQuadratureType, typename FaceQuadratureType>
-    struct is_hp_cell_or_face_q_collection
-      : std::conditional<
-          std::is_same<typename std::decay<FaceQuadratureType>::type,
-                       std::nullptr_t>::value,
-          is_hp_q_collection<CellQuadratureType>,
-          is_hp_q_collection<FaceQuadratureType>>::type
-    {};
+    private:
+      std::vector<InterfaceData> interface_data;
+      unsigned int               n_active_interface_data;
+    };
 
 
-    template <bool is_hp_enabled>
-    struct HP_Helper;
+    /**
+     * The scratch data used by each thread during assembly. Along with a
+     * handle to a ScratchData object, this holds the association between
+     * the solution vectors and the ScratchData objects that their local
+     * values are extracted with. Since this association does not change
+     * from one cell to the next, it is created only once per assembly and
+     * thread.
+     *
+     * It also keeps track of the cell that the cell FEValues were last
+     * initialized for, so that the boundary faces of a cell can reuse the
+     * values computed for the cell itself.
+     */
+    template <typename ScratchDataHandle, int dim, int spacedim>
+    class AssemblyScratchData
+    {
+    public:
+      AssemblyScratchData(const ScratchDataHandle &scratch_data_handle)
+        : scratch_data_handle(scratch_data_handle)
+        , solution_extraction_data_initialized(false)
+        , current_cell_level(-1)
+        , current_cell_index(-1)
+      {}
 
+      // The solution extraction data and cell FEValues refer to the
+      // ScratchData object of the other instance, so they are not copied.
+      AssemblyScratchData(const AssemblyScratchData &other)
+        : scratch_data_handle(other.scratch_data_handle)
+        , solution_extraction_data_initialized(false)
+        , current_cell_level(-1)
+        , current_cell_index(-1)
+      {}
 
-    template <>
-    struct HP_Helper<false>
-    {
-      template <int dim, int spacedim>
-      static const FiniteElement<dim, spacedim> &
-      get_fe(const DoFHandler<dim, spacedim> &dof_handler,
-             const unsigned int               index = 0)
+      AssemblyScratchData &
+      operator=(const AssemblyScratchData &other)
       {
-        return dof_handler.get_fe(index);
+        scratch_data_handle                  = other.scratch_data_handle;
+        solution_extraction_data_initialized = false;
+        solution_extraction_data.clear();
+        current_cell_level = -1;
+        current_cell_index = -1;
+        return *this;
       }
 
-      template <int dim, int spacedim>
-      static unsigned int
-      get_dofs_per_cell(const DoFHandler<dim, spacedim> &dof_handler,
-                        const unsigned int               index = 0)
+      MeshWorker::ScratchData<dim, spacedim> &
+      get()
       {
-        return dof_handler.get_fe(index).dofs_per_cell;
+        return scratch_data_handle.get();
       }
-    };
 
+      /**
+       * Initialize the cell FEValues of the ScratchData object for the
+       * given @p cell, and make them the current FEValues.
+       */
+      template <typename CellIteratorType>
+      const FEValues<dim, spacedim> &
+      reinit(const CellIteratorType &cell)
+      {
+        const FEValues<dim, spacedim> &fe_values = get().reinit(cell);
+        current_cell_level                       = cell->level();
+        current_cell_index                       = cell->index();
+        return fe_values;
+      }
 
-    template <>
-    struct HP_Helper<true>
-    {
-      template <int dim, int spacedim>
-      static const hp::FECollection<dim, spacedim> &
-      get_fe(const DoFHandler<dim, spacedim> &dof_handler)
+      /**
+       * Return the cell FEValues of the ScratchData object for the given
+       * @p cell. These are only recomputed if they were last initialized
+       * for a different cell. Unlike reinit(), this does not change which
+       * FEValues object is the current one.
+       */
+      template <typename CellIteratorType>
+      const FEValues<dim, spacedim> &
+      get_fe_values(const CellIteratorType &cell)
       {
-        return dof_handler.get_fe_collection();
+        if (cell->level() == current_cell_level &&
+            cell->index() == current_cell_index)
+          return get().get_fe_values();
+
+        return reinit(cell);
       }
 
-      template <int dim, int spacedim>
-      static unsigned int
-      get_dofs_per_cell(const DoFHandler<dim, spacedim> &dof_handler)
+      /**
+       * Return the solution extraction data, creating it on first use. The
+       * @p solution_storage must already have been initialized for the
+       * ScratchData object.
+       */
+      template <typename SolutionStorageType, typename DoFHandlerType>
+      const std::vector<SolutionExtractionData<dim, spacedim>> &
+      get_solution_extraction_data(
+        const SolutionStorageType &solution_storage,
+        const DoFHandlerType &     dof_handler)
       {
-        return dof_handler.get_fe_collection().max_dofs_per_cell();
+        if (!solution_extraction_data_initialized)
+          {
+            solution_extraction_data =
+              solution_storage.get_solution_extraction_data(get(),
+                                                            dof_handler);
+            solution_extraction_data_initialized = true;
+          }
+
+        Assert(solution_extraction_data.size() ==
+                 solution_storage.n_solution_vectors(),
+               ExcDimensionMismatch(solution_extraction_data.size(),
+                                    solution_storage.n_solution_vectors()));
+        return solution_extraction_data;
       }
-    };
 
-    template <typename CellQuadratureType, typename FaceQuadratureType>
-    using HP_Helper_t =
-      HP_Helper<is_hp_cell_or_face_q_collection<CellQuadratureType,
-                                                FaceQuadratureType>::value>;
+    private:
+      ScratchDataHandle scratch_data_handle;
 
-  } // namespace internal
+      bool solution_extraction_data_initialized;
+      std::vector<SolutionExtractionData<dim, spacedim>>
+        solution_extraction_data;
 
-  /**
-   *
-   * @param width Vectorization width: we wish to vectorize the quadrature point data / indices. This value determines the quadrature point batch size for all vectorized operations.
-   */
-  template <int dim,
-            int spacedim                  = dim,
-            typename ScalarType           = double,
-            bool        use_vectorization = numbers::UseVectorization::value,
-            std::size_t width =
-              numbers::VectorizationDefaults<ScalarType>::width>
-  class MatrixBasedAssembler
-    : public AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>
-  {
-    template <typename CellIteratorType,
-              typename ScratchData,
-              typename CopyData>
-    using CellWorkerType =
-      std::function<void(const CellIteratorType &, ScratchData &, CopyData &)>;
+      // The cell that the cell FEValues were last initialized for.
+      int current_cell_level;
+      int current_cell_index;
+    };
 
-    template <typename CellIteratorType,
-              typename ScratchData,
-              typename CopyData>
-    using BoundaryWorkerType = std::function<void(const CellIteratorType &,
-                                                  const unsigned int &,
-                                                  ScratchData &,
-                                                  CopyData &)>;
 
-    template <typename CellIteratorType,
-              typename ScratchData,
-              typename CopyData>
-    using FaceWorkerType = std::function<void(const CellIteratorType &,
-                                              const unsigned int,
-                                              const unsigned int,
-                                              const CellIteratorType &,
-                                              const unsigned int,
-                                              const unsigned int,
-                                              ScratchData &,
-                                              CopyData &)>;
+    /**
+     * The scratch data used when assembling a batch of cells at once. There
+     * is one handle to a ScratchData object for each cell in the batch.
+     */
+    template <typename ScratchDataHandle>
+    struct CellBatchScratchData
+    {
+      CellBatchScratchData(const ScratchDataHandle &sample_scratch_data,
+                           const unsigned int       max_n_cells)
+        : cells(max_n_cells, sample_scratch_data)
+      {}
 
-  public:
-    explicit MatrixBasedAssembler()
-      : AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>(){};
+      std::vector<ScratchDataHandle> cells;
+    };
 
-    explicit MatrixBasedAssembler(AD_SD_Functor_Cache &user_ad_sd_cache)
-      : AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>(
-          user_ad_sd_cache)
-    {}
 
     /**
-     * Assemble the linear system matrix, excluding boundary and internal
-     * face contributions.
-     *
-     * @tparam MatrixType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @param system_matrix
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
-     *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * The copy data used when assembling a batch of cells at once. There is
+     * one CopyData object for each cell in the batch, so that the local
+     * contributions from each cell can be handed to the copier individually.
      */
-    template <typename MatrixType,
-              typename DoFHandlerType,
-              typename CellQuadratureType>
-    void
-    assemble_matrix(MatrixType &                         system_matrix,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature) const
+    template <typename CopyData>
+    struct CellBatchCopyData
     {
-      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
-        &system_matrix,
-        nullptr /*system_vector*/,
-        constraints,
-        dof_handler,
-        nullptr /*solution_vector*/,
-        cell_quadrature,
-        nullptr /*face_quadrature*/);
-    }
+      CellBatchCopyData(const CopyData &   sample_copy_data,
+                        const unsigned int max_n_cells)
+        : cells(max_n_cells, sample_copy_data)
+        , n_cells(0)
+      {}
+
+      std::vector<CopyData> cells;
+      unsigned int          n_cells;
+    };
+
+
 
     /**
-     * Same as the previous function, but with a solution vector
+     * The ways in which a local matrix can be reduced to a local vector.
      */
-    template <typename MatrixType,
-              typename VectorType,
-              typename DoFHandlerType,
-              typename CellQuadratureType>
-    void
-    assemble_matrix(MatrixType &                         system_matrix,
-                    const VectorType &                   solution_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature) const
+    enum class LocalMatrixReductionType
     {
-      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
-        &system_matrix,
-        nullptr /*system_vector*/,
-        constraints,
-        dof_handler,
-        &solution_vector,
-        cell_quadrature,
-        nullptr /*face_quadrature*/);
-    }
+      /**
+       * Extract the diagonal entries.
+       */
+      diagonal,
+      /**
+       * Sum all of the entries in each row.
+       */
+      row_sum
+    };
+
 
     /**
-     * Same as the previous function, but with solution storage
+     * A stand-in for the system matrix that, instead of accumulating the
+     * local matrices, reduces each of them to a local vector that is then
+     * accumulated into a global vector.
      */
-    template <typename MatrixType,
-              typename VectorType,
-              typename DoFHandlerType,
-              typename CellQuadratureType,
-              typename SSDType>
-    void
-    assemble_matrix(
-      MatrixType &                                system_matrix,
-      const SolutionStorage<VectorType, SSDType> &solution_storage,
-      const AffineConstraints<ScalarType> &       constraints,
-      const DoFHandlerType &                      dof_handler,
-      const CellQuadratureType &                  cell_quadrature) const
+    template <typename VectorType>
+    struct LocalMatrixReduction
     {
-      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
-        &system_matrix,
-        nullptr /*system_vector*/,
-        constraints,
-        dof_handler,
-        solution_storage,
-        cell_quadrature,
-        nullptr /*face_quadrature*/);
-    }
+      LocalMatrixReduction(VectorType &                   vector,
+                           const LocalMatrixReductionType type)
+        : vector(vector)
+        , type(type)
+      {}
+
+      void
+      compress(const VectorOperation::values operation)
+      {
+        vector.compress(operation);
+      }
+
+      VectorType &                   vector;
+      const LocalMatrixReductionType type;
+    };
+
 
     /**
-     * Assemble the linear system matrix, including boundary and internal
-     * face contributions.
-     *
-     * @tparam MatrixType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @tparam FaceQuadratureType
-     * @param system_matrix
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
-     * @param face_quadrature
-     *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * A stand-in for the system matrix that, instead of accumulating the
+     * local matrices, immediately applies each of them to the local entries
+     * of the @p src vector and accumulates the result into the @p dst
+     * vector.
      */
-    template <typename MatrixType,
-              typename DoFHandlerType,
+    template <typename VectorType>
+    struct ElementByElementOperator
+    {
+      ElementByElementOperator(VectorType &dst, const VectorType &src)
+        : dst(dst)
+        , src(src)
+      {}
+
+      void
+      compress(const VectorOperation::values operation)
+      {
+        dst.compress(operation);
+      }
+
+      VectorType &      dst;
+      const VectorType &src;
+    };
+
+
+    /**
+     * A stand-in for the system matrix that accumulates the local matrices
+     * of the cells on one multigrid @p level into the @p level_matrix. If
+     * an @p interface_matrix is given, then the entries of the local
+     * matrices that couple the DoFs on the refinement edge to those in the
+     * interior of the level are also accumulated into it.
+     */
+    template <typename MatrixType>
+    struct MGLevelMatrix
+    {
+      MGLevelMatrix(MatrixType &             level_matrix,
+                    MatrixType *const        interface_matrix,
+                    const MGConstrainedDoFs &mg_constrained_dofs,
+                    const unsigned int       level)
+        : level_matrix(level_matrix)
+        , interface_matrix(interface_matrix)
+        , mg_constrained_dofs(mg_constrained_dofs)
+        , level(level)
+      {}
+
+      void
+      compress(const VectorOperation::values operation)
+      {
+        level_matrix.compress(operation);
+        if (interface_matrix)
+          interface_matrix->compress(operation);
+      }
+
+      MatrixType &             level_matrix;
+      MatrixType *const        interface_matrix;
+      const MGConstrainedDoFs &mg_constrained_dofs;
+      const unsigned int       level;
+    };
+
+
+    /**
+     * A trait that indicates whether or not the system matrix type is only a
+     * stand-in for a matrix, which processes the local matrices in some
+     * other way than accumulating them.
+     */
+    template <typename MatrixType>
+    struct IsMatrixStandIn : std::false_type
+    {};
+
+    template <typename VectorType>
+    struct IsMatrixStandIn<LocalMatrixReduction<VectorType>> : std::true_type
+    {};
+
+    template <typename VectorType>
+    struct IsMatrixStandIn<ElementByElementOperator<VectorType>>
+      : std::true_type
+    {};
+
+    template <typename MatrixType>
+    struct IsMatrixStandIn<MGLevelMatrix<MatrixType>> : std::true_type
+    {};
+
+
+    /**
+     * A trait that indicates whether or not the system matrix type is an
+     * actual matrix, into which the entries of the local matrices are
+     * added.
+     */
+    template <typename MatrixType>
+    struct IsAssembledMatrix
+      : std::integral_constant<
+          bool,
+          !IsMatrixStandIn<MatrixType>::value &&
+            !std::is_same<MatrixType, std::nullptr_t>::value>
+    {};
+
+
+    /**
+     * A trait that indicates whether or not the local contributions of
+     * several cells may be written into the given system matrix or vector
+     * type concurrently, as long as these cells share no DoFs. This is the
+     * case for the deal.II matrix and vector types, for which each thread
+     * then only writes into its own set of entries. The wrappers for the
+     * PETSc and Trilinos types, as well as any other type that is not listed
+     * here, do not give this guarantee.
+     */
+    template <typename T>
+    struct SupportsConcurrentWrites : std::false_type
+    {};
+
+    template <>
+    struct SupportsConcurrentWrites<std::nullptr_t> : std::true_type
+    {};
+
+    template <typename Number>
+    struct SupportsConcurrentWrites<dealii::SparseMatrix<Number>>
+      : std::true_type
+    {};
+
+    template <typename Number>
+    struct SupportsConcurrentWrites<dealii::BlockSparseMatrix<Number>>
+      : std::true_type
+    {};
+
+    template <typename Number>
+    struct SupportsConcurrentWrites<dealii::Vector<Number>> : std::true_type
+    {};
+
+    template <typename Number>
+    struct SupportsConcurrentWrites<dealii::BlockVector<Number>>
+      : std::true_type
+    {};
+
+    template <typename Number, typename MemorySpace>
+    struct SupportsConcurrentWrites<
+      dealii::LinearAlgebra::distributed::Vector<Number, MemorySpace>>
+      : std::true_type
+    {};
+
+    template <typename Number>
+    struct SupportsConcurrentWrites<
+      dealii::LinearAlgebra::distributed::BlockVector<Number>> : std::true_type
+    {};
+
+    template <typename VectorType>
+    struct SupportsConcurrentWrites<LocalMatrixReduction<VectorType>>
+      : SupportsConcurrentWrites<VectorType>
+    {};
+
+    template <typename VectorType>
+    struct SupportsConcurrentWrites<ElementByElementOperator<VectorType>>
+      : SupportsConcurrentWrites<VectorType>
+    {};
+
+
+    /**
+     * A trait that indicates whether or not the system matrix type collects
+     * the contributions from the cells on a multigrid level, rather than
+     * those from the active cells.
+     */
+    template <typename MatrixType>
+    struct IsMGLevelMatrix : std::false_type
+    {};
+
+    template <typename MatrixType>
+    struct IsMGLevelMatrix<MGLevelMatrix<MatrixType>> : std::true_type
+    {};
+
+
+    /**
+     * A helper that selects the cells that are assembled, which are either
+     * the active cells or the cells on one multigrid level.
+     */
+    template <typename DoFHandlerType, bool level_cells>
+    struct AssemblyCells;
+
+    template <typename DoFHandlerType>
+    struct AssemblyCells<DoFHandlerType, false>
+    {
+      using CellIteratorType = typename DoFHandlerType::active_cell_iterator;
+
+      static IteratorRange<CellIteratorType>
+      get(const DoFHandlerType &dof_handler, const unsigned int /*level*/)
+      {
+        return dof_handler.active_cell_iterators();
+      }
+
+      static bool
+      is_locally_owned(const CellIteratorType &cell)
+      {
+        return cell->is_locally_owned();
+      }
+
+      template <typename CellSelectionType>
+      static bool
+      is_selected(const CellSelectionType *const cell_selection,
+                  const CellIteratorType &       cell)
+      {
+        return cell_selection == nullptr || (*cell_selection)(cell);
+      }
+    };
+
+    template <typename DoFHandlerType>
+    struct AssemblyCells<DoFHandlerType, true>
+    {
+      using CellIteratorType = typename DoFHandlerType::level_cell_iterator;
+
+      static IteratorRange<CellIteratorType>
+      get(const DoFHandlerType &dof_handler, const unsigned int level)
+      {
+        return dof_handler.mg_cell_iterators_on_level(level);
+      }
+
+      static bool
+      is_locally_owned(const CellIteratorType &cell)
+      {
+        return cell->is_locally_owned_on_level();
+      }
+
+      // Only active cells can be selected for reassembly.
+      template <typename CellSelectionType>
+      static bool
+      is_selected(const CellSelectionType *const cell_selection,
+                  const CellIteratorType &)
+      {
+        Assert(cell_selection == nullptr, ExcInternalError());
+        (void)cell_selection;
+        return true;
+      }
+    };
+
+
+    /**
+     * Return the multigrid level that the @p system_matrix collects the
+     * contributions of, or an invalid level if it collects those of the
+     * active cells.
+     */
+    template <typename MatrixType>
+    unsigned int
+    get_mg_level(const MatrixType *const /*system_matrix*/)
+    {
+      return numbers::invalid_unsigned_int;
+    }
+
+    template <typename MatrixType>
+    unsigned int
+    get_mg_level(const MGLevelMatrix<MatrixType> *const system_matrix)
+    {
+      Assert(system_matrix, ExcInternalError());
+      return system_matrix->level;
+    }
+
+
+    /**
+     * A flag that marks an assembler as being in use by an assembly call.
+     * A copy of an assembler is not in use, whatever the state of the
+     * original.
+     */
+    struct AssemblyInProgressFlag
+    {
+      AssemblyInProgressFlag()
+        : in_progress(false)
+      {}
+
+      AssemblyInProgressFlag(const AssemblyInProgressFlag &)
+        : in_progress(false)
+      {}
+
+      AssemblyInProgressFlag &
+      operator=(const AssemblyInProgressFlag &)
+      {
+        return *this;
+      }
+
+      std::atomic<bool> in_progress;
+    };
+
+
+    /**
+     * Mark an assembler as being in use for the lifetime of this object. It
+     * is an error to start an assembly with an assembler that is already in
+     * use, e.g. while one of its assemble_system_async() tasks is still
+     * running, as the assembler holds the caches and the state of each call.
+     */
+    class AssemblyInProgressGuard
+    {
+    public:
+      explicit AssemblyInProgressGuard(AssemblyInProgressFlag &flag)
+        : flag(flag)
+      {
+        const bool was_in_progress = flag.in_progress.exchange(true);
+        Assert(!was_in_progress,
+               ExcMessage(
+                 "This assembler is already performing an assembly, e.g. in "
+                 "a task launched by assemble_system_async() that has not "
+                 "yet been joined. An assembler may only perform one "
+                 "assembly at a time."));
+        (void)was_in_progress;
+      }
+
+      ~AssemblyInProgressGuard()
+      {
+        flag.in_progress = false;
+      }
+
+    private:
+      AssemblyInProgressFlag &flag;
+    };
+
+
+    /**
+     * Return the entries of the local matrices that have to be computed in
+     * order to accumulate them into the @p system_matrix. If the local
+     * matrices are only reduced to a vector, then the kernels can compute
+     * this reduction directly.
+     */
+    template <typename MatrixType>
+    LocalMatrixContribution
+    get_local_matrix_contribution(const MatrixType *const /*system_matrix*/)
+    {
+      return LocalMatrixContribution::full;
+    }
+
+    template <typename VectorType>
+    LocalMatrixContribution
+    get_local_matrix_contribution(
+      const LocalMatrixReduction<VectorType> *const system_matrix)
+    {
+      Assert(system_matrix, ExcInternalError());
+      return (system_matrix->type == LocalMatrixReductionType::diagonal ?
+                LocalMatrixContribution::diagonal :
+                LocalMatrixContribution::row_sum);
+    }
+
+
+
+    /**
+     * A helper that distributes local contributions into a global system.
+     *
+     * If the system matrix is a block matrix, then the local matrix is split
+     * up into the sub-blocks that couple the DoFs of each pair of matrix
+     * blocks, and each of these is added directly to the corresponding block
+     * of the system matrix. Sub-blocks that are entirely zero (i.e. the forms
+     * do not couple the two fields), or that correspond to a block of the
+     * system matrix that has no entries at all, are skipped. For multi-field
+     * problems this avoids walking through all of the zero couplings when
+     * the entries are inserted. (The kernels that compute the local matrix
+     * already skip the pairs of fields that a form does not couple, so that
+     * these zero sub-blocks cost no more than the scan that detects them.)
+     * The block that each local DoF belongs to is still looked up for each
+     * cell. Local matrices for cells with constrained DoFs are still
+     * distributed as a whole by the AffineConstraints, so that the
+     * constraints are resolved in exactly the same way as for any other
+     * matrix type. With Dirichlet boundaries and hanging nodes, this
+     * may well be a sizeable share of all cells, for which the block-wise
+     * distribution brings no benefit.
+     *
+     * If the system matrix is a LocalMatrixReduction, then each local matrix
+     * is reduced to a local vector, which is distributed like a contribution
+     * to a RHS vector.
+     *
+     * If the system matrix is an ElementByElementOperator, then each local
+     * matrix is multiplied by the local entries of the source vector, and the
+     * result is distributed like a contribution to a RHS vector.
+     *
+     * If the system matrix is an MGLevelMatrix, then each local matrix is
+     * distributed into the level matrix, and the entries that couple the
+     * refinement edge to the interior of the level are added to the
+     * interface matrix.
+     *
+     * Unless the cells are colored, the copier is executed sequentially, so
+     * one instance of this class may be shared for all cells, and its data
+     * is reused for each one.
+     */
+    template <typename ScalarType>
+    class LocalToGlobalScatter
+    {
+    public:
+      template <typename MatrixType, typename VectorType>
+      typename std::enable_if<!IsBlockMatrix<MatrixType>::value>::type
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const Vector<ScalarType> &                          cell_vector,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix,
+        VectorType *const                                   system_vector)
+      {
+        internal::distribute_local_to_global(constraints,
+                                             cell_matrix,
+                                             cell_vector,
+                                             local_dof_indices,
+                                             system_matrix,
+                                             system_vector);
+      }
+
+      template <typename MatrixType, typename VectorType>
+      typename std::enable_if<IsBlockMatrix<MatrixType>::value>::type
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const Vector<ScalarType> &                          cell_vector,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix,
+        VectorType *const                                   system_vector)
+      {
+        // The RHS contributions from inhomogeneous constraints depend on
+        // the full local matrix. Otherwise, the matrix and vector
+        // contributions can be distributed independently.
+        if (constraints.has_inhomogeneities())
+          {
+            internal::distribute_local_to_global(constraints,
+                                                 cell_matrix,
+                                                 cell_vector,
+                                                 local_dof_indices,
+                                                 system_matrix,
+                                                 system_vector);
+            return;
+          }
+
+        distribute_local_to_global(constraints,
+                                   cell_matrix,
+                                   local_dof_indices,
+                                   system_matrix);
+        internal::distribute_local_to_global(constraints,
+                                             cell_vector,
+                                             local_dof_indices,
+                                             system_vector);
+      }
+
+      template <typename MatrixType>
+      typename std::enable_if<!IsBlockMatrix<MatrixType>::value>::type
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix)
+      {
+        internal::distribute_local_to_global(constraints,
+                                             cell_matrix,
+                                             local_dof_indices,
+                                             system_matrix);
+      }
+
+      template <typename MatrixType>
+      typename std::enable_if<IsBlockMatrix<MatrixType>::value>::type
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix)
+      {
+        Assert(system_matrix, ExcInternalError());
+        Assert(cell_matrix.m() == local_dof_indices.size(),
+               ExcDimensionMismatch(cell_matrix.m(), local_dof_indices.size()));
+
+        // The diagonal entries of constrained DoFs are scaled by the mean
+        // diagonal entry of the entire local matrix. So, to get exactly the
+        // same result as when distributing the local matrix as a whole, we
+        // do just that when any of the DoFs are constrained.
+        for (const dealii::types::global_dof_index dof_index :
+             local_dof_indices)
+          if (constraints.is_constrained(dof_index))
+            {
+              internal::distribute_local_to_global(constraints,
+                                                   cell_matrix,
+                                                   local_dof_indices,
+                                                   system_matrix);
+              return;
+            }
+
+        const BlockIndices &block_indices = system_matrix->get_row_indices();
+        const unsigned int  n_blocks      = block_indices.size();
+
+        const Table<2, bool> &block_has_entries =
+          get_block_has_entries(*system_matrix);
+
+        // Sort the local DoFs into the blocks of the system matrix.
+        block_local_dofs.resize(n_blocks);
+        block_dof_indices.resize(n_blocks);
+        for (unsigned int b = 0; b < n_blocks; ++b)
+          {
+            block_local_dofs[b].clear();
+            block_dof_indices[b].clear();
+          }
+        for (unsigned int i = 0; i < local_dof_indices.size(); ++i)
+          {
+            const std::pair<unsigned int, dealii::types::global_dof_index>
+              block_and_index =
+                block_indices.global_to_local(local_dof_indices[i]);
+            block_local_dofs[block_and_index.first].push_back(i);
+            block_dof_indices[block_and_index.first].push_back(
+              block_and_index.second);
+          }
+
+        // None of the DoFs are constrained, so the entries of each sub-block
+        // can be added directly into the corresponding block of the system
+        // matrix.
+
+        for (unsigned int I = 0; I < n_blocks; ++I)
+          for (unsigned int J = 0; J < n_blocks; ++J)
+            {
+              if (block_local_dofs[I].empty() || block_local_dofs[J].empty())
+                continue;
+
+              // A block without any entries cannot take any contributions.
+              // Only zero sub-blocks may therefore be skipped; anything else
+              // means that the forms and the sparsity pattern do not match.
+              if (!block_has_entries(I, J))
+                {
+                  Assert(!extract_sub_block(cell_matrix,
+                                            block_local_dofs[I],
+                                            block_local_dofs[J]),
+                         ExcMessage(
+                           "The local matrix has non-zero entries in block (" +
+                           Utilities::to_string(I) + "," +
+                           Utilities::to_string(J) +
+                           ") of the system matrix, but the sparsity pattern "
+                           "of that block has no entries."));
+                  continue;
+                }
+
+              if (!extract_sub_block(cell_matrix,
+                                     block_local_dofs[I],
+                                     block_local_dofs[J]))
+                continue;
+
+              system_matrix->block(I, J).add(block_dof_indices[I],
+                                             block_dof_indices[J],
+                                             sub_block_matrix);
+            }
+      }
+
+      template <typename VectorType>
+      void
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        LocalMatrixReduction<VectorType> *const             system_matrix)
+      {
+        Assert(system_matrix, ExcInternalError());
+        Assert(cell_matrix.m() == local_dof_indices.size(),
+               ExcDimensionMismatch(cell_matrix.m(), local_dof_indices.size()));
+
+        Assert(system_matrix->type == LocalMatrixReductionType::diagonal ||
+                 system_matrix->type == LocalMatrixReductionType::row_sum,
+               ExcNotImplemented());
+        const bool reduce_to_diagonal =
+          (system_matrix->type == LocalMatrixReductionType::diagonal);
+
+        const bool has_constrained_dofs =
+          std::any_of(local_dof_indices.begin(),
+                      local_dof_indices.end(),
+                      [&constraints](
+                        const dealii::types::global_dof_index dof_index)
+                      { return constraints.is_constrained(dof_index); });
+
+        if (!has_constrained_dofs)
+          {
+            reduced_cell_vector.reinit(cell_matrix.m());
+            if (reduce_to_diagonal)
+              {
+                for (unsigned int i = 0; i < cell_matrix.m(); ++i)
+                  reduced_cell_vector(i) = cell_matrix(i, i);
+              }
+            else
+              {
+                // The kernels might have already stored the row sums in the
+                // diagonal entries, in which case the others are all zero.
+                for (unsigned int i = 0; i < cell_matrix.m(); ++i)
+                  for (unsigned int j = 0; j < cell_matrix.n(); ++j)
+                    reduced_cell_vector(i) += cell_matrix(i, j);
+              }
+
+            constraints.distribute_local_to_global(reduced_cell_vector,
+                                                   local_dof_indices,
+                                                   system_matrix->vector);
+            return;
+          }
+
+        // The local matrix contributes C^T A C to the condensed system
+        // matrix, where C expresses each local DoF in terms of the
+        // unconstrained global DoFs: An unconstrained DoF stands for itself,
+        // while a constrained DoF stands for the weighted sum of the DoFs
+        // that it is constrained to. The inhomogeneities play no role for
+        // the matrix. We reduce this contribution, rather than the local
+        // matrix itself.
+        const unsigned int n_dofs = local_dof_indices.size();
+        expand_local_dofs(constraints, local_dof_indices);
+
+        // For the row sums, only the sum of the weights of each column of C
+        // is required.
+        if (!reduce_to_diagonal)
+          {
+            src_cell_vector.reinit(n_dofs);
+            for (unsigned int j = 0; j < n_dofs; ++j)
+              for (const auto &entry : local_dof_expansions[j])
+                src_cell_vector(j) += entry.second;
+          }
+
+        condensed_dof_indices.clear();
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (const auto &row_entry : local_dof_expansions[i])
+            condensed_dof_indices.push_back(row_entry.first);
+
+        reduced_cell_vector.reinit(condensed_dof_indices.size());
+        unsigned int k = 0;
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (const auto &row_entry : local_dof_expansions[i])
+            {
+              ScalarType value = ScalarType(0);
+              for (unsigned int j = 0; j < n_dofs; ++j)
+                {
+                  if (cell_matrix(i, j) == ScalarType(0))
+                    continue;
+
+                  if (reduce_to_diagonal)
+                    {
+                      for (const auto &column_entry : local_dof_expansions[j])
+                        if (column_entry.first == row_entry.first)
+                          value += cell_matrix(i, j) * column_entry.second;
+                    }
+                  else
+                    value += cell_matrix(i, j) * src_cell_vector(j);
+                }
+
+              reduced_cell_vector(k++) = row_entry.second * value;
+            }
+
+        // None of the condensed DoFs are constrained, so the constraints
+        // simply add these contributions to the global vector.
+        constraints.distribute_local_to_global(reduced_cell_vector,
+                                               condensed_dof_indices,
+                                               system_matrix->vector);
+      }
+
+      template <typename VectorType>
+      void
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        ElementByElementOperator<VectorType> *const         system_matrix)
+      {
+        Assert(system_matrix, ExcInternalError());
+        Assert(cell_matrix.m() == local_dof_indices.size(),
+               ExcDimensionMismatch(cell_matrix.m(), local_dof_indices.size()));
+
+        // Gather the local source values. The entries for constrained DoFs
+        // are resolved from those of the DoFs that they are constrained to,
+        // ignoring any inhomogeneities, so that the local matrix acts on the
+        // same space as the condensed system matrix does.
+        const VectorType &src = system_matrix->src;
+        src_cell_vector.reinit(cell_matrix.n());
+        for (unsigned int j = 0; j < cell_matrix.n(); ++j)
+          {
+            const dealii::types::global_dof_index dof_index =
+              local_dof_indices[j];
+            if (const auto *const entries =
+                  constraints.get_constraint_entries(dof_index))
+              {
+                for (const auto &entry : *entries)
+                  src_cell_vector(j) += entry.second * src(entry.first);
+              }
+            else
+              src_cell_vector(j) = src(dof_index);
+          }
+
+        dst_cell_vector.reinit(cell_matrix.m());
+        cell_matrix.vmult(dst_cell_vector, src_cell_vector);
+
+        constraints.distribute_local_to_global(dst_cell_vector,
+                                               local_dof_indices,
+                                               system_matrix->dst);
+      }
+
+      template <typename VectorType>
+      void
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const Vector<ScalarType> &                          cell_vector,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        ElementByElementOperator<VectorType> *const         system_matrix,
+        VectorType *const                                   system_vector)
+      {
+        distribute_local_to_global(constraints,
+                                   cell_matrix,
+                                   local_dof_indices,
+                                   system_matrix);
+        internal::distribute_local_to_global(constraints,
+                                             cell_vector,
+                                             local_dof_indices,
+                                             system_vector);
+      }
+
+      template <typename MatrixType>
+      void
+      distribute_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MGLevelMatrix<MatrixType> *const                    system_matrix)
+      {
+        Assert(system_matrix, ExcInternalError());
+        Assert(cell_matrix.m() == local_dof_indices.size(),
+               ExcDimensionMismatch(cell_matrix.m(), local_dof_indices.size()));
+
+        constraints.distribute_local_to_global(cell_matrix,
+                                               local_dof_indices,
+                                               system_matrix->level_matrix);
+
+        if (system_matrix->interface_matrix == nullptr)
+          return;
+
+        // Only the entries that couple a DoF on the refinement edge to a DoF
+        // in the interior of the level enter the interface matrix. These
+        // are added as they are, as the level constraints would eliminate
+        // the rows and columns of the refinement edge DoFs.
+        const MGConstrainedDoFs &mg_constrained_dofs =
+          system_matrix->mg_constrained_dofs;
+        const unsigned int level = system_matrix->level;
+
+        bool has_interface_entries = false;
+        interface_cell_matrix.reinit(cell_matrix.m(), cell_matrix.n());
+        for (unsigned int i = 0; i < cell_matrix.m(); ++i)
+          for (unsigned int j = 0; j < cell_matrix.n(); ++j)
+            if (mg_constrained_dofs.is_interface_matrix_entry(
+                  level, local_dof_indices[i], local_dof_indices[j]))
+              {
+                interface_cell_matrix(i, j) = cell_matrix(i, j);
+                has_interface_entries       = true;
+              }
+
+        if (has_interface_entries)
+          system_matrix->interface_matrix->add(local_dof_indices,
+                                               interface_cell_matrix);
+      }
+
+      /**
+       * Distribute only those contributions of the symmetric @p cell_matrix
+       * that lie in the upper triangle of the condensed system matrix, along
+       * with the @p cell_vector.
+       *
+       * The constraints do not preserve the triangular structure of a local
+       * matrix, so for cells with constrained DoFs the full local matrix and
+       * vector are condensed first. Only then are the entries that belong to
+       * the lower triangle dropped. This retains the contributions that
+       * inhomogeneous constraints make to the system vector.
+       */
+      template <typename MatrixType, typename VectorType>
+      typename std::enable_if<IsAssembledMatrix<MatrixType>::value>::type
+      distribute_upper_triangle_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const Vector<ScalarType> &                          cell_vector,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix,
+        VectorType *const                                   system_vector)
+      {
+        Assert(system_matrix, ExcInternalError());
+
+        if (!condense_upper_triangle(constraints,
+                                     cell_matrix,
+                                     &cell_vector,
+                                     local_dof_indices))
+          {
+            distribute_local_to_global(constraints,
+                                       upper_triangle_cell_matrix,
+                                       cell_vector,
+                                       local_dof_indices,
+                                       system_matrix,
+                                       system_vector);
+            return;
+          }
+
+        // None of the condensed DoFs are constrained, so the constraints
+        // simply add these contributions to the global system.
+        distribute_local_to_global(constraints,
+                                   upper_triangle_cell_matrix,
+                                   condensed_cell_vector,
+                                   condensed_dof_indices,
+                                   system_matrix,
+                                   system_vector);
+        add_constrained_diagonal_entries(constraints,
+                                         cell_matrix,
+                                         local_dof_indices,
+                                         *system_matrix);
+      }
+
+      /**
+       * Same as the previous function, but without a system vector.
+       */
+      template <typename MatrixType>
+      typename std::enable_if<IsAssembledMatrix<MatrixType>::value>::type
+      distribute_upper_triangle_local_to_global(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType *const                                   system_matrix)
+      {
+        Assert(system_matrix, ExcInternalError());
+
+        if (!condense_upper_triangle(constraints,
+                                     cell_matrix,
+                                     nullptr,
+                                     local_dof_indices))
+          {
+            distribute_local_to_global(constraints,
+                                       upper_triangle_cell_matrix,
+                                       local_dof_indices,
+                                       system_matrix);
+            return;
+          }
+
+        distribute_local_to_global(constraints,
+                                   upper_triangle_cell_matrix,
+                                   condensed_dof_indices,
+                                   system_matrix);
+        add_constrained_diagonal_entries(constraints,
+                                         cell_matrix,
+                                         local_dof_indices,
+                                         *system_matrix);
+      }
+
+      /**
+       * The stand-ins for a system matrix always require the full local
+       * matrix, so the upper triangle is never distributed into them.
+       */
+      template <typename MatrixType, typename VectorType>
+      typename std::enable_if<!IsAssembledMatrix<MatrixType>::value>::type
+      distribute_upper_triangle_local_to_global(
+        const AffineConstraints<ScalarType> &,
+        const FullMatrix<ScalarType> &,
+        const Vector<ScalarType> &,
+        const std::vector<dealii::types::global_dof_index> &,
+        MatrixType *const,
+        VectorType *const)
+      {
+        AssertThrow(false, ExcInternalError());
+      }
+
+      template <typename MatrixType>
+      typename std::enable_if<!IsAssembledMatrix<MatrixType>::value>::type
+      distribute_upper_triangle_local_to_global(
+        const AffineConstraints<ScalarType> &,
+        const FullMatrix<ScalarType> &,
+        const std::vector<dealii::types::global_dof_index> &,
+        MatrixType *const)
+      {
+        AssertThrow(false, ExcInternalError());
+      }
+
+    private:
+      /**
+       * For each of the block system matrices that have been scattered into,
+       * a flag for each of its blocks that indicates whether or not the
+       * sparsity pattern of that block has any entries. The matrices of
+       * different slots may well have different block sparsity patterns.
+       * A scatter is only used during a single assembly call, during which
+       * the sparsity patterns do not change.
+       */
+      std::vector<std::pair<const void *, Table<2, bool>>>
+        block_has_entries_tables;
+
+      /**
+       * The local indices of the DoFs of the current cell that lie in each
+       * of the blocks of the system matrix.
+       */
+      std::vector<std::vector<unsigned int>> block_local_dofs;
+
+      /**
+       * The indices, within each block of the system matrix, of the DoFs of
+       * the current cell that lie in that block.
+       */
+      std::vector<std::vector<dealii::types::global_dof_index>>
+        block_dof_indices;
+
+      /**
+       * The sub-block of the local matrix that is currently being
+       * distributed.
+       */
+      FullMatrix<ScalarType> sub_block_matrix;
+
+      /**
+       * The local matrix, reduced to a vector.
+       */
+      Vector<ScalarType> reduced_cell_vector;
+
+      /**
+       * The unconstrained global DoFs, and their weights, that each local
+       * DoF is expressed in terms of, and the global DoFs that the entries
+       * of a reduced and condensed local matrix belong to.
+       */
+      std::vector<
+        std::vector<std::pair<dealii::types::global_dof_index, ScalarType>>>
+                                                   local_dof_expansions;
+      std::vector<dealii::types::global_dof_index> condensed_dof_indices;
+
+      /**
+       * The position, within the condensed DoFs, of each of the global DoFs
+       * that the local DoFs are expressed in terms of.
+       */
+      std::vector<std::vector<unsigned int>> local_dof_expansion_positions;
+
+      /**
+       * The upper triangle of a local matrix, or of a condensed local matrix,
+       * and the condensed local vector.
+       */
+      FullMatrix<ScalarType> upper_triangle_cell_matrix;
+      Vector<ScalarType>     condensed_cell_vector;
+
+      /**
+       * The local entries of the source vector that a local matrix is
+       * applied to, and the result of that operation.
+       */
+      Vector<ScalarType> src_cell_vector;
+      Vector<ScalarType> dst_cell_vector;
+
+      /**
+       * The entries of the local matrix that contribute to a multigrid
+       * interface matrix.
+       */
+      FullMatrix<ScalarType> interface_cell_matrix;
+
+      /**
+       * Express each of the @p local_dof_indices in terms of the
+       * unconstrained global DoFs: An unconstrained DoF stands for itself,
+       * while a constrained DoF stands for the weighted sum of the DoFs that
+       * it is constrained to.
+       */
+      void
+      expand_local_dofs(
+        const AffineConstraints<ScalarType> &               constraints,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices)
+      {
+        local_dof_expansions.resize(local_dof_indices.size());
+        for (unsigned int i = 0; i < local_dof_indices.size(); ++i)
+          {
+            local_dof_expansions[i].clear();
+            if (const auto *const entries =
+                  constraints.get_constraint_entries(local_dof_indices[i]))
+              {
+                for (const auto &entry : *entries)
+                  local_dof_expansions[i].emplace_back(entry.first,
+                                                       entry.second);
+              }
+            else
+              local_dof_expansions[i].emplace_back(local_dof_indices[i],
+                                                   ScalarType(1));
+          }
+      }
+
+      /**
+       * Build the upper triangle of the symmetric @p cell_matrix, with
+       * respect to the global DoF indices. If any of the local DoFs are
+       * constrained, then the local matrix (and the @p cell_vector, if
+       * given) are condensed first, and the condensed DoFs are stored.
+       * Return whether or not the condensation has been performed.
+       */
+      bool
+      condense_upper_triangle(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const Vector<ScalarType> *const                     cell_vector,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices)
+      {
+        Assert(cell_matrix.m() == local_dof_indices.size(),
+               ExcDimensionMismatch(cell_matrix.m(), local_dof_indices.size()));
+        const unsigned int n_dofs = local_dof_indices.size();
+
+        const bool has_constrained_dofs =
+          std::any_of(local_dof_indices.begin(),
+                      local_dof_indices.end(),
+                      [&constraints](
+                        const dealii::types::global_dof_index dof_index)
+                      { return constraints.is_constrained(dof_index); });
+
+        if (!has_constrained_dofs)
+          {
+            upper_triangle_cell_matrix.reinit(n_dofs, n_dofs);
+            for (unsigned int i = 0; i < n_dofs; ++i)
+              for (unsigned int j = 0; j < n_dofs; ++j)
+                if (local_dof_indices[i] <= local_dof_indices[j])
+                  upper_triangle_cell_matrix(i, j) = cell_matrix(i, j);
+            return false;
+          }
+
+        // The local matrix contributes C^T A C to the condensed system
+        // matrix, and the local vector contributes C^T (b - A g), where g
+        // holds the inhomogeneities of the constrained DoFs.
+        expand_local_dofs(constraints, local_dof_indices);
+
+        condensed_dof_indices.clear();
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (const auto &entry : local_dof_expansions[i])
+            condensed_dof_indices.push_back(entry.first);
+        std::sort(condensed_dof_indices.begin(), condensed_dof_indices.end());
+        condensed_dof_indices.erase(std::unique(condensed_dof_indices.begin(),
+                                                condensed_dof_indices.end()),
+                                    condensed_dof_indices.end());
+
+        local_dof_expansion_positions.resize(n_dofs);
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          {
+            local_dof_expansion_positions[i].clear();
+            for (const auto &entry : local_dof_expansions[i])
+              local_dof_expansion_positions[i].push_back(
+                std::lower_bound(condensed_dof_indices.begin(),
+                                 condensed_dof_indices.end(),
+                                 entry.first) -
+                condensed_dof_indices.begin());
+          }
+
+        const unsigned int n_condensed_dofs = condensed_dof_indices.size();
+        upper_triangle_cell_matrix.reinit(n_condensed_dofs, n_condensed_dofs);
+        for (unsigned int i = 0; i < n_dofs; ++i)
+          for (unsigned int j = 0; j < n_dofs; ++j)
+            {
+              const ScalarType &value = cell_matrix(i, j);
+              if (value == ScalarType(0))
+                continue;
+
+              for (unsigned int a = 0; a < local_dof_expansions[i].size(); ++a)
+                for (unsigned int b = 0; b < local_dof_expansions[j].size();
+                     ++b)
+                  upper_triangle_cell_matrix(
+                    local_dof_expansion_positions[i][a],
+                    local_dof_expansion_positions[j][b]) +=
+                    local_dof_expansions[i][a].second * value *
+                    local_dof_expansions[j][b].second;
+            }
+
+        for (unsigned int a = 0; a < n_condensed_dofs; ++a)
+          for (unsigned int b = 0; b < a; ++b)
+            upper_triangle_cell_matrix(a, b) = ScalarType(0);
+
+        if (cell_vector != nullptr)
+          {
+            condensed_cell_vector.reinit(n_condensed_dofs);
+            for (unsigned int i = 0; i < n_dofs; ++i)
+              {
+                ScalarType value = (*cell_vector)(i);
+                for (unsigned int j = 0; j < n_dofs; ++j)
+                  if (constraints.is_inhomogeneously_constrained(
+                        local_dof_indices[j]))
+                    value -= cell_matrix(i, j) *
+                             constraints.get_inhomogeneity(
+                               local_dof_indices[j]);
+
+                for (unsigned int a = 0; a < local_dof_expansions[i].size();
+                     ++a)
+                  condensed_cell_vector(local_dof_expansion_positions[i][a]) +=
+                    local_dof_expansions[i][a].second * value;
+              }
+          }
+
+        return true;
+      }
+
+      /**
+       * Add the diagonal entries of the rows of constrained DoFs, in the
+       * same way as AffineConstraints::distribute_local_to_global() does,
+       * so that the system matrix remains invertible.
+       */
+      template <typename MatrixType>
+      void
+      add_constrained_diagonal_entries(
+        const AffineConstraints<ScalarType> &               constraints,
+        const FullMatrix<ScalarType> &                      cell_matrix,
+        const std::vector<dealii::types::global_dof_index> &local_dof_indices,
+        MatrixType &                                        system_matrix)
+      {
+        ScalarType average_diagonal = ScalarType(0);
+        for (unsigned int i = 0; i < cell_matrix.m(); ++i)
+          average_diagonal += std::abs(cell_matrix(i, i));
+        average_diagonal /= static_cast<ScalarType>(cell_matrix.m());
+
+        for (unsigned int i = 0; i < local_dof_indices.size(); ++i)
+          if (constraints.is_constrained(local_dof_indices[i]))
+            system_matrix.add(local_dof_indices[i],
+                              local_dof_indices[i],
+                              std::abs(cell_matrix(i, i)) != ScalarType(0) ?
+                                std::abs(cell_matrix(i, i)) :
+                                average_diagonal);
+      }
+
+      template <typename BlockMatrixType>
+      const Table<2, bool> &
+      get_block_has_entries(const BlockMatrixType &system_matrix)
+      {
+        for (const auto &table : block_has_entries_tables)
+          if (table.first == &system_matrix)
+            return table.second;
+
+        block_has_entries_tables.emplace_back(
+          &system_matrix,
+          Table<2, bool>(system_matrix.n_block_rows(),
+                         system_matrix.n_block_cols()));
+        Table<2, bool> &block_has_entries =
+          block_has_entries_tables.back().second;
+        for (unsigned int I = 0; I < system_matrix.n_block_rows(); ++I)
+          for (unsigned int J = 0; J < system_matrix.n_block_cols(); ++J)
+            block_has_entries(I, J) =
+              (system_matrix.block(I, J).n_nonzero_elements() > 0);
+        return block_has_entries;
+      }
+
+      /**
+       * Copy the entries of the @p cell_matrix that couple the @p row_dofs
+       * and @p column_dofs into the sub-block matrix. Return whether or not
+       * any of these entries are non-zero.
+       */
+      bool
+      extract_sub_block(const FullMatrix<ScalarType> &   cell_matrix,
+                        const std::vector<unsigned int> &row_dofs,
+                        const std::vector<unsigned int> &column_dofs)
+      {
+        sub_block_matrix.reinit(row_dofs.size(), column_dofs.size());
+
+        bool has_non_zero_entries = false;
+        for (unsigned int i = 0; i < row_dofs.size(); ++i)
+          for (unsigned int j = 0; j < column_dofs.size(); ++j)
+            {
+              const ScalarType &value =
+                cell_matrix(row_dofs[i], column_dofs[j]);
+              sub_block_matrix(i, j) = value;
+              if (value != ScalarType())
+                has_non_zero_entries = true;
+            }
+
+        return has_non_zero_entries;
+      }
+    };
+
+
+
+    template <typename T>
+    struct is_hp_q_collection : std::false_type
+    {};
+
+
+    template <int dim>
+    struct is_hp_q_collection<hp::QCollection<dim>> : std::true_type
+    {};
+
+
+    template <typename CellQuadratureType, typename FaceQuadratureType>
+    struct is_hp_cell_or_face_q_collection
+      : std::conditional<
+          std::is_same<typename std::decay<FaceQuadratureType>::type,
+                       std::nullptr_t>::value,
+          is_hp_q_collection<CellQuadratureType>,
+          is_hp_q_collection<FaceQuadratureType>>::type
+    {};
+
+
+    template <bool is_hp_enabled>
+    struct HP_Helper;
+
+
+    template <>
+    struct HP_Helper<false>
+    {
+      template <int dim, int spacedim>
+      static const FiniteElement<dim, spacedim> &
+      get_fe(const DoFHandler<dim, spacedim> &dof_handler,
+             const unsigned int               index = 0)
+      {
+        return dof_handler.get_fe(index);
+      }
+
+      template <int dim, int spacedim>
+      static unsigned int
+      get_dofs_per_cell(const DoFHandler<dim, spacedim> &dof_handler,
+                        const unsigned int               index = 0)
+      {
+        return dof_handler.get_fe(index).dofs_per_cell;
+      }
+    };
+
+
+    template <>
+    struct HP_Helper<true>
+    {
+      template <int dim, int spacedim>
+      static const hp::FECollection<dim, spacedim> &
+      get_fe(const DoFHandler<dim, spacedim> &dof_handler)
+      {
+        return dof_handler.get_fe_collection();
+      }
+
+      template <int dim, int spacedim>
+      static unsigned int
+      get_dofs_per_cell(const DoFHandler<dim, spacedim> &dof_handler)
+      {
+        return dof_handler.get_fe_collection().max_dofs_per_cell();
+      }
+    };
+
+    template <typename CellQuadratureType, typename FaceQuadratureType>
+    using HP_Helper_t =
+      HP_Helper<is_hp_cell_or_face_q_collection<CellQuadratureType,
+                                                FaceQuadratureType>::value>;
+
+  } // namespace internal
+
+
+  /**
+   * A selection of cells, over which a partial reassembly is to be
+   * performed. The cells may either be described by a predicate, or be given
+   * as an explicit list.
+   */
+  template <int dim, int spacedim = dim>
+  class CellSelection
+  {
+  public:
+    using cell_iterator =
+      typename Triangulation<dim, spacedim>::active_cell_iterator;
+
+    /**
+     * Select all cells for which the @p predicate returns <tt>true</tt>.
+     * The @p predicate must be callable with a cell_iterator.
+     */
+    template <typename Predicate>
+    CellSelection(const Predicate &predicate)
+      : predicate(predicate)
+    {}
+
+    /**
+     * Select all of the given @p cells.
+     */
+    template <typename CellIteratorType>
+    CellSelection(const std::vector<CellIteratorType> &cells)
+    {
+      std::vector<bool> is_selected;
+      for (const CellIteratorType &cell : cells)
+        {
+          Assert(cell->is_active(),
+                 ExcMessage("Only active cells may be selected."));
+          if (cell->active_cell_index() >= is_selected.size())
+            is_selected.resize(cell->active_cell_index() + 1, false);
+          is_selected[cell->active_cell_index()] = true;
+        }
+
+      predicate = [is_selected](const cell_iterator &cell)
+      {
+        return cell->active_cell_index() < is_selected.size() &&
+               is_selected[cell->active_cell_index()];
+      };
+    }
+
+    /**
+     * Return whether or not the @p cell is selected.
+     */
+    bool
+    operator()(const cell_iterator &cell) const
+    {
+      return predicate(cell);
+    }
+
+  private:
+    std::function<bool(const cell_iterator &)> predicate;
+  };
+
+
+  /**
+   *
+   * @param width Vectorization width: we wish to vectorize the quadrature point data / indices. This value determines the quadrature point batch size for all vectorized operations.
+   */
+  template <int dim,
+            int spacedim                  = dim,
+            typename ScalarType           = double,
+            bool        use_vectorization = numbers::UseVectorization::value,
+            std::size_t width =
+              numbers::VectorizationDefaults<ScalarType>::width>
+  class MatrixBasedAssembler
+    : public AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>
+  {
+    template <typename CellIteratorType,
+              typename ScratchData,
+              typename CopyData>
+    using CellWorkerType =
+      std::function<void(const CellIteratorType &, ScratchData &, CopyData &)>;
+
+    template <typename CellIteratorType,
+              typename ScratchData,
+              typename CopyData>
+    using BoundaryWorkerType = std::function<void(const CellIteratorType &,
+                                                  const unsigned int &,
+                                                  ScratchData &,
+                                                  CopyData &)>;
+
+    template <typename CellIteratorType,
+              typename ScratchData,
+              typename CopyData>
+    using FaceWorkerType = std::function<void(const CellIteratorType &,
+                                              const unsigned int,
+                                              const unsigned int,
+                                              const CellIteratorType &,
+                                              const unsigned int,
+                                              const unsigned int,
+                                              ScratchData &,
+                                              CopyData &)>;
+
+  public:
+    explicit MatrixBasedAssembler()
+      : AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>()
+      , cell_batch_flag(false)
+      , persistent_scratch_data_flag(false)
+      , cell_matrix_cache_flag(false)
+      , local_matrix_history_flag(false)
+      , upper_triangle_scatter_flag(false)
+      , graph_coloring_flag(false)
+      , queue_length(2 * MultithreadInfo::n_threads())
+      , chunk_size(8)
+      , work_stream_auto_tuning_flag(false)
+      , communication_overlap_flag(false)
+      , interface_data_capacity(0, 0){};
+
+    explicit MatrixBasedAssembler(AD_SD_Functor_Cache &user_ad_sd_cache)
+      : AssemblerBase<dim, spacedim, ScalarType, use_vectorization, width>(
+          user_ad_sd_cache)
+      , cell_batch_flag(false)
+      , persistent_scratch_data_flag(false)
+      , cell_matrix_cache_flag(false)
+      , local_matrix_history_flag(false)
+      , upper_triangle_scatter_flag(false)
+      , graph_coloring_flag(false)
+      , queue_length(2 * MultithreadInfo::n_threads())
+      , chunk_size(8)
+      , work_stream_auto_tuning_flag(false)
+      , communication_overlap_flag(false)
+      , interface_data_capacity(0, 0)
+    {}
+
+    /**
+     * Set whether or not the cell contributions of bilinear forms are
+     * assembled for batches of @p width cells at a time.
+     *
+     * In this mode, each vectorization lane is associated with a different
+     * cell rather than with a different quadrature point of the same cell.
+     * This means that every lane does useful work even when the number of
+     * quadrature points is not a multiple of the vectorization width, or is
+     * smaller than it. Only cells that share the same finite element are
+     * batched together. A local matrix is computed for each cell in the
+     * batch, and each one is distributed into the global system just as it
+     * would have been otherwise.
+     *
+     * @note This mode is not used if any AD or SD functors are in use, as
+     * their shared cache may only be bound to a single cell at a time per
+     * thread. The operations for linear forms, and for boundary and interface
+     * contributions, are still evaluated one cell at a time.
+     */
+    void
+    set_cell_batch_flag(const bool flag)
+    {
+      cell_batch_flag = flag;
+    }
+
+    /**
+     * Set whether or not the ScratchData objects that are used during
+     * assembly persist from one assembly call to the next.
+     *
+     * Constructing these objects is costly, so when assembling repeatedly
+     * (e.g. within a nonlinear solver) it is beneficial to reuse them.
+     * They are only rebuilt if the DoFHandler, its finite element(s), the
+     * quadrature rules or the required update flags change between calls.
+     *
+     * @note The ScratchData objects refer to the finite element(s) held by
+     * the DoFHandler. So if this flag is set, then clear_scratch_data() must
+     * be called before the DoFHandler is destroyed or has its degrees of
+     * freedom distributed with a different finite element, unless this
+     * assembler is destroyed first.
+     */
+    void
+    set_persistent_scratch_data_flag(const bool flag)
+    {
+      persistent_scratch_data_flag = flag;
+      if (!persistent_scratch_data_flag)
+        clear_scratch_data();
+    }
+
+    /**
+     * Set whether or not the local matrix contributions from those cell
+     * integrals of bilinear forms that do not depend on the solution are
+     * cached, and reused in subsequent assembly calls.
+     *
+     * Within a nonlinear solver, many of the bilinear forms (e.g. mass
+     * terms, or linear elastic contributions) do not change from one
+     * iteration to the next. With this flag set, their local matrices are
+     * computed only once per cell and are retrieved from the cache
+     * thereafter, while the solution-dependent contributions are recomputed
+     * in each assembly call. A form is deemed to depend on the solution if
+     * any of its operands involves a field solution, or if it stems from a
+     * self-linearizing form.
+     *
+     * The cache is invalidated whenever the triangulation changes or its
+     * vertices are moved (as announced by the mesh_movement signal of the
+     * triangulation, e.g. by GridTools::transform()), or if the DoFHandler,
+     * its finite element(s), the quadrature rules or the set of assembled
+     * forms change between calls.
+     *
+     * @note The cached matrices depend on the geometry of the cells. If the
+     * vertices are moved without announcing it, or if the mapping depends on
+     * the solution (e.g. a MappingQEulerian built from the displacement
+     * field), then clear_cell_matrix_cache() must be called whenever the
+     * geometry changes.
+     *
+     * @note The values returned by user-defined functors are assumed to
+     * remain the same between assembly calls. If this is not the case (e.g.
+     * if a functor captures the current time step size) then
+     * clear_cell_matrix_cache() must be called whenever these values change.
+     *
+     * @note Boundary and interface contributions are always recomputed, and
+     * this mode is not used in combination with assembly for batches of
+     * cells.
+     */
+    void
+    set_cell_matrix_cache_flag(const bool flag)
+    {
+      cell_matrix_cache_flag = flag;
+      if (!cell_matrix_cache_flag)
+        clear_cell_matrix_cache();
+    }
+
+    /**
+     * Discard all of the cached solution-independent local matrices.
+     */
+    void
+    clear_cell_matrix_cache()
+    {
+      cell_matrix_cache.clear();
+    }
+
+    /**
+     * Set whether or not the local matrix of each cell is recorded when the
+     * system matrix is assembled, so that its contribution can later be
+     * replaced using reassemble_matrix().
+     *
+     * @note This requires one local matrix to be stored for every cell. The
+     * record is discarded whenever the triangulation changes.
+     */
+    void
+    set_local_matrix_history_flag(const bool flag)
+    {
+      local_matrix_history_flag = flag;
+      if (!local_matrix_history_flag)
+        local_matrix_history.clear();
+    }
+
+    /**
+     * Set whether or not only the upper triangle of a symmetric system
+     * matrix is to be assembled. This is intended for use with matrix
+     * storage formats and solvers that only require one triangle of a
+     * symmetric matrix, and can only be used if the global system is marked
+     * as being symmetric (see AssemblerBase::symmetrize()).
+     *
+     * In this mode only those entries of each local matrix that contribute
+     * to the upper triangle of the system matrix (i.e. those entries for
+     * which the global row index does not exceed the global column index)
+     * are distributed, and the entries of the lower triangle are never
+     * written to. The sparsity pattern of the system matrix therefore need
+     * only contain the upper triangle. For cells with constrained DoFs, the
+     * full local matrix and vector are condensed before the entries of the
+     * lower triangle are dropped, so that both hanging node constraints and
+     * the contributions of inhomogeneous constraints to the system vector
+     * are accounted for. The result is then the upper triangle of the system
+     * matrix that is assembled without this flag.
+     *
+     * @note This mode does not apply to the assembly of the diagonal, the
+     * lumped matrix, or to the element-by-element operator application,
+     * which all require the full local matrix.
+     */
+    void
+    set_upper_triangle_scatter_flag(const bool flag)
+    {
+      upper_triangle_scatter_flag = flag;
+    }
+
+    /**
+     * Set whether or not the cells are colored such that the contributions
+     * of all cells of the same color may be written into the global system
+     * concurrently.
+     *
+     * By default, the local contributions are computed in parallel but are
+     * distributed into the global system one cell at a time. With this flag
+     * set, the cells are first partitioned using
+     * GraphColoring::make_graph_coloring() such that no two cells of the
+     * same color share a DoF (either directly, or through the constraints).
+     * Each color is then assembled by WorkStream::run(), with the local
+     * contributions of each cell being distributed by the thread that
+     * computed them. The coloring is computed once, and is reused until the
+     * triangulation changes or the assembly is performed for a different
+     * DoFHandler or set of constraints.
+     *
+     * @note Only the deal.II matrix and vector types (e.g. SparseMatrix,
+     * Vector and LinearAlgebra::distributed::Vector, and their block
+     * counterparts) are known to support concurrent writes into different
+     * rows. For any other types, such as the PETSc and Trilinos wrappers,
+     * this flag is ignored and the contributions are distributed one cell at
+     * a time. This mode is also not used if there are any interface
+     * contributions, as these write into the rows of the neighboring cell,
+     * nor in combination with assembly for batches of cells, reassembly over
+     * a subset of cells, or overlapped communication.
+     */
+    void
+    set_graph_coloring_flag(const bool flag)
+    {
+      graph_coloring_flag = flag;
+      if (!graph_coloring_flag)
+        clear_cell_coloring();
+    }
+
+    /**
+     * Discard the cached coloring of the cells.
+     */
+    void
+    clear_cell_coloring()
+    {
+      cell_coloring_cache.clear();
+    }
+
+    /**
+     * Set the number of items that may be in flight at any given time in
+     * the assembly loop. This is passed on to WorkStream::run() (and hence
+     * MeshWorker::mesh_loop()), and defaults to twice the number of
+     * threads.
+     *
+     * If a shared AD/SD functor cache is in use, then it is enlarged to
+     * hold at least this many entries so that no thread ever has to wait
+     * for an entry to be released.
+     */
+    void
+    set_queue_length(const unsigned int queue_length)
+    {
+      Assert(queue_length > 0,
+             ExcMessage("The queue length must be positive."));
+      this->queue_length = queue_length;
+    }
+
+    /**
+     * Set the number of cells that each thread works on in one go in the
+     * assembly loop. This is passed on to WorkStream::run() (and hence
+     * MeshWorker::mesh_loop()), and defaults to 8.
+     */
+    void
+    set_chunk_size(const unsigned int chunk_size)
+    {
+      Assert(chunk_size > 0, ExcMessage("The chunk size must be positive."));
+      this->chunk_size = chunk_size;
+    }
+
+    /**
+     * Set whether or not the queue length and chunk size are chosen
+     * automatically.
+     *
+     * With this flag set, the first few assembly calls are timed, each with
+     * a different combination of these parameters, after which the fastest
+     * combination is used for all subsequent calls. The parameters are
+     * tuned separately for each kind of assembly (e.g. that of the system
+     * matrix, the RHS vector, or the diagonal), and the tuning starts anew
+     * if the DoFHandler, its finite element(s), the quadrature rules, the
+     * set of assembled forms or the number of active cells change. The
+     * values set through set_queue_length() and set_chunk_size() are used
+     * until the tuning has completed.
+     *
+     * @note Reassembly over a subset of cells and the assembly of multigrid
+     * level matrices do not take part in the tuning. These calls use the
+     * values set through set_queue_length() and set_chunk_size().
+     */
+    void
+    set_work_stream_auto_tuning_flag(const bool flag)
+    {
+      work_stream_auto_tuning_flag = flag;
+    }
+
+    /**
+     * Set whether or not the communication of off-process contributions is
+     * overlapped with the assembly, when the DoFs are distributed over
+     * several processes.
+     *
+     * In this mode, the locally owned cells that contribute to rows that are
+     * owned by other processes (either directly, or through the constraints)
+     * are assembled first. The exchange of these contributions is then
+     * started for the system vectors, and proceeds while the remaining cells
+     * are assembled. It is completed at the end of the assembly. This hides
+     * the communication latency for vector types that support a non-blocking
+     * exchange (i.e. those with the compress_start() and compress_finish()
+     * functions, such as LinearAlgebra::distributed::Vector). For all other
+     * types, including the system matrices, the exchange takes place at the
+     * end of the assembly as usual.
+     *
+     * @note This mode is not used if there are any interface contributions,
+     * as these write into the rows of the neighboring cell, nor in
+     * combination with the coloring of the cells.
+     */
+    void
+    set_communication_overlap_flag(const bool flag)
+    {
+      communication_overlap_flag = flag;
+    }
+
+    /**
+     * Discard all of the ScratchData objects that have persisted from
+     * previous assembly calls.
+     */
+    void
+    clear_scratch_data()
+    {
+      scratch_data_pool.clear();
+    }
+
+    /**
+     * Assemble the linear system matrix, excluding boundary and internal
+     * face contributions.
+     *
+     * @tparam MatrixType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @param system_matrix
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_matrix(MatrixType &                         system_matrix,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_matrix(MatrixType &                         system_matrix,
+                    const VectorType &                   solution_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename SSDType>
+    void
+    assemble_matrix(
+      MatrixType &                                system_matrix,
+      const SolutionStorage<VectorType, SSDType> &solution_storage,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellQuadratureType &                  cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, std::nullptr_t>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Assemble the linear system matrix, including boundary and internal
+     * face contributions.
+     *
+     * @tparam MatrixType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @tparam FaceQuadratureType
+     * @param system_matrix
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     * @param face_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_matrix(MatrixType &                         system_matrix,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature,
+                    const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_matrix(MatrixType &                         system_matrix,
+                    const VectorType &                   solution_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature,
+                    const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType,
+              typename SSDType>
+    void
+    assemble_matrix(
+      MatrixType &                                system_matrix,
+      const SolutionStorage<VectorType, SSDType> &solution_storage,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellQuadratureType &                  cell_quadrature,
+      const FaceQuadratureType &                  face_quadrature) const
+    {
+      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
+        &system_matrix,
+        nullptr /*system_vector*/,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Assemble a RHS vector, boundary and internal face contributions.
+     *
+     * @tparam VectorType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @param system_vector
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_rhs_vector(VectorType &                         system_vector,
+                        const AffineConstraints<ScalarType> &constraints,
+                        const DoFHandlerType &               dof_handler,
+                        const CellQuadratureType &cell_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_rhs_vector(VectorType &                         system_vector,
+                        const VectorType &                   solution_vector,
+                        const AffineConstraints<ScalarType> &constraints,
+                        const DoFHandlerType &               dof_handler,
+                        const CellQuadratureType &cell_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename SSDType>
+    void
+    assemble_rhs_vector(
+      VectorType &system_vector,
+      const SolutionStorage<typename identity<VectorType>::type, SSDType>
+        &                                  solution_storage,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Assemble a RHS vector, including boundary and internal face
+     * contributions.
+     *
+     * @tparam VectorType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @tparam FaceQuadratureType
+     * @param system_vector
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     * @param face_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_rhs_vector(VectorType &                         system_vector,
+                        const AffineConstraints<ScalarType> &constraints,
+                        const DoFHandlerType &               dof_handler,
+                        const CellQuadratureType &           cell_quadrature,
+                        const FaceQuadratureType &face_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_rhs_vector(VectorType &                         system_vector,
+                        const VectorType &                   solution_vector,
+                        const AffineConstraints<ScalarType> &constraints,
+                        const DoFHandlerType &               dof_handler,
+                        const CellQuadratureType &           cell_quadrature,
+                        const FaceQuadratureType &face_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType,
+              typename SSDType>
+    void
+    assemble_rhs_vector(
+      VectorType &system_vector,
+      const SolutionStorage<typename identity<VectorType>::type, SSDType>
+        &                                  solution_storage,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellQuadratureType &           cell_quadrature,
+      const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
+        nullptr /*system_matrix*/,
+        &system_vector,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Assemble a system matrix and a RHS vector, excluding boundary and
+     * internal face contributions.
+     *
+     * @tparam MatrixType
+     * @tparam VectorType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @param system_matrix
+     * @param system_vector
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
+        &system_matrix,
+        &system_vector,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const VectorType &                   solution_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
+        &system_matrix,
+        &system_vector,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename SSDType>
+    void
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const SolutionStorage<typename identity<VectorType>::type,
+                                          SSDType> &     solution_storage,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
+        &system_matrix,
+        &system_vector,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Assemble a system matrix and a RHS vector, including boundary and
+     * internal face contributions.
+     *
+     * @tparam MatrixType
+     * @tparam VectorType
+     * @tparam DoFHandlerType
+     * @tparam CellQuadratureType
+     * @tparam FaceQuadratureType
+     * @param system_matrix
+     * @param system_vector
+     * @param constraints
+     * @param dof_handler
+     * @param cell_quadrature
+     * @param face_quadrature
+     *
+     * @note Does not reset the matrix, so one can assemble from multiple
+     * Assemblers into one matrix. This is useful if you want different
+     * quadrature rules for different contributions on the same cell.
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature,
+                    const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
+        &system_matrix,
+        &system_vector,
+        constraints,
+        dof_handler,
+        nullptr /*solution_vector*/,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with a solution vector
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
               typename CellQuadratureType,
               typename FaceQuadratureType>
     void
-    assemble_matrix(MatrixType &                         system_matrix,
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const VectorType &                   solution_vector,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature,
+                    const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
+        &system_matrix,
+        &system_vector,
+        constraints,
+        dof_handler,
+        &solution_vector,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType,
+              typename SSDType>
+    void
+    assemble_system(MatrixType &                         system_matrix,
+                    VectorType &                         system_vector,
+                    const SolutionStorage<typename identity<VectorType>::type,
+                                          SSDType> &     solution_storage,
                     const AffineConstraints<ScalarType> &constraints,
                     const DoFHandlerType &               dof_handler,
                     const CellQuadratureType &           cell_quadrature,
                     const FaceQuadratureType &           face_quadrature) const
     {
-      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
+      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
         &system_matrix,
-        nullptr /*system_vector*/,
+        &system_vector,
         constraints,
         dof_handler,
-        nullptr /*solution_vector*/,
+        solution_storage,
         cell_quadrature,
         &face_quadrature);
     }
 
+    /**
+     * Launch the assembly of a system matrix and a RHS vector as a task, so
+     * that the calling thread is free to do other work in the meantime (e.g.
+     * solve another subsystem). The @p args are the same as those of any of
+     * the assemble_system() functions, and the assembly is complete once
+     * Threads::Task::join() has been called on the returned task.
+     *
+     * The arguments are held by reference, so all of the following must
+     * remain alive and must not be modified until the task has completed:
+     * - the system matrix and vector, the constraints, the DoFHandler (and
+     *   its triangulation), and the quadrature rules;
+     * - the solution vector or SolutionStorage, as well as all of the
+     *   solution vectors that a SolutionStorage refers to;
+     * - this assembler, which holds the operations built from the forms,
+     *   and any data that user-defined functors in these forms refer to;
+     * - the AD_SD_Functor_Cache that this assembler was constructed with, if
+     *   any.
+     * Temporaries cannot be passed as arguments, for this reason.
+     *
+     * @note An assembler may only perform one assembly at a time, which is
+     * checked in debug mode. To assemble several subsystems concurrently,
+     * use one assembler for each of them. For distributed matrix and vector
+     * types, the assembly ends with a collective compress() operation that
+     * is called from within the task, which requires the MPI library to
+     * support multiple threads.
+     */
+    template <typename... Args>
+    Threads::Task<void>
+    assemble_system_async(Args &... args) const
+    {
+      return Threads::new_task(
+        [this, &args...]() { this->assemble_system(args...); });
+    }
+
+    /**
+     * Assemble several system matrices and RHS vectors within a single loop
+     * over all cells, excluding boundary and internal face contributions.
+     * This shares the FEValues, the shape function data and the extracted
+     * solution values between all of them.
+     *
+     * The forms that were added to this assembler with the slot @p i (see
+     * AssemblerBase::add()) are assembled into <tt>system_matrices[i]</tt>
+     * and <tt>system_vectors[i]</tt>. Both arrays must be large enough to
+     * hold an entry for every slot that their kind of form was added to.
+     * Any of these entries may be a null pointer, in which case the
+     * contributions to it are not computed. Each matrix is
+     * distributed together with the vector of the same slot, so the
+     * contributions of inhomogeneous constraints to a vector stem from the
+     * matrix of that same slot.
+     *
+     * @note Does not reset the matrices or vectors, so one can assemble from
+     * multiple Assemblers into them.
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellQuadratureType &                  cell_quadrature) const
+    {
+      do_assemble_systems<MatrixType, VectorType, std::nullptr_t>(
+        system_matrices,
+        system_vectors,
+        constraints,
+        dof_handler,
+        SolutionStorage<VectorType>(),
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
     /**
      * Same as the previous function, but with a solution vector
      */
     template <typename MatrixType,
               typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const VectorType &                          solution_vector,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellQuadratureType &                  cell_quadrature) const
+    {
+      do_assemble_systems<MatrixType, VectorType, std::nullptr_t>(
+        system_matrices,
+        system_vectors,
+        constraints,
+        dof_handler,
+        SolutionStorage<VectorType>(solution_vector),
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename SSDType>
+    void
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const SolutionStorage<typename identity<VectorType>::type, SSDType>
+        &                                  solution_storage,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellQuadratureType &           cell_quadrature) const
+    {
+      do_assemble_systems<MatrixType, VectorType, std::nullptr_t>(
+        system_matrices,
+        system_vectors,
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Assemble several system matrices and RHS vectors within a single loop
+     * over all cells, including boundary and internal face contributions.
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
               typename DoFHandlerType,
               typename CellQuadratureType,
               typename FaceQuadratureType>
     void
-    assemble_matrix(MatrixType &                         system_matrix,
-                    const VectorType &                   solution_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature,
-                    const FaceQuadratureType &           face_quadrature) const
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellQuadratureType &                  cell_quadrature,
+      const FaceQuadratureType &                  face_quadrature) const
     {
-      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
-        &system_matrix,
-        nullptr /*system_vector*/,
+      do_assemble_systems<MatrixType, VectorType, FaceQuadratureType>(
+        system_matrices,
+        system_vectors,
         constraints,
         dof_handler,
-        &solution_vector,
+        SolutionStorage<VectorType>(),
         cell_quadrature,
         &face_quadrature);
     }
 
     /**
-     * Same as the previous function, but with solution storage
+     * Same as the previous function, but with a solution vector
      */
     template <typename MatrixType,
               typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
               typename DoFHandlerType,
               typename CellQuadratureType,
-              typename FaceQuadratureType,
-              typename SSDType>
+              typename FaceQuadratureType>
     void
-    assemble_matrix(
-      MatrixType &                                system_matrix,
-      const SolutionStorage<VectorType, SSDType> &solution_storage,
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const VectorType &                          solution_vector,
       const AffineConstraints<ScalarType> &       constraints,
       const DoFHandlerType &                      dof_handler,
       const CellQuadratureType &                  cell_quadrature,
       const FaceQuadratureType &                  face_quadrature) const
     {
-      do_assemble_system<MatrixType, std::nullptr_t, FaceQuadratureType>(
-        &system_matrix,
-        nullptr /*system_vector*/,
+      do_assemble_systems<MatrixType, VectorType, FaceQuadratureType>(
+        system_matrices,
+        system_vectors,
+        constraints,
+        dof_handler,
+        SolutionStorage<VectorType>(solution_vector),
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType,
+              typename SSDType>
+    void
+    assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const SolutionStorage<typename identity<VectorType>::type, SSDType>
+        &                                  solution_storage,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellQuadratureType &           cell_quadrature,
+      const FaceQuadratureType &           face_quadrature) const
+    {
+      do_assemble_systems<MatrixType, VectorType, FaceQuadratureType>(
+        system_matrices,
+        system_vectors,
         constraints,
         dof_handler,
         solution_storage,
@@ -417,151 +2881,326 @@ namespace WeakForms
     }
 
     /**
-     * Assemble a RHS vector, boundary and internal face contributions.
+     * Assemble the bilinear forms into one matrix per multigrid level,
+     * excluding boundary and internal face contributions. The contributions
+     * to the matrix of each level stem from the cells on that level, as
+     * given by DoFHandler::mg_cell_iterators_on_level(), so the multigrid
+     * DoFs must already have been distributed.
      *
-     * @tparam VectorType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @param system_vector
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
+     * The local matrices are distributed into the @p level_matrices subject
+     * to the level constraints that are described by the
+     * @p mg_constrained_dofs. That is, the DoFs on the refinement edge and
+     * the boundary DoFs of each level are eliminated, and their diagonal
+     * entries are set to a non-zero value.
      *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * Only the bilinear forms are assembled. As there is no solution vector
+     * on the levels, these may not depend on the solution.
+     *
+     * @note Does not reset the matrices, so one can assemble from multiple
+     * Assemblers into them.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_level_matrices(MGLevelObject<MatrixType> &level_matrices,
+                            const MGConstrainedDoFs &  mg_constrained_dofs,
+                            const DoFHandlerType &     dof_handler,
+                            const CellQuadratureType & cell_quadrature) const
+    {
+      do_assemble_level_matrices<std::nullptr_t>(level_matrices,
+                                                 nullptr /*interface*/,
+                                                 mg_constrained_dofs,
+                                                 dof_handler,
+                                                 cell_quadrature,
+                                                 nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but including boundary and internal
+     * face contributions.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_level_matrices(MGLevelObject<MatrixType> &level_matrices,
+                            const MGConstrainedDoFs &  mg_constrained_dofs,
+                            const DoFHandlerType &     dof_handler,
+                            const CellQuadratureType & cell_quadrature,
+                            const FaceQuadratureType & face_quadrature) const
+    {
+      do_assemble_level_matrices<FaceQuadratureType>(level_matrices,
+                                                     nullptr /*interface*/,
+                                                     mg_constrained_dofs,
+                                                     dof_handler,
+                                                     cell_quadrature,
+                                                     &face_quadrature);
+    }
+
+    /**
+     * Same as the first assemble_level_matrices() function, but the entries
+     * of the local matrices that couple the DoFs on the refinement edge of
+     * each level to those in its interior are also assembled into the
+     * @p interface_matrices (also known as the edge matrices). These are
+     * required to transfer the residual across the refinement edge when
+     * the smoother only acts on the refined part of the mesh, e.g. with
+     * MGMatrixBlockVector or mg::Matrix together with
+     * Multigrid::set_edge_matrices().
+     *
+     * The sparsity patterns of the @p interface_matrices may be built with
+     * MGTools::make_interface_sparsity_pattern().
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    assemble_level_matrices(MGLevelObject<MatrixType> &level_matrices,
+                            MGLevelObject<MatrixType> &interface_matrices,
+                            const MGConstrainedDoFs &  mg_constrained_dofs,
+                            const DoFHandlerType &     dof_handler,
+                            const CellQuadratureType & cell_quadrature) const
+    {
+      do_assemble_level_matrices<std::nullptr_t>(level_matrices,
+                                                 &interface_matrices,
+                                                 mg_constrained_dofs,
+                                                 dof_handler,
+                                                 cell_quadrature,
+                                                 nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Same as the previous function, but including boundary and internal
+     * face contributions.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_level_matrices(MGLevelObject<MatrixType> &level_matrices,
+                            MGLevelObject<MatrixType> &interface_matrices,
+                            const MGConstrainedDoFs &  mg_constrained_dofs,
+                            const DoFHandlerType &     dof_handler,
+                            const CellQuadratureType & cell_quadrature,
+                            const FaceQuadratureType & face_quadrature) const
+    {
+      do_assemble_level_matrices<FaceQuadratureType>(level_matrices,
+                                                     &interface_matrices,
+                                                     mg_constrained_dofs,
+                                                     dof_handler,
+                                                     cell_quadrature,
+                                                     &face_quadrature);
+    }
+
+    /**
+     * Assemble only the diagonal of the system matrix into the vector
+     * @p diagonal, excluding boundary and internal face contributions.
+     *
+     * Only the diagonal entries of the local matrices for cell and boundary
+     * face integrals are computed, and no global matrix is required. This is
+     * useful for Jacobi or Chebyshev smoothers.
+     *
+     * The result is the diagonal of the condensed system matrix, i.e. the
+     * one that would be built by assemble_matrix() with the same
+     * @p constraints. On cells with constrained DoFs the full local matrix is
+     * computed and condensed before it is reduced, so that hanging node
+     * constraints are accounted for exactly. One is added to the entries for
+     * constrained DoFs, which is the identity convention that apply() and the
+     * MatrixFreeAssembler use for these DoFs.
+     *
+     * @note Does not reset the vector, so one can assemble from multiple
+     * Assemblers into one vector.
      */
     template <typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType>
     void
-    assemble_rhs_vector(VectorType &                         system_vector,
-                        const AffineConstraints<ScalarType> &constraints,
-                        const DoFHandlerType &               dof_handler,
-                        const CellQuadratureType &cell_quadrature) const
+    assemble_diagonal(VectorType &                         diagonal,
+                      const AffineConstraints<ScalarType> &constraints,
+                      const DoFHandlerType &               dof_handler,
+                      const CellQuadratureType &cell_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
-        nullptr /*system_matrix*/,
-        &system_vector,
+      do_assemble_reduced_matrix<std::nullptr_t>(
+        diagonal,
+        internal::LocalMatrixReductionType::diagonal,
         constraints,
         dof_handler,
-        nullptr /*solution_vector*/,
         cell_quadrature,
         nullptr /*face_quadrature*/);
     }
 
     /**
-     * Same as the previous function, but with a solution vector
+     * Same as the previous function, but including boundary and internal
+     * face contributions.
+     */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    assemble_diagonal(VectorType &                         diagonal,
+                      const AffineConstraints<ScalarType> &constraints,
+                      const DoFHandlerType &               dof_handler,
+                      const CellQuadratureType &           cell_quadrature,
+                      const FaceQuadratureType &face_quadrature) const
+    {
+      do_assemble_reduced_matrix<FaceQuadratureType>(
+        diagonal,
+        internal::LocalMatrixReductionType::diagonal,
+        constraints,
+        dof_handler,
+        cell_quadrature,
+        &face_quadrature);
+    }
+
+    /**
+     * Assemble the row-sum lumped system matrix, i.e. the sum of all of the
+     * entries in each row of the system matrix, into the vector @p lumped,
+     * excluding boundary and internal face contributions. This is typically
+     * used to build a lumped mass matrix for explicit time integration.
+     *
+     * No global matrix is required. The result is the row sums of the
+     * condensed system matrix, i.e. the one that would be built by
+     * assemble_matrix() with the same @p constraints. On cells with
+     * constrained DoFs the full local matrix is computed and condensed before
+     * it is reduced, so columns that belong to constrained DoFs (e.g. those
+     * next to a Dirichlet boundary) do not contribute. One is added to the
+     * entries for constrained DoFs, as for assemble_diagonal().
+     *
+     * @note Does not reset the vector, so one can assemble from multiple
+     * Assemblers into one vector.
      */
     template <typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType>
     void
-    assemble_rhs_vector(VectorType &                         system_vector,
-                        const VectorType &                   solution_vector,
-                        const AffineConstraints<ScalarType> &constraints,
-                        const DoFHandlerType &               dof_handler,
-                        const CellQuadratureType &cell_quadrature) const
+    assemble_lumped(VectorType &                         lumped,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
-        nullptr /*system_matrix*/,
-        &system_vector,
+      do_assemble_reduced_matrix<std::nullptr_t>(
+        lumped,
+        internal::LocalMatrixReductionType::row_sum,
         constraints,
         dof_handler,
-        &solution_vector,
         cell_quadrature,
         nullptr /*face_quadrature*/);
     }
 
     /**
-     * Same as the previous function, but with solution storage
+     * Same as the previous function, but including boundary and internal
+     * face contributions.
      */
     template <typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType,
-              typename SSDType>
+              typename FaceQuadratureType>
     void
-    assemble_rhs_vector(
-      VectorType &system_vector,
-      const SolutionStorage<typename identity<VectorType>::type, SSDType>
-        &                                  solution_storage,
-      const AffineConstraints<ScalarType> &constraints,
-      const DoFHandlerType &               dof_handler,
-      const CellQuadratureType &           cell_quadrature) const
+    assemble_lumped(VectorType &                         lumped,
+                    const AffineConstraints<ScalarType> &constraints,
+                    const DoFHandlerType &               dof_handler,
+                    const CellQuadratureType &           cell_quadrature,
+                    const FaceQuadratureType &           face_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, std::nullptr_t>(
-        nullptr /*system_matrix*/,
-        &system_vector,
+      do_assemble_reduced_matrix<FaceQuadratureType>(
+        lumped,
+        internal::LocalMatrixReductionType::row_sum,
         constraints,
         dof_handler,
-        solution_storage,
         cell_quadrature,
-        nullptr /*face_quadrature*/);
+        &face_quadrature);
     }
 
     /**
-     * Assemble a RHS vector, including boundary and internal face
-     * contributions.
-     *
-     * @tparam VectorType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @tparam FaceQuadratureType
-     * @param system_vector
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
-     * @param face_quadrature
+     * Apply the linear system matrix, excluding boundary and internal face
+     * contributions, to the vector @p src and store the result in @p dst.
      *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * The local matrix of each cell is computed from the bilinear forms and
+     * is immediately multiplied by the local entries of @p src, after which
+     * the result is distributed into @p dst. So, unlike for
+     * assemble_matrix(), no global matrix is ever stored. This supports all
+     * of the forms that the matrix-based assembly does (including the
+     * self-linearizing ones) at the cost of recomputing the local matrices
+     * for every operator application, which makes it suitable for problems
+     * where the memory required for the system matrix is prohibitive.
+     *
+     * For unconstrained DoFs, the result is the same as that of multiplying
+     * @p src with the system matrix that assemble_matrix() would produce
+     * using the same @p constraints. The operator acts as the identity on
+     * constrained DoFs. If @p src is a distributed vector, then it must have
+     * its ghost values set.
+     *
+     * @note Unlike the assembly functions, this resets the @p dst vector.
      */
+    template <typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    apply(VectorType &                         dst,
+          const VectorType &                   src,
+          const AffineConstraints<ScalarType> &constraints,
+          const DoFHandlerType &               dof_handler,
+          const CellQuadratureType &           cell_quadrature) const
+    {
+      do_apply<std::nullptr_t>(dst,
+                               src,
+                               SolutionStorage<VectorType>(),
+                               constraints,
+                               dof_handler,
+                               cell_quadrature,
+                               nullptr /*face_quadrature*/);
+    }
 
+    /**
+     * Same as the previous function, but with solution storage
+     */
     template <typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType,
-              typename FaceQuadratureType>
+              typename SSDType>
     void
-    assemble_rhs_vector(VectorType &                         system_vector,
-                        const AffineConstraints<ScalarType> &constraints,
-                        const DoFHandlerType &               dof_handler,
-                        const CellQuadratureType &           cell_quadrature,
-                        const FaceQuadratureType &face_quadrature) const
+    apply(VectorType &                                dst,
+          const VectorType &                          src,
+          const SolutionStorage<VectorType, SSDType> &solution_storage,
+          const AffineConstraints<ScalarType> &       constraints,
+          const DoFHandlerType &                      dof_handler,
+          const CellQuadratureType &                  cell_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
-        nullptr /*system_matrix*/,
-        &system_vector,
-        constraints,
-        dof_handler,
-        nullptr /*solution_vector*/,
-        cell_quadrature,
-        &face_quadrature);
+      do_apply<std::nullptr_t>(dst,
+                               src,
+                               solution_storage,
+                               constraints,
+                               dof_handler,
+                               cell_quadrature,
+                               nullptr /*face_quadrature*/);
     }
 
     /**
-     * Same as the previous function, but with a solution vector
+     * Apply the linear system matrix, including boundary and internal face
+     * contributions, to the vector @p src and store the result in @p dst.
      */
     template <typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType,
               typename FaceQuadratureType>
     void
-    assemble_rhs_vector(VectorType &                         system_vector,
-                        const VectorType &                   solution_vector,
-                        const AffineConstraints<ScalarType> &constraints,
-                        const DoFHandlerType &               dof_handler,
-                        const CellQuadratureType &           cell_quadrature,
-                        const FaceQuadratureType &face_quadrature) const
+    apply(VectorType &                         dst,
+          const VectorType &                   src,
+          const AffineConstraints<ScalarType> &constraints,
+          const DoFHandlerType &               dof_handler,
+          const CellQuadratureType &           cell_quadrature,
+          const FaceQuadratureType &           face_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
-        nullptr /*system_matrix*/,
-        &system_vector,
-        constraints,
-        dof_handler,
-        &solution_vector,
-        cell_quadrature,
-        &face_quadrature);
+      do_apply<FaceQuadratureType>(dst,
+                                   src,
+                                   SolutionStorage<VectorType>(),
+                                   constraints,
+                                   dof_handler,
+                                   cell_quadrature,
+                                   &face_quadrature);
     }
 
     /**
@@ -573,60 +3212,55 @@ namespace WeakForms
               typename FaceQuadratureType,
               typename SSDType>
     void
-    assemble_rhs_vector(
-      VectorType &system_vector,
-      const SolutionStorage<typename identity<VectorType>::type, SSDType>
-        &                                  solution_storage,
-      const AffineConstraints<ScalarType> &constraints,
-      const DoFHandlerType &               dof_handler,
-      const CellQuadratureType &           cell_quadrature,
-      const FaceQuadratureType &           face_quadrature) const
+    apply(VectorType &                                dst,
+          const VectorType &                          src,
+          const SolutionStorage<VectorType, SSDType> &solution_storage,
+          const AffineConstraints<ScalarType> &       constraints,
+          const DoFHandlerType &                      dof_handler,
+          const CellQuadratureType &                  cell_quadrature,
+          const FaceQuadratureType &                  face_quadrature) const
     {
-      do_assemble_system<std::nullptr_t, VectorType, FaceQuadratureType>(
-        nullptr /*system_matrix*/,
-        &system_vector,
-        constraints,
-        dof_handler,
-        solution_storage,
-        cell_quadrature,
-        &face_quadrature);
+      do_apply<FaceQuadratureType>(dst,
+                                   src,
+                                   solution_storage,
+                                   constraints,
+                                   dof_handler,
+                                   cell_quadrature,
+                                   &face_quadrature);
     }
 
     /**
-     * Assemble a system matrix and a RHS vector, excluding boundary and
-     * internal face contributions.
+     * Replace the contributions that the selected @p cells make to a
+     * @p system_matrix that has previously been assembled, without
+     * reassembling the contributions from any of the other cells.
      *
-     * @tparam MatrixType
-     * @tparam VectorType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @param system_matrix
-     * @param system_vector
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
+     * The local matrix of each selected cell is recomputed, and only the
+     * difference between it and the local matrix that was last distributed
+     * for that cell is added to the @p system_matrix. This requires that the
+     * local matrices were recorded during the previous assembly, i.e. that
+     * set_local_matrix_history_flag() has been called prior to it.
      *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * @note The diagonal entries that are associated with constrained DoFs
+     * are not necessarily the same as those that a full reassembly would
+     * produce. Contributions from internal face integrals are not supported.
      */
     template <typename MatrixType,
-              typename VectorType,
               typename DoFHandlerType,
               typename CellQuadratureType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature) const
+    reassemble_matrix(
+      MatrixType &                         system_matrix,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellSelection<dim, spacedim> & cells,
+      const CellQuadratureType &           cell_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
-        &system_matrix,
-        &system_vector,
+      do_reassemble_matrix<std::nullptr_t>(
+        system_matrix,
+        SolutionStorage<Vector<ScalarType>>(),
         constraints,
         dof_handler,
-        nullptr /*solution_vector*/,
+        cells,
         cell_quadrature,
         nullptr /*face_quadrature*/);
     }
@@ -639,19 +3273,20 @@ namespace WeakForms
               typename DoFHandlerType,
               typename CellQuadratureType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const VectorType &                   solution_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature) const
+    reassemble_matrix(
+      MatrixType &                         system_matrix,
+      const VectorType &                   solution_vector,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellSelection<dim, spacedim> & cells,
+      const CellQuadratureType &           cell_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
-        &system_matrix,
-        &system_vector,
+      do_reassemble_matrix<std::nullptr_t>(
+        system_matrix,
+        SolutionStorage<VectorType>(solution_vector),
         constraints,
         dof_handler,
-        &solution_vector,
+        cells,
         cell_quadrature,
         nullptr /*face_quadrature*/);
     }
@@ -665,43 +3300,53 @@ namespace WeakForms
               typename CellQuadratureType,
               typename SSDType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const SolutionStorage<typename identity<VectorType>::type,
-                                          SSDType> &     solution_storage,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature) const
+    reassemble_matrix(
+      MatrixType &                                system_matrix,
+      const SolutionStorage<VectorType, SSDType> &solution_storage,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellSelection<dim, spacedim> &        cells,
+      const CellQuadratureType &                  cell_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, std::nullptr_t>(
-        &system_matrix,
-        &system_vector,
+      do_reassemble_matrix<std::nullptr_t>(system_matrix,
+                                           solution_storage,
+                                           constraints,
+                                           dof_handler,
+                                           cells,
+                                           cell_quadrature,
+                                           nullptr /*face_quadrature*/);
+    }
+
+    /**
+     * Replace the contributions that the selected @p cells, including
+     * their boundary faces, make to a @p system_matrix that has previously
+     * been assembled.
+     */
+    template <typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType>
+    void
+    reassemble_matrix(
+      MatrixType &                         system_matrix,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellSelection<dim, spacedim> & cells,
+      const CellQuadratureType &           cell_quadrature,
+      const FaceQuadratureType &           face_quadrature) const
+    {
+      do_reassemble_matrix<FaceQuadratureType>(
+        system_matrix,
+        SolutionStorage<Vector<ScalarType>>(),
         constraints,
         dof_handler,
-        solution_storage,
+        cells,
         cell_quadrature,
-        nullptr /*face_quadrature*/);
+        &face_quadrature);
     }
 
     /**
-     * Assemble a system matrix and a RHS vector, including boundary and
-     * internal face contributions.
-     *
-     * @tparam MatrixType
-     * @tparam VectorType
-     * @tparam DoFHandlerType
-     * @tparam CellQuadratureType
-     * @tparam FaceQuadratureType
-     * @param system_matrix
-     * @param system_vector
-     * @param constraints
-     * @param dof_handler
-     * @param cell_quadrature
-     * @param face_quadrature
-     *
-     * @note Does not reset the matrix, so one can assemble from multiple
-     * Assemblers into one matrix. This is useful if you want different
-     * quadrature rules for different contributions on the same cell.
+     * Same as the previous function, but with a solution vector
      */
     template <typename MatrixType,
               typename VectorType,
@@ -709,81 +3354,380 @@ namespace WeakForms
               typename CellQuadratureType,
               typename FaceQuadratureType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature,
-                    const FaceQuadratureType &           face_quadrature) const
+    reassemble_matrix(
+      MatrixType &                         system_matrix,
+      const VectorType &                   solution_vector,
+      const AffineConstraints<ScalarType> &constraints,
+      const DoFHandlerType &               dof_handler,
+      const CellSelection<dim, spacedim> & cells,
+      const CellQuadratureType &           cell_quadrature,
+      const FaceQuadratureType &           face_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
-        &system_matrix,
-        &system_vector,
+      do_reassemble_matrix<FaceQuadratureType>(
+        system_matrix,
+        SolutionStorage<VectorType>(solution_vector),
         constraints,
         dof_handler,
-        nullptr /*solution_vector*/,
+        cells,
         cell_quadrature,
         &face_quadrature);
     }
 
     /**
-     * Same as the previous function, but with a solution vector
+     * Same as the previous function, but with solution storage
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename FaceQuadratureType,
+              typename SSDType>
+    void
+    reassemble_matrix(
+      MatrixType &                                system_matrix,
+      const SolutionStorage<VectorType, SSDType> &solution_storage,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellSelection<dim, spacedim> &        cells,
+      const CellQuadratureType &                  cell_quadrature,
+      const FaceQuadratureType &                  face_quadrature) const
+    {
+      do_reassemble_matrix<FaceQuadratureType>(system_matrix,
+                                               solution_storage,
+                                               constraints,
+                                               dof_handler,
+                                               cells,
+                                               cell_quadrature,
+                                               &face_quadrature);
+    }
+
+
+  private:
+    /**
+     * A flag to indicate whether or not the cell contributions of bilinear
+     * forms are assembled for batches of cells at a time.
+     */
+    bool cell_batch_flag;
+
+    /**
+     * A flag to indicate whether or not the ScratchData objects persist
+     * from one assembly call to the next.
+     */
+    bool persistent_scratch_data_flag;
+
+    /**
+     * A flag to indicate whether or not the solution-independent local
+     * matrix contributions from cell integrals are cached.
+     */
+    bool cell_matrix_cache_flag;
+
+    /**
+     * The cached solution-independent local cell matrices.
+     */
+    mutable internal::CellMatrixCache<ScalarType> cell_matrix_cache;
+
+    /**
+     * A flag to indicate whether or not the local matrix of each cell is
+     * recorded when the system matrix is assembled.
+     */
+    bool local_matrix_history_flag;
+
+    /**
+     * A flag to indicate whether or not only the upper triangle of a
+     * symmetric system matrix is assembled.
+     */
+    bool upper_triangle_scatter_flag;
+
+    /**
+     * A flag to indicate whether or not the cells are colored, such that
+     * the cells of each color may be assembled concurrently.
+     */
+    bool graph_coloring_flag;
+
+    /**
+     * The cached coloring of the cells.
+     */
+    mutable internal::CellColoringCache<dim, spacedim> cell_coloring_cache;
+
+    /**
+     * The queue length that is passed on to WorkStream::run().
+     */
+    unsigned int queue_length;
+
+    /**
+     * The chunk size that is passed on to WorkStream::run().
+     */
+    unsigned int chunk_size;
+
+    /**
+     * A flag to indicate whether or not the queue length and chunk size
+     * are chosen automatically.
+     */
+    bool work_stream_auto_tuning_flag;
+
+    /**
+     * The helpers that choose the queue length and chunk size, one for each
+     * kind of assembly.
+     */
+    mutable std::map<internal::AssemblyKind, internal::WorkStreamTuner>
+      work_stream_tuners;
+
+    /**
+     * A flag to indicate whether or not the communication of off-process
+     * contributions is overlapped with the assembly.
+     */
+    bool communication_overlap_flag;
+
+    /**
+     * The local matrices that were last distributed into the system matrix.
+     */
+    mutable internal::LocalMatrixHistory<ScalarType> local_matrix_history;
+
+    /**
+     * The ScratchData objects that are used during assembly.
+     */
+    mutable internal::ScratchDataPool<MeshWorker::ScratchData<dim, spacedim>>
+      scratch_data_pool;
+
+    /**
+     * The largest number of interfaces that the copy data has had to hold
+     * for any one cell, and the largest number of DoFs on any one of these
+     * interfaces, over all previous assembly calls. This is used to
+     * preallocate the interface data for the next assembly call.
+     */
+    mutable std::pair<unsigned int, unsigned int> interface_data_capacity;
+
+#ifdef DEBUG
+    /**
+     * A flag that marks this assembler as being in use by an assembly call.
+     */
+    mutable internal::AssemblyInProgressFlag assembly_in_progress;
+#endif
+
+    /**
+     * Return the coloring of the active cells of the @p dof_handler, which
+     * is retrieved from the cache.
+     */
+    template <typename DoFHandlerType>
+    const std::vector<
+      std::vector<typename DoFHandlerType::active_cell_iterator>> &
+    get_cell_coloring(const DoFHandlerType &               dof_handler,
+                      const AffineConstraints<ScalarType> &constraints,
+                      std::false_type /*level_cells*/) const
+    {
+      return cell_coloring_cache.get(dof_handler, constraints);
+    }
+
+    /**
+     * The cells on the multigrid levels are never colored, so this only
+     * exists for the assembly code to compile.
+     */
+    template <typename DoFHandlerType>
+    const std::vector<
+      std::vector<typename DoFHandlerType::level_cell_iterator>> &
+    get_cell_coloring(const DoFHandlerType &,
+                      const AffineConstraints<ScalarType> &,
+                      std::true_type /*level_cells*/) const
+    {
+      Assert(false, ExcInternalError());
+      static const std::vector<
+        std::vector<typename DoFHandlerType::level_cell_iterator>>
+        colored_cells;
+      return colored_cells;
+    }
+
+    /**
+     * Assemble the system matrix, but reduce each local matrix to a vector
+     * (as given by the @p reduction_type) which is then accumulated into the
+     * global @p vector.
+     */
+    template <typename FaceQuadratureType,
+              typename VectorType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    do_assemble_reduced_matrix(
+      VectorType &                             vector,
+      const internal::LocalMatrixReductionType reduction_type,
+      const AffineConstraints<ScalarType> &    constraints,
+      const DoFHandlerType &                   dof_handler,
+      const CellQuadratureType &               cell_quadrature,
+      const FaceQuadratureType *const          face_quadrature) const
+    {
+      internal::LocalMatrixReduction<VectorType> system_matrix(vector,
+                                                               reduction_type);
+      do_assemble_system<internal::LocalMatrixReduction<VectorType>,
+                         std::nullptr_t,
+                         FaceQuadratureType>(&system_matrix,
+                                             nullptr /*system_vector*/,
+                                             constraints,
+                                             dof_handler,
+                                             nullptr /*solution_vector*/,
+                                             cell_quadrature,
+                                             face_quadrature);
+
+      // The condensed system matrix acts as the identity on constrained
+      // DoFs, so both its diagonal entry and its row sum are one. This is
+      // added to, rather than written into, the vector so that the
+      // contributions of several assemblers can be accumulated.
+      const IndexSet locally_owned_dofs = vector.locally_owned_elements();
+      for (const auto &line : constraints.get_lines())
+        if (locally_owned_dofs.is_element(line.index))
+          vector(line.index) += ScalarType(1);
+      vector.compress(VectorOperation::add);
+    }
+
+    /**
+     * Apply the system matrix to the @p src vector and store the result in
+     * the @p dst vector, without assembling the system matrix.
      */
-    template <typename MatrixType,
+    template <typename FaceQuadratureType,
               typename VectorType,
+              typename SSDType,
               typename DoFHandlerType,
-              typename CellQuadratureType,
-              typename FaceQuadratureType>
+              typename CellQuadratureType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const VectorType &                   solution_vector,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature,
-                    const FaceQuadratureType &           face_quadrature) const
+    do_apply(VectorType &                                dst,
+             const VectorType &                          src,
+             const SolutionStorage<VectorType, SSDType> &solution_storage,
+             const AffineConstraints<ScalarType> &       constraints,
+             const DoFHandlerType &                      dof_handler,
+             const CellQuadratureType &                  cell_quadrature,
+             const FaceQuadratureType *const face_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
-        &system_matrix,
-        &system_vector,
-        constraints,
-        dof_handler,
-        &solution_vector,
-        cell_quadrature,
-        &face_quadrature);
+      Assert(!this->cell_matrix_operations.empty() ||
+               !this->boundary_face_matrix_operations.empty() ||
+               !this->interface_face_matrix_operations.empty(),
+             ExcMessage("There are no bilinear forms to apply."));
+
+      dst = ScalarType(0);
+
+      internal::ElementByElementOperator<VectorType> system_matrix(dst, src);
+      do_assemble_system<internal::ElementByElementOperator<VectorType>,
+                         VectorType,
+                         FaceQuadratureType>(&system_matrix,
+                                             nullptr /*system_vector*/,
+                                             constraints,
+                                             dof_handler,
+                                             solution_storage,
+                                             cell_quadrature,
+                                             face_quadrature);
+
+      // The operator acts as the identity on constrained DoFs.
+      const IndexSet locally_owned_dofs = dst.locally_owned_elements();
+      for (const auto &line : constraints.get_lines())
+        if (locally_owned_dofs.is_element(line.index))
+          dst(line.index) = src(line.index);
+      dst.compress(VectorOperation::insert);
     }
 
     /**
-     * Same as the previous function, but with solution storage
+     * Assemble the system matrix for each multigrid level, and optionally
+     * the interface matrices as well, from the cells on that level.
      */
-    template <typename MatrixType,
+    template <typename FaceQuadratureType,
+              typename MatrixType,
+              typename DoFHandlerType,
+              typename CellQuadratureType>
+    void
+    do_assemble_level_matrices(
+      MGLevelObject<MatrixType> &      level_matrices,
+      MGLevelObject<MatrixType> *const interface_matrices,
+      const MGConstrainedDoFs &        mg_constrained_dofs,
+      const DoFHandlerType &           dof_handler,
+      const CellQuadratureType &       cell_quadrature,
+      const FaceQuadratureType *const  face_quadrature) const
+    {
+      Assert(!this->cell_matrix_operations.empty() ||
+               !this->boundary_face_matrix_operations.empty() ||
+               !this->interface_face_matrix_operations.empty(),
+             ExcMessage("There are no bilinear forms to assemble."));
+      Assert(dof_handler.has_level_dofs(),
+             ExcMessage("The multigrid DoFs have not been distributed."));
+      Assert(interface_matrices == nullptr ||
+               (interface_matrices->min_level() ==
+                  level_matrices.min_level() &&
+                interface_matrices->max_level() == level_matrices.max_level()),
+             ExcMessage("The level and interface matrices must be defined "
+                        "on the same levels."));
+
+      for (unsigned int level = level_matrices.min_level();
+           level <= level_matrices.max_level();
+           ++level)
+        {
+          // The DoFs on the refinement edge and on the boundary are
+          // eliminated from the level matrix.
+          IndexSet locally_relevant_level_dofs;
+          DoFTools::extract_locally_relevant_level_dofs(
+            dof_handler, level, locally_relevant_level_dofs);
+
+          AffineConstraints<ScalarType> level_constraints;
+          level_constraints.reinit(locally_relevant_level_dofs);
+          level_constraints.add_lines(
+            mg_constrained_dofs.get_refinement_edge_indices(level));
+          level_constraints.add_lines(
+            mg_constrained_dofs.get_boundary_indices(level));
+          level_constraints.close();
+
+          internal::MGLevelMatrix<MatrixType> system_matrix(
+            level_matrices[level],
+            interface_matrices ? &(*interface_matrices)[level] : nullptr,
+            mg_constrained_dofs,
+            level);
+          do_assemble_system<internal::MGLevelMatrix<MatrixType>,
+                             std::nullptr_t,
+                             FaceQuadratureType>(&system_matrix,
+                                                 nullptr /*system_vector*/,
+                                                 level_constraints,
+                                                 dof_handler,
+                                                 nullptr /*solution_vector*/,
+                                                 cell_quadrature,
+                                                 face_quadrature);
+        }
+    }
+
+    /**
+     * Recompute the local matrices of the selected @p cells, and add the
+     * difference between them and the recorded local matrices to the
+     * @p system_matrix.
+     */
+    template <typename FaceQuadratureType,
+              typename MatrixType,
               typename VectorType,
+              typename SSDType,
               typename DoFHandlerType,
-              typename CellQuadratureType,
-              typename FaceQuadratureType,
-              typename SSDType>
+              typename CellQuadratureType>
     void
-    assemble_system(MatrixType &                         system_matrix,
-                    VectorType &                         system_vector,
-                    const SolutionStorage<typename identity<VectorType>::type,
-                                          SSDType> &     solution_storage,
-                    const AffineConstraints<ScalarType> &constraints,
-                    const DoFHandlerType &               dof_handler,
-                    const CellQuadratureType &           cell_quadrature,
-                    const FaceQuadratureType &           face_quadrature) const
+    do_reassemble_matrix(
+      MatrixType &                                system_matrix,
+      const SolutionStorage<VectorType, SSDType> &solution_storage,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const CellSelection<dim, spacedim> &        cells,
+      const CellQuadratureType &                  cell_quadrature,
+      const FaceQuadratureType *const             face_quadrature) const
     {
-      do_assemble_system<MatrixType, VectorType, FaceQuadratureType>(
-        &system_matrix,
-        &system_vector,
+      static_assert(!internal::IsMatrixStandIn<MatrixType>::value,
+                    "Only a system matrix can be reassembled.");
+      Assert(local_matrix_history_flag,
+             ExcMessage("The local matrices must be recorded during assembly "
+                        "in order to reassemble the system matrix. Call "
+                        "set_local_matrix_history_flag() beforehand."));
+      Assert(this->interface_face_matrix_operations.empty(),
+             ExcMessage("Reassembly of internal face contributions is not "
+                        "supported."));
+
+      do_assemble_systems<MatrixType, VectorType, FaceQuadratureType>(
+        std::array<MatrixType *, 1>{{&system_matrix}},
+        std::array<VectorType *, 1>{{nullptr}},
         constraints,
         dof_handler,
         solution_storage,
         cell_quadrature,
-        &face_quadrature);
+        face_quadrature,
+        &cells);
     }
 
-
-  private:
     // TODO: ScratchData supports face quadrature without cell quadrature.
     //       But does mesh loop? Check this out...
     template <typename MatrixType,
@@ -840,16 +3784,130 @@ namespace WeakForms
         &                             solution_storage,
       const CellQuadratureType &      cell_quadrature,
       const FaceQuadratureType *const face_quadrature) const
+    {
+      do_assemble_systems<MatrixType, VectorType, FaceQuadratureType>(
+        std::array<MatrixType *, 1>{{system_matrix}},
+        std::array<VectorType *, 1>{{system_vector}},
+        constraints,
+        dof_handler,
+        solution_storage,
+        cell_quadrature,
+        face_quadrature);
+    }
+
+
+    /**
+     * Assemble the contributions of the forms associated with each slot into
+     * the system matrix and vector with the same index, within a single loop
+     * over all cells. Any of the @p system_matrices and @p system_vectors may
+     * be a null pointer, in which case the contributions to it are not
+     * computed.
+     *
+     * If a @p cell_selection is given, then only these cells are assembled,
+     * and their local matrices replace those that were recorded when the
+     * system matrix was last assembled.
+     */
+    template <typename MatrixType,
+              typename VectorType,
+              typename FaceQuadratureType,
+              std::size_t n_matrices,
+              std::size_t n_vectors,
+              typename DoFHandlerType,
+              typename CellQuadratureType,
+              typename SSDType>
+    void
+    do_assemble_systems(
+      const std::array<MatrixType *, n_matrices> &system_matrices,
+      const std::array<VectorType *, n_vectors> & system_vectors,
+      const AffineConstraints<ScalarType> &       constraints,
+      const DoFHandlerType &                      dof_handler,
+      const SolutionStorage<typename identity<VectorType>::type, SSDType>
+        &                                       solution_storage,
+      const CellQuadratureType &                cell_quadrature,
+      const FaceQuadratureType *const           face_quadrature,
+      const CellSelection<dim, spacedim> *const cell_selection = nullptr) const
     {
       static_assert(DoFHandlerType::dimension == dim,
                     "Dimension is incompatible");
       static_assert(DoFHandlerType::space_dimension == spacedim,
                     "Space dimension is incompatible");
+      static_assert(n_matrices > 0 && n_vectors > 0,
+                    "At least one system matrix and vector slot is required.");
+
+#ifdef DEBUG
+      const internal::AssemblyInProgressGuard assembly_in_progress_guard(
+        this->assembly_in_progress);
+#endif
 
-      Assert(system_matrix || system_vector,
+      const bool assemble_matrix =
+        std::any_of(system_matrices.begin(),
+                    system_matrices.end(),
+                    [](const MatrixType *const system_matrix)
+                    { return system_matrix != nullptr; });
+      const bool assemble_vector =
+        std::any_of(system_vectors.begin(),
+                    system_vectors.end(),
+                    [](const VectorType *const system_vector)
+                    { return system_vector != nullptr; });
+
+      Assert(assemble_matrix || assemble_vector,
              ExcMessage("Either the system matrix or system RHS vector have "
                         "to be supplied in order for assembly to occur."));
 
+      // The index of the local matrix or vector that each operation
+      // contributes to, or an invalid index if its contribution is not
+      // required because the global matrix or vector for its slot is not
+      // supplied. Every slot must have a global matrix and vector, so that
+      // no form is silently dropped. This also means that the functions
+      // that assemble a single system only accept forms of the first slot.
+      const auto get_operation_targets =
+        [this](const internal::AssemblyOperationType type,
+               const auto &                          system_outputs)
+      {
+        const std::vector<unsigned int> &slots =
+          this->get_operation_slots(type);
+        std::vector<unsigned int> targets(slots.size(),
+                                          numbers::invalid_unsigned_int);
+        for (unsigned int k = 0; k < slots.size(); ++k)
+          {
+            Assert(slots[k] < system_outputs.size(),
+                   ExcMessage(
+                     "A form was added to slot " +
+                     Utilities::to_string(slots[k]) + ", but only " +
+                     Utilities::to_string(system_outputs.size()) +
+                     " system matrices or vectors of the kind that it "
+                     "contributes to are assembled. Forms that are "
+                     "associated with any slot other than the first one can "
+                     "only be assembled with assemble_systems()."));
+            if (slots[k] < system_outputs.size() &&
+                system_outputs[slots[k]] != nullptr)
+              targets[k] = slots[k];
+          }
+        return targets;
+      };
+      const std::vector<unsigned int> cell_matrix_targets =
+        get_operation_targets(internal::AssemblyOperationType::cell_matrix,
+                              system_matrices);
+      const std::vector<unsigned int> cell_vector_targets =
+        get_operation_targets(internal::AssemblyOperationType::cell_vector,
+                              system_vectors);
+      const std::vector<unsigned int> boundary_face_matrix_targets =
+        get_operation_targets(
+          internal::AssemblyOperationType::boundary_face_matrix,
+          system_matrices);
+      const std::vector<unsigned int> boundary_face_vector_targets =
+        get_operation_targets(
+          internal::AssemblyOperationType::boundary_face_vector,
+          system_vectors);
+      const std::vector<unsigned int> interface_face_matrix_targets =
+        get_operation_targets(
+          internal::AssemblyOperationType::interface_face_matrix,
+          system_matrices);
+      const std::vector<unsigned int> interface_face_vector_targets =
+        get_operation_targets(
+          internal::AssemblyOperationType::interface_face_vector,
+          system_vectors);
+
       // if (!cell_quadrature)
       //   Assert(this->cell_vector_operations.empty(),
       //         ExcMessage("Assembly with no cell quadrature has been selected,
@@ -862,7 +3920,7 @@ namespace WeakForms
 
       if (!face_quadrature)
         {
-          if (system_matrix)
+          if (assemble_matrix)
             {
               Assert(
                 this->boundary_face_matrix_operations.empty(),
@@ -882,7 +3940,7 @@ namespace WeakForms
                   "function that takes in face quadrature as an argument so "
                   "that all contributions are considered."));
             }
-          if (system_vector)
+          if (assemble_vector)
             {
               Assert(
                 this->boundary_face_vector_operations.empty(),
@@ -903,59 +3961,157 @@ namespace WeakForms
             }
         }
 
-      using CellIteratorType = typename DoFHandlerType::active_cell_iterator;
+      // The cells that are assembled are either the active cells, or the
+      // cells on the multigrid level that the system matrix belongs to.
+      constexpr bool assemble_level_cells =
+        internal::IsMGLevelMatrix<MatrixType>::value;
+      using AssemblyCells =
+        internal::AssemblyCells<DoFHandlerType, assemble_level_cells>;
+      const unsigned int level = internal::get_mg_level(system_matrices[0]);
+
+      using CellIteratorType = typename AssemblyCells::CellIteratorType;
       using ScratchData      = MeshWorker::ScratchData<dim, spacedim>;
+      using ScratchDataHandle = internal::AssemblyScratchData<
+        typename internal::ScratchDataPool<ScratchData>::Handle,
+        dim,
+        spacedim>;
       using CopyData =
-        internal::CopyDataWithInterfaceSupport<ScalarType, 1, 1, 1>;
+        internal::CopyDataWithInterfaceSupport<ScalarType,
+                                               static_cast<int>(n_matrices),
+                                               static_cast<int>(n_vectors),
+                                               1>;
+
+      // The entries of the local matrices that the system matrix requires.
+      // Even if these are fewer than all of them, the kernels still have to
+      // compute the full local matrix for cells with constrained DoFs, so
+      // that it can be condensed. If the global system is symmetric, then
+      // the blocks below the diagonal are only recovered from the full local
+      // matrix, so its row sums cannot be computed directly.
+      const internal::LocalMatrixContribution system_matrix_contribution =
+        internal::get_local_matrix_contribution(system_matrices[0]);
+      const internal::LocalMatrixContribution reduced_contribution =
+        (this->global_system_symmetry_flag &&
+             system_matrix_contribution ==
+               internal::LocalMatrixContribution::row_sum ?
+           internal::LocalMatrixContribution::full :
+           system_matrix_contribution);
+      const auto get_local_matrix_contribution =
+        [&constraints, reduced_contribution](
+          const std::vector<dealii::types::global_dof_index> &local_dof_indices)
+      {
+        if (reduced_contribution == internal::LocalMatrixContribution::full ||
+            std::any_of(local_dof_indices.begin(),
+                        local_dof_indices.end(),
+                        [&constraints](
+                          const dealii::types::global_dof_index dof_index)
+                        { return constraints.is_constrained(dof_index); }))
+          return internal::LocalMatrixContribution::full;
+
+        return reduced_contribution;
+      };
+
+      // Define the preparation that is required on each cell before any
+      // cell operations can be performed.
+      const auto initialize_cell =
+        [&dof_handler, &solution_storage](
+          const CellIteratorType &cell,
+          ScratchDataHandle &     scratch_data_handle,
+          CopyData &              copy_data)
+        -> const std::vector<SolutionExtractionData<dim, spacedim>> &
+      {
+        ScratchData &scratch_data = scratch_data_handle.get();
+        const auto & fe_values    = scratch_data_handle.reinit(cell);
+        copy_data.reset(fe_values.dofs_per_cell);
+        copy_data.active_cell_index = (cell->is_active() ?
+                                         cell->active_cell_index() :
+                                         numbers::invalid_unsigned_int);
+
+        // The shape function data that was cached for the previous cell
+        // is no longer valid.
+        internal::ShapeFunctionCache::invalidate(scratch_data);
+        copy_data.local_dof_indices[0] = scratch_data.get_local_dof_indices();
+
+        // Extract the local solution vector, if it has been provided by the
+        // user.
+        if (solution_storage.n_solution_vectors() > 0)
+          {
+            internal::initialize(scratch_data,
+                                 fe_values,
+                                 dof_handler,
+                                 solution_storage);
+            internal::extract_solution_local_dof_values(scratch_data,
+                                                        dof_handler,
+                                                        solution_storage);
+          }
+
+        // Retrieve the association between the various solution vectors and
+        // an appropriate ScratchData object that can be used to extract
+        // data from them. This covers the case that the solution field is
+        // associated with a DoFHandler that is not the one used during
+        // assembly.
+        return scratch_data_handle.get_solution_extraction_data(
+          solution_storage, dof_handler);
+      };
 
       // Define a cell worker
       const auto &cell_matrix_operations = this->cell_matrix_operations;
+      const auto &cell_batch_matrix_operations =
+        this->cell_batch_matrix_operations;
       const auto &cell_vector_operations = this->cell_vector_operations;
       const auto &cell_ad_sd_operations  = this->cell_ad_sd_operations;
 
+      // Decide whether or not the solution-independent contributions to the
+      // local cell matrices are to be retrieved from the cache. The cache
+      // can only be filled by kernels that compute the entire local matrix.
+      const std::vector<bool> &cell_matrix_solution_dependence =
+        this->cell_matrix_solution_dependence;
+      Assert(cell_matrix_solution_dependence.size() ==
+               cell_matrix_operations.size(),
+             ExcDimensionMismatch(cell_matrix_solution_dependence.size(),
+                                  cell_matrix_operations.size()));
+      const unsigned int n_cached_cell_matrix_operations =
+        std::count(cell_matrix_solution_dependence.begin(),
+                   cell_matrix_solution_dependence.end(),
+                   false);
+      // The cache is only kept for the active cells.
+      const bool use_cell_matrix_cache =
+        cell_matrix_cache_flag && assemble_matrix &&
+        reduced_contribution == internal::LocalMatrixContribution::full &&
+        !this->has_multiple_slots() && n_cached_cell_matrix_operations > 0 &&
+        !assemble_level_cells;
+      internal::CellMatrixCache<ScalarType> &cell_matrix_cache =
+        this->cell_matrix_cache;
+
       auto cell_worker =
-        CellWorkerType<CellIteratorType, ScratchData, CopyData>();
+        CellWorkerType<CellIteratorType, ScratchDataHandle, CopyData>();
       if (!cell_matrix_operations.empty() || !cell_vector_operations.empty())
         {
           cell_worker = [&cell_matrix_operations,
                          &cell_vector_operations,
                          &cell_ad_sd_operations,
-                         &dof_handler,
-                         system_matrix,
-                         system_vector,
-                         solution_storage](const CellIteratorType &cell,
-                                           ScratchData &           scratch_data,
-                                           CopyData &              copy_data)
+                         &cell_matrix_solution_dependence,
+                         use_cell_matrix_cache,
+                         &cell_matrix_cache,
+                         &initialize_cell,
+                         &get_local_matrix_contribution,
+                         &cell_matrix_targets,
+                         &cell_vector_targets,
+                         assemble_matrix,
+                         assemble_vector,
+                         solution_storage](
+                          const CellIteratorType &cell,
+                          ScratchDataHandle &     scratch_data_handle,
+                          CopyData &              copy_data)
           {
+            ScratchData &scratch_data = scratch_data_handle.get();
             internal::bind_user_cache_to_thread(scratch_data);
 
-            const auto &fe_values = scratch_data.reinit(cell);
-            copy_data             = CopyData(fe_values.dofs_per_cell);
-            copy_data.local_dof_indices[0] =
-              scratch_data.get_local_dof_indices();
-
-            // Extract the local solution vector, if it has been provided by the
-            // user.
-            if (solution_storage.n_solution_vectors() > 0)
-              {
-                internal::initialize(scratch_data,
-                                     fe_values,
-                                     dof_handler,
-                                     solution_storage);
-                internal::extract_solution_local_dof_values(scratch_data,
-                                                            dof_handler,
-                                                            solution_storage);
-              }
-
-            // Retrieve the association between the various solution vectors and
-            // an appropriate ScratchData object that can be used to extract
-            // data from them. This covers the case that the solution field is
-            // associated with a DoFHandler that is not the one used during
-            // assembly.
             const std::vector<SolutionExtractionData<dim, spacedim>>
-              solution_extraction_data =
-                solution_storage.get_solution_extraction_data(scratch_data,
-                                                              dof_handler);
+              &solution_extraction_data =
+                initialize_cell(cell, scratch_data_handle, copy_data);
+            const auto &fe_values = scratch_data.get_current_fe_values();
+            const internal::LocalMatrixContribution contribution =
+              get_local_matrix_contribution(copy_data.local_dof_indices[0]);
 
             // Next we perform all operations that use AD or SD functors.
             // Although the forms are self-linearizing, they reference the
@@ -977,31 +4133,74 @@ namespace WeakForms
               }
 
             // Perform all operations that contribute to the local cell matrix
-            if (system_matrix)
+            if (assemble_matrix && use_cell_matrix_cache)
               {
+                // Only the solution-dependent contributions are recomputed.
+                // The others are computed once, and then retrieved from the
+                // cache.
                 FullMatrix<ScalarType> &cell_matrix = copy_data.matrices[0];
-                for (const auto &cell_matrix_op : cell_matrix_operations)
+                cell_matrix.add(
+                  1.0,
+                  cell_matrix_cache.get(
+                    cell,
+                    cell_matrix.m(),
+                    [&](FullMatrix<ScalarType> &cached_cell_matrix)
+                    {
+                      for (unsigned int k = 0;
+                           k < cell_matrix_operations.size();
+                           ++k)
+                        if (!cell_matrix_solution_dependence[k])
+                          cell_matrix_operations[k](
+                            cached_cell_matrix,
+                            scratch_data,
+                            solution_extraction_data,
+                            fe_values,
+                            internal::LocalMatrixContribution::full);
+                    }));
+
+                for (unsigned int k = 0; k < cell_matrix_operations.size();
+                     ++k)
+                  if (cell_matrix_solution_dependence[k])
+                    cell_matrix_operations[k](cell_matrix,
+                                              scratch_data,
+                                              solution_extraction_data,
+                                              fe_values,
+                                              contribution);
+              }
+            else if (assemble_matrix)
+              {
+                for (unsigned int k = 0; k < cell_matrix_operations.size();
+                     ++k)
                   {
+                    if (cell_matrix_targets[k] == numbers::invalid_unsigned_int)
+                      continue;
+
                     // We pass in solution extraction data here
                     // to decouple the VectorType that underlies SolutionStorage
                     // from the operation.
-                    cell_matrix_op(cell_matrix,
-                                   scratch_data,
-                                   solution_extraction_data,
-                                   fe_values);
+                    cell_matrix_operations[k](
+                      copy_data.matrices[cell_matrix_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_values,
+                      contribution);
                   }
               }
 
             // Perform all operations that contribute to the local cell vector
-            if (system_vector)
+            if (assemble_vector)
               {
-                Vector<ScalarType> &cell_vector = copy_data.vectors[0];
-                for (const auto &cell_vector_op : cell_vector_operations)
+                for (unsigned int k = 0; k < cell_vector_operations.size();
+                     ++k)
                   {
-                    cell_vector_op(cell_vector,
-                                   scratch_data,
-                                   solution_extraction_data,
-                                   fe_values);
+                    if (cell_vector_targets[k] == numbers::invalid_unsigned_int)
+                      continue;
+
+                    cell_vector_operations[k](
+                      copy_data.vectors[cell_vector_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_values);
                   }
               }
 
@@ -1018,32 +4217,43 @@ namespace WeakForms
         this->boundary_face_ad_sd_operations;
 
       auto boundary_worker =
-        BoundaryWorkerType<CellIteratorType, ScratchData, CopyData>();
+        BoundaryWorkerType<CellIteratorType, ScratchDataHandle, CopyData>();
       if (!boundary_face_matrix_operations.empty() ||
           !boundary_face_vector_operations.empty())
         {
           boundary_worker = [&boundary_face_matrix_operations,
                              &boundary_face_vector_operations,
                              &boundary_face_ad_sd_operations,
+                             &boundary_face_matrix_targets,
+                             &boundary_face_vector_targets,
                              &dof_handler,
-                             system_matrix,
-                             system_vector,
-                             solution_storage](const CellIteratorType &cell,
-                                               const unsigned int      face,
-                                               ScratchData &scratch_data,
-                                               CopyData &   copy_data)
+                             &get_local_matrix_contribution,
+                             assemble_matrix,
+                             assemble_vector,
+                             solution_storage](
+                              const CellIteratorType &cell,
+                              const unsigned int      face,
+                              ScratchDataHandle &     scratch_data_handle,
+                              CopyData &              copy_data)
           {
             Assert((cell->face(face)->at_boundary()),
                    ExcMessage("Cell face is not at the boundary."));
 
+            ScratchData &scratch_data = scratch_data_handle.get();
             internal::bind_user_cache_to_thread(scratch_data);
 
-            const auto &fe_values      = scratch_data.reinit(cell);
+            // The cell FEValues have typically already been initialized for
+            // this cell by the cell worker, or for a previous face of this
+            // cell.
+            const auto &fe_values      = scratch_data_handle.get_fe_values(cell);
             const auto &fe_face_values = scratch_data.reinit(cell, face);
+            internal::ShapeFunctionCache::invalidate(scratch_data);
             // Not permitted inside a boundary or face worker!
             // copy_data             = CopyData(fe_values.dofs_per_cell);
             copy_data.local_dof_indices[0] =
               scratch_data.get_local_dof_indices();
+            const internal::LocalMatrixContribution contribution =
+              get_local_matrix_contribution(copy_data.local_dof_indices[0]);
 
             // Extract the local solution vector, if it's provided.
             if (solution_storage.n_solution_vectors() > 0)
@@ -1064,9 +4274,9 @@ namespace WeakForms
             // associated with a DoFHandler that is not the one used during
             // assembly.
             const std::vector<SolutionExtractionData<dim, spacedim>>
-              solution_extraction_data =
-                solution_storage.get_solution_extraction_data(scratch_data,
-                                                              dof_handler);
+              &solution_extraction_data =
+                scratch_data_handle.get_solution_extraction_data(
+                  solution_storage, dof_handler);
 
             // Next we perform all operations that use AD or SD functors.
             // Although the forms are self-linearizing, they reference the
@@ -1081,34 +4291,45 @@ namespace WeakForms
               }
 
             // Perform all operations that contribute to the local cell matrix
-            if (system_matrix)
+            if (assemble_matrix)
               {
-                FullMatrix<ScalarType> &cell_matrix = copy_data.matrices[0];
-                for (const auto &boundary_face_matrix_op :
-                     boundary_face_matrix_operations)
+                for (unsigned int k = 0;
+                     k < boundary_face_matrix_operations.size();
+                     ++k)
                   {
-                    boundary_face_matrix_op(cell_matrix,
-                                            scratch_data,
-                                            solution_extraction_data,
-                                            fe_values,
-                                            fe_face_values,
-                                            face);
+                    if (boundary_face_matrix_targets[k] ==
+                        numbers::invalid_unsigned_int)
+                      continue;
+
+                    boundary_face_matrix_operations[k](
+                      copy_data.matrices[boundary_face_matrix_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_values,
+                      fe_face_values,
+                      face,
+                      contribution);
                   }
               }
 
             // Perform all operations that contribute to the local cell vector
-            if (system_vector)
+            if (assemble_vector)
               {
-                Vector<ScalarType> &cell_vector = copy_data.vectors[0];
-                for (const auto &boundary_face_vector_op :
-                     boundary_face_vector_operations)
+                for (unsigned int k = 0;
+                     k < boundary_face_vector_operations.size();
+                     ++k)
                   {
-                    boundary_face_vector_op(cell_vector,
-                                            scratch_data,
-                                            solution_extraction_data,
-                                            fe_values,
-                                            fe_face_values,
-                                            face);
+                    if (boundary_face_vector_targets[k] ==
+                        numbers::invalid_unsigned_int)
+                      continue;
+
+                    boundary_face_vector_operations[k](
+                      copy_data.vectors[boundary_face_vector_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_values,
+                      fe_face_values,
+                      face);
                   }
               }
 
@@ -1124,7 +4345,7 @@ namespace WeakForms
       const auto &interface_face_ad_sd_operations =
         this->interface_face_ad_sd_operations;
       auto face_worker =
-        FaceWorkerType<CellIteratorType, ScratchData, CopyData>();
+        FaceWorkerType<CellIteratorType, ScratchDataHandle, CopyData>();
       if (!interface_face_matrix_operations.empty() ||
           !interface_face_vector_operations.empty())
         {
@@ -1132,21 +4353,24 @@ namespace WeakForms
             [&interface_face_matrix_operations,
              &interface_face_vector_operations,
              &interface_face_ad_sd_operations,
+             &interface_face_matrix_targets,
+             &interface_face_vector_targets,
              &dof_handler,
-             system_matrix,
-             system_vector,
+             assemble_matrix,
+             assemble_vector,
              solution_storage](const CellIteratorType &cell,
                                const unsigned int      face,
                                const unsigned int      subface,
                                const CellIteratorType &neighbour_cell,
                                const unsigned int      neighbour_face,
                                const unsigned int      neighbour_subface,
-                               ScratchData &           scratch_data,
+                               ScratchDataHandle &     scratch_data_handle,
                                CopyData &              copy_data)
           {
             Assert((!cell->face(face)->at_boundary()),
                    ExcMessage("Cell face is at the boundary."));
 
+            ScratchData &scratch_data = scratch_data_handle.get();
             internal::bind_user_cache_to_thread(scratch_data);
 
             const FEInterfaceValues<dim> &fe_interface_values =
@@ -1156,14 +4380,14 @@ namespace WeakForms
                                   neighbour_cell,
                                   neighbour_face,
                                   neighbour_subface);
+            internal::ShapeFunctionCache::invalidate(scratch_data);
 
             const unsigned int n_interface_dofs =
               fe_interface_values.n_current_interface_dofs();
 
             // Follow the method used by step-74
-            copy_data.interface_data.emplace_back();
             typename CopyData::InterfaceData &copy_data_interface =
-              copy_data.interface_data.back();
+              copy_data.add_interface_data(n_interface_dofs);
 
             copy_data_interface.local_dof_indices[0] =
               fe_interface_values.get_interface_dof_indices();
@@ -1186,9 +4410,9 @@ namespace WeakForms
             // associated with a DoFHandler that is not the one used during
             // assembly.
             const std::vector<SolutionExtractionData<dim, spacedim>>
-              solution_extraction_data =
-                solution_storage.get_solution_extraction_data(scratch_data,
-                                                              dof_handler);
+              &solution_extraction_data =
+                scratch_data_handle.get_solution_extraction_data(
+                  solution_storage, dof_handler);
 
             // Next we perform all operations that use AD or SD functors.
             // Although the forms are self-linearizing, they reference the
@@ -1203,40 +4427,46 @@ namespace WeakForms
               }
 
             // Perform all operations that contribute to the local cell matrix
-            if (system_matrix)
+            if (assemble_matrix)
               {
-                FullMatrix<ScalarType> &cell_matrix =
-                  copy_data_interface.matrices[0];
-                cell_matrix.reinit(n_interface_dofs, n_interface_dofs);
-
-                for (const auto &interface_face_matrix_op :
-                     interface_face_matrix_operations)
+                for (unsigned int k = 0;
+                     k < interface_face_matrix_operations.size();
+                     ++k)
                   {
-                    interface_face_matrix_op(cell_matrix,
-                                             scratch_data,
-                                             solution_extraction_data,
-                                             fe_interface_values,
-                                             face,
-                                             neighbour_face);
+                    if (interface_face_matrix_targets[k] ==
+                        numbers::invalid_unsigned_int)
+                      continue;
+
+                    interface_face_matrix_operations[k](
+                      copy_data_interface
+                        .matrices[interface_face_matrix_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_interface_values,
+                      face,
+                      neighbour_face);
                   }
               }
 
             // Perform all operations that contribute to the local cell vector
-            if (system_vector)
+            if (assemble_vector)
               {
-                Vector<ScalarType> &cell_vector =
-                  copy_data_interface.vectors[0];
-                cell_vector.reinit(n_interface_dofs);
-
-                for (const auto &interface_face_vector_op :
-                     interface_face_vector_operations)
+                for (unsigned int k = 0;
+                     k < interface_face_vector_operations.size();
+                     ++k)
                   {
-                    interface_face_vector_op(cell_vector,
-                                             scratch_data,
-                                             solution_extraction_data,
-                                             fe_interface_values,
-                                             face,
-                                             neighbour_face);
+                    if (interface_face_vector_targets[k] ==
+                        numbers::invalid_unsigned_int)
+                      continue;
+
+                    interface_face_vector_operations[k](
+                      copy_data_interface
+                        .vectors[interface_face_vector_targets[k]],
+                      scratch_data,
+                      solution_extraction_data,
+                      fe_interface_values,
+                      face,
+                      neighbour_face);
                   }
               }
 
@@ -1248,24 +4478,138 @@ namespace WeakForms
       const bool &global_system_symmetry_flag =
         this->global_system_symmetry_flag;
 
-      auto copier = [&constraints,
-                     system_matrix,
-                     system_vector,
-                     &global_system_symmetry_flag](const CopyData &copy_data)
+      // Only the upper triangle of a symmetric system matrix may be
+      // assembled. The stand-ins for the system matrix always require the
+      // full local matrix.
+      Assert(!upper_triangle_scatter_flag || global_system_symmetry_flag,
+             ExcMessage("Only the upper triangle of a symmetric system "
+                        "matrix can be assembled. Call symmetrize() first."));
+      const bool scatter_upper_triangle =
+        upper_triangle_scatter_flag && global_system_symmetry_flag &&
+        !internal::IsMatrixStandIn<MatrixType>::value;
+
+      // Record the local matrix of each cell, so that its contribution may
+      // later be replaced. When reassembling, only the difference between
+      // the new and the recorded local matrix is distributed.
+      internal::LocalMatrixHistory<ScalarType> *const local_matrix_history =
+        (local_matrix_history_flag && system_matrices[0] != nullptr &&
+         n_matrices == 1 && !this->has_multiple_slots() &&
+         !internal::IsMatrixStandIn<MatrixType>::value) ?
+          &this->local_matrix_history :
+          nullptr;
+      if (local_matrix_history)
+        local_matrix_history->initialize(dof_handler.get_triangulation());
+      const bool incremental_reassembly = (cell_selection != nullptr);
+      Assert(!incremental_reassembly || local_matrix_history,
+             ExcInternalError());
+
+      // Decide whether or not the communication of off-process
+      // contributions is to be overlapped with the assembly. This is only
+      // worthwhile if some rows are owned by other processes. Interface
+      // contributions are also distributed into the rows of the DoFs of
+      // the neighboring cell, which is not accounted for when the cells are
+      // split up. The cells are only split up for assembly on the active
+      // cells.
+      const bool use_communication_overlap =
+        communication_overlap_flag && !assemble_level_cells &&
+        dof_handler.locally_owned_dofs().n_elements() < dof_handler.n_dofs() &&
+        interface_face_matrix_operations.empty() &&
+        interface_face_vector_operations.empty();
+
+      // When overlapping communication with assembly, the cells that write
+      // into rows owned by other processes are assembled in a first pass
+      // over the mesh, and all other cells in a second pass. A DoF that is
+      // constrained writes into the rows of the DoFs that it is constrained
+      // to.
+      std::vector<bool> writes_off_process;
+      bool              off_process_pass = false;
+      if (use_communication_overlap)
+        {
+          const IndexSet &locally_owned_dofs = dof_handler.locally_owned_dofs();
+          writes_off_process.resize(
+            dof_handler.get_triangulation().n_active_cells(), false);
+
+          std::vector<dealii::types::global_dof_index> local_dof_indices;
+          for (const auto &cell : dof_handler.active_cell_iterators())
+            {
+              if (!cell->is_locally_owned())
+                continue;
+
+              local_dof_indices.resize(cell->get_fe().dofs_per_cell);
+              cell->get_dof_indices(local_dof_indices);
+
+              const auto is_off_process =
+                [&locally_owned_dofs,
+                 &constraints](const dealii::types::global_dof_index dof_index)
+              {
+                if (!locally_owned_dofs.is_element(dof_index))
+                  return true;
+                if (const auto *const entries =
+                      constraints.get_constraint_entries(dof_index))
+                  {
+                    for (const auto &entry : *entries)
+                      if (!locally_owned_dofs.is_element(entry.first))
+                        return true;
+                  }
+                return false;
+              };
+
+              writes_off_process[cell->active_cell_index()] =
+                std::any_of(local_dof_indices.begin(),
+                            local_dof_indices.end(),
+                            is_off_process);
+            }
+        }
+
+      // Restrict the assembly to the selected cells, if there are any, and
+      // to those of the current pass over the mesh.
+      const auto cells = filter_iterators(
+        AssemblyCells::get(dof_handler, level),
+        [cell_selection, &writes_off_process, &off_process_pass](
+          const CellIteratorType &cell)
+        {
+          return AssemblyCells::is_locally_owned(cell) &&
+                 AssemblyCells::is_selected(cell_selection, cell) &&
+                 (writes_off_process.empty() ||
+                  writes_off_process[cell->active_cell_index()] ==
+                    off_process_pass);
+        });
+
+      // The interface data capacity is only recorded by the sequential
+      // copier, as the cells are not colored when there are any interface
+      // contributions.
+      std::pair<unsigned int, unsigned int> &interface_data_capacity =
+        this->interface_data_capacity;
+
+      // Distribute the local contributions into the global system, using
+      // the given scatter (which cannot be shared between threads).
+      auto copy_to_global =
+        [&constraints,
+         &system_matrices,
+         &system_vectors,
+         &global_system_symmetry_flag,
+         scatter_upper_triangle,
+         &interface_data_capacity,
+         local_matrix_history,
+         incremental_reassembly](
+          const CopyData &                            copy_data,
+          internal::LocalToGlobalScatter<ScalarType> &scatter)
       {
         auto const copy_local_to_global =
           [&constraints,
-           system_matrix,
-           system_vector,
-           &global_system_symmetry_flag](
+           &global_system_symmetry_flag,
+           scatter_upper_triangle,
+           &scatter](
             const FullMatrix<ScalarType> &cell_matrix,
             const Vector<ScalarType> &    cell_vector,
             const std::vector<dealii::types::global_dof_index>
-              &local_dof_indices)
+              &                     local_dof_indices,
+            MatrixType *const system_matrix,
+            VectorType *const system_vector)
         {
           // Copy the upper half (i.e. contributions below the diagonal) into
           // the lower half if the global system is marked as symmetric.
-          if (global_system_symmetry_flag == true)
+          if (system_matrix != nullptr && global_system_symmetry_flag == true)
             {
               // Hmm... a bit nasty, but it makes sense to do the global
               // symmetrization only once if possible. To (unnecessarily)
@@ -1286,21 +4630,39 @@ namespace WeakForms
                 }
             }
 
-          if (system_matrix && system_vector)
+          // Only those contributions that end up in the upper triangle of
+          // the condensed system matrix are distributed, so that the lower
+          // triangle is never written to.
+          if (system_matrix && system_vector && scatter_upper_triangle)
             {
-              internal::distribute_local_to_global(constraints,
-                                                   cell_matrix,
-                                                   cell_vector,
-                                                   local_dof_indices,
-                                                   system_matrix,
-                                                   system_vector);
+              scatter.distribute_upper_triangle_local_to_global(
+                constraints,
+                cell_matrix,
+                cell_vector,
+                local_dof_indices,
+                system_matrix,
+                system_vector);
+            }
+          else if (system_matrix && scatter_upper_triangle)
+            {
+              scatter.distribute_upper_triangle_local_to_global(
+                constraints, cell_matrix, local_dof_indices, system_matrix);
+            }
+          else if (system_matrix && system_vector)
+            {
+              scatter.distribute_local_to_global(constraints,
+                                                 cell_matrix,
+                                                 cell_vector,
+                                                 local_dof_indices,
+                                                 system_matrix,
+                                                 system_vector);
             }
           else if (system_matrix)
             {
-              internal::distribute_local_to_global(constraints,
-                                                   cell_matrix,
-                                                   local_dof_indices,
-                                                   system_matrix);
+              scatter.distribute_local_to_global(constraints,
+                                                 cell_matrix,
+                                                 local_dof_indices,
+                                                 system_matrix);
             }
           else if (system_vector)
             {
@@ -1318,42 +4680,137 @@ namespace WeakForms
             }
         };
 
+        if (local_matrix_history &&
+            copy_data.active_cell_index != numbers::invalid_unsigned_int)
+          {
+            // The local matrix is recorded before it is symmetrized. As the
+            // symmetrization is linear, it may equally be applied to the
+            // difference between two local matrices.
+            FullMatrix<ScalarType> &cell_matrix =
+              const_cast<FullMatrix<ScalarType> &>(copy_data.matrices[0]);
+            FullMatrix<ScalarType> &recorded_cell_matrix =
+              local_matrix_history->get(copy_data.active_cell_index);
+            if (incremental_reassembly)
+              {
+                Assert(recorded_cell_matrix.m() == cell_matrix.m(),
+                       ExcMessage(
+                         "No local matrix has been recorded for this cell."));
+                recorded_cell_matrix.add(-1.0, cell_matrix);
+                recorded_cell_matrix.swap(cell_matrix);
+                cell_matrix *= -1.0;
+              }
+            else
+              recorded_cell_matrix = cell_matrix;
+          }
+
+        // Each local matrix is distributed together with the local vector
+        // of the same slot, so that the contributions that inhomogeneous
+        // constraints make to the system vector are accounted for.
+        // The local data of the last matrix (or vector) slot is passed in
+        // for the slots that have no matrix (or vector), but it is then not
+        // used.
+        const auto copy_slots_local_to_global =
+          [&copy_local_to_global, &system_matrices, &system_vectors](
+            const auto &local_data,
+            const std::vector<dealii::types::global_dof_index>
+              &local_dof_indices)
+        {
+          constexpr std::size_t n_slots = std::max(n_matrices, n_vectors);
+          for (std::size_t slot = 0; slot < n_slots; ++slot)
+            {
+              MatrixType *const system_matrix =
+                (slot < n_matrices ? system_matrices[slot] : nullptr);
+              VectorType *const system_vector =
+                (slot < n_vectors ? system_vectors[slot] : nullptr);
+              if (system_matrix == nullptr && system_vector == nullptr)
+                continue;
+
+              copy_local_to_global(
+                local_data.matrices[std::min(slot, n_matrices - 1)],
+                local_data.vectors[std::min(slot, n_vectors - 1)],
+                local_dof_indices,
+                system_matrix,
+                system_vector);
+            }
+        };
+
         // Cell and/or boundary contributions
-        copy_local_to_global(copy_data.matrices[0],
-                             copy_data.vectors[0],
-                             copy_data.local_dof_indices[0]);
+        copy_slots_local_to_global(copy_data, copy_data.local_dof_indices[0]);
 
         // Interface contributions
-        for (const typename CopyData::InterfaceData &copy_data_interface :
-             copy_data.interface_data)
+        for (unsigned int i = 0; i < copy_data.n_interface_data(); ++i)
           {
-            copy_local_to_global(copy_data_interface.matrices[0],
-                                 copy_data_interface.vectors[0],
-                                 copy_data_interface.local_dof_indices[0]);
+            const typename CopyData::InterfaceData &copy_data_interface =
+              copy_data.get_interface_data(i);
+            copy_slots_local_to_global(
+              copy_data_interface, copy_data_interface.local_dof_indices[0]);
+
+            interface_data_capacity.second =
+              std::max(interface_data_capacity.second,
+                       copy_data_interface.n_dofs());
           }
+
+        // Record how much interface data was needed, so that the copy data
+        // for the next assembly can be sized accordingly.
+        if (copy_data.n_interface_data() > 0)
+          interface_data_capacity.first =
+            std::max(interface_data_capacity.first,
+                     copy_data.n_interface_data());
       };
 
+      // Contributions to block matrices are distributed block-wise.
+      internal::LocalToGlobalScatter<ScalarType> scatter;
+
+      auto copier = [&copy_to_global, &scatter](const CopyData &copy_data)
+      { copy_to_global(copy_data, scatter); };
+
       // A helper to retrieve either normal or hp-compatible data structures
       using HP_Helper_t =
         internal::HP_Helper_t<CellQuadratureType, FaceQuadratureType>;
 
-      // Initialize the assistant objects used during assembly.
-      const ScratchData sample_scratch_data =
-        (face_quadrature ?
-           internal::construct_scratch_data<ScratchData, FaceQuadratureType>(
-             HP_Helper_t::get_fe(dof_handler),
-             cell_quadrature,
-             this->get_cell_update_flags(),
-             face_quadrature,
-             this->get_face_update_flags(),
-             this->ad_sd_functor_cache) :
-           internal::construct_scratch_data<ScratchData>(
-             HP_Helper_t::get_fe(dof_handler),
-             cell_quadrature,
-             this->get_cell_update_flags(),
-             this->ad_sd_functor_cache));
-      const CopyData sample_copy_data(
-        HP_Helper_t::get_dofs_per_cell(dof_handler));
+      // Initialize the assistant objects used during assembly. The scratch
+      // data is drawn from the pool, and is only rebuilt if anything that
+      // it depends on has changed since the last assembly.
+      internal::ScratchDataPoolKey scratch_data_key;
+      scratch_data_key.dof_handler = &dof_handler;
+      scratch_data_key.add(HP_Helper_t::get_fe(dof_handler));
+      scratch_data_key.add(cell_quadrature);
+      scratch_data_key.add(face_quadrature);
+      scratch_data_key.cell_update_flags = this->get_cell_update_flags();
+      scratch_data_key.face_update_flags = this->get_face_update_flags();
+
+      if (use_cell_matrix_cache)
+        cell_matrix_cache.initialize(scratch_data_key,
+                                     dof_handler.get_triangulation(),
+                                     n_cached_cell_matrix_operations);
+
+      const ScratchDataHandle sample_scratch_data =
+        scratch_data_pool.initialize(
+          scratch_data_key,
+          [this, &dof_handler, &cell_quadrature, face_quadrature]()
+          {
+            return (
+              face_quadrature ?
+                internal::construct_scratch_data<ScratchData,
+                                                 FaceQuadratureType>(
+                  HP_Helper_t::get_fe(dof_handler),
+                  cell_quadrature,
+                  this->get_cell_update_flags(),
+                  face_quadrature,
+                  this->get_face_update_flags(),
+                  this->ad_sd_functor_cache) :
+                internal::construct_scratch_data<ScratchData>(
+                  HP_Helper_t::get_fe(dof_handler),
+                  cell_quadrature,
+                  this->get_cell_update_flags(),
+                  this->ad_sd_functor_cache));
+          });
+      // Every copy of the sample copy data inherits its interface data, so
+      // by sizing it according to the previous assembly call we avoid
+      // reallocating the interface matrices on each thread.
+      CopyData sample_copy_data(HP_Helper_t::get_dofs_per_cell(dof_handler));
+      sample_copy_data.reserve_interface_data(interface_data_capacity.first,
+                                              interface_data_capacity.second);
 
       // Set the assembly flags, based off of the operations that we intend to
       // do.
@@ -1373,39 +4830,364 @@ namespace WeakForms
           assembly_flags |= MeshWorker::assemble_own_interior_faces_once;
         }
 
+      // Decide whether or not the cell contributions are to be assembled
+      // for batches of cells at a time. The shared AD/SD cache can only be
+      // bound to one cell at a time, so we cannot use this mode if it is
+      // required.
+      // The cell batch kernels always compute the entire local matrix, and
+      // don't make use of the cache for the local cell matrices. They also
+      // only assemble the first slot.
+      const bool use_cell_batches =
+        cell_batch_flag && assemble_matrix && !assemble_level_cells &&
+        !cell_matrix_operations.empty() && !this->has_multiple_slots() &&
+        reduced_contribution == internal::LocalMatrixContribution::full &&
+        !use_cell_matrix_cache && cell_ad_sd_operations.empty() &&
+        boundary_face_ad_sd_operations.empty() &&
+        interface_face_ad_sd_operations.empty() &&
+        this->ad_sd_functor_cache == nullptr;
+
+      // Decide whether or not the cells are to be colored. Interface
+      // contributions are also distributed into the rows of the DoFs of
+      // the neighboring cell, which the coloring does not account for.
+      // Only the active cells are colored, and only for those system matrix
+      // and vector types that may be written into concurrently.
+      constexpr bool supports_concurrent_writes =
+        internal::SupportsConcurrentWrites<MatrixType>::value &&
+        internal::SupportsConcurrentWrites<VectorType>::value;
+      const bool use_graph_coloring =
+        graph_coloring_flag && supports_concurrent_writes &&
+        !use_cell_batches && !assemble_level_cells &&
+        interface_face_matrix_operations.empty() &&
+        interface_face_vector_operations.empty() && cell_selection == nullptr &&
+        !use_communication_overlap;
+
+      // Choose the parameters for the assembly loop. While these are being
+      // tuned, each assembly call tries out a different set of them. Only
+      // the assembly calls over all active cells are timed, so that the
+      // timings of the calls of one kind can be compared with one another.
+      internal::WorkStreamParameters work_stream_parameters(queue_length,
+                                                            chunk_size);
+      internal::WorkStreamTuner *const work_stream_tuner =
+        (work_stream_auto_tuning_flag && !assemble_level_cells &&
+         cell_selection == nullptr) ?
+          &work_stream_tuners[internal::AssemblyKind(
+            std::type_index(typeid(MatrixType)),
+            std::type_index(typeid(VectorType)),
+            assemble_matrix,
+            assemble_vector,
+            reduced_contribution !=
+              internal::LocalMatrixContribution::full)] :
+          nullptr;
+      if (work_stream_tuner)
+        {
+          work_stream_tuner->initialize(
+            scratch_data_key,
+            cell_matrix_operations.size() + cell_vector_operations.size() +
+              boundary_face_matrix_operations.size() +
+              boundary_face_vector_operations.size() +
+              interface_face_matrix_operations.size() +
+              interface_face_vector_operations.size(),
+            dof_handler.get_triangulation().n_active_cells(),
+            work_stream_parameters);
+          work_stream_parameters = work_stream_tuner->get_parameters();
+        }
+
+      // Every item in flight may bind to an entry of the shared AD/SD cache,
+      // so there must be enough of them for no thread to have to wait.
+      if (this->ad_sd_functor_cache != nullptr &&
+          this->ad_sd_functor_cache->queue_length() <
+            work_stream_parameters.queue_length)
+        this->ad_sd_functor_cache->resize(work_stream_parameters.queue_length);
+
       // Finally! We can perform the assembly.
+      const auto assemble_cells = [&]()
+      {
+        if (assembly_flags && use_cell_batches)
+          {
+            Assert(cell_batch_matrix_operations.size() ==
+                     cell_matrix_operations.size(),
+                   ExcDimensionMismatch(cell_batch_matrix_operations.size(),
+                                        cell_matrix_operations.size()));
+
+            // Group the cells into batches, each of which holds cells with
+            // the same finite element.
+            using CellBatch = std::vector<CellIteratorType>;
+            std::vector<CellBatch> cell_batches;
+            for (const auto &cell : cells)
+              {
+                if (cell_batches.empty() ||
+                    cell_batches.back().size() == width ||
+                    cell_batches.back().front()->active_fe_index() !=
+                      cell->active_fe_index())
+                  {
+                    cell_batches.emplace_back();
+                    cell_batches.back().reserve(width);
+                  }
+                cell_batches.back().push_back(cell);
+              }
+
+            using CellBatchScratchData =
+              internal::CellBatchScratchData<ScratchDataHandle>;
+            using CellBatchCopyData = internal::CellBatchCopyData<CopyData>;
+
+            // Define a worker that performs all of the cell and boundary face
+            // operations for a batch of cells. Only the cell operations for
+            // bilinear forms are vectorized over the cells.
+            auto cell_batch_worker =
+              [&cell_matrix_operations,
+               &cell_batch_matrix_operations,
+               &cell_vector_operations,
+               &initialize_cell,
+               &boundary_worker,
+               assemble_vector](
+                const typename std::vector<CellBatch>::const_iterator &batch,
+                CellBatchScratchData &batch_scratch_data,
+                CellBatchCopyData &   batch_copy_data)
+            {
+              const unsigned int n_cells = batch->size();
+              Assert(n_cells <= batch_scratch_data.cells.size(),
+                     ExcIndexRange(n_cells,
+                                   0,
+                                   batch_scratch_data.cells.size() + 1));
+              batch_copy_data.n_cells = n_cells;
+
+              std::vector<FullMatrix<ScalarType> *> cell_matrices(n_cells);
+              std::vector<ScratchData *>            scratch_data(n_cells);
+              std::vector<const FEValuesBase<dim, spacedim> *> fe_values(
+                n_cells);
+              std::vector<
+                const std::vector<SolutionExtractionData<dim, spacedim>> *>
+                solution_extraction_data(n_cells);
+              for (unsigned int c = 0; c < n_cells; ++c)
+                {
+                  scratch_data[c] = &batch_scratch_data.cells[c].get();
+                  solution_extraction_data[c] =
+                    &initialize_cell((*batch)[c],
+                                     batch_scratch_data.cells[c],
+                                     batch_copy_data.cells[c]);
+                  fe_values[c] = &scratch_data[c]->get_current_fe_values();
+                  cell_matrices[c] = &batch_copy_data.cells[c].matrices[0];
+                }
+
+              // Perform all operations that contribute to the local cell
+              // matrices. Those operations that have no batched counterpart
+              // are performed for each cell in turn.
+              for (unsigned int k = 0; k < cell_matrix_operations.size(); ++k)
+                {
+                  if (cell_batch_matrix_operations[k])
+                    {
+                      cell_batch_matrix_operations[k](cell_matrices,
+                                                      scratch_data,
+                                                      solution_extraction_data,
+                                                      fe_values);
+                    }
+                  else
+                    {
+                      for (unsigned int c = 0; c < n_cells; ++c)
+                        cell_matrix_operations[k](
+                          *cell_matrices[c],
+                          *scratch_data[c],
+                          *solution_extraction_data[c],
+                          *fe_values[c],
+                          internal::LocalMatrixContribution::full);
+                    }
+                }
+
+              for (unsigned int c = 0; c < n_cells; ++c)
+                {
+                  // Perform all operations that contribute to the local cell
+                  // vector
+                  if (assemble_vector)
+                    {
+                      Vector<ScalarType> &cell_vector =
+                        batch_copy_data.cells[c].vectors[0];
+                      for (const auto &cell_vector_op : cell_vector_operations)
+                        {
+                          cell_vector_op(cell_vector,
+                                         *scratch_data[c],
+                                         *solution_extraction_data[c],
+                                         *fe_values[c]);
+                        }
+                    }
+
+                  // Perform all boundary face operations, in the same manner
+                  // as MeshWorker::mesh_loop() would.
+                  if (boundary_worker)
+                    {
+                      const CellIteratorType &cell = (*batch)[c];
+                      for (const unsigned int face : cell->face_indices())
+                        if (cell->at_boundary(face) &&
+                            !cell->has_periodic_neighbor(face))
+                          boundary_worker(cell,
+                                          face,
+                                          batch_scratch_data.cells[c],
+                                          batch_copy_data.cells[c]);
+                    }
+                }
+            };
+
+            // Each cell in the batch is handed to the copier individually.
+            auto cell_batch_copier =
+              [&copier](const CellBatchCopyData &batch_copy_data)
+            {
+              for (unsigned int c = 0; c < batch_copy_data.n_cells; ++c)
+                copier(batch_copy_data.cells[c]);
+            };
+
+            WorkStream::run(cell_batches.cbegin(),
+                            cell_batches.cend(),
+                            cell_batch_worker,
+                            cell_batch_copier,
+                            CellBatchScratchData(sample_scratch_data, width),
+                            CellBatchCopyData(CopyData(
+                                                HP_Helper_t::get_dofs_per_cell(
+                                                  dof_handler)),
+                                              width),
+                            work_stream_parameters.queue_length,
+                            work_stream_parameters.chunk_size);
+
+            // The interface contributions are assembled separately. The copy
+            // data has to be reset on each cell, as it would be by the cell
+            // worker.
+            if (face_worker)
+              {
+                const auto reset_worker =
+                  [](const CellIteratorType &,
+                     ScratchDataHandle &,
+                     CopyData &copy_data) { copy_data.reset(0); };
+
+                MeshWorker::mesh_loop(
+                  cells,
+                  reset_worker,
+                  copier,
+                  sample_scratch_data,
+                  sample_copy_data,
+                  MeshWorker::assemble_own_cells |
+                    MeshWorker::assemble_own_interior_faces_once,
+                  BoundaryWorkerType<CellIteratorType,
+                                     ScratchDataHandle,
+                                     CopyData>(),
+                  face_worker,
+                  work_stream_parameters.queue_length,
+                  work_stream_parameters.chunk_size);
+              }
+          }
+        else if (assembly_flags && use_graph_coloring)
+          {
+            const std::vector<std::vector<CellIteratorType>> &colored_cells =
+              get_cell_coloring(
+                dof_handler,
+                constraints,
+                std::integral_constant<bool, assemble_level_cells>());
+
+            // Perform all of the cell and boundary face operations, in the
+            // same manner as MeshWorker::mesh_loop() would.
+            auto colored_cell_worker = [&cell_worker, &boundary_worker](
+                                         const CellIteratorType &cell,
+                                         ScratchDataHandle &     scratch_data,
+                                         CopyData &              copy_data)
+            {
+              if (cell_worker)
+                cell_worker(cell, scratch_data, copy_data);
+
+              if (boundary_worker)
+                for (const unsigned int face : cell->face_indices())
+                  if (cell->at_boundary(face) &&
+                      !cell->has_periodic_neighbor(face))
+                    boundary_worker(cell, face, scratch_data, copy_data);
+            };
+
+            // The cells of one color share no DoFs, so the copier is executed
+            // concurrently for all of them. Each thread therefore uses its own
+            // scatter.
+            Threads::ThreadLocalStorage<
+              internal::LocalToGlobalScatter<ScalarType>>
+              thread_scatter;
+            auto colored_cell_copier =
+              [&copy_to_global, &thread_scatter](const CopyData &copy_data)
+            { copy_to_global(copy_data, thread_scatter.get()); };
+
+            WorkStream::run(colored_cells,
+                            colored_cell_worker,
+                            colored_cell_copier,
+                            sample_scratch_data,
+                            sample_copy_data,
+                            work_stream_parameters.queue_length,
+                            work_stream_parameters.chunk_size);
+          }
+        else if (assembly_flags)
+          {
+            MeshWorker::mesh_loop(cells,
+                                  cell_worker,
+                                  copier,
+                                  sample_scratch_data,
+                                  sample_copy_data,
+                                  assembly_flags,
+                                  boundary_worker,
+                                  face_worker,
+                                  work_stream_parameters.queue_length,
+                                  work_stream_parameters.chunk_size);
+          }
+      };
+
+      const auto start_time = std::chrono::steady_clock::now();
+      if (use_communication_overlap)
+        {
+          off_process_pass = true;
+          assemble_cells();
+
+          // The off-process contributions to the vectors are now complete,
+          // so their exchange may proceed while the remaining cells are
+          // assembled. These cells only write into locally owned rows. The
+          // exchange for each vector uses the channel of its slot.
+          if (!cell_vector_operations.empty() ||
+              !boundary_face_vector_operations.empty())
+            {
+              for (std::size_t slot = 0; slot < n_vectors; ++slot)
+                if (system_vectors[slot])
+                  internal::compress_start(system_vectors[slot], slot);
+            }
+
+          off_process_pass = false;
+          assemble_cells();
+        }
+      else
+        assemble_cells();
+
+      if (assembly_flags && work_stream_tuner)
+        work_stream_tuner->record(std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() -
+                                    start_time)
+                                    .count());
+
       if (assembly_flags)
         {
-          MeshWorker::mesh_loop(dof_handler.active_cell_iterators() |
-                                  IteratorFilters::LocallyOwnedCell(),
-                                cell_worker,
-                                copier,
-                                sample_scratch_data,
-                                sample_copy_data,
-                                assembly_flags,
-                                boundary_worker,
-                                face_worker);
-
-          if (system_matrix)
+          if (!cell_matrix_operations.empty() ||
+              !boundary_face_matrix_operations.empty() ||
+              !interface_face_matrix_operations.empty())
             {
-              if (!cell_matrix_operations.empty() ||
-                  !boundary_face_matrix_operations.empty() ||
-                  !interface_face_matrix_operations.empty())
-                {
+              for (MatrixType *const system_matrix : system_matrices)
+                if (system_matrix)
                   internal::compress(system_matrix);
-                }
             }
 
-          if (system_vector)
+          if (!cell_vector_operations.empty() ||
+              !boundary_face_vector_operations.empty() ||
+              !interface_face_vector_operations.empty())
             {
-              if (!cell_vector_operations.empty() ||
-                  !boundary_face_vector_operations.empty() ||
-                  !interface_face_vector_operations.empty())
-                {
-                  internal::compress(system_vector);
-                }
+              for (VectorType *const system_vector : system_vectors)
+                if (system_vector)
+                  {
+                    if (use_communication_overlap)
+                      internal::compress_finish(system_vector);
+                    else
+                      internal::compress(system_vector);
+                  }
             }
         }
+
+      if (!persistent_scratch_data_flag)
+        scratch_data_pool.clear();
     }
   };
 
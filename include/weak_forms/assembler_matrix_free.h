@@ -0,0 +1,1488 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii_weakforms_assembler_matrix_free_h
+#define dealii_weakforms_assembler_matrix_free_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/vectorization.h>
+
+#include <deal.II/dofs/dof_handler.h>
+
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/fe/mapping.h>
+#include <deal.II/fe/mapping_q1.h>
+
+#include <deal.II/lac/affine_constraints.h>
+#include <deal.II/lac/la_parallel_vector.h>
+
+#include <deal.II/matrix_free/evaluation_flags.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+#include <deal.II/matrix_free/matrix_free.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/assembler_base.h>
+#include <weak_forms/config.h>
+#include <weak_forms/numbers.h>
+#include <weak_forms/operator_evaluators.h>
+#include <weak_forms/solution_extraction_data.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_views.h>
+#include <weak_forms/symbolic_operators.h>
+#include <weak_forms/type_traits.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * Access a single component of the values and gradients that are
+     * returned by FEEvaluation and FEFaceEvaluation.
+     *
+     * For vector-valued finite elements, the values and gradients are
+     * indexed by component first.
+     */
+    template <int n_components>
+    struct MatrixFreeComponentAccess
+    {
+      template <typename ValueType>
+      static decltype(auto)
+      value(ValueType &v, const unsigned int component)
+      {
+        return v[component];
+      }
+
+      template <typename GradientType>
+      static decltype(auto)
+      gradient(GradientType &g, const unsigned int component)
+      {
+        return g[component];
+      }
+    };
+
+
+    /**
+     * Access a single component of the values and gradients that are
+     * returned by FEEvaluation and FEFaceEvaluation.
+     *
+     * For scalar-valued finite elements, the values and gradients are not
+     * wrapped in an additional tensor.
+     */
+    template <>
+    struct MatrixFreeComponentAccess<1>
+    {
+      template <typename ValueType>
+      static ValueType &
+      value(ValueType &v, const unsigned int component)
+      {
+        (void)component;
+        Assert(component == 0, ExcIndexRange(component, 0, 1));
+        return v;
+      }
+
+      template <typename GradientType>
+      static GradientType &
+      gradient(GradientType &g, const unsigned int component)
+      {
+        (void)component;
+        Assert(component == 0, ExcIndexRange(component, 0, 1));
+        return g;
+      }
+    };
+
+
+    /**
+     * Translate the action of a test function or trial solution operation
+     * into the evaluation and integration steps of sum factorization.
+     *
+     * The @p view_rank is zero for scalar subspaces (or the full space of
+     * a scalar-valued finite element), and one for vector subspaces. The
+     * primary template marks all unsupported combinations.
+     */
+    template <int dim,
+              typename VectorizedArrayType,
+              enum Operators::SymbolicOpCodes OpCode,
+              int                             view_rank>
+    struct MatrixFreeSpaceOpEvaluator
+    {
+      static constexpr bool is_supported = false;
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<dim,
+                                      VectorizedArrayType,
+                                      Operators::SymbolicOpCodes::value,
+                                      0>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::values;
+      }
+
+      template <typename FEEvaluationType>
+      static VectorizedArrayType
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Access =
+          MatrixFreeComponentAccess<FEEvaluationType::n_components>;
+        const auto value = phi.get_value(q_point);
+        return Access::value(value, first_component);
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const VectorizedArrayType &flux,
+                ValueType &                value_flux,
+                GradientType &             gradient_flux,
+                const unsigned int         first_component)
+      {
+        (void)gradient_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        Access::value(value_flux, first_component) += flux;
+      }
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<dim,
+                                      VectorizedArrayType,
+                                      Operators::SymbolicOpCodes::gradient,
+                                      0>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::gradients;
+      }
+
+      template <typename FEEvaluationType>
+      static Tensor<1, dim, VectorizedArrayType>
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Access =
+          MatrixFreeComponentAccess<FEEvaluationType::n_components>;
+        const auto gradient = phi.get_gradient(q_point);
+        return Access::gradient(gradient, first_component);
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const Tensor<1, dim, VectorizedArrayType> &flux,
+                ValueType &                                value_flux,
+                GradientType &                             gradient_flux,
+                const unsigned int                         first_component)
+      {
+        (void)value_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        Access::gradient(gradient_flux, first_component) += flux;
+      }
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<dim,
+                                      VectorizedArrayType,
+                                      Operators::SymbolicOpCodes::value,
+                                      1>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::values;
+      }
+
+      template <typename FEEvaluationType>
+      static Tensor<1, dim, VectorizedArrayType>
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Access =
+          MatrixFreeComponentAccess<FEEvaluationType::n_components>;
+        const auto                          value = phi.get_value(q_point);
+        Tensor<1, dim, VectorizedArrayType> out;
+        for (unsigned int d = 0; d < dim; ++d)
+          out[d] = Access::value(value, first_component + d);
+        return out;
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const Tensor<1, dim, VectorizedArrayType> &flux,
+                ValueType &                                value_flux,
+                GradientType &                             gradient_flux,
+                const unsigned int                         first_component)
+      {
+        (void)gradient_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        for (unsigned int d = 0; d < dim; ++d)
+          Access::value(value_flux, first_component + d) += flux[d];
+      }
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<dim,
+                                      VectorizedArrayType,
+                                      Operators::SymbolicOpCodes::gradient,
+                                      1>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::gradients;
+      }
+
+      template <typename FEEvaluationType>
+      static Tensor<2, dim, VectorizedArrayType>
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Access =
+          MatrixFreeComponentAccess<FEEvaluationType::n_components>;
+        const auto gradient = phi.get_gradient(q_point);
+        Tensor<2, dim, VectorizedArrayType> out;
+        for (unsigned int d = 0; d < dim; ++d)
+          out[d] = Access::gradient(gradient, first_component + d);
+        return out;
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const Tensor<2, dim, VectorizedArrayType> &flux,
+                ValueType &                                value_flux,
+                GradientType &                             gradient_flux,
+                const unsigned int                         first_component)
+      {
+        (void)value_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        for (unsigned int d = 0; d < dim; ++d)
+          Access::gradient(gradient_flux, first_component + d) += flux[d];
+      }
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<
+      dim,
+      VectorizedArrayType,
+      Operators::SymbolicOpCodes::symmetric_gradient,
+      1>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::gradients;
+      }
+
+      template <typename FEEvaluationType>
+      static SymmetricTensor<2, dim, VectorizedArrayType>
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Gradient_t = MatrixFreeSpaceOpEvaluator<
+          dim,
+          VectorizedArrayType,
+          Operators::SymbolicOpCodes::gradient,
+          1>;
+        return symmetrize(Gradient_t::evaluate(phi, q_point, first_component));
+      }
+
+      // Since the flux is contracted with a symmetric tensor, only its
+      // symmetric part contributes.
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const SymmetricTensor<2, dim, VectorizedArrayType> &flux,
+                ValueType &                                         value_flux,
+                GradientType &     gradient_flux,
+                const unsigned int first_component)
+      {
+        (void)value_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        for (unsigned int d = 0; d < dim; ++d)
+          for (unsigned int e = 0; e < dim; ++e)
+            Access::gradient(gradient_flux, first_component + d)[e] +=
+              flux[d][e];
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const Tensor<2, dim, VectorizedArrayType> &flux,
+                ValueType &                                value_flux,
+                GradientType &                             gradient_flux,
+                const unsigned int                         first_component)
+      {
+        integrate<n_components>(symmetrize(flux),
+                                value_flux,
+                                gradient_flux,
+                                first_component);
+      }
+    };
+
+
+    template <int dim, typename VectorizedArrayType>
+    struct MatrixFreeSpaceOpEvaluator<dim,
+                                      VectorizedArrayType,
+                                      Operators::SymbolicOpCodes::divergence,
+                                      1>
+    {
+      static constexpr bool is_supported = true;
+
+      static EvaluationFlags::EvaluationFlags
+      evaluation_flags()
+      {
+        return EvaluationFlags::gradients;
+      }
+
+      template <typename FEEvaluationType>
+      static VectorizedArrayType
+      evaluate(const FEEvaluationType &phi,
+               const unsigned int      q_point,
+               const unsigned int      first_component)
+      {
+        using Access =
+          MatrixFreeComponentAccess<FEEvaluationType::n_components>;
+        const auto          gradient = phi.get_gradient(q_point);
+        VectorizedArrayType out      = 0.0;
+        for (unsigned int d = 0; d < dim; ++d)
+          out += Access::gradient(gradient, first_component + d)[d];
+        return out;
+      }
+
+      template <int n_components, typename ValueType, typename GradientType>
+      static void
+      integrate(const VectorizedArrayType &flux,
+                ValueType &                value_flux,
+                GradientType &             gradient_flux,
+                const unsigned int         first_component)
+      {
+        (void)value_flux;
+        using Access = MatrixFreeComponentAccess<n_components>;
+        for (unsigned int d = 0; d < dim; ++d)
+          Access::gradient(gradient_flux, first_component + d)[d] += flux;
+      }
+    };
+
+
+    /**
+     * Identify the subspace that a test function or trial solution operation
+     * acts on. The primary template marks all unsupported operations, e.g.
+     * those that are composed of unary or binary operations.
+     */
+    template <typename SpaceOp, typename T = void>
+    struct MatrixFreeSpaceOpTraits
+    {
+      static constexpr bool is_supported = false;
+    };
+
+
+    template <enum Operators::SymbolicOpCodes OpCode_>
+    struct MatrixFreeFullSpaceOpTraits
+    {
+      static constexpr bool                       is_supported  = true;
+      static constexpr bool                       is_full_space = true;
+      static constexpr Operators::SymbolicOpCodes op_code       = OpCode_;
+      static constexpr int                        view_rank     = 0;
+
+      template <typename SpaceOp>
+      static unsigned int
+      first_component(const SpaceOp &)
+      {
+        return 0;
+      }
+    };
+
+
+    template <int dim, int spacedim, enum Operators::SymbolicOpCodes OpCode>
+    struct MatrixFreeSpaceOpTraits<
+      Operators::SymbolicOp<TestFunction<dim, spacedim>, OpCode>>
+      : MatrixFreeFullSpaceOpTraits<OpCode>
+    {};
+
+
+    template <int dim, int spacedim, enum Operators::SymbolicOpCodes OpCode>
+    struct MatrixFreeSpaceOpTraits<
+      Operators::SymbolicOp<TrialSolution<dim, spacedim>, OpCode>>
+      : MatrixFreeFullSpaceOpTraits<OpCode>
+    {};
+
+
+    template <typename SpaceType, enum Operators::SymbolicOpCodes OpCode_>
+    struct MatrixFreeSpaceOpTraits<
+      Operators::SymbolicOp<SubSpaceViews::Scalar<SpaceType>, OpCode_>>
+    {
+      static constexpr bool                       is_supported  = true;
+      static constexpr bool                       is_full_space = false;
+      static constexpr Operators::SymbolicOpCodes op_code       = OpCode_;
+      static constexpr int                        view_rank     = 0;
+
+      template <typename SpaceOp>
+      static unsigned int
+      first_component(const SpaceOp &space_op)
+      {
+        return space_op.get_extractor().component;
+      }
+    };
+
+
+    template <typename SpaceType, enum Operators::SymbolicOpCodes OpCode_>
+    struct MatrixFreeSpaceOpTraits<
+      Operators::SymbolicOp<SubSpaceViews::Vector<SpaceType>, OpCode_>>
+    {
+      static constexpr bool                       is_supported  = true;
+      static constexpr bool                       is_full_space = false;
+      static constexpr Operators::SymbolicOpCodes op_code       = OpCode_;
+      static constexpr int                        view_rank     = 1;
+
+      template <typename SpaceOp>
+      static unsigned int
+      first_component(const SpaceOp &space_op)
+      {
+        return space_op.get_extractor().first_vector_component;
+      }
+    };
+
+
+    template <typename Number, std::size_t width>
+    void
+    set_to_zero(VectorizedArray<Number, width> &value)
+    {
+      value = Number(0.0);
+    }
+
+
+    template <int rank, int dim, typename Number>
+    void
+    set_to_zero(Tensor<rank, dim, Number> &value)
+    {
+      value = Tensor<rank, dim, Number>();
+    }
+
+  } // namespace internal
+
+
+
+  /**
+   * An assembler that does not build a global matrix, but rather applies the
+   * operator described by the registered bilinear forms on-the-fly using the
+   * deal.II MatrixFree framework (i.e. FEEvaluation with sum factorization).
+   *
+   * The same weak form expressions that are used with the
+   * MatrixBasedAssembler can be added to this class, e.g.
+   * @code
+   * MatrixFreeAssembler<dim, fe_degree> assembler;
+   * assembler += bilinear_form(test_grad, coeff_func, trial_grad).dV();
+   * assembler.initialize(mapping, dof_handler, constraints);
+   * assembler.vmult(dst, src);
+   * @endcode
+   *
+   * The supported subset of forms is the following:
+   * - volume and boundary integrals of bilinear forms,
+   * - whose test function and trial solution are either the value or
+   *   gradient of the full space (for a scalar-valued finite element) or
+   *   scalar subspace, or the value, gradient, symmetric gradient or
+   *   divergence of a vector subspace, and
+   * - whose functor does not depend on the field solution.
+   *
+   * Since the operator is linear and does not depend on the solution, the
+   * values of all functors are computed once during initialize() and are
+   * stored for every cell batch and quadrature point.
+   *
+   * @tparam dim The dimension of the problem. The space dimension is the same.
+   * @tparam fe_degree The polynomial degree of the finite element.
+   * @tparam n_q_points_1d The number of quadrature points in each coordinate
+   * direction.
+   * @tparam n_components The number of components of the finite element.
+   * @tparam ScalarType The number type for the vectors that the operator
+   * acts on.
+   *
+   * @note Constrained degrees of freedom are treated as in
+   * MatrixFreeOperators::Base, namely the operator acts as the identity on
+   * them.
+   */
+  template <int dim,
+            int fe_degree,
+            int n_q_points_1d   = fe_degree + 1,
+            int n_components    = 1,
+            typename ScalarType = double>
+  class MatrixFreeAssembler : public Subscriptor
+  {
+  public:
+    using scalar_type = ScalarType;
+
+    using VectorizedArrayType = VectorizedArray<ScalarType>;
+
+    static constexpr std::size_t width = VectorizedArrayType::size();
+
+    using MatrixFreeType = MatrixFree<dim, ScalarType, VectorizedArrayType>;
+
+    using VectorType = LinearAlgebra::distributed::Vector<ScalarType>;
+
+    using CellEvaluatorType = FEEvaluation<dim,
+                                           fe_degree,
+                                           n_q_points_1d,
+                                           n_components,
+                                           ScalarType,
+                                           VectorizedArrayType>;
+
+    using FaceEvaluatorType = FEFaceEvaluation<dim,
+                                               fe_degree,
+                                               n_q_points_1d,
+                                               n_components,
+                                               ScalarType,
+                                               VectorizedArrayType>;
+
+    using value_type    = typename CellEvaluatorType::value_type;
+    using gradient_type = typename CellEvaluatorType::gradient_type;
+
+    using CellInitializationOperation =
+      std::function<void(const MatrixFreeType &          matrix_free,
+                         MeshWorker::ScratchData<dim> &scratch_data)>;
+
+    using BoundaryInitializationOperation =
+      std::function<void(const MatrixFreeType &          matrix_free,
+                         MeshWorker::ScratchData<dim> &scratch_data)>;
+
+    using CellOperation =
+      std::function<void(const CellEvaluatorType &     phi,
+                         const unsigned int            cell_batch,
+                         AlignedVector<value_type> &   value_flux,
+                         AlignedVector<gradient_type> &gradient_flux)>;
+
+    using BoundaryOperation =
+      std::function<void(const FaceEvaluatorType &     phi,
+                         const unsigned int            boundary_face_batch,
+                         AlignedVector<value_type> &   value_flux,
+                         AlignedVector<gradient_type> &gradient_flux)>;
+
+    MatrixFreeAssembler()
+      : cell_evaluation_flags(EvaluationFlags::nothing)
+      , cell_integration_flags(EvaluationFlags::nothing)
+      , boundary_face_evaluation_flags(EvaluationFlags::nothing)
+      , boundary_face_integration_flags(EvaluationFlags::nothing)
+      , cell_update_flags(update_default)
+      , boundary_face_update_flags(update_default)
+    {}
+
+    // For the cases:
+    //  assembler += ().dV + ().dV + ...
+    //  assembler += ().dV - ().dA + ...
+    //  ... etc.
+    template <typename BinaryOpType,
+              typename std::enable_if<
+                is_binary_integral_op<BinaryOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator+=(const BinaryOpType &composite_integral)
+    {
+      *this += composite_integral.get_lhs_operand();
+
+      // For addition, the RHS of the composite operation retains its sign.
+      if (BinaryOpType::op_code == Operators::BinaryOpCodes::add)
+        *this += composite_integral.get_rhs_operand();
+      else if (BinaryOpType::op_code == Operators::BinaryOpCodes::subtract)
+        *this -= composite_integral.get_rhs_operand();
+      else
+        {
+          AssertThrow(BinaryOpType::op_code == Operators::BinaryOpCodes::add ||
+                        BinaryOpType::op_code ==
+                          Operators::BinaryOpCodes::subtract,
+                      ExcNotImplemented());
+        }
+
+      return *this;
+    }
+
+    // For the cases:
+    //  assembler -= ().dV + ().dV + ...
+    //  assembler -= ().dV - ().dA + ...
+    //  ... etc.
+    template <typename BinaryOpType,
+              typename std::enable_if<
+                is_binary_integral_op<BinaryOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator-=(const BinaryOpType &composite_integral)
+    {
+      *this -= composite_integral.get_lhs_operand();
+
+      // For subtraction, the RHS of the composite operation swaps its sign.
+      if (BinaryOpType::op_code == Operators::BinaryOpCodes::add)
+        *this -= composite_integral.get_rhs_operand();
+      else if (BinaryOpType::op_code == Operators::BinaryOpCodes::subtract)
+        *this += composite_integral.get_rhs_operand();
+      else
+        {
+          AssertThrow(BinaryOpType::op_code == Operators::BinaryOpCodes::add ||
+                        BinaryOpType::op_code ==
+                          Operators::BinaryOpCodes::subtract,
+                      ExcNotImplemented());
+        }
+
+      return *this;
+    }
+
+    // For the cases:
+    //  assembler += -().dV + ().dV + ...
+    //  assembler += -(().dV - ().dA) + ...
+    //  ... etc.
+    template <typename UnaryOpType,
+              typename std::enable_if<
+                is_unary_integral_op<UnaryOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator+=(const UnaryOpType &unary_integral)
+    {
+      if (UnaryOpType::op_code == Operators::UnaryOpCodes::negate)
+        *this -= unary_integral.get_operand();
+      else
+        {
+          AssertThrow(UnaryOpType::op_code == Operators::UnaryOpCodes::negate,
+                      ExcNotImplemented());
+        }
+
+      return *this;
+    }
+
+    // For the cases:
+    //  assembler -= -().dV + ().dV + ...
+    //  assembler -= -(().dV - ().dA) + ...
+    //  ... etc.
+    template <typename UnaryOpType,
+              typename std::enable_if<
+                is_unary_integral_op<UnaryOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator-=(const UnaryOpType &unary_integral)
+    {
+      // For subtraction, the value of the operation swaps its sign.
+      if (UnaryOpType::op_code == Operators::UnaryOpCodes::negate)
+        *this += unary_integral.get_operand();
+      else
+        {
+          AssertThrow(UnaryOpType::op_code == Operators::UnaryOpCodes::negate,
+                      ExcNotImplemented());
+        }
+
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_volume_integral_op<SymbolicOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator+=(const SymbolicOpType &volume_integral)
+    {
+      add_cell_operation<internal::AccumulationSign::plus>(volume_integral);
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_volume_integral_op<SymbolicOpType>::value>::type * = nullptr>
+    MatrixFreeAssembler &
+    operator-=(const SymbolicOpType &volume_integral)
+    {
+      add_cell_operation<internal::AccumulationSign::minus>(volume_integral);
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_boundary_integral_op<SymbolicOpType>::value>::type * =
+                nullptr>
+    MatrixFreeAssembler &
+    operator+=(const SymbolicOpType &boundary_integral)
+    {
+      add_boundary_face_operation<internal::AccumulationSign::plus>(
+        boundary_integral);
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_boundary_integral_op<SymbolicOpType>::value>::type * =
+                nullptr>
+    MatrixFreeAssembler &
+    operator-=(const SymbolicOpType &boundary_integral)
+    {
+      add_boundary_face_operation<internal::AccumulationSign::minus>(
+        boundary_integral);
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_interface_integral_op<SymbolicOpType>::value>::type * =
+                nullptr>
+    MatrixFreeAssembler &
+    operator+=(const SymbolicOpType &interface_integral)
+    {
+      static_assert(!is_interface_integral_op<SymbolicOpType>::value,
+                    "The matrix-free assembler does not support interface "
+                    "integrals.");
+      (void)interface_integral;
+      return *this;
+    }
+
+    template <typename SymbolicOpType,
+              typename std::enable_if<
+                is_symbolic_integral_op<SymbolicOpType>::value &&
+                is_interface_integral_op<SymbolicOpType>::value>::type * =
+                nullptr>
+    MatrixFreeAssembler &
+    operator-=(const SymbolicOpType &interface_integral)
+    {
+      static_assert(!is_interface_integral_op<SymbolicOpType>::value,
+                    "The matrix-free assembler does not support interface "
+                    "integrals.");
+      (void)interface_integral;
+      return *this;
+    }
+
+    /**
+     * Set up the underlying MatrixFree object and precompute the values of
+     * all functors at the quadrature points of every cell batch and
+     * boundary face batch.
+     *
+     * This must be called once all forms have been added to the assembler,
+     * and again whenever the mesh or degree-of-freedom distribution changes.
+     *
+     * @param mapping The mapping that describes the geometry.
+     * @param dof_handler The DoFHandler that the operator acts on.
+     * @param constraints The constraints that are applied to the operator.
+     * @param additional_data Additional settings for the MatrixFree object.
+     * The mapping update flags that the registered forms require are added
+     * to those given here.
+     */
+    void
+    initialize(const Mapping<dim> &                       mapping,
+               const DoFHandler<dim> &                    dof_handler,
+               const AffineConstraints<ScalarType> &      constraints,
+               const typename MatrixFreeType::AdditionalData &additional_data =
+                 typename MatrixFreeType::AdditionalData())
+    {
+      AssertThrow(!cell_operations.empty() ||
+                    !boundary_face_operations.empty(),
+                  ExcMessage("No operations have been added to the "
+                             "assembler."));
+      AssertThrow(dof_handler.get_fe().n_components() == n_components,
+                  ExcDimensionMismatch(dof_handler.get_fe().n_components(),
+                                       n_components));
+      AssertThrow(dof_handler.get_fe().degree == fe_degree,
+                  ExcDimensionMismatch(dof_handler.get_fe().degree,
+                                       fe_degree));
+
+      const UpdateFlags mapping_update_flags =
+        update_values | update_gradients | update_JxW_values |
+        update_quadrature_points;
+
+      typename MatrixFreeType::AdditionalData data(additional_data);
+      data.mapping_update_flags |= mapping_update_flags;
+      if (!boundary_face_operations.empty())
+        data.mapping_update_flags_boundary_faces |= mapping_update_flags;
+
+      const auto mf_storage = std::make_shared<MatrixFreeType>();
+      mf_storage->reinit(
+        mapping, dof_handler, constraints, QGauss<1>(n_q_points_1d), data);
+      matrix_free = mf_storage;
+
+      // The functors are evaluated with the standard FEValues machinery,
+      // which guarantees that they have exactly the same meaning as in
+      // the matrix-based assemblers.
+      MeshWorker::ScratchData<dim> scratch_data(
+        mapping,
+        dof_handler.get_fe(),
+        QGauss<dim>(n_q_points_1d),
+        cell_update_flags | update_quadrature_points,
+        QGauss<dim - 1>(n_q_points_1d),
+        boundary_face_update_flags | update_quadrature_points);
+
+      for (const auto &cell_initialization_op : cell_initialization_operations)
+        cell_initialization_op(*matrix_free, scratch_data);
+
+      for (const auto &boundary_initialization_op :
+           boundary_face_initialization_operations)
+        boundary_initialization_op(*matrix_free, scratch_data);
+    }
+
+    /**
+     * Same as the other function, but using a linear (Q1) mapping.
+     */
+    void
+    initialize(const DoFHandler<dim> &                    dof_handler,
+               const AffineConstraints<ScalarType> &      constraints,
+               const typename MatrixFreeType::AdditionalData &additional_data =
+                 typename MatrixFreeType::AdditionalData())
+    {
+      initialize(StaticMappingQ1<dim>::mapping,
+                 dof_handler,
+                 constraints,
+                 additional_data);
+    }
+
+    /**
+     * Return the number of rows of the operator.
+     */
+    types::global_dof_index
+    m() const
+    {
+      Assert(matrix_free, ExcNotInitialized());
+      return matrix_free->get_dof_handler().n_dofs();
+    }
+
+    /**
+     * Return the number of columns of the operator.
+     */
+    types::global_dof_index
+    n() const
+    {
+      return m();
+    }
+
+    /**
+     * Initialize a vector with the parallel layout of the underlying
+     * MatrixFree object.
+     */
+    void
+    initialize_dof_vector(VectorType &vector) const
+    {
+      Assert(matrix_free, ExcNotInitialized());
+      matrix_free->initialize_dof_vector(vector);
+    }
+
+    /**
+     * Return the underlying MatrixFree object.
+     */
+    const MatrixFreeType &
+    get_matrix_free() const
+    {
+      Assert(matrix_free, ExcNotInitialized());
+      return *matrix_free;
+    }
+
+    /**
+     * Matrix-vector product: @p dst = A * @p src.
+     */
+    void
+    vmult(VectorType &dst, const VectorType &src) const
+    {
+      do_vmult(dst, src, true /*zero_dst_vector*/);
+    }
+
+    /**
+     * Matrix-vector product with accumulation: @p dst += A * @p src.
+     */
+    void
+    vmult_add(VectorType &dst, const VectorType &src) const
+    {
+      do_vmult(dst, src, false /*zero_dst_vector*/);
+    }
+
+  private:
+    std::shared_ptr<const MatrixFreeType> matrix_free;
+
+    EvaluationFlags::EvaluationFlags cell_evaluation_flags;
+    EvaluationFlags::EvaluationFlags cell_integration_flags;
+    EvaluationFlags::EvaluationFlags boundary_face_evaluation_flags;
+    EvaluationFlags::EvaluationFlags boundary_face_integration_flags;
+
+    UpdateFlags cell_update_flags;
+    UpdateFlags boundary_face_update_flags;
+
+    std::vector<CellInitializationOperation> cell_initialization_operations;
+    std::vector<BoundaryInitializationOperation>
+      boundary_face_initialization_operations;
+
+    std::vector<CellOperation>     cell_operations;
+    std::vector<BoundaryOperation> boundary_face_operations;
+
+
+    template <enum internal::AccumulationSign Sign,
+              typename FEEvaluationType,
+              typename TestSpaceOp,
+              typename VectorizedValueTypeFunctor,
+              typename TrialSpaceOp>
+    static void
+    apply_bilinear_form(const FEEvaluationType &phi,
+                        const unsigned int      batch,
+                        const AlignedVector<VectorizedValueTypeFunctor>
+                          &                           functor_values,
+                        const unsigned int            test_first_component,
+                        const unsigned int            trial_first_component,
+                        AlignedVector<value_type> &   value_flux,
+                        AlignedVector<gradient_type> &gradient_flux)
+    {
+      using TestTraits  = internal::MatrixFreeSpaceOpTraits<TestSpaceOp>;
+      using TrialTraits = internal::MatrixFreeSpaceOpTraits<TrialSpaceOp>;
+      using TestEvaluator =
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TestTraits::op_code,
+                                             TestTraits::view_rank>;
+      using TrialEvaluator =
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TrialTraits::op_code,
+                                             TrialTraits::view_rank>;
+
+      const unsigned int n_q_points = phi.n_q_points;
+      Assert(functor_values.size() >= (batch + 1) * n_q_points,
+             ExcIndexRange((batch + 1) * n_q_points,
+                           0,
+                           functor_values.size() + 1));
+
+      // This is the equivalent of
+      // for (q : q_points)
+      //   flux[q] = values_functor[q] * trial_solution[q]
+      //   test_function[q] <- flux[q]
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        {
+          const auto trial_value =
+            TrialEvaluator::evaluate(phi, q, trial_first_component);
+          using ValueTypeTrial =
+            typename std::decay<decltype(trial_value)>::type;
+          using ContractionType_FS =
+            internal::FullContraction<VectorizedValueTypeFunctor,
+                                      ValueTypeTrial>;
+          const auto flux =
+            ContractionType_FS::contract(functor_values[batch * n_q_points + q],
+                                         trial_value);
+
+          if (Sign == internal::AccumulationSign::plus)
+            {
+              TestEvaluator::template integrate<n_components>(
+                flux, value_flux[q], gradient_flux[q], test_first_component);
+            }
+          else
+            {
+              Assert(Sign == internal::AccumulationSign::minus,
+                     ExcInternalError());
+              TestEvaluator::template integrate<n_components>(
+                -flux, value_flux[q], gradient_flux[q], test_first_component);
+            }
+        }
+    }
+
+
+    template <typename TestSpaceOp, typename TrialSpaceOp>
+    static void
+    check_space_operations(const TestSpaceOp & test_space_op,
+                           const TrialSpaceOp &trial_space_op)
+    {
+      using TestTraits  = internal::MatrixFreeSpaceOpTraits<TestSpaceOp>;
+      using TrialTraits = internal::MatrixFreeSpaceOpTraits<TrialSpaceOp>;
+      static_assert(TestTraits::is_supported,
+                    "The matrix-free assembler only supports test functions "
+                    "of a full space or a scalar or vector subspace.");
+      static_assert(TrialTraits::is_supported,
+                    "The matrix-free assembler only supports trial solutions "
+                    "of a full space or a scalar or vector subspace.");
+      static_assert(!TestTraits::is_full_space || n_components == 1,
+                    "Full space test functions are only supported for "
+                    "scalar-valued finite elements.");
+      static_assert(!TrialTraits::is_full_space || n_components == 1,
+                    "Full space trial solutions are only supported for "
+                    "scalar-valued finite elements.");
+      static_assert(internal::MatrixFreeSpaceOpEvaluator<
+                      dim,
+                      VectorizedArrayType,
+                      TestTraits::op_code,
+                      TestTraits::view_rank>::is_supported,
+                    "The matrix-free assembler does not support this "
+                    "operation on the test function.");
+      static_assert(internal::MatrixFreeSpaceOpEvaluator<
+                      dim,
+                      VectorizedArrayType,
+                      TrialTraits::op_code,
+                      TrialTraits::view_rank>::is_supported,
+                    "The matrix-free assembler does not support this "
+                    "operation on the trial solution.");
+
+      Assert(TestTraits::first_component(test_space_op) +
+                 (TestTraits::view_rank == 0 ? 1 : dim) <=
+               n_components,
+             ExcIndexRange(TestTraits::first_component(test_space_op),
+                           0,
+                           n_components));
+      Assert(TrialTraits::first_component(trial_space_op) +
+                 (TrialTraits::view_rank == 0 ? 1 : dim) <=
+               n_components,
+             ExcIndexRange(TrialTraits::first_component(trial_space_op),
+                           0,
+                           n_components));
+      (void)test_space_op;
+      (void)trial_space_op;
+    }
+
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpVolumeIntegral>
+    void
+    add_cell_operation(const SymbolicOpVolumeIntegral &volume_integral)
+    {
+      using IntegrandType = typename SymbolicOpVolumeIntegral::IntegrandType;
+      static_assert(is_bilinear_form<IntegrandType>::value,
+                    "The matrix-free assembler only supports bilinear forms.");
+
+      const auto &form           = volume_integral.get_integrand();
+      const auto &test_space_op  = form.get_test_space_operation();
+      const auto &functor        = form.get_functor();
+      const auto &trial_space_op = form.get_trial_space_operation();
+
+      using TestSpaceOp  = typename std::decay<decltype(test_space_op)>::type;
+      using Functor      = typename std::decay<decltype(functor)>::type;
+      using TrialSpaceOp = typename std::decay<decltype(trial_space_op)>::type;
+      using TestTraits   = internal::MatrixFreeSpaceOpTraits<TestSpaceOp>;
+      using TrialTraits  = internal::MatrixFreeSpaceOpTraits<TrialSpaceOp>;
+
+      check_space_operations(test_space_op, trial_space_op);
+
+      using ValueTypeFunctor =
+        typename Functor::template value_type<ScalarType>;
+      using VectorizedValueTypeFunctor = typename numbers::VectorizedValue<
+        ValueTypeFunctor>::template type<width>;
+
+      cell_evaluation_flags |=
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TrialTraits::op_code,
+                                             TrialTraits::view_rank>::
+          evaluation_flags();
+      cell_integration_flags |=
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TestTraits::op_code,
+                                             TestTraits::view_rank>::
+          evaluation_flags();
+      cell_update_flags |= volume_integral.get_update_flags();
+
+      const unsigned int test_first_component =
+        TestTraits::first_component(test_space_op);
+      const unsigned int trial_first_component =
+        TrialTraits::first_component(trial_space_op);
+
+      // Storage for the functor values at all quadrature points of all cell
+      // batches. This is shared between the initialization and the
+      // application operations.
+      const auto functor_values =
+        std::make_shared<AlignedVector<VectorizedValueTypeFunctor>>();
+
+      // Important note: All operations must be captured by copy!
+      const auto f_init = [volume_integral, functor, functor_values](
+                            const MatrixFreeType &          matrix_free,
+                            MeshWorker::ScratchData<dim> &scratch_data)
+      {
+        const unsigned int n_q_points = Utilities::pow(n_q_points_1d, dim);
+        const unsigned int n_cell_batches = matrix_free.n_cell_batches();
+        const std::vector<SolutionExtractionData<dim, dim>>
+          solution_extraction_data;
+
+        functor_values->resize(n_cell_batches * n_q_points);
+        for (unsigned int cell = 0; cell < n_cell_batches; ++cell)
+          {
+            // Lanes that are not filled, or that do not lie in the
+            // integration domain, must not contribute.
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              for (unsigned int v = 0; v < width; ++v)
+                numbers::set_vectorized_values(
+                  (*functor_values)[cell * n_q_points + q],
+                  v,
+                  ValueTypeFunctor{});
+
+            for (unsigned int v = 0;
+                 v < matrix_free.n_active_entries_per_cell_batch(cell);
+                 ++v)
+              {
+                const typename DoFHandler<dim>::active_cell_iterator
+                  dof_cell = matrix_free.get_cell_iterator(cell, v);
+
+                if (!volume_integral.get_integral_operation()
+                       .integrate_on_cell(dof_cell))
+                  continue;
+
+                // The ordering of the tensor-product quadrature points is
+                // the same as that used by FEEvaluation.
+                const FEValuesBase<dim> &fe_values =
+                  scratch_data.reinit(dof_cell);
+                Assert(fe_values.n_quadrature_points == n_q_points,
+                       ExcDimensionMismatch(fe_values.n_quadrature_points,
+                                            n_q_points));
+
+                const std::vector<ValueTypeFunctor> values =
+                  internal::evaluate_functor<ScalarType>(
+                    functor, fe_values, scratch_data, solution_extraction_data);
+                for (unsigned int q = 0; q < n_q_points; ++q)
+                  numbers::set_vectorized_values(
+                    (*functor_values)[cell * n_q_points + q], v, values[q]);
+              }
+          }
+      };
+
+      const auto f = [functor_values,
+                      test_first_component,
+                      trial_first_component](
+                       const CellEvaluatorType &     phi,
+                       const unsigned int            cell,
+                       AlignedVector<value_type> &   value_flux,
+                       AlignedVector<gradient_type> &gradient_flux)
+      {
+        apply_bilinear_form<Sign,
+                            CellEvaluatorType,
+                            TestSpaceOp,
+                            VectorizedValueTypeFunctor,
+                            TrialSpaceOp>(phi,
+                                          cell,
+                                          *functor_values,
+                                          test_first_component,
+                                          trial_first_component,
+                                          value_flux,
+                                          gradient_flux);
+      };
+
+      cell_initialization_operations.emplace_back(f_init);
+      cell_operations.emplace_back(f);
+    }
+
+
+    template <enum internal::AccumulationSign Sign,
+              typename SymbolicOpBoundaryIntegral>
+    void
+    add_boundary_face_operation(
+      const SymbolicOpBoundaryIntegral &boundary_integral)
+    {
+      using IntegrandType = typename SymbolicOpBoundaryIntegral::IntegrandType;
+      static_assert(is_bilinear_form<IntegrandType>::value,
+                    "The matrix-free assembler only supports bilinear forms.");
+
+      const auto &form           = boundary_integral.get_integrand();
+      const auto &test_space_op  = form.get_test_space_operation();
+      const auto &functor        = form.get_functor();
+      const auto &trial_space_op = form.get_trial_space_operation();
+
+      using TestSpaceOp  = typename std::decay<decltype(test_space_op)>::type;
+      using Functor      = typename std::decay<decltype(functor)>::type;
+      using TrialSpaceOp = typename std::decay<decltype(trial_space_op)>::type;
+      using TestTraits   = internal::MatrixFreeSpaceOpTraits<TestSpaceOp>;
+      using TrialTraits  = internal::MatrixFreeSpaceOpTraits<TrialSpaceOp>;
+
+      check_space_operations(test_space_op, trial_space_op);
+
+      using ValueTypeFunctor =
+        typename Functor::template value_type<ScalarType>;
+      using VectorizedValueTypeFunctor = typename numbers::VectorizedValue<
+        ValueTypeFunctor>::template type<width>;
+
+      boundary_face_evaluation_flags |=
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TrialTraits::op_code,
+                                             TrialTraits::view_rank>::
+          evaluation_flags();
+      boundary_face_integration_flags |=
+        internal::MatrixFreeSpaceOpEvaluator<dim,
+                                             VectorizedArrayType,
+                                             TestTraits::op_code,
+                                             TestTraits::view_rank>::
+          evaluation_flags();
+      boundary_face_update_flags |= boundary_integral.get_update_flags();
+
+      const unsigned int test_first_component =
+        TestTraits::first_component(test_space_op);
+      const unsigned int trial_first_component =
+        TrialTraits::first_component(trial_space_op);
+
+      const auto functor_values =
+        std::make_shared<AlignedVector<VectorizedValueTypeFunctor>>();
+
+      // Important note: All operations must be captured by copy!
+      const auto f_init = [boundary_integral, functor, functor_values](
+                            const MatrixFreeType &          matrix_free,
+                            MeshWorker::ScratchData<dim> &scratch_data)
+      {
+        FaceEvaluatorType  phi(matrix_free, true);
+        const unsigned int n_q_points = phi.n_q_points;
+        const unsigned int n_boundary_face_batches =
+          matrix_free.n_boundary_face_batches();
+        const unsigned int face_batch_offset =
+          matrix_free.n_inner_face_batches();
+        const std::vector<SolutionExtractionData<dim, dim>>
+          solution_extraction_data;
+
+        functor_values->resize(n_boundary_face_batches * n_q_points);
+        for (unsigned int f = 0; f < n_boundary_face_batches; ++f)
+          {
+            const unsigned int face = face_batch_offset + f;
+            phi.reinit(face);
+
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              for (unsigned int v = 0; v < width; ++v)
+                numbers::set_vectorized_values(
+                  (*functor_values)[f * n_q_points + q],
+                  v,
+                  ValueTypeFunctor{});
+
+            for (unsigned int v = 0;
+                 v < matrix_free.n_active_entries_per_face_batch(face);
+                 ++v)
+              {
+                const auto cell_and_face =
+                  matrix_free.get_face_iterator(face, v, true);
+                const typename DoFHandler<dim>::active_cell_iterator
+                                   dof_cell = cell_and_face.first;
+                const unsigned int face_no  = cell_and_face.second;
+
+                if (!boundary_integral.get_integral_operation()
+                       .integrate_on_face(dof_cell, face_no))
+                  continue;
+
+                const FEValuesBase<dim> &fe_face_values =
+                  scratch_data.reinit(dof_cell, face_no);
+                const std::vector<ValueTypeFunctor> values =
+                  internal::evaluate_functor<ScalarType>(
+                    functor,
+                    fe_face_values,
+                    scratch_data,
+                    solution_extraction_data);
+
+                // The face quadrature points of FEFaceEvaluation are not
+                // necessarily ordered in the same way as those of
+                // FEFaceValues (this depends on the face orientation), so
+                // we match them by their position.
+                for (unsigned int q = 0; q < n_q_points; ++q)
+                  {
+                    Point<dim> point;
+                    for (unsigned int d = 0; d < dim; ++d)
+                      point[d] = phi.quadrature_point(q)[d][v];
+
+                    unsigned int q_match  = 0;
+                    double       min_dist = point.distance_square(
+                      fe_face_values.quadrature_point(0));
+                    for (const unsigned int q_fe :
+                         fe_face_values.quadrature_point_indices())
+                      {
+                        const double dist = point.distance_square(
+                          fe_face_values.quadrature_point(q_fe));
+                        if (dist < min_dist)
+                          {
+                            min_dist = dist;
+                            q_match  = q_fe;
+                          }
+                      }
+
+                    numbers::set_vectorized_values(
+                      (*functor_values)[f * n_q_points + q],
+                      v,
+                      values[q_match]);
+                  }
+              }
+          }
+      };
+
+      const auto f = [functor_values,
+                      test_first_component,
+                      trial_first_component](
+                       const FaceEvaluatorType &     phi,
+                       const unsigned int            boundary_face,
+                       AlignedVector<value_type> &   value_flux,
+                       AlignedVector<gradient_type> &gradient_flux)
+      {
+        apply_bilinear_form<Sign,
+                            FaceEvaluatorType,
+                            TestSpaceOp,
+                            VectorizedValueTypeFunctor,
+                            TrialSpaceOp>(phi,
+                                          boundary_face,
+                                          *functor_values,
+                                          test_first_component,
+                                          trial_first_component,
+                                          value_flux,
+                                          gradient_flux);
+      };
+
+      boundary_face_initialization_operations.emplace_back(f_init);
+      boundary_face_operations.emplace_back(f);
+    }
+
+
+    template <typename FEEvaluationType>
+    static void
+    submit_and_reset_fluxes(FEEvaluationType &                     phi,
+                            const EvaluationFlags::EvaluationFlags integration_flags,
+                            AlignedVector<value_type> &            value_flux,
+                            AlignedVector<gradient_type> &         gradient_flux)
+    {
+      for (unsigned int q = 0; q < phi.n_q_points; ++q)
+        {
+          if (integration_flags & EvaluationFlags::values)
+            phi.submit_value(value_flux[q], q);
+          if (integration_flags & EvaluationFlags::gradients)
+            phi.submit_gradient(gradient_flux[q], q);
+
+          internal::set_to_zero(value_flux[q]);
+          internal::set_to_zero(gradient_flux[q]);
+        }
+    }
+
+
+    void
+    local_apply_cell(const MatrixFreeType &                       matrix_free,
+                     VectorType &                                 dst,
+                     const VectorType &                           src,
+                     const std::pair<unsigned int, unsigned int> &cell_range) const
+    {
+      if (cell_operations.empty())
+        return;
+
+      CellEvaluatorType            phi(matrix_free);
+      AlignedVector<value_type>    value_flux(phi.n_q_points);
+      AlignedVector<gradient_type> gradient_flux(phi.n_q_points);
+      for (unsigned int q = 0; q < phi.n_q_points; ++q)
+        {
+          internal::set_to_zero(value_flux[q]);
+          internal::set_to_zero(gradient_flux[q]);
+        }
+
+      for (unsigned int cell = cell_range.first; cell < cell_range.second;
+           ++cell)
+        {
+          phi.reinit(cell);
+          phi.gather_evaluate(src, cell_evaluation_flags);
+
+          for (const auto &cell_op : cell_operations)
+            cell_op(phi, cell, value_flux, gradient_flux);
+
+          submit_and_reset_fluxes(phi,
+                                  cell_integration_flags,
+                                  value_flux,
+                                  gradient_flux);
+          phi.integrate_scatter(cell_integration_flags, dst);
+        }
+    }
+
+
+    void
+    local_apply_inner_face(
+      const MatrixFreeType &,
+      VectorType &,
+      const VectorType &,
+      const std::pair<unsigned int, unsigned int> &) const
+    {}
+
+
+    void
+    local_apply_boundary_face(
+      const MatrixFreeType &                       matrix_free,
+      VectorType &                                 dst,
+      const VectorType &                           src,
+      const std::pair<unsigned int, unsigned int> &face_range) const
+    {
+      FaceEvaluatorType            phi(matrix_free, true);
+      AlignedVector<value_type>    value_flux(phi.n_q_points);
+      AlignedVector<gradient_type> gradient_flux(phi.n_q_points);
+      for (unsigned int q = 0; q < phi.n_q_points; ++q)
+        {
+          internal::set_to_zero(value_flux[q]);
+          internal::set_to_zero(gradient_flux[q]);
+        }
+
+      const unsigned int face_batch_offset = matrix_free.n_inner_face_batches();
+      for (unsigned int face = face_range.first; face < face_range.second;
+           ++face)
+        {
+          phi.reinit(face);
+          phi.gather_evaluate(src, boundary_face_evaluation_flags);
+
+          for (const auto &boundary_op : boundary_face_operations)
+            boundary_op(phi, face - face_batch_offset, value_flux, gradient_flux);
+
+          submit_and_reset_fluxes(phi,
+                                  boundary_face_integration_flags,
+                                  value_flux,
+                                  gradient_flux);
+          phi.integrate_scatter(boundary_face_integration_flags, dst);
+        }
+    }
+
+
+    void
+    do_vmult(VectorType &      dst,
+             const VectorType &src,
+             const bool        zero_dst_vector) const
+    {
+      Assert(matrix_free, ExcNotInitialized());
+
+      if (boundary_face_operations.empty())
+        matrix_free->cell_loop(&MatrixFreeAssembler::local_apply_cell,
+                               this,
+                               dst,
+                               src,
+                               zero_dst_vector);
+      else
+        matrix_free->loop(&MatrixFreeAssembler::local_apply_cell,
+                          &MatrixFreeAssembler::local_apply_inner_face,
+                          &MatrixFreeAssembler::local_apply_boundary_face,
+                          this,
+                          dst,
+                          src,
+                          zero_dst_vector);
+
+      // The operator acts as the identity on constrained DoFs.
+      for (const unsigned int constrained_dof :
+           matrix_free->get_constrained_dofs())
+        dst.local_element(constrained_dof) += src.local_element(constrained_dof);
+    }
+  };
+
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+
+#endif // dealii_weakforms_assembler_matrix_free_h
@@ -0,0 +1,197 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii_weakforms_cell_coloring_cache_h
+#define dealii_weakforms_cell_coloring_cache_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/base/graph_coloring.h>
+#include <deal.II/base/types.h>
+
+#include <deal.II/dofs/dof_handler.h>
+
+#include <deal.II/lac/affine_constraints.h>
+
+#include <boost/signals2/connection.hpp>
+
+#include <weak_forms/config.h>
+
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * A cache for a coloring of the locally owned cells of a DoFHandler,
+     * such that no two cells of the same color write into the same rows of
+     * the global system. The cells of one color may therefore distribute
+     * their local contributions concurrently.
+     *
+     * A constrained DoF is deemed to conflict with all of the DoFs that it
+     * is constrained to, as its contributions are redistributed into their
+     * rows. The coloring is discarded whenever the triangulation changes.
+     */
+    template <int dim, int spacedim>
+    class CellColoringCache
+    {
+    public:
+      using CellIteratorType =
+        typename DoFHandler<dim, spacedim>::active_cell_iterator;
+
+      CellColoringCache()
+        : dof_handler(nullptr)
+        , constraints(nullptr)
+        , n_dofs(0)
+        , n_constraints(0)
+      {}
+
+      // Caches are never shared, so a copy starts out empty.
+      CellColoringCache(const CellColoringCache &)
+        : CellColoringCache()
+      {}
+
+      CellColoringCache &
+      operator=(const CellColoringCache &)
+      {
+        clear();
+        return *this;
+      }
+
+      ~CellColoringCache()
+      {
+        clear();
+      }
+
+      /**
+       * Return the locally owned cells of the @p dof_handler, grouped by
+       * color. The coloring is only recomputed if the @p dof_handler or the
+       * @p constraints differ from those of the previous call, or if the
+       * triangulation has changed since then.
+       *
+       * This function is not thread-safe.
+       */
+      template <typename ScalarType>
+      const std::vector<std::vector<CellIteratorType>> &
+      get(const DoFHandler<dim, spacedim> &    dof_handler,
+          const AffineConstraints<ScalarType> &constraints)
+      {
+        if (&dof_handler != this->dof_handler ||
+            &constraints != this->constraints ||
+            dof_handler.n_dofs() != n_dofs ||
+            constraints.n_constraints() != n_constraints ||
+            !triangulation_listener.connected())
+          {
+            clear();
+            this->dof_handler   = &dof_handler;
+            this->constraints   = &constraints;
+            this->n_dofs        = dof_handler.n_dofs();
+            this->n_constraints = constraints.n_constraints();
+
+            compute_coloring(dof_handler, constraints);
+
+            // Any change to the triangulation invalidates the cells that
+            // the coloring refers to.
+            triangulation_listener =
+              dof_handler.get_triangulation().signals.any_change.connect(
+                [this]() { clear(); });
+          }
+
+        return colored_cells;
+      }
+
+      /**
+       * Discard the cached coloring.
+       */
+      void
+      clear()
+      {
+        triangulation_listener.disconnect();
+        colored_cells.clear();
+        dof_handler   = nullptr;
+        constraints   = nullptr;
+        n_dofs        = 0;
+        n_constraints = 0;
+      }
+
+    private:
+      const void *                               dof_handler;
+      const void *                               constraints;
+      dealii::types::global_dof_index            n_dofs;
+      dealii::types::global_dof_index            n_constraints;
+      boost::signals2::connection                triangulation_listener;
+      std::vector<std::vector<CellIteratorType>> colored_cells;
+
+      template <typename ScalarType>
+      void
+      compute_coloring(const DoFHandler<dim, spacedim> &    dof_handler,
+                       const AffineConstraints<ScalarType> &constraints)
+      {
+        // Cells that are not locally owned are never assembled, so they
+        // conflict with nothing.
+        const auto get_conflict_indices =
+          [&constraints](const CellIteratorType &cell)
+        {
+          std::vector<dealii::types::global_dof_index> conflict_indices;
+          if (!cell->is_locally_owned())
+            return conflict_indices;
+
+          const unsigned int n_dofs_per_cell = cell->get_fe().dofs_per_cell;
+          conflict_indices.resize(n_dofs_per_cell);
+          cell->get_dof_indices(conflict_indices);
+
+          for (unsigned int i = 0; i < n_dofs_per_cell; ++i)
+            if (const auto *const entries =
+                  constraints.get_constraint_entries(conflict_indices[i]))
+              {
+                for (const auto &entry : *entries)
+                  conflict_indices.push_back(entry.first);
+              }
+
+          return conflict_indices;
+        };
+
+        const std::vector<std::vector<CellIteratorType>> coloring =
+          GraphColoring::make_graph_coloring(dof_handler.begin_active(),
+                                             dof_handler.end(),
+                                             get_conflict_indices);
+
+        for (const auto &color : coloring)
+          {
+            std::vector<CellIteratorType> cells;
+            cells.reserve(color.size());
+            for (const CellIteratorType &cell : color)
+              if (cell->is_locally_owned())
+                cells.push_back(cell);
+
+            if (!cells.empty())
+              colored_cells.emplace_back(std::move(cells));
+          }
+      }
+    };
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+#endif // dealii_weakforms_cell_coloring_cache_h
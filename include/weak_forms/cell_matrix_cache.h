@@ -0,0 +1,286 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii_weakforms_cell_matrix_cache_h
+#define dealii_weakforms_cell_matrix_cache_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/types.h>
+
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/full_matrix.h>
+
+#include <boost/signals2/connection.hpp>
+
+#include <weak_forms/config.h>
+#include <weak_forms/scratch_data_pool.h>
+
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * A cache for the local matrix contributions from the cell operations
+     * that do not depend on the solution, so that they need only be
+     * computed once and may then be reused by all subsequent assembly calls.
+     *
+     * The cached matrices are stored per active cell. They are discarded
+     * whenever the triangulation changes or its vertices are moved, or if
+     * anything that the ScratchData objects depend on (as is described by
+     * the ScratchDataPoolKey) changes between assembly calls. A cached matrix
+     * is also recomputed if the active finite element of its cell changes.
+     *
+     * The cached matrices also depend on the mapping of each cell. A mapping
+     * that depends on the solution (e.g. one that follows the displacement
+     * field) therefore invalidates the cache, which is not detected here.
+     */
+    template <typename ScalarType>
+    class CellMatrixCache
+    {
+    public:
+      CellMatrixCache()
+        : triangulation(nullptr)
+        , n_operations(0)
+      {}
+
+      // Caches are never shared, so a copy starts out empty.
+      CellMatrixCache(const CellMatrixCache &)
+        : CellMatrixCache()
+      {}
+
+      CellMatrixCache &
+      operator=(const CellMatrixCache &)
+      {
+        clear();
+        return *this;
+      }
+
+      ~CellMatrixCache()
+      {
+        clear();
+      }
+
+      /**
+       * Prepare the cache for an assembly with the given @p key on the
+       * @p triangulation, in which the cached matrices are built from
+       * @p n_operations cell operations. If any of these differ from those
+       * of the previous assembly, then all cached matrices are discarded.
+       *
+       * This function is not thread-safe, and must be called before the
+       * cache is used during assembly.
+       */
+      template <int dim, int spacedim>
+      void
+      initialize(const ScratchDataPoolKey &          key,
+                 const Triangulation<dim, spacedim> &triangulation,
+                 const unsigned int                  n_operations)
+      {
+        if (key != this->key || &triangulation != this->triangulation ||
+            n_operations != this->n_operations ||
+            !triangulation_listener.connected() ||
+            !mesh_movement_listener.connected())
+          {
+            clear();
+            this->key           = key;
+            this->triangulation = &triangulation;
+            this->n_operations  = n_operations;
+
+            // Any change to the triangulation invalidates the cell indices
+            // that the cached matrices are associated with. Moving the
+            // vertices changes the geometry that they were computed with.
+            triangulation_listener =
+              triangulation.signals.any_change.connect([this]() { clear(); });
+            mesh_movement_listener =
+              triangulation.signals.mesh_movement.connect(
+                [this]() { clear(); });
+          }
+
+        if (cell_matrices.size() != triangulation.n_active_cells())
+          {
+            cell_matrices.resize(triangulation.n_active_cells());
+            active_fe_indices.assign(triangulation.n_active_cells(),
+                                     numbers::invalid_unsigned_int);
+          }
+      }
+
+      /**
+       * Return the cached matrix for the @p cell. If there is no valid
+       * matrix for this cell, then it is first reinitialized to a zero
+       * matrix of size @p n_dofs and passed to the @p compute function.
+       *
+       * Each cell is only ever processed by one thread at a time, so this
+       * function may be called concurrently for different cells.
+       */
+      template <typename CellIteratorType, typename ComputeFunction>
+      const FullMatrix<ScalarType> &
+      get(const CellIteratorType &cell,
+          const unsigned int      n_dofs,
+          const ComputeFunction & compute)
+      {
+        const unsigned int index = cell->active_cell_index();
+        Assert(index < cell_matrices.size(),
+               ExcIndexRange(index, 0, cell_matrices.size()));
+
+        FullMatrix<ScalarType> &cell_matrix = cell_matrices[index];
+        if (active_fe_indices[index] != cell->active_fe_index())
+          {
+            cell_matrix.reinit(n_dofs, n_dofs);
+            compute(cell_matrix);
+            active_fe_indices[index] = cell->active_fe_index();
+          }
+
+        Assert(cell_matrix.m() == n_dofs,
+               ExcDimensionMismatch(cell_matrix.m(), n_dofs));
+        return cell_matrix;
+      }
+
+      /**
+       * Discard all cached matrices.
+       */
+      void
+      clear()
+      {
+        triangulation_listener.disconnect();
+        mesh_movement_listener.disconnect();
+        cell_matrices.clear();
+        active_fe_indices.clear();
+        key           = ScratchDataPoolKey();
+        triangulation = nullptr;
+        n_operations  = 0;
+      }
+
+    private:
+      ScratchDataPoolKey                  key;
+      const void *                        triangulation;
+      unsigned int                        n_operations;
+      boost::signals2::connection         triangulation_listener;
+      boost::signals2::connection         mesh_movement_listener;
+      std::vector<FullMatrix<ScalarType>> cell_matrices;
+
+      /**
+       * The active finite element index of each cell at the time that its
+       * matrix was cached, or an invalid value if there is no cached matrix.
+       */
+      std::vector<unsigned int> active_fe_indices;
+    };
+
+
+
+    /**
+     * A record of the local matrix of each cell, as it was last distributed
+     * into the system matrix. This allows the contribution from a cell to
+     * be replaced later on, without reassembling the entire system.
+     *
+     * The recorded matrices are stored per active cell, and are discarded
+     * whenever the triangulation changes.
+     */
+    template <typename ScalarType>
+    class LocalMatrixHistory
+    {
+    public:
+      LocalMatrixHistory()
+        : triangulation(nullptr)
+      {}
+
+      // Histories are never shared, so a copy starts out empty.
+      LocalMatrixHistory(const LocalMatrixHistory &)
+        : LocalMatrixHistory()
+      {}
+
+      LocalMatrixHistory &
+      operator=(const LocalMatrixHistory &)
+      {
+        clear();
+        return *this;
+      }
+
+      ~LocalMatrixHistory()
+      {
+        clear();
+      }
+
+      /**
+       * Prepare the history for an assembly on the @p triangulation. If this
+       * differs from the triangulation of the previous assembly, then all
+       * recorded matrices are discarded.
+       *
+       * This function is not thread-safe.
+       */
+      template <int dim, int spacedim>
+      void
+      initialize(const Triangulation<dim, spacedim> &triangulation)
+      {
+        if (&triangulation != this->triangulation ||
+            !triangulation_listener.connected())
+          {
+            clear();
+            this->triangulation = &triangulation;
+
+            // Any change to the triangulation invalidates the cell indices
+            // that the recorded matrices are associated with.
+            triangulation_listener =
+              triangulation.signals.any_change.connect([this]() { clear(); });
+          }
+
+        cell_matrices.resize(triangulation.n_active_cells());
+      }
+
+      /**
+       * Return the recorded matrix for the cell with the given
+       * @p active_cell_index. It is empty if no matrix has been recorded
+       * for this cell.
+       */
+      FullMatrix<ScalarType> &
+      get(const unsigned int active_cell_index)
+      {
+        Assert(active_cell_index < cell_matrices.size(),
+               ExcIndexRange(active_cell_index, 0, cell_matrices.size()));
+        return cell_matrices[active_cell_index];
+      }
+
+      /**
+       * Discard all recorded matrices.
+       */
+      void
+      clear()
+      {
+        triangulation_listener.disconnect();
+        cell_matrices.clear();
+        triangulation = nullptr;
+      }
+
+    private:
+      const void *                        triangulation;
+      boost::signals2::connection         triangulation_listener;
+      std::vector<FullMatrix<ScalarType>> cell_matrices;
+    };
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+#endif // dealii_weakforms_cell_matrix_cache_h
@@ -0,0 +1,285 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii_weakforms_local_gemm_kernel_h
+#define dealii_weakforms_local_gemm_kernel_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/algorithms/general_data_storage.h>
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/symmetric_tensor.h>
+#include <deal.II/base/tensor.h>
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/vectorization.h>
+
+#include <deal.II/lac/full_matrix.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/config.h>
+#include <weak_forms/template_constraints.h>
+
+#include <string>
+#include <type_traits>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * Access to the individual components of a shape function or functor
+     * value, such that the full contraction of two values of the same shape
+     * is the sum of the products of their components.
+     *
+     * Symmetric tensors are treated like their full counterparts, so that
+     * every off-diagonal component is accounted for separately.
+     */
+    template <typename T, typename U = void>
+    struct GEMMComponentAccess
+    {
+      static constexpr bool         is_supported = false;
+      static constexpr int          rank         = -1;
+      static constexpr unsigned int n_components = 0;
+    };
+
+
+    template <typename T>
+    struct GEMMComponentAccess<
+      T,
+      typename std::enable_if<is_scalar_type<T>::value>::type>
+    {
+      static constexpr bool         is_supported = true;
+      static constexpr int          rank         = 0;
+      static constexpr unsigned int n_components = 1;
+
+      static const T &
+      get(const T &value, const unsigned int component)
+      {
+        (void)component;
+        Assert(component == 0, ExcIndexRange(component, 0, n_components));
+        return value;
+      }
+    };
+
+
+    template <int rank_, int dim, typename T>
+    struct GEMMComponentAccess<Tensor<rank_, dim, T>,
+                               typename std::enable_if<(rank_ > 0)>::type>
+    {
+      static constexpr bool         is_supported = true;
+      static constexpr int          rank         = rank_;
+      static constexpr unsigned int n_components =
+        Tensor<rank_, dim>::n_independent_components;
+
+      static T
+      get(const Tensor<rank_, dim, T> &value, const unsigned int component)
+      {
+        Assert(component < n_components,
+               ExcIndexRange(component, 0, n_components));
+        return value[Tensor<rank_, dim>::unrolled_to_component_indices(
+          component)];
+      }
+    };
+
+
+    template <int rank_, int dim, typename T>
+    struct GEMMComponentAccess<SymmetricTensor<rank_, dim, T>>
+    {
+      static constexpr bool         is_supported = true;
+      static constexpr int          rank         = rank_;
+      static constexpr unsigned int n_components =
+        Tensor<rank_, dim>::n_independent_components;
+
+      static T
+      get(const SymmetricTensor<rank_, dim, T> &value,
+          const unsigned int                    component)
+      {
+        Assert(component < n_components,
+               ExcIndexRange(component, 0, n_components));
+        return value[Tensor<rank_, dim>::unrolled_to_component_indices(
+          component)];
+      }
+    };
+
+
+    /**
+     * Extract the value of a single vectorization lane.
+     */
+    template <typename T>
+    const T &
+    get_vectorization_lane(const T &value, const unsigned int lane)
+    {
+      (void)lane;
+      Assert(lane == 0, ExcIndexRange(lane, 0, 1));
+      return value;
+    }
+
+
+    template <typename T, std::size_t width>
+    T
+    get_vectorization_lane(const VectorizedArray<T, width> &value,
+                           const unsigned int               lane)
+    {
+      Assert(lane < width, ExcIndexRange(lane, 0, width));
+      return value[lane];
+    }
+
+
+    /**
+     * A kernel that computes a local matrix in the "B^T D B" form, i.e.
+     * as the dense matrix-matrix product
+     * @f[
+     *   \mathbf{K} = \mathbf{B}_{\text{test}}^{T} \mathbf{W}_{\text{trial}}
+     * @f]
+     * where the rows of $\mathbf{B}_{\text{test}}$ hold the components of
+     * the test functions at every quadrature point, and the rows of
+     * $\mathbf{W}_{\text{trial}}$ hold the components of the trial solutions
+     * after they have been contracted with the functor and scaled by the
+     * integration weight at that same quadrature point. Each row therefore
+     * corresponds to one component at one quadrature point, and each column
+     * to one DoF.
+     *
+     * Assembling the local matrix in this way replaces the reduction over
+     * all quadrature points for each individual matrix entry with a single
+     * call to FullMatrix::Tmmult(), which uses the optimized BLAS routines
+     * when deal.II is configured with LAPACK. This pays off for elements with
+     * many DoFs per cell.
+     *
+     * The matrices are stored in the ScratchData, so that their memory is
+     * reused from one cell to the next.
+     */
+    template <typename ScalarType>
+    class LocalGEMMKernel
+    {
+    public:
+      /**
+       * Get the kernel associated with the @p scratch_data.
+       */
+      template <int dim, int spacedim>
+      static LocalGEMMKernel &
+      get(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+      {
+        GeneralDataStorage &data_storage =
+          scratch_data.get_general_data_storage();
+        return data_storage.get_or_add_object_with_name<LocalGEMMKernel>(
+          get_name_local_gemm_kernel());
+      }
+
+      /**
+       * Prepare the kernel for a new contribution that is integrated over
+       * @p n_q_points quadrature points, for values with @p n_components
+       * components and with @p n_dofs test functions and trial solutions.
+       */
+      void
+      reinit(const unsigned int n_q_points,
+             const unsigned int n_components,
+             const unsigned int n_dofs)
+      {
+        this->n_components = n_components;
+        test_shapes.reinit(n_q_points * n_components, n_dofs);
+        weighted_trial_shapes.reinit(n_q_points * n_components, n_dofs);
+        local_matrix.reinit(n_dofs, n_dofs);
+      }
+
+      /**
+       * Set the components of the test function @p dof at the quadrature
+       * point @p q_point. If the @p value is vectorized, then the quadrature
+       * point is associated with the given vectorization @p lane.
+       */
+      template <typename ValueType>
+      void
+      set_test_shape(const unsigned int dof,
+                     const unsigned int q_point,
+                     const ValueType &  value,
+                     const unsigned int lane = 0)
+      {
+        set_row_components(test_shapes, dof, q_point, value, lane);
+      }
+
+      /**
+       * Set the components of the trial solution @p dof at the quadrature
+       * point @p q_point, already contracted with the functor and scaled by
+       * the integration weight. If the @p value is vectorized, then the
+       * quadrature point is associated with the given vectorization @p lane.
+       */
+      template <typename ValueType>
+      void
+      set_weighted_trial_shape(const unsigned int dof,
+                               const unsigned int q_point,
+                               const ValueType &  value,
+                               const unsigned int lane = 0)
+      {
+        set_row_components(weighted_trial_shapes, dof, q_point, value, lane);
+      }
+
+      /**
+       * Compute the local matrix from all of the data that has been set
+       * since the last call to reinit().
+       */
+      const FullMatrix<ScalarType> &
+      compute()
+      {
+        test_shapes.Tmmult(local_matrix, weighted_trial_shapes);
+        return local_matrix;
+      }
+
+    private:
+      unsigned int           n_components = 0;
+      FullMatrix<ScalarType> test_shapes;
+      FullMatrix<ScalarType> weighted_trial_shapes;
+      FullMatrix<ScalarType> local_matrix;
+
+      template <typename ValueType>
+      void
+      set_row_components(FullMatrix<ScalarType> &matrix,
+                         const unsigned int      dof,
+                         const unsigned int      q_point,
+                         const ValueType &       value,
+                         const unsigned int      lane)
+      {
+        using Access = GEMMComponentAccess<ValueType>;
+        static_assert(Access::is_supported,
+                      "The GEMM kernel does not support this value type.");
+        Assert(Access::n_components == n_components,
+               ExcDimensionMismatch(Access::n_components, n_components));
+
+        const unsigned int row_offset = q_point * n_components;
+        for (unsigned int c = 0; c < Access::n_components; ++c)
+          matrix(row_offset + c, dof) =
+            get_vectorization_lane(Access::get(value, c), lane);
+      }
+
+      static const std::string &
+      get_name_local_gemm_kernel()
+      {
+        static const std::string name =
+          Utilities::get_deal_II_prefix() + "LocalGEMMKernel";
+        return name;
+      }
+    };
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+#endif // dealii_weakforms_local_gemm_kernel_h
@@ -29,6 +29,7 @@
 
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 
@@ -87,6 +88,77 @@ namespace WeakForms
       template <typename OpType, typename U = void>
       struct BranchEvaluator;
 
+      /**
+       * A struct that evaluates an entire (sub-)tree one quadrature point at
+       * a time.
+       *
+       * Only the leaves of the tree are evaluated at all quadrature points
+       * at once, so that the intermediate results of the unary and binary
+       * operations need not be stored.
+       */
+      template <typename OpType, typename U = void>
+      struct FusedOpEvaluator;
+
+      /**
+       * Apply the unary operation @p op to the (sub-)tree @p operand,
+       * evaluating the whole tree at each quadrature point rather than
+       * producing the values at all quadrature points for each node of the
+       * tree.
+       */
+      template <typename ScalarType,
+                typename UnaryOpType,
+                typename OpType,
+                typename... Arguments>
+      typename UnaryOpType::template return_type<ScalarType>
+      apply_fused_unary_op(const UnaryOpType &op,
+                           const OpType &     operand,
+                           Arguments &...args);
+
+      /**
+       * Apply the unary operation @p op to the (sub-)tree @p operand,
+       * evaluating the whole tree for one batch of quadrature points at a
+       * time.
+       */
+      template <typename ScalarType,
+                std::size_t width,
+                typename UnaryOpType,
+                typename OpType,
+                typename... Arguments>
+      typename UnaryOpType::template vectorized_return_type<ScalarType, width>
+      apply_fused_unary_op(const UnaryOpType &op,
+                           const OpType &     operand,
+                           Arguments &...args);
+
+      /**
+       * The equivalent of apply_fused_unary_op() for a binary operation.
+       */
+      template <typename ScalarType,
+                typename BinaryOpType,
+                typename LhsOpType,
+                typename RhsOpType,
+                typename... Arguments>
+      typename BinaryOpType::template return_type<ScalarType>
+      apply_fused_binary_op(const BinaryOpType &op,
+                            const LhsOpType &   lhs_operand,
+                            const RhsOpType &   rhs_operand,
+                            Arguments &...args);
+
+      /**
+       * The equivalent of apply_fused_unary_op() for a binary operation,
+       * evaluated for one batch of quadrature points at a time.
+       */
+      template <typename ScalarType,
+                std::size_t width,
+                typename BinaryOpType,
+                typename LhsOpType,
+                typename RhsOpType,
+                typename... Arguments>
+      typename BinaryOpType::template vectorized_return_type<ScalarType, width>
+      apply_fused_binary_op(const BinaryOpType &op,
+                            const LhsOpType &   lhs_operand,
+                            const RhsOpType &   rhs_operand,
+                            Arguments &...args);
+
 
       // ---- SYMBOLIC OPERATORS -----
       // These represent the terminal points on the expression tree.
@@ -505,9 +577,7 @@ namespace WeakForms
           // return op.template operator()<ScalarType>(
           //   operand.template operator()<ScalarType>(fe_values));
 
-          return op.template operator()<ScalarType>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType>(operand,
-                                                                   fe_values));
+          return apply_fused_unary_op<ScalarType>(op, operand, fe_values);
         }
 
         template <typename ScalarType,
@@ -564,9 +634,10 @@ namespace WeakForms
               const FEValuesType &                fe_values,
               const types::vectorized_qp_range_t &q_point_range)
         {
-          return op.template operator()<ScalarType, width>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType, width>(
-              operand, fe_values, q_point_range));
+          return apply_fused_unary_op<ScalarType, width>(op,
+                                                         operand,
+                                                         fe_values,
+                                                         q_point_range);
         }
 
         template <typename ScalarType,
@@ -628,9 +699,10 @@ namespace WeakForms
           //   operand.template operator()<ScalarType>(scratch_data,
           //                                           solution_extraction_data));
 
-          return op.template operator()<ScalarType>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType>(
-              operand, scratch_data, solution_extraction_data));
+          return apply_fused_unary_op<ScalarType>(op,
+                                                  operand,
+                                                  scratch_data,
+                                                  solution_extraction_data);
         }
 
         template <typename ScalarType,
@@ -654,9 +726,8 @@ namespace WeakForms
           //                                           scratch_data,
           //                                           solution_extraction_data));
 
-          return op.template operator()<ScalarType>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType>(
-              operand, fe_values, scratch_data, solution_extraction_data));
+          return apply_fused_unary_op<ScalarType>(
+            op, operand, fe_values, scratch_data, solution_extraction_data);
         }
 
         template <typename ScalarType,
@@ -676,9 +747,8 @@ namespace WeakForms
         {
           (void)fe_values_dofs;
 
-          return op.template operator()<ScalarType>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType>(
-              operand, fe_values_op, scratch_data, solution_extraction_data));
+          return apply_fused_unary_op<ScalarType>(
+            op, operand, fe_values_op, scratch_data, solution_extraction_data);
         }
 
         // ----- VECTORIZATION -----
@@ -697,9 +767,8 @@ namespace WeakForms
                 &                                 solution_extraction_data,
               const types::vectorized_qp_range_t &q_point_range)
         {
-          return op.template operator()<ScalarType, width>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType, width>(
-              operand, scratch_data, solution_extraction_data, q_point_range));
+          return apply_fused_unary_op<ScalarType, width>(
+            op, operand, scratch_data, solution_extraction_data, q_point_range);
         }
 
         template <typename ScalarType,
@@ -718,13 +787,13 @@ namespace WeakForms
                 &                                 solution_extraction_data,
               const types::vectorized_qp_range_t &q_point_range)
         {
-          return op.template operator()<ScalarType, width>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType, width>(
-              operand,
-              fe_values,
-              scratch_data,
-              solution_extraction_data,
-              q_point_range));
+          return apply_fused_unary_op<ScalarType, width>(
+            op,
+            operand,
+            fe_values,
+            scratch_data,
+            solution_extraction_data,
+            q_point_range);
         }
 
         template <typename ScalarType,
@@ -747,13 +816,13 @@ namespace WeakForms
         {
           (void)fe_values_dofs;
 
-          return op.template operator()<ScalarType, width>(
-            BranchEvaluator<OpType>::template evaluate<ScalarType, width>(
-              operand,
-              fe_values_op,
-              scratch_data,
-              solution_extraction_data,
-              q_point_range));
+          return apply_fused_unary_op<ScalarType, width>(
+            op,
+            operand,
+            fe_values_op,
+            scratch_data,
+            solution_extraction_data,
+            q_point_range);
         }
       };
 
@@ -1015,11 +1084,32 @@ namespace WeakForms
         template <typename ScalarType,
                   typename BinaryOpType,
                   typename... Arguments>
-        static typename BinaryOpType::template return_type<ScalarType>
+        static auto
+        apply(const BinaryOpType &op,
+              const LhsOpType &   lhs_operand,
+              const RhsOpType &   rhs_operand,
+              Arguments &...args) ->
+          typename std::enable_if<
+            !is_or_has_test_function_or_trial_solution_op<LhsOpType>::value &&
+              !is_or_has_test_function_or_trial_solution_op<RhsOpType>::value,
+            typename BinaryOpType::template return_type<ScalarType>>::type
+        {
+          return apply_fused_binary_op<ScalarType>(
+            op, lhs_operand, rhs_operand, args...);
+        }
+
+        template <typename ScalarType,
+                  typename BinaryOpType,
+                  typename... Arguments>
+        static auto
         apply(const BinaryOpType &op,
               const LhsOpType &   lhs_operand,
               const RhsOpType &   rhs_operand,
-              Arguments &...args)
+              Arguments &...args) ->
+          typename std::enable_if<
+            is_or_has_test_function_or_trial_solution_op<LhsOpType>::value ||
+              is_or_has_test_function_or_trial_solution_op<RhsOpType>::value,
+            typename BinaryOpType::template return_type<ScalarType>>::type
         {
           return op.template operator()<ScalarType>(
             BranchEvaluator<LhsOpType>::template evaluate<ScalarType>(
@@ -1036,13 +1126,35 @@ namespace WeakForms
                   std::size_t width,
                   typename BinaryOpType,
                   typename... Arguments>
-        static
-          typename BinaryOpType::template vectorized_return_type<ScalarType,
-                                                                 width>
-          apply(const BinaryOpType &op,
-                const LhsOpType &   lhs_operand,
-                const RhsOpType &   rhs_operand,
-                Arguments &...args)
+        static auto
+        apply(const BinaryOpType &op,
+              const LhsOpType &   lhs_operand,
+              const RhsOpType &   rhs_operand,
+              Arguments &...args) ->
+          typename std::enable_if<
+            !is_or_has_test_function_or_trial_solution_op<LhsOpType>::value &&
+              !is_or_has_test_function_or_trial_solution_op<RhsOpType>::value,
+            typename BinaryOpType::template vectorized_return_type<ScalarType,
+                                                                   width>>::type
+        {
+          return apply_fused_binary_op<ScalarType, width>(
+            op, lhs_operand, rhs_operand, args...);
+        }
+
+        template <typename ScalarType,
+                  std::size_t width,
+                  typename BinaryOpType,
+                  typename... Arguments>
+        static auto
+        apply(const BinaryOpType &op,
+              const LhsOpType &   lhs_operand,
+              const RhsOpType &   rhs_operand,
+              Arguments &...args) ->
+          typename std::enable_if<
+            is_or_has_test_function_or_trial_solution_op<LhsOpType>::value ||
+              is_or_has_test_function_or_trial_solution_op<RhsOpType>::value,
+            typename BinaryOpType::template vectorized_return_type<ScalarType,
+                                                                   width>>::type
         {
           return op.template operator()<ScalarType, width>(
             BranchEvaluator<LhsOpType>::template evaluate<ScalarType, width>(
@@ -1562,6 +1674,311 @@ namespace WeakForms
         }
       };
 
+
+
+      // ---- FUSED EVALUATORS -----
+      // These are only used for trees that do not contain test functions or
+      // trial solutions, i.e. for which each node has exactly one value per
+      // quadrature point (or per batch of quadrature points).
+
+      template <typename OpType>
+      struct FusedOpEvaluator<
+        OpType,
+        typename std::enable_if<!is_unary_op<OpType>::value &&
+                                !is_binary_op<OpType>::value>::type>
+      {
+        static_assert(
+          !is_or_has_test_function_or_trial_solution_op<OpType>::value,
+          "Fused evaluation is not possible for test functions or trial "
+          "solutions.");
+
+        // Leaves are evaluated at all quadrature points at once.
+        template <typename ScalarType, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return BranchEvaluator<OpType>::template evaluate<ScalarType>(
+            op, args...);
+        }
+
+        template <typename ScalarType, std::size_t width, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return BranchEvaluator<OpType>::template evaluate<ScalarType, width>(
+            op, args...);
+        }
+
+        template <typename LeafValuesType>
+        static unsigned int
+        n_q_points(const LeafValuesType &leaf_values)
+        {
+          return leaf_values.size();
+        }
+
+        template <typename ScalarType, typename LeafValuesType>
+        static const typename LeafValuesType::value_type &
+        value(const OpType &         op,
+              const LeafValuesType & leaf_values,
+              const unsigned int     q_point)
+        {
+          (void)op;
+          Assert(q_point < leaf_values.size(),
+                 ExcIndexRange(q_point, 0, leaf_values.size()));
+          return leaf_values[q_point];
+        }
+
+        template <typename ScalarType,
+                  std::size_t width,
+                  typename LeafValuesType>
+        static const LeafValuesType &
+        value(const OpType &op, const LeafValuesType &leaf_values)
+        {
+          (void)op;
+          return leaf_values;
+        }
+      };
+
+
+      template <typename OpType>
+      struct FusedOpEvaluator<
+        OpType,
+        typename std::enable_if<is_unary_op<OpType>::value>::type>
+      {
+        using OperandEvaluator = FusedOpEvaluator<typename OpType::OpType>;
+
+        template <typename ScalarType, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return OperandEvaluator::template gather<ScalarType>(
+            op.get_operand(), args...);
+        }
+
+        template <typename ScalarType, std::size_t width, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return OperandEvaluator::template gather<ScalarType, width>(
+            op.get_operand(), args...);
+        }
+
+        template <typename LeafValuesType>
+        static unsigned int
+        n_q_points(const LeafValuesType &leaf_values)
+        {
+          return OperandEvaluator::n_q_points(leaf_values);
+        }
+
+        template <typename ScalarType, typename LeafValuesType>
+        static typename OpType::template value_type<ScalarType>
+        value(const OpType &         op,
+              const LeafValuesType & leaf_values,
+              const unsigned int     q_point)
+        {
+          return op.template operator()<ScalarType>(
+            OperandEvaluator::template value<ScalarType>(op.get_operand(),
+                                                         leaf_values,
+                                                         q_point));
+        }
+
+        template <typename ScalarType,
+                  std::size_t width,
+                  typename LeafValuesType>
+        static auto
+        value(const OpType &op, const LeafValuesType &leaf_values)
+        {
+          return op.template operator()<ScalarType, width>(
+            OperandEvaluator::template value<ScalarType, width>(
+              op.get_operand(), leaf_values));
+        }
+      };
+
+
+      template <typename OpType>
+      struct FusedOpEvaluator<
+        OpType,
+        typename std::enable_if<is_binary_op<OpType>::value>::type>
+      {
+        using LhsEvaluator = FusedOpEvaluator<typename OpType::LhsOpType>;
+        using RhsEvaluator = FusedOpEvaluator<typename OpType::RhsOpType>;
+
+        template <typename ScalarType, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return std::make_pair(
+            LhsEvaluator::template gather<ScalarType>(op.get_lhs_operand(),
+                                                      args...),
+            RhsEvaluator::template gather<ScalarType>(op.get_rhs_operand(),
+                                                      args...));
+        }
+
+        template <typename ScalarType, std::size_t width, typename... Arguments>
+        static auto
+        gather(const OpType &op, Arguments &...args)
+        {
+          return std::make_pair(
+            LhsEvaluator::template gather<ScalarType, width>(
+              op.get_lhs_operand(), args...),
+            RhsEvaluator::template gather<ScalarType, width>(
+              op.get_rhs_operand(), args...));
+        }
+
+        template <typename LeafValuesType>
+        static unsigned int
+        n_q_points(const LeafValuesType &leaf_values)
+        {
+          Assert(LhsEvaluator::n_q_points(leaf_values.first) ==
+                   RhsEvaluator::n_q_points(leaf_values.second),
+                 ExcDimensionMismatch(
+                   LhsEvaluator::n_q_points(leaf_values.first),
+                   RhsEvaluator::n_q_points(leaf_values.second)));
+          return LhsEvaluator::n_q_points(leaf_values.first);
+        }
+
+        template <typename ScalarType, typename LeafValuesType>
+        static typename OpType::template value_type<ScalarType>
+        value(const OpType &         op,
+              const LeafValuesType & leaf_values,
+              const unsigned int     q_point)
+        {
+          return op.template operator()<ScalarType>(
+            LhsEvaluator::template value<ScalarType>(op.get_lhs_operand(),
+                                                     leaf_values.first,
+                                                     q_point),
+            RhsEvaluator::template value<ScalarType>(op.get_rhs_operand(),
+                                                     leaf_values.second,
+                                                     q_point));
+        }
+
+        template <typename ScalarType,
+                  std::size_t width,
+                  typename LeafValuesType>
+        static auto
+        value(const OpType &op, const LeafValuesType &leaf_values)
+        {
+          return op.template operator()<ScalarType, width>(
+            LhsEvaluator::template value<ScalarType, width>(
+              op.get_lhs_operand(), leaf_values.first),
+            RhsEvaluator::template value<ScalarType, width>(
+              op.get_rhs_operand(), leaf_values.second));
+        }
+      };
+
+
+      template <typename ScalarType,
+                typename UnaryOpType,
+                typename OpType,
+                typename... Arguments>
+      typename UnaryOpType::template return_type<ScalarType>
+      apply_fused_unary_op(const UnaryOpType &op,
+                           const OpType &     operand,
+                           Arguments &...args)
+      {
+        using FusedEvaluator = FusedOpEvaluator<OpType>;
+        const auto leaf_values =
+          FusedEvaluator::template gather<ScalarType>(operand, args...);
+        const unsigned int n_q_points = FusedEvaluator::n_q_points(leaf_values);
+
+        typename UnaryOpType::template return_type<ScalarType> out;
+        out.reserve(n_q_points);
+        for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
+          out.emplace_back(op.template operator()<ScalarType>(
+            FusedEvaluator::template value<ScalarType>(operand,
+                                                       leaf_values,
+                                                       q_point)));
+
+        return out;
+      }
+
+
+      template <typename ScalarType,
+                std::size_t width,
+                typename UnaryOpType,
+                typename OpType,
+                typename... Arguments>
+      typename UnaryOpType::template vectorized_return_type<ScalarType, width>
+      apply_fused_unary_op(const UnaryOpType &op,
+                           const OpType &     operand,
+                           Arguments &...args)
+      {
+        using FusedEvaluator = FusedOpEvaluator<OpType>;
+        const auto leaf_values =
+          FusedEvaluator::template gather<ScalarType, width>(operand, args...);
+
+        return op.template operator()<ScalarType, width>(
+          FusedEvaluator::template value<ScalarType, width>(operand,
+                                                            leaf_values));
+      }
+
+
+      template <typename ScalarType,
+                typename BinaryOpType,
+                typename LhsOpType,
+                typename RhsOpType,
+                typename... Arguments>
+      typename BinaryOpType::template return_type<ScalarType>
+      apply_fused_binary_op(const BinaryOpType &op,
+                            const LhsOpType &   lhs_operand,
+                            const RhsOpType &   rhs_operand,
+                            Arguments &...args)
+      {
+        using LhsFusedEvaluator = FusedOpEvaluator<LhsOpType>;
+        using RhsFusedEvaluator = FusedOpEvaluator<RhsOpType>;
+        const auto lhs_leaf_values =
+          LhsFusedEvaluator::template gather<ScalarType>(lhs_operand, args...);
+        const auto rhs_leaf_values =
+          RhsFusedEvaluator::template gather<ScalarType>(rhs_operand, args...);
+        const unsigned int n_q_points =
+          LhsFusedEvaluator::n_q_points(lhs_leaf_values);
+        Assert(RhsFusedEvaluator::n_q_points(rhs_leaf_values) == n_q_points,
+               ExcDimensionMismatch(
+                 RhsFusedEvaluator::n_q_points(rhs_leaf_values), n_q_points));
+
+        typename BinaryOpType::template return_type<ScalarType> out;
+        out.reserve(n_q_points);
+        for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
+          out.emplace_back(op.template operator()<ScalarType>(
+            LhsFusedEvaluator::template value<ScalarType>(lhs_operand,
+                                                          lhs_leaf_values,
+                                                          q_point),
+            RhsFusedEvaluator::template value<ScalarType>(rhs_operand,
+                                                          rhs_leaf_values,
+                                                          q_point)));
+
+        return out;
+      }
+
+
+      template <typename ScalarType,
+                std::size_t width,
+                typename BinaryOpType,
+                typename LhsOpType,
+                typename RhsOpType,
+                typename... Arguments>
+      typename BinaryOpType::template vectorized_return_type<ScalarType, width>
+      apply_fused_binary_op(const BinaryOpType &op,
+                            const LhsOpType &   lhs_operand,
+                            const RhsOpType &   rhs_operand,
+                            Arguments &...args)
+      {
+        using LhsFusedEvaluator = FusedOpEvaluator<LhsOpType>;
+        using RhsFusedEvaluator = FusedOpEvaluator<RhsOpType>;
+        const auto lhs_leaf_values =
+          LhsFusedEvaluator::template gather<ScalarType, width>(lhs_operand,
+                                                                args...);
+        const auto rhs_leaf_values =
+          RhsFusedEvaluator::template gather<ScalarType, width>(rhs_operand,
+                                                                args...);
+
+        return op.template operator()<ScalarType, width>(
+          LhsFusedEvaluator::template value<ScalarType, width>(lhs_operand,
+                                                               lhs_leaf_values),
+          RhsFusedEvaluator::template value<ScalarType, width>(
+            rhs_operand, rhs_leaf_values));
+      }
+
     } // namespace internal
   }   // namespace Operators
 
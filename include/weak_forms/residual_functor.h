@@ -754,6 +754,9 @@ namespace WeakForms
         , function(function)
         , update_flags(update_flags)
         , extractors(OpHelper_t::get_initialized_extractors())
+        , slot_ad_helper(AD_SD_Functor_Cache::get_slot(get_name_ad_helper()))
+        , slot_values(AD_SD_Functor_Cache::get_slot(get_name_value()))
+        , slot_jacobians(AD_SD_Functor_Cache::get_slot(get_name_jacobian()))
       {}
 
       std::string
@@ -786,10 +789,10 @@ namespace WeakForms
       get_ad_helper(
         const MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        const GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        const WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
-        return cache.get_object_with_name<ad_helper_type>(get_name_ad_helper());
+        return cache.get_object<ad_helper_type>(slot_ad_helper);
       }
 
       const TestSpaceOp &
@@ -818,22 +821,21 @@ namespace WeakForms
       get_values(
         const MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        const GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        const WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
-        return cache.get_object_with_name<std::vector<Vector<scalar_type>>>(
-          get_name_value());
+        return cache.get_object<std::vector<Vector<scalar_type>>>(slot_values);
       }
 
       const std::vector<FullMatrix<scalar_type>> &
       get_jacobians(
         const MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        const GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        const WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
-        return cache.get_object_with_name<std::vector<FullMatrix<scalar_type>>>(
-          get_name_jacobian());
+        return cache.get_object<std::vector<FullMatrix<scalar_type>>>(
+          slot_jacobians);
       }
 
       /**
@@ -951,6 +953,13 @@ namespace WeakForms
       const typename OpHelper_t::field_extractors_t
         extractors; // FEValuesExtractors to work with multi-component fields
 
+      // The slots in the AD/SD cache that the ADHelper and its results are
+      // stored in. These are fixed upon construction, so that no names need
+      // to be built during assembly.
+      const WeakForms::internal::AD_SD_CacheSlot slot_ad_helper;
+      const WeakForms::internal::AD_SD_CacheSlot slot_values;
+      const WeakForms::internal::AD_SD_CacheSlot slot_jacobians;
+
       std::string
       get_name_ad_helper() const
       {
@@ -980,9 +989,8 @@ namespace WeakForms
       get_mutable_ad_helper(
         MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
-        const std::string name_ad_helper = get_name_ad_helper();
+        WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
         // Unfortunately we cannot perform a check like this because the
         // ScratchData is reused by many cells during the mesh loop. So
@@ -990,19 +998,19 @@ namespace WeakForms
         // re-using an object because they forget to uniquely name the
         // ResidualFunctor upon which this op is based.
         //
-        // Assert(!(cache.stores_object_with_name(name_ad_helper)),
+        // Assert(!(cache.stores_object(slot_ad_helper)),
         //        ExcMessage("ADHelper is already present in the cache."));
 
         // Keep these as non-const:
         // Work around a GCC bug, where it cannot disambiguate between a lvalue
-        // and rvalue template parameter in
-        // GeneralDataStorage::get_or_add_object_with_name()
+        // and rvalue template parameter when these are forwarded to the
+        // constructor of the cached object.
         unsigned int n_dependent_variables =
           Operators::internal::SpaceOpComponentInfo<TestSpaceOp>::n_components;
         unsigned int n_independent_variables = OpHelper_t::get_n_components();
 
-        return cache.get_or_add_object_with_name<ad_helper_type>(
-          name_ad_helper,
+        return cache.get_or_add_object<ad_helper_type>(
+          slot_ad_helper,
           std::move(n_independent_variables),
           std::move(n_dependent_variables));
       }
@@ -1011,16 +1019,15 @@ namespace WeakForms
       get_mutable_values(MeshWorker::ScratchData<dim, spacedim> &scratch_data,
                          const ad_helper_type &ad_helper) const
       {
-        GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
         const FEValuesBase<dim, spacedim> &fe_values =
           scratch_data.get_current_fe_values();
 
-        return cache
-          .get_or_add_object_with_name<std::vector<Vector<scalar_type>>>(
-            get_name_value(),
-            fe_values.n_quadrature_points,
-            Vector<scalar_type>(ad_helper.n_dependent_variables()));
+        return cache.get_or_add_object<std::vector<Vector<scalar_type>>>(
+          slot_values,
+          fe_values.n_quadrature_points,
+          Vector<scalar_type>(ad_helper.n_dependent_variables()));
       }
 
       std::vector<FullMatrix<scalar_type>> &
@@ -1028,17 +1035,16 @@ namespace WeakForms
         MeshWorker::ScratchData<dim, spacedim> &scratch_data,
         const ad_helper_type &                  ad_helper) const
       {
-        GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
         const FEValuesBase<dim, spacedim> &fe_values =
           scratch_data.get_current_fe_values();
 
-        return cache
-          .get_or_add_object_with_name<std::vector<FullMatrix<scalar_type>>>(
-            get_name_jacobian(),
-            fe_values.n_quadrature_points,
-            FullMatrix<scalar_type>(ad_helper.n_dependent_variables(),
-                                    ad_helper.n_independent_variables()));
+        return cache.get_or_add_object<std::vector<FullMatrix<scalar_type>>>(
+          slot_jacobians,
+          fe_values.n_quadrature_points,
+          FullMatrix<scalar_type>(ad_helper.n_dependent_variables(),
+                                  ad_helper.n_independent_variables()));
       }
     };
 
@@ -1159,9 +1165,10 @@ namespace WeakForms
         , optimization_method(optimization_method)
         , optimization_flags(optimization_flags)
         , update_flags(update_flags)
-        , name_sd_batch_optimizer(get_name_sd_batch_optimizer(operand))
-        , name_evaluated_dependent_functions(
-            get_name_evaluated_dependent_functions(operand))
+        , slot_sd_batch_optimizer(AD_SD_Functor_Cache::get_slot(
+            get_name_sd_batch_optimizer(operand)))
+        , slot_evaluated_dependent_functions(AD_SD_Functor_Cache::get_slot(
+            get_name_evaluated_dependent_functions(operand)))
         , symbolic_fields(OpHelper_t::template get_symbolic_fields<sd_type>(
             get_field_args(),
             SymbolicDecorations()))
@@ -1207,11 +1214,11 @@ namespace WeakForms
       get_batch_optimizer(
         const MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        const GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        const WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
-        return cache.get_object_with_name<sd_helper_type<ResultScalarType>>(
-          name_sd_batch_optimizer);
+        return cache.get_object<sd_helper_type<ResultScalarType>>(
+          slot_sd_batch_optimizer);
       }
 
       const auto &
@@ -1235,12 +1242,11 @@ namespace WeakForms
       get_evaluated_dependent_functions(
         const MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        const GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        const WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
-        return cache
-          .get_object_with_name<std::vector<std::vector<ResultScalarType>>>(
-            name_evaluated_dependent_functions);
+        return cache.get_object<std::vector<std::vector<ResultScalarType>>>(
+          slot_evaluated_dependent_functions);
       }
 
       /**
@@ -1449,9 +1455,11 @@ namespace WeakForms
       // evaluate their SD function (e.g. UpdateFlags::update_quadrature_points)
       const UpdateFlags update_flags;
 
-      // Naming
-      const std::string name_sd_batch_optimizer;
-      const std::string name_evaluated_dependent_functions;
+      // The slots in the AD/SD cache that the BatchOptimizer and its results
+      // are stored in.
+      const WeakForms::internal::AD_SD_CacheSlot slot_sd_batch_optimizer;
+      const WeakForms::internal::AD_SD_CacheSlot
+        slot_evaluated_dependent_functions;
 
       // Independent variables
       const typename OpHelper_t::template field_values_t<sd_type>
@@ -1488,8 +1496,8 @@ namespace WeakForms
       get_mutable_sd_batch_optimizer(
         MeshWorker::ScratchData<dim, spacedim> &scratch_data) const
       {
-        GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
 
         // Unfortunately we cannot perform a check like this because the
         // ScratchData is reused by many cells during the mesh loop. So
@@ -1497,23 +1505,22 @@ namespace WeakForms
         // re-using an object because they forget to uniquely name the
         // ResidualFunctor upon which this op is based.
         //
-        // Assert(!(cache.stores_object_with_name(name_sd_batch_optimizer)),
+        // Assert(!(cache.stores_object(slot_sd_batch_optimizer)),
         //        ExcMessage("SDBatchOptimizer is already present in the
         //        cache."));
 
         // Work around a GCC bug, where it cannot disambiguate between a lvalue
-        // and rvalue template parameter in
-        // GeneralDataStorage::get_or_add_object_with_name()
+        // and rvalue template parameter when these are forwarded to the
+        // constructor of the cached object.
         enum Differentiation::SD::OptimizerType nc_optimization_method =
           this->optimization_method;
         enum Differentiation::SD::OptimizationFlags nc_optimization_flags =
           this->optimization_flags;
 
-        return cache
-          .get_or_add_object_with_name<sd_helper_type<ResultScalarType>>(
-            name_sd_batch_optimizer,
-            std::move(nc_optimization_method),
-            std::move(nc_optimization_flags));
+        return cache.get_or_add_object<sd_helper_type<ResultScalarType>>(
+          slot_sd_batch_optimizer,
+          std::move(nc_optimization_method),
+          std::move(nc_optimization_flags));
       }
 
       template <typename ResultScalarType>
@@ -1522,14 +1529,14 @@ namespace WeakForms
         MeshWorker::ScratchData<dim, spacedim> &scratch_data,
         const sd_helper_type<ResultScalarType> &batch_optimizer) const
       {
-        GeneralDataStorage &cache =
-          AD_SD_Functor_Cache::get_cache(scratch_data);
+        WeakForms::internal::AD_SD_CacheSlotTable &cache =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
         const FEValuesBase<dim, spacedim> &fe_values =
           scratch_data.get_current_fe_values();
 
-        return cache.get_or_add_object_with_name<
+        return cache.get_or_add_object<
           std::vector<std::vector<ResultScalarType>>>(
-          name_evaluated_dependent_functions,
+          slot_evaluated_dependent_functions,
           fe_values.n_quadrature_points,
           std::vector<ResultScalarType>(
             batch_optimizer.n_dependent_variables()));
@@ -0,0 +1,320 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii_weakforms_scratch_data_pool_h
+#define dealii_weakforms_scratch_data_pool_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/quadrature.h>
+
+#include <deal.II/fe/fe.h>
+#include <deal.II/fe/fe_update_flags.h>
+
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/q_collection.h>
+
+#include <weak_forms/config.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * A description of everything that a ScratchData object, as used by
+     * the assemblers, depends on. If any of this changes between two
+     * assembly calls, then the ScratchData objects must be rebuilt.
+     */
+    struct ScratchDataPoolKey
+    {
+      ScratchDataPoolKey()
+        : dof_handler(nullptr)
+        , cell_update_flags(update_default)
+        , face_update_flags(update_default)
+      {}
+
+      const void *              dof_handler;
+      std::vector<const void *> finite_elements;
+      std::vector<std::string>  finite_element_names;
+      std::vector<double>       quadrature_data;
+      UpdateFlags               cell_update_flags;
+      UpdateFlags               face_update_flags;
+
+      bool
+      operator==(const ScratchDataPoolKey &other) const
+      {
+        return dof_handler == other.dof_handler &&
+               finite_elements == other.finite_elements &&
+               finite_element_names == other.finite_element_names &&
+               quadrature_data == other.quadrature_data &&
+               cell_update_flags == other.cell_update_flags &&
+               face_update_flags == other.face_update_flags;
+      }
+
+      bool
+      operator!=(const ScratchDataPoolKey &other) const
+      {
+        return !(*this == other);
+      }
+
+      template <int dim, int spacedim>
+      void
+      add(const FiniteElement<dim, spacedim> &finite_element)
+      {
+        finite_elements.push_back(&finite_element);
+        finite_element_names.push_back(finite_element.get_name());
+      }
+
+      template <int dim, int spacedim>
+      void
+      add(const hp::FECollection<dim, spacedim> &fe_collection)
+      {
+        for (unsigned int i = 0; i < fe_collection.size(); ++i)
+          add(fe_collection[i]);
+      }
+
+      template <int dim>
+      void
+      add(const Quadrature<dim> &quadrature)
+      {
+        // Delimit each quadrature rule by its size, so that a change in the
+        // way that the points are split up between rules is also detected.
+        quadrature_data.push_back(quadrature.size());
+        for (unsigned int q = 0; q < quadrature.size(); ++q)
+          {
+            for (unsigned int d = 0; d < dim; ++d)
+              quadrature_data.push_back(quadrature.point(q)[d]);
+            quadrature_data.push_back(quadrature.weight(q));
+          }
+      }
+
+      template <int dim>
+      void
+      add(const hp::QCollection<dim> &q_collection)
+      {
+        for (unsigned int i = 0; i < q_collection.size(); ++i)
+          add(q_collection[i]);
+      }
+
+      void
+      add(const std::nullptr_t *const)
+      {}
+
+      template <typename QuadratureType>
+      void
+      add(const QuadratureType *const quadrature)
+      {
+        quadrature_data.push_back(-1.0);
+        if (quadrature)
+          add(*quadrature);
+      }
+    };
+
+
+    /**
+     * A pool of ScratchData objects that persists across assembly calls.
+     *
+     * Constructing a ScratchData object means constructing (and
+     * initializing) its FEValues objects, which is costly. Since the
+     * WorkStream copies the sample ScratchData for each thread on every
+     * assembly call, this would otherwise happen many times over when
+     * assembling repeatedly, e.g. within a nonlinear solver. Instead, a
+     * lightweight Handle is passed to the WorkStream in place of the
+     * ScratchData itself, and each handle draws a ScratchData object from
+     * this pool when it is first used. The objects are returned to the pool
+     * once the handle is destroyed, and are only discarded if the
+     * ScratchDataPoolKey changes.
+     */
+    template <typename ScratchData>
+    class ScratchDataPool
+    {
+    public:
+      class Handle
+      {
+      public:
+        explicit Handle(ScratchDataPool &pool)
+          : pool(&pool)
+          , scratch_data(nullptr)
+        {}
+
+        // A copy acquires its own ScratchData object from the pool.
+        Handle(const Handle &other)
+          : pool(other.pool)
+          , scratch_data(nullptr)
+        {}
+
+        Handle &
+        operator=(const Handle &other)
+        {
+          release();
+          pool = other.pool;
+          return *this;
+        }
+
+        ~Handle()
+        {
+          release();
+        }
+
+        /**
+         * Return the ScratchData object that is associated with this handle.
+         */
+        ScratchData &
+        get()
+        {
+          if (scratch_data == nullptr)
+            scratch_data = &pool->acquire();
+          return *scratch_data;
+        }
+
+      private:
+        ScratchDataPool *pool;
+        ScratchData *    scratch_data;
+
+        void
+        release()
+        {
+          if (scratch_data != nullptr)
+            pool->release(*scratch_data);
+          scratch_data = nullptr;
+        }
+      };
+
+
+      ScratchDataPool()
+        : n_objects_in_use(0)
+      {}
+
+      // Pools are never shared, so a copy starts out empty.
+      ScratchDataPool(const ScratchDataPool &)
+        : ScratchDataPool()
+      {}
+
+      ScratchDataPool &
+      operator=(const ScratchDataPool &)
+      {
+        clear();
+        return *this;
+      }
+
+      /**
+       * Prepare the pool for an assembly with the given @p key, and return
+       * a handle that can be used as the sample scratch data for the
+       * WorkStream. If the @p key differs from that of the previous
+       * assembly, then all pooled objects are discarded and the sample
+       * ScratchData is rebuilt using the @p construct_scratch_data function.
+       */
+      template <typename ScratchDataConstructor>
+      Handle
+      initialize(const ScratchDataPoolKey &    key,
+                 const ScratchDataConstructor &construct_scratch_data)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!sample_scratch_data || key != this->key)
+          {
+            Assert(n_objects_in_use == 0,
+                   ExcMessage("Cannot rebuild the scratch data pool while "
+                              "some of its objects are in use."));
+            free_objects.clear();
+            objects.clear();
+            sample_scratch_data.reset(
+              new ScratchData(construct_scratch_data()));
+            this->key = key;
+          }
+
+        return Handle(*this);
+      }
+
+      /**
+       * Discard all pooled objects.
+       */
+      void
+      clear()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Assert(n_objects_in_use == 0,
+               ExcMessage("Cannot clear the scratch data pool while some of "
+                          "its objects are in use."));
+        free_objects.clear();
+        objects.clear();
+        sample_scratch_data.reset();
+        key = ScratchDataPoolKey();
+      }
+
+    private:
+      ScratchDataPoolKey                        key;
+      std::unique_ptr<ScratchData>              sample_scratch_data;
+      std::vector<std::unique_ptr<ScratchData>> objects;
+      std::vector<ScratchData *>                free_objects;
+      unsigned int                              n_objects_in_use;
+      std::mutex                                mutex;
+
+      ScratchData &
+      acquire()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          Assert(sample_scratch_data, ExcNotInitialized());
+
+          ++n_objects_in_use;
+          if (!free_objects.empty())
+            {
+              ScratchData *scratch_data = free_objects.back();
+              free_objects.pop_back();
+              return *scratch_data;
+            }
+        }
+
+        // Building a new object is costly, so we don't hold the lock while
+        // doing so. The sample is not modified while objects are in use.
+        std::unique_ptr<ScratchData> scratch_data(
+          new ScratchData(*sample_scratch_data));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        objects.emplace_back(std::move(scratch_data));
+        return *objects.back();
+      }
+
+      void
+      release(ScratchData &scratch_data)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        Assert(n_objects_in_use > 0, ExcInternalError());
+
+        --n_objects_in_use;
+        free_objects.push_back(&scratch_data);
+      }
+    };
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+#endif // dealii_weakforms_scratch_data_pool_h
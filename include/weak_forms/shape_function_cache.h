@@ -0,0 +1,489 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+#ifndef dealii_weakforms_shape_function_cache_h
+#define dealii_weakforms_shape_function_cache_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/algorithms/general_data_storage.h>
+
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/utilities.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/config.h>
+#include <weak_forms/operator_evaluators.h>
+#include <weak_forms/solution_extraction_data.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_views.h>
+#include <weak_forms/type_traits.h>
+#include <weak_forms/types.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * A trait that determines whether or not the shape function data
+     * associated with a test function or trial solution operation can be
+     * shared between several forms, and what identifies that data.
+     *
+     * Only the elementary operations (value, gradient, etc.) of a full space
+     * or subspace view are considered. Their result depends solely on the
+     * operation code, the subspace that it acts on, and the finite element
+     * data that it is evaluated with. In particular, the test function and
+     * trial solution of the same subspace share the same shape function data.
+     * Composite operations may carry additional state, and are therefore
+     * never cached.
+     */
+    template <typename SpaceOp, typename T = void>
+    struct ShapeFunctionCacheTraits
+    {
+      static constexpr bool is_cacheable = false;
+    };
+
+
+    template <enum Operators::SymbolicOpCodes OpCode>
+    struct ShapeFunctionCacheFullSpaceTraits
+    {
+      static constexpr bool is_cacheable = true;
+
+      static constexpr Operators::SymbolicOpCodes op_code = OpCode;
+
+      using extractor_t = void;
+
+      template <typename SpaceOp>
+      static unsigned int
+      first_component(const SpaceOp &)
+      {
+        return 0;
+      }
+    };
+
+
+    template <int dim, int spacedim, enum Operators::SymbolicOpCodes OpCode>
+    struct ShapeFunctionCacheTraits<
+      Operators::SymbolicOp<TestFunction<dim, spacedim>, OpCode>>
+      : ShapeFunctionCacheFullSpaceTraits<OpCode>
+    {};
+
+
+    template <int dim, int spacedim, enum Operators::SymbolicOpCodes OpCode>
+    struct ShapeFunctionCacheTraits<
+      Operators::SymbolicOp<TrialSolution<dim, spacedim>, OpCode>>
+      : ShapeFunctionCacheFullSpaceTraits<OpCode>
+    {};
+
+
+    template <typename SubSpaceViewsType,
+              enum Operators::SymbolicOpCodes OpCode_>
+    struct ShapeFunctionCacheTraits<
+      Operators::SymbolicOp<SubSpaceViewsType, OpCode_>,
+      typename std::enable_if<
+        is_subspace_view<SubSpaceViewsType>::value &&
+        (is_test_function<typename SubSpaceViewsType::SpaceType>::value ||
+         is_trial_solution<typename SubSpaceViewsType::SpaceType>::value)>::
+        type>
+    {
+      static constexpr bool is_cacheable = true;
+
+      static constexpr Operators::SymbolicOpCodes op_code = OpCode_;
+
+      using extractor_t = typename SubSpaceViewsType::extractor_type;
+
+      template <typename SpaceOp>
+      static unsigned int
+      first_component(const SpaceOp &space_op)
+      {
+        return SubSpaceViews::internal::FEValuesExtractorHelper<
+          extractor_t>::first_component(space_op.get_extractor());
+      }
+    };
+
+
+
+    /**
+     * A per-thread cache for the shape function data of test functions and
+     * trial solutions.
+     *
+     * All forms that are assembled on one cell (or face, or interface) with
+     * the same ScratchData object can share the shape function data that
+     * has been extracted for any one of them. This is of particular benefit
+     * when many forms are composed from the same subspaces, as the data for
+     * each subspace operation need only be computed once per cell instead of
+     * once per form.
+     *
+     * The cache is stored in the GeneralDataStorage of a ScratchData object,
+     * so each thread has its own instance. It must be invalidated each time
+     * the ScratchData object is reinitialized; invalidation retains the
+     * already allocated storage, and the data is evaluated directly into it
+     * on the next cell.
+     *
+     * The entries are grouped into slots. Each combination of value type,
+     * subspace extractor type and operation code is a compile-time property
+     * of a form, so it is assigned a slot index exactly once. Finding the
+     * data for a space operation is then an index into the slots, followed
+     * by a search through the few entries of that slot that differ by
+     * their first component, finite element data or quadrature point batch.
+     */
+    class ShapeFunctionCache
+    {
+    public:
+      ShapeFunctionCache()
+        : current_generation(1)
+      {}
+
+      // The ScratchData object (and therefore its cache) is copied for each
+      // thread. The cached data is specific to the finite element data of
+      // the original object, so a copy starts out empty.
+      ShapeFunctionCache(const ShapeFunctionCache &)
+        : current_generation(1)
+      {}
+
+      ShapeFunctionCache &
+      operator=(const ShapeFunctionCache &)
+      {
+        slots.clear();
+        current_generation = 1;
+        return *this;
+      }
+
+      /**
+       * Mark all of the cached data as being outdated.
+       */
+      void
+      invalidate()
+      {
+        ++current_generation;
+      }
+
+      /**
+       * Return the cached shape function data for the @p space_op, evaluated
+       * with the given finite element data and the quadrature points in
+       * @p q_point_range. If there is no valid cached data, then it is
+       * first computed by calling @p evaluate, which receives the storage
+       * of the previous evaluation to write into.
+       */
+      template <typename ValueType,
+                typename SpaceOp,
+                typename FEValuesDofsType,
+                typename FEValuesOpType,
+                typename EvaluationFunctionType>
+      const ValueType &
+      get_or_evaluate(const SpaceOp &                     space_op,
+                      const FEValuesDofsType &            fe_values_dofs,
+                      const FEValuesOpType &              fe_values_op,
+                      const types::vectorized_qp_range_t &q_point_range,
+                      const EvaluationFunctionType &      evaluate)
+      {
+        using Traits = ShapeFunctionCacheTraits<SpaceOp>;
+        static_assert(Traits::is_cacheable,
+                      "This space operation cannot be cached.");
+
+        std::vector<std::unique_ptr<EntryBase>> &slot_entries =
+          get_slot(get_slot_index<ValueType,
+                                  typename Traits::extractor_t,
+                                  Traits::op_code>());
+
+        const EntryKey key{Traits::first_component(space_op),
+                           static_cast<const void *>(&fe_values_dofs),
+                           static_cast<const void *>(&fe_values_op),
+                           (q_point_range.size() > 0 ? q_point_range[0] : 0u),
+                           static_cast<unsigned int>(q_point_range.size())};
+
+        // The type of the stored data is encoded in the slot index.
+        Entry<ValueType> *entry = nullptr;
+        for (const std::unique_ptr<EntryBase> &entry_base : slot_entries)
+          if (entry_base->key == key)
+            {
+              entry = static_cast<Entry<ValueType> *>(entry_base.get());
+              break;
+            }
+
+        if (entry == nullptr)
+          {
+            entry = new Entry<ValueType>(key);
+            slot_entries.emplace_back(entry);
+          }
+
+        if (entry->generation != current_generation)
+          {
+            evaluate(entry->value);
+            entry->generation = current_generation;
+          }
+
+        return entry->value;
+      }
+
+      /**
+       * Return the cache that is associated with the @p scratch_data.
+       */
+      template <int dim, int spacedim>
+      static ShapeFunctionCache &
+      get(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+      {
+        GeneralDataStorage &data_storage =
+          scratch_data.get_general_data_storage();
+        return data_storage.get_or_add_object_with_name<ShapeFunctionCache>(
+          get_name_shape_function_cache());
+      }
+
+      /**
+       * Invalidate the cache that is associated with the @p scratch_data.
+       * This should be called whenever the @p scratch_data has been
+       * reinitialized.
+       */
+      template <int dim, int spacedim>
+      static void
+      invalidate(MeshWorker::ScratchData<dim, spacedim> &scratch_data)
+      {
+        get(scratch_data).invalidate();
+      }
+
+    private:
+      using EntryKey = std::tuple<unsigned int,
+                                  const void *,
+                                  const void *,
+                                  unsigned int,
+                                  unsigned int>;
+
+      struct EntryBase
+      {
+        explicit EntryBase(const EntryKey &key)
+          : key(key)
+        {}
+
+        virtual ~EntryBase() = default;
+
+        const EntryKey key;
+        unsigned int   generation = 0;
+      };
+
+      template <typename ValueType>
+      struct Entry : EntryBase
+      {
+        explicit Entry(const EntryKey &key)
+          : EntryBase(key)
+        {}
+
+        ValueType value;
+      };
+
+      std::vector<std::vector<std::unique_ptr<EntryBase>>> slots;
+      unsigned int current_generation;
+
+      std::vector<std::unique_ptr<EntryBase>> &
+      get_slot(const unsigned int slot)
+      {
+        if (slot >= slots.size())
+          slots.resize(slot + 1);
+        return slots[slot];
+      }
+
+      /**
+       * Return the slot index that is associated with the given combination
+       * of value type, subspace extractor type and operation code. The
+       * index is assigned the first time that any form uses the combination,
+       * and is shared by all threads.
+       */
+      template <typename ValueType,
+                typename ExtractorType,
+                enum Operators::SymbolicOpCodes OpCode>
+      static unsigned int
+      get_slot_index()
+      {
+        static const unsigned int slot = get_n_slots()++;
+        return slot;
+      }
+
+      static std::atomic<unsigned int> &
+      get_n_slots()
+      {
+        static std::atomic<unsigned int> n_slots(0);
+        return n_slots;
+      }
+
+      static const std::string &
+      get_name_shape_function_cache()
+      {
+        static const std::string name =
+          Utilities::get_deal_II_prefix() + "ShapeFunctionCache";
+        return name;
+      }
+    };
+
+
+
+    /**
+     * Evaluate the shape function data of a test function or trial
+     * solution, sharing the result with all other forms that are assembled
+     * with the same @p scratch_data.
+     */
+    template <typename ScalarType,
+              typename TestOrTrialSpaceOp,
+              typename FEValuesDofsType,
+              typename FEValuesOpType,
+              int dim,
+              int spacedim>
+    typename std::enable_if<
+      ShapeFunctionCacheTraits<TestOrTrialSpaceOp>::is_cacheable,
+      const std::vector<std::vector<
+        typename TestOrTrialSpaceOp::template value_type<ScalarType>>> &>::type
+    evaluate_fe_space_cached(
+      const TestOrTrialSpaceOp &              test_or_trial_space_op,
+      const FEValuesDofsType &                fe_values_dofs,
+      const FEValuesOpType &                  fe_values_op,
+      MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      const std::vector<SolutionExtractionData<dim, spacedim>>
+        &solution_extraction_data)
+    {
+      // Elementary space operations do not depend on the solution.
+      (void)solution_extraction_data;
+
+      using ReturnType = std::vector<std::vector<
+        typename TestOrTrialSpaceOp::template value_type<ScalarType>>>;
+
+      return ShapeFunctionCache::get(scratch_data)
+        .template get_or_evaluate<ReturnType>(
+          test_or_trial_space_op,
+          fe_values_dofs,
+          fe_values_op,
+          types::vectorized_qp_range_t(0u, 0u),
+          [&](ReturnType &out)
+          {
+            test_or_trial_space_op.template evaluate_into<ScalarType>(
+              out, fe_values_dofs, fe_values_op);
+          });
+    }
+
+
+    template <typename ScalarType,
+              typename TestOrTrialSpaceOp,
+              typename FEValuesDofsType,
+              typename FEValuesOpType,
+              int dim,
+              int spacedim>
+    typename std::enable_if<
+      !ShapeFunctionCacheTraits<TestOrTrialSpaceOp>::is_cacheable,
+      std::vector<std::vector<
+        typename TestOrTrialSpaceOp::template value_type<ScalarType>>>>::type
+    evaluate_fe_space_cached(
+      const TestOrTrialSpaceOp &              test_or_trial_space_op,
+      const FEValuesDofsType &                fe_values_dofs,
+      const FEValuesOpType &                  fe_values_op,
+      MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      const std::vector<SolutionExtractionData<dim, spacedim>>
+        &solution_extraction_data)
+    {
+      return evaluate_fe_space<ScalarType>(test_or_trial_space_op,
+                                           fe_values_dofs,
+                                           fe_values_op,
+                                           scratch_data,
+                                           solution_extraction_data);
+    }
+
+
+    template <typename ScalarType,
+              std::size_t width,
+              typename TestOrTrialSpaceOp,
+              typename FEValuesDofsType,
+              typename FEValuesOpType,
+              int dim,
+              int spacedim>
+    typename std::enable_if<
+      ShapeFunctionCacheTraits<TestOrTrialSpaceOp>::is_cacheable,
+      const AlignedVector<typename TestOrTrialSpaceOp::
+                            template vectorized_value_type<ScalarType, width>>
+        &>::type
+    evaluate_fe_space_cached(
+      const TestOrTrialSpaceOp &              test_or_trial_space_op,
+      const FEValuesDofsType &                fe_values_dofs,
+      const FEValuesOpType &                  fe_values_op,
+      MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      const std::vector<SolutionExtractionData<dim, spacedim>>
+        &                                 solution_extraction_data,
+      const types::vectorized_qp_range_t &q_point_range)
+    {
+      // Elementary space operations do not depend on the solution.
+      (void)solution_extraction_data;
+
+      using ReturnType = AlignedVector<typename TestOrTrialSpaceOp::
+                                         template vectorized_value_type<ScalarType,
+                                                                        width>>;
+
+      return ShapeFunctionCache::get(scratch_data)
+        .template get_or_evaluate<ReturnType>(
+          test_or_trial_space_op,
+          fe_values_dofs,
+          fe_values_op,
+          q_point_range,
+          [&](ReturnType &out)
+          {
+            test_or_trial_space_op.template evaluate_into<ScalarType, width>(
+              out, fe_values_dofs, fe_values_op, q_point_range);
+          });
+    }
+
+
+    template <typename ScalarType,
+              std::size_t width,
+              typename TestOrTrialSpaceOp,
+              typename FEValuesDofsType,
+              typename FEValuesOpType,
+              int dim,
+              int spacedim>
+    typename std::enable_if<
+      !ShapeFunctionCacheTraits<TestOrTrialSpaceOp>::is_cacheable,
+      AlignedVector<typename TestOrTrialSpaceOp::
+                      template vectorized_value_type<ScalarType, width>>>::type
+    evaluate_fe_space_cached(
+      const TestOrTrialSpaceOp &              test_or_trial_space_op,
+      const FEValuesDofsType &                fe_values_dofs,
+      const FEValuesOpType &                  fe_values_op,
+      MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      const std::vector<SolutionExtractionData<dim, spacedim>>
+        &                                 solution_extraction_data,
+      const types::vectorized_qp_range_t &q_point_range)
+    {
+      return evaluate_fe_space<ScalarType, width>(test_or_trial_space_op,
+                                                  fe_values_dofs,
+                                                  fe_values_op,
+                                                  scratch_data,
+                                                  solution_extraction_data,
+                                                  q_point_range);
+    }
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+
+#endif // dealii_weakforms_shape_function_cache_h
@@ -21,6 +21,7 @@
 #include <deal.II/meshworker/scratch_data.h>
 
 #include <weak_forms/config.h>
+#include <weak_forms/types.h>
 
 #include <string>
 
@@ -30,13 +31,24 @@ WEAK_FORMS_NAMESPACE_OPEN
 
 namespace WeakForms
 {
+  /**
+   * The association between a solution vector and the ScratchData object
+   * from which its local values are to be extracted.
+   *
+   * This object is cheap to create: The @p solution_name is not copied, but
+   * only referenced. It must therefore outlive this object, which is the
+   * case for the names held by the SolutionStorage that this data is
+   * created by.
+   */
   template <int dim, int spacedim = dim>
   struct SolutionExtractionData
   {
     SolutionExtractionData(MeshWorker::ScratchData<dim, spacedim> &scratch_data,
-                           const std::string &solution_name,
-                           const bool         uses_external_dofhandler)
-      : solution_name(solution_name)
+                           const types::solution_index solution_index,
+                           const std::string &         solution_name,
+                           const bool uses_external_dofhandler)
+      : solution_index(solution_index)
+      , solution_name(solution_name)
       , uses_external_dofhandler(uses_external_dofhandler)
       , scratch_data(&scratch_data)
     {}
@@ -53,8 +65,9 @@ namespace WeakForms
       return *scratch_data;
     }
 
-    const std::string solution_name;
-    const bool        uses_external_dofhandler;
+    const types::solution_index solution_index;
+    const std::string &         solution_name;
+    const bool                  uses_external_dofhandler;
 
   private:
     MeshWorker::ScratchData<dim, spacedim> *const scratch_data;
@@ -54,6 +54,8 @@ namespace WeakForms
       const std::vector<std::string> &        solution_names)
       : solution_names(solution_names)
       , solution_vectors(solution_vectors)
+      , solution_scratch_names(
+          create_scratch_name_vector(solution_vectors.size()))
       , dof_handlers(dof_handlers)
     {
       AssertThrow((!std::is_same<VectorType, std::nullptr_t>::value),
@@ -363,27 +365,10 @@ namespace WeakForms
       MeshWorker::ScratchData<dim, spacedim> &scratch_data,
       const DoFHandlerType2<dim, spacedim> &  dof_handler) const
     {
-      std::vector<SolutionExtractionData<dim, spacedim>>
-        solution_extraction_data =
-          get_solution_extraction_data(scratch_data, dof_handler);
-      Assert(solution_extraction_data.size() == n_solution_vectors(),
-             ExcDimensionMismatch(solution_extraction_data.size(),
-                                  n_solution_vectors()));
-
       for (unsigned int t = 0; t < n_solution_vectors(); ++t)
         {
-          Assert(solution_extraction_data[t].solution_name ==
-                   get_solution_name(t),
-                 ExcInternalError());
-          if (solution_extraction_data[t].uses_external_dofhandler == false)
-            {
-              Assert(&solution_extraction_data[t].get_scratch_data() ==
-                       &scratch_data,
-                     ExcInternalError());
-            }
-
           MeshWorker::ScratchData<dim, spacedim> &solution_scratch_data =
-            solution_extraction_data[t].get_scratch_data();
+            get_solution_scratch_data(t, scratch_data, dof_handler);
           solution_scratch_data.extract_local_dof_values(
             get_solution_name(t), get_solution_vector(t));
         }
@@ -413,7 +398,12 @@ namespace WeakForms
     }
 
     /**
-     * Returns a vector to a scratch
+     * Returns the association between each solution vector and the
+     * ScratchData object that its local values are extracted with.
+     *
+     * This association does not change from one cell to the next, so it
+     * need only be created once per @p scratch_data object. It is only
+     * valid once initialize() has been called for the @p scratch_data.
      */
     template <int dim, int spacedim, template <int, int> class DoFHandlerType2>
     std::vector<SolutionExtractionData<dim, spacedim>>
@@ -427,35 +417,13 @@ namespace WeakForms
 
       for (unsigned int t = 0; t < n_solution_vectors(); ++t)
         {
-          if (uses_same_dof_handler(t, dof_handler))
-            {
-              constexpr const bool uses_external_dofhandler = false;
-              solution_extraction_data.emplace_back(scratch_data,
-                                                    get_solution_name(t),
-                                                    uses_external_dofhandler);
-            }
-          else
-            {
-              Assert(
-                (!std::is_same<DoFHandlerType, std::nullptr_t>::value),
-                ExcMessage(
-                  "Cannot extract from an external scratch data object when it "
-                  "is not associated with another DoFHandler. You need to use the "
-                  "constructor that takes in a DoFHandler in order to use this "
-                  "functionality."));
-
-              GeneralDataStorage &cache =
-                scratch_data.get_general_data_storage();
-              MeshWorker::ScratchData<dim, spacedim> &external_scratch_data =
-                cache.template get_object_with_name<
-                  MeshWorker::ScratchData<dim, spacedim>>(
-                  get_name_solution_scratch(t));
-
-              constexpr const bool uses_external_dofhandler = true;
-              solution_extraction_data.emplace_back(external_scratch_data,
-                                                    get_solution_name(t),
-                                                    uses_external_dofhandler);
-            }
+          const bool uses_external_dofhandler =
+            !uses_same_dof_handler(t, dof_handler);
+          solution_extraction_data.emplace_back(
+            get_solution_scratch_data(t, scratch_data, dof_handler),
+            t,
+            get_solution_name(t),
+            uses_external_dofhandler);
         }
 
       return solution_extraction_data;
@@ -475,6 +443,13 @@ namespace WeakForms
     const std::vector<std::string>       solution_names;
     const std::vector<solution_ptr_type> solution_vectors;
 
+    /**
+     * The names under which the ScratchData objects for solutions that are
+     * associated with an external DoFHandler are stored. These are built
+     * once, so that they need not be recreated on every cell.
+     */
+    const std::vector<std::string> solution_scratch_names;
+
     /**
      * Permit each of the solution vectors to be associated with a DoFHandler
      * that is not necessarily the one used in the main assembly loop. This
@@ -485,11 +460,12 @@ namespace WeakForms
      */
     const std::vector<dofhandler_ptr_type> dof_handlers;
 
-    std::string
+    const std::string &
     get_name_solution_scratch(const types::solution_index index) const
     {
-      return Utilities::get_deal_II_prefix() + "Solution_Storage_Scratch_" +
-             std::to_string(index);
+      Assert(index < solution_scratch_names.size(),
+             ExcIndexRange(index, 0, solution_scratch_names.size()));
+      return solution_scratch_names[index];
     }
 
     const std::string &
@@ -526,6 +502,19 @@ namespace WeakForms
       return out;
     }
 
+    static std::vector<std::string>
+    create_scratch_name_vector(const unsigned int n_entries)
+    {
+      std::vector<std::string> out;
+      out.reserve(n_entries);
+
+      for (unsigned int index = 0; index < n_entries; ++index)
+        out.push_back(Utilities::get_deal_II_prefix() +
+                      "Solution_Storage_Scratch_" + std::to_string(index));
+
+      return out;
+    }
+
     template <int dim,
               int spacedim,
               template <int, int>
@@ -627,6 +616,33 @@ namespace WeakForms
       return true;
     }
 
+    /**
+     * Return the ScratchData object from which the local values of the
+     * solution vector with the given @p index are to be extracted.
+     */
+    template <int dim, int spacedim, template <int, int> class DoFHandlerType2>
+    MeshWorker::ScratchData<dim, spacedim> &
+    get_solution_scratch_data(
+      const types::solution_index             index,
+      MeshWorker::ScratchData<dim, spacedim> &scratch_data,
+      const DoFHandlerType2<dim, spacedim> &  dof_handler) const
+    {
+      if (uses_same_dof_handler(index, dof_handler))
+        return scratch_data;
+
+      Assert((!std::is_same<DoFHandlerType, std::nullptr_t>::value),
+             ExcMessage(
+               "Cannot extract from an external scratch data object when it "
+               "is not associated with another DoFHandler. You need to use the "
+               "constructor that takes in a DoFHandler in order to use this "
+               "functionality."));
+
+      GeneralDataStorage &cache = scratch_data.get_general_data_storage();
+      return cache.template get_object_with_name<
+        MeshWorker::ScratchData<dim, spacedim>>(
+        get_name_solution_scratch(index));
+    }
+
     const DoFHandlerType &
     get_dof_handler(const types::solution_index index) const
     {
@@ -1621,34 +1621,71 @@ public:                                                                      \
     const FEValuesBase<dimension, space_dimension> &fe_values_dofs,          \
     const FEValuesBase<dimension, space_dimension> &fe_values_op) const      \
   {                                                                          \
-    return_type<ScalarType> out(fe_values_dofs.dofs_per_cell);               \
+    return_type<ScalarType> out;                                             \
+    this->template evaluate_into<ScalarType>(out,                            \
+                                             fe_values_dofs,                 \
+                                             fe_values_op);                  \
+    return out;                                                              \
+  }                                                                          \
+                                                                             \
+  template <typename ScalarType, std::size_t width>                          \
+  vectorized_return_type<ScalarType, width> operator()(                      \
+    const FEValuesBase<dimension, space_dimension> &fe_values_dofs,          \
+    const FEValuesBase<dimension, space_dimension> &fe_values_op,            \
+    const types::vectorized_qp_range_t &            q_point_range) const     \
+  {                                                                          \
+    vectorized_return_type<ScalarType, width> out;                           \
+    this->template evaluate_into<ScalarType, width>(out,                     \
+                                                    fe_values_dofs,          \
+                                                    fe_values_op,            \
+                                                    q_point_range);          \
+    return out;                                                              \
+  }                                                                          \
+                                                                             \
+  /**                                                                        \
+   * Write all shape function values at all quadrature points into           \
+   * @p out, reusing the memory that it has already allocated.               \
+   */                                                                        \
+  template <typename ScalarType>                                             \
+  void evaluate_into(                                                        \
+    return_type<ScalarType> &                       out,                     \
+    const FEValuesBase<dimension, space_dimension> &fe_values_dofs,          \
+    const FEValuesBase<dimension, space_dimension> &fe_values_op) const      \
+  {                                                                          \
+    out.resize(fe_values_dofs.dofs_per_cell);                                \
                                                                              \
     for (const auto dof_index : fe_values_dofs.dof_indices())                \
       {                                                                      \
-        out[dof_index].reserve(fe_values_op.n_quadrature_points);            \
+        out[dof_index].resize(fe_values_op.n_quadrature_points);             \
                                                                              \
         for (const auto q_point : fe_values_op.quadrature_point_indices())   \
-          out[dof_index].emplace_back(this->template operator()<ScalarType>( \
-            fe_values_op, dof_index, q_point));                              \
+          out[dof_index][q_point] = this->template operator()<ScalarType>(   \
+            fe_values_op, dof_index, q_point);                               \
       }                                                                      \
-                                                                             \
-    return out;                                                              \
   }                                                                          \
                                                                              \
+  /**                                                                        \
+   * Write the shape function values at the quadrature points in             \
+   * @p q_point_range into @p out, reusing the memory that it has            \
+   * already allocated. The vectorization lanes that are not associated      \
+   * with any quadrature point are set to zero.                              \
+   */                                                                        \
   template <typename ScalarType, std::size_t width>                          \
-  vectorized_return_type<ScalarType, width> operator()(                      \
+  void evaluate_into(                                                        \
+    vectorized_return_type<ScalarType, width> &     out,                     \
     const FEValuesBase<dimension, space_dimension> &fe_values_dofs,          \
     const FEValuesBase<dimension, space_dimension> &fe_values_op,            \
-    const types::vectorized_qp_range_t &            q_point_range) const                 \
+    const types::vectorized_qp_range_t &            q_point_range) const     \
   {                                                                          \
-    vectorized_return_type<ScalarType, width> out(                           \
-      fe_values_dofs.dofs_per_cell);                                         \
-                                                                             \
     Assert(q_point_range.size() <= width,                                    \
            ExcIndexRange(q_point_range.size(), 0, width));                   \
                                                                              \
+    out.resize_fast(fe_values_dofs.dofs_per_cell);                           \
+                                                                             \
     for (const auto dof_index : fe_values_dofs.dof_indices())                \
       {                                                                      \
+        out[dof_index] = vectorized_value_type<ScalarType, width>();         \
+                                                                             \
         DEAL_II_OPENMP_SIMD_PRAGMA                                           \
         for (unsigned int i = 0; i < q_point_range.size(); ++i)              \
           if (q_point_range[i] < fe_values_op.n_quadrature_points)           \
@@ -1659,11 +1696,9 @@ public:                                                                      \
                                                     dof_index,               \
                                                     q_point_range[i]));      \
       }                                                                      \
-                                                                             \
-    return out;                                                              \
   }                                                                          \
                                                                              \
-protected:                                                                   \
+public:                                                                      \
   /**                                                                        \
    * The extractor corresponding to the view itself                          \
    */                                                                        \
@@ -2116,22 +2151,10 @@ public:
     const FEInterfaceValues<dimension, space_dimension> &fe_interface_values)              \
     const                                                                                  \
   {                                                                                        \
-    return_type<ScalarType> out(                                                           \
-      fe_interface_values.n_current_interface_dofs());                                     \
-                                                                                           \
-    for (const auto interface_dof_index : fe_interface_values.dof_indices())               \
-      {                                                                                    \
-        out[interface_dof_index].reserve(                                                  \
-          fe_interface_values.n_quadrature_points);                                        \
-                                                                                           \
-        for (const auto q_point :                                                          \
-             fe_interface_values.quadrature_point_indices())                               \
-          out[interface_dof_index].emplace_back(                                           \
-            this->template operator()<ScalarType>(fe_interface_values,                     \
-                                                  interface_dof_index,                     \
-                                                  q_point));                               \
-      }                                                                                    \
-                                                                                           \
+    return_type<ScalarType> out;                                                           \
+    this->template evaluate_into<ScalarType>(out,                                          \
+                                             fe_interface_values,                          \
+                                             fe_interface_values);                         \
     return out;                                                                            \
   }                                                                                        \
                                                                                            \
@@ -2153,27 +2176,13 @@ public:
   template <typename ScalarType, std::size_t width>                                        \
   vectorized_return_type<ScalarType, width> operator()(                                    \
     const FEInterfaceValues<dimension, space_dimension> &fe_interface_values,              \
-    const types::vectorized_qp_range_t &                 q_point_range) const                               \
+    const types::vectorized_qp_range_t &                 q_point_range) const              \
   {                                                                                        \
-    vectorized_return_type<ScalarType, width> out(                                         \
-      fe_interface_values.n_current_interface_dofs());                                     \
-                                                                                           \
-    Assert(q_point_range.size() <= width,                                                  \
-           ExcIndexRange(q_point_range.size(), 0, width));                                 \
-                                                                                           \
-    for (const auto interface_dof_index : fe_interface_values.dof_indices())               \
-      {                                                                                    \
-        DEAL_II_OPENMP_SIMD_PRAGMA                                                         \
-        for (unsigned int i = 0; i < q_point_range.size(); ++i)                            \
-          if (q_point_range[i] < fe_interface_values.n_quadrature_points)                  \
-            numbers::set_vectorized_values(                                                \
-              out[interface_dof_index],                                                    \
-              i,                                                                           \
-              this->template operator()<ScalarType>(fe_interface_values,                   \
-                                                    interface_dof_index,                   \
-                                                    q_point_range[i]));                    \
-      }                                                                                    \
-                                                                                           \
+    vectorized_return_type<ScalarType, width> out;                                         \
+    this->template evaluate_into<ScalarType, width>(out,                                   \
+                                                    fe_interface_values,                   \
+                                                    fe_interface_values,                   \
+                                                    q_point_range);                        \
     return out;                                                                            \
   }                                                                                        \
                                                                                            \
@@ -2194,8 +2203,80 @@ public:
       fe_interface_values_dofs, q_point_range);                                            \
   }                                                                                        \
                                                                                            \
+  /**                                                                                      \
+   * Write all shape function values at all quadrature points into                         \
+   * @p out, reusing the memory that it has already allocated.                             \
+   */                                                                                      \
+  template <typename ScalarType>                                                           \
+  void evaluate_into(                                                                      \
+    return_type<ScalarType> &                            out,                              \
+    const FEInterfaceValues<dimension, space_dimension> &fe_interface_values,              \
+    const FEInterfaceValues<dimension, space_dimension>                                    \
+      &fe_interface_values_op) const                                                       \
+  {                                                                                        \
+    Assert(                                                                                \
+      &fe_interface_values == &fe_interface_values_op,                                     \
+      ExcMessage(                                                                          \
+        "Expected exactly the same FEInterfaceValues object for the DoFs and Operator.")); \
+    (void)fe_interface_values_op;                                                          \
+                                                                                           \
+    out.resize(fe_interface_values.n_current_interface_dofs());                            \
+                                                                                           \
+    for (const auto interface_dof_index : fe_interface_values.dof_indices())               \
+      {                                                                                    \
+        out[interface_dof_index].resize(                                                   \
+          fe_interface_values.n_quadrature_points);                                        \
+                                                                                           \
+        for (const auto q_point :                                                          \
+             fe_interface_values.quadrature_point_indices())                               \
+          out[interface_dof_index][q_point] =                                              \
+            this->template operator()<ScalarType>(fe_interface_values,                     \
+                                                  interface_dof_index,                     \
+                                                  q_point);                                \
+      }                                                                                    \
+  }                                                                                        \
                                                                                            \
-protected:                                                                                 \
+  /**                                                                                      \
+   * Write the shape function values at the quadrature points in                           \
+   * @p q_point_range into @p out, reusing the memory that it has                          \
+   * already allocated. The vectorization lanes that are not associated                    \
+   * with any quadrature point are set to zero.                                            \
+   */                                                                                      \
+  template <typename ScalarType, std::size_t width>                                        \
+  void evaluate_into(                                                                      \
+    vectorized_return_type<ScalarType, width> &          out,                              \
+    const FEInterfaceValues<dimension, space_dimension> &fe_interface_values,              \
+    const FEInterfaceValues<dimension, space_dimension>                                    \
+      &                                 fe_interface_values_op,                            \
+    const types::vectorized_qp_range_t &q_point_range) const                               \
+  {                                                                                        \
+    Assert(                                                                                \
+      &fe_interface_values == &fe_interface_values_op,                                     \
+      ExcMessage(                                                                          \
+        "Expected exactly the same FEInterfaceValues object for the DoFs and Operator.")); \
+    (void)fe_interface_values_op;                                                          \
+    Assert(q_point_range.size() <= width,                                                  \
+           ExcIndexRange(q_point_range.size(), 0, width));                                 \
+                                                                                           \
+    out.resize_fast(fe_interface_values.n_current_interface_dofs());                       \
+                                                                                           \
+    for (const auto interface_dof_index : fe_interface_values.dof_indices())               \
+      {                                                                                    \
+        out[interface_dof_index] = vectorized_value_type<ScalarType, width>();             \
+                                                                                           \
+        DEAL_II_OPENMP_SIMD_PRAGMA                                                         \
+        for (unsigned int i = 0; i < q_point_range.size(); ++i)                            \
+          if (q_point_range[i] < fe_interface_values.n_quadrature_points)                  \
+            numbers::set_vectorized_values(                                                \
+              out[interface_dof_index],                                                    \
+              i,                                                                           \
+              this->template operator()<ScalarType>(fe_interface_values,                   \
+                                                    interface_dof_index,                   \
+                                                    q_point_range[i]));                    \
+      }                                                                                    \
+  }                                                                                        \
+                                                                                           \
+public:                                                                                    \
   /**                                                                                      \
    * The extractor corresponding to the view itself                                        \
    */                                                                                      \
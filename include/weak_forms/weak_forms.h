@@ -69,7 +69,7 @@
 
 // Assembly
 #include <weak_forms/assembler_matrix_based.h>
-// #include <weak_forms/assembler_matrix_free.h>
+#include <weak_forms/assembler_matrix_free.h>
 
 
 #endif // dealii_weakforms_weakforms_h
@@ -0,0 +1,243 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+#ifndef dealii_weakforms_work_stream_tuner_h
+#define dealii_weakforms_work_stream_tuner_h
+
+#include <deal.II/base/config.h>
+
+#include <deal.II/base/exceptions.h>
+#include <deal.II/base/multithread_info.h>
+
+#include <weak_forms/config.h>
+#include <weak_forms/scratch_data_pool.h>
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <typeindex>
+#include <vector>
+
+
+WEAK_FORMS_NAMESPACE_OPEN
+
+
+namespace WeakForms
+{
+  namespace internal
+  {
+    /**
+     * The parameters that control how WorkStream::run() (and hence
+     * MeshWorker::mesh_loop()) distributes the work among threads.
+     */
+    struct WorkStreamParameters
+    {
+      WorkStreamParameters(const unsigned int queue_length,
+                           const unsigned int chunk_size)
+        : queue_length(queue_length)
+        , chunk_size(chunk_size)
+      {}
+
+      unsigned int queue_length;
+      unsigned int chunk_size;
+
+      bool
+      operator==(const WorkStreamParameters &other) const
+      {
+        return queue_length == other.queue_length &&
+               chunk_size == other.chunk_size;
+      }
+
+      bool
+      operator!=(const WorkStreamParameters &other) const
+      {
+        return !(*this == other);
+      }
+    };
+
+
+    /**
+     * A description of the kind of assembly that is performed. Only the
+     * timings of assembly calls of the same kind are compared with one
+     * another, as each kind performs a different amount of work per cell.
+     */
+    struct AssemblyKind
+    {
+      AssemblyKind(const std::type_index &matrix_type,
+                   const std::type_index &vector_type,
+                   const bool             assemble_matrix,
+                   const bool             assemble_vector,
+                   const bool             reduced_contribution)
+        : matrix_type(matrix_type)
+        , vector_type(vector_type)
+        , assemble_matrix(assemble_matrix)
+        , assemble_vector(assemble_vector)
+        , reduced_contribution(reduced_contribution)
+      {}
+
+      std::type_index matrix_type;
+      std::type_index vector_type;
+      bool            assemble_matrix;
+      bool            assemble_vector;
+      bool            reduced_contribution;
+
+      bool
+      operator<(const AssemblyKind &other) const
+      {
+        return std::tie(matrix_type,
+                        vector_type,
+                        assemble_matrix,
+                        assemble_vector,
+                        reduced_contribution) <
+               std::tie(other.matrix_type,
+                        other.vector_type,
+                        other.assemble_matrix,
+                        other.assemble_vector,
+                        other.reduced_contribution);
+      }
+    };
+
+
+    /**
+     * A helper that selects the fastest WorkStreamParameters for repeated
+     * assembly calls of the same kind.
+     *
+     * The first assembly call is a warm-up, as it typically includes
+     * one-off costs such as building the ScratchData objects. Each of the
+     * subsequent assembly calls is then performed with a different
+     * candidate set of parameters, until all of them have been timed. From
+     * then on the fastest candidate is used. The candidates combine queue
+     * lengths of one, two and four times the number of threads with chunk
+     * sizes of 1, 8 and 32 cells.
+     *
+     * The tuning starts anew if anything that the ScratchData objects
+     * depend on (as is described by the ScratchDataPoolKey), the number of
+     * assembly operations, the number of cells that are assembled, or the
+     * user-provided parameters change. One tuner is to be used for each
+     * AssemblyKind.
+     */
+    class WorkStreamTuner
+    {
+    public:
+      WorkStreamTuner()
+        : n_operations(0)
+        , n_cells(0)
+        , initial_parameters(0, 0)
+        , best_parameters(0, 0)
+        , warm_up_done(false)
+        , n_timed_candidates(0)
+      {}
+
+      /**
+       * Prepare the tuner for an assembly with the given @p key, in which
+       * @p n_operations assembly operations are performed on @p n_cells
+       * cells and for which the user has chosen the @p parameters.
+       */
+      void
+      initialize(const ScratchDataPoolKey &  key,
+                 const unsigned int          n_operations,
+                 const unsigned int          n_cells,
+                 const WorkStreamParameters &parameters)
+      {
+        if (key == this->key && n_operations == this->n_operations &&
+            n_cells == this->n_cells && parameters == initial_parameters)
+          return;
+
+        this->key          = key;
+        this->n_operations = n_operations;
+        this->n_cells      = n_cells;
+        initial_parameters = parameters;
+        best_parameters    = parameters;
+        warm_up_done       = false;
+        n_timed_candidates = 0;
+
+        candidates.clear();
+        const unsigned int n_threads = MultithreadInfo::n_threads();
+        for (const unsigned int queue_length_factor : {1u, 2u, 4u})
+          for (const unsigned int chunk_size : {1u, 8u, 32u})
+            candidates.emplace_back(queue_length_factor * n_threads,
+                                    chunk_size);
+        timings.assign(candidates.size(),
+                       std::numeric_limits<double>::max());
+      }
+
+      /**
+       * Return the parameters to be used for the next assembly call.
+       */
+      const WorkStreamParameters &
+      get_parameters() const
+      {
+        if (!warm_up_done || is_tuned())
+          return best_parameters;
+        return candidates[n_timed_candidates];
+      }
+
+      /**
+       * Record the @p wall_time that the last assembly call, which used
+       * the parameters returned by get_parameters(), took.
+       */
+      void
+      record(const double wall_time)
+      {
+        if (!warm_up_done)
+          {
+            warm_up_done = true;
+            return;
+          }
+        if (is_tuned())
+          return;
+
+        Assert(n_timed_candidates < timings.size(),
+               ExcIndexRange(n_timed_candidates, 0, timings.size()));
+        timings[n_timed_candidates] = wall_time;
+        ++n_timed_candidates;
+
+        if (is_tuned())
+          {
+            const auto fastest =
+              std::min_element(timings.begin(), timings.end());
+            best_parameters = candidates[fastest - timings.begin()];
+          }
+      }
+
+      /**
+       * Return whether or not all candidates have been timed.
+       */
+      bool
+      is_tuned() const
+      {
+        return warm_up_done && n_timed_candidates == candidates.size();
+      }
+
+    private:
+      ScratchDataPoolKey                key;
+      unsigned int                      n_operations;
+      unsigned int                      n_cells;
+      WorkStreamParameters              initial_parameters;
+      WorkStreamParameters              best_parameters;
+      bool                              warm_up_done;
+      unsigned int                      n_timed_candidates;
+      std::vector<WorkStreamParameters> candidates;
+      std::vector<double>               timings;
+    };
+
+  } // namespace internal
+} // namespace WeakForms
+
+
+WEAK_FORMS_NAMESPACE_CLOSE
+
+#endif // dealii_weakforms_work_stream_tuner_h
@@ -0,0 +1,121 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that each entry of a persistent AD/SD cache is only ever bound to one
+// thread at a time, even when there are more threads than entries, and that
+// the binding statistics are recorded.
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/ad_sd_functor_cache.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../weak_forms_tests.h"
+
+
+template <int dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  constexpr unsigned int n_threads             = 4;
+  constexpr unsigned int n_bindings_per_thread = 1000;
+  constexpr unsigned int queue_length          = 2;
+
+  const FE_Q<dim>              fe(1);
+  const QGauss<dim>            qf_cell(2);
+  MeshWorker::ScratchData<dim> sample_scratch_data(fe, qf_cell, update_values);
+
+  AD_SD_Functor_Cache user_cache(queue_length);
+  AD_SD_Functor_Cache::initialize(sample_scratch_data, &user_cache);
+  AssertThrow(user_cache.queue_length() == queue_length,
+              ExcDimensionMismatch(user_cache.queue_length(), queue_length));
+
+  const internal::AD_SD_CacheSlot slot =
+    AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_01");
+  AssertThrow(AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_01")
+                  .index() == slot.index(),
+              ExcMessage("Slot index is not unique."));
+
+  std::atomic<bool> shared_use(false);
+  const auto        worker = [&]()
+  {
+    MeshWorker::ScratchData<dim> scratch_data(sample_scratch_data);
+    for (unsigned int i = 0; i < n_bindings_per_thread; ++i)
+      {
+        AD_SD_Functor_Cache::bind_user_cache_to_thread(scratch_data);
+
+        std::atomic<unsigned int> &n_users =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data)
+            .template get_or_add_object<std::atomic<unsigned int>>(slot, 0u);
+        if (++n_users != 1)
+          shared_use = true;
+        std::this_thread::yield();
+        --n_users;
+
+        AD_SD_Functor_Cache::unbind_user_cache_from_thread(
+          scratch_data, AD_SD_Functor_Cache::get_cache(scratch_data));
+      }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < n_threads; ++t)
+    threads.emplace_back(worker);
+  for (auto &thread : threads)
+    thread.join();
+
+  AssertThrow(shared_use == false,
+              ExcMessage("A cache entry was used by several threads at once."));
+  AssertThrow(user_cache.get_n_bindings() == n_threads * n_bindings_per_thread,
+              ExcDimensionMismatch(user_cache.get_n_bindings(),
+                                   n_threads * n_bindings_per_thread));
+  AssertThrow(user_cache.get_n_redirected_bindings() <=
+                user_cache.get_n_bindings(),
+              ExcInternalError());
+
+  user_cache.reset_binding_statistics();
+  AssertThrow(user_cache.get_n_bindings() == 0, ExcInternalError());
+  AssertThrow(user_cache.get_n_redirected_bindings() == 0, ExcInternalError());
+  AssertThrow(user_cache.get_n_blocked_bindings() == 0, ExcInternalError());
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
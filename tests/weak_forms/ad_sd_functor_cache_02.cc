@@ -0,0 +1,173 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that the indices of released AD/SD cache slots are reused without
+// exposing the objects of the slot that previously held them, and that
+// the slot table of a bound ScratchData object is the one that is
+// resolved while it is bound.
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/ad_sd_functor_cache.h>
+
+#include "../weak_forms_tests.h"
+
+
+void
+test_slot_registry()
+{
+  LogStream::Prefix prefix("Registry");
+
+  using namespace WeakForms;
+
+  internal::AD_SD_CacheSlotTable table;
+  unsigned int                   released_index;
+  {
+    const internal::AD_SD_CacheSlot slot_1 =
+      AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02_1");
+    const internal::AD_SD_CacheSlot slot_1_copy = slot_1;
+    const internal::AD_SD_CacheSlot slot_1_other =
+      AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02_1");
+    const internal::AD_SD_CacheSlot slot_2 =
+      AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02_2");
+
+    AssertThrow(slot_1_copy.index() == slot_1.index() &&
+                  slot_1_other.index() == slot_1.index() &&
+                  slot_1_other.id() == slot_1.id(),
+                ExcMessage("Slots with the same name differ."));
+    AssertThrow(slot_2.index() != slot_1.index(),
+                ExcMessage("Slots with different names share an index."));
+
+    table.get_or_add_object<int>(slot_1, 1);
+    AssertThrow(table.stores_object(slot_1_other), ExcInternalError());
+    AssertThrow(!table.stores_object(slot_2), ExcInternalError());
+
+    released_index = slot_1.index();
+  }
+
+  // All handles to both slots have been destroyed, so their indices are
+  // free to be reused by any other name.
+  const internal::AD_SD_CacheSlot slot_3 =
+    AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02_3");
+  AssertThrow(slot_3.index() == released_index,
+              ExcMessage("The index of a released slot was not reused."));
+
+  // A name that is registered anew is not given the objects that were
+  // stored for it before it was released.
+  const internal::AD_SD_CacheSlot slot_1 =
+    AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02_1");
+  AssertThrow(!table.stores_object(slot_1) && !table.stores_object(slot_3),
+              ExcMessage("The object of a released slot is still exposed."));
+
+  AssertThrow(table.get_or_add_object<double>(slot_3, 2.0) == 2.0,
+              ExcInternalError());
+  AssertThrow(table.get_or_add_object<double>(slot_3, 3.0) == 2.0,
+              ExcInternalError());
+
+  deallog << "OK" << std::endl;
+}
+
+
+template <int dim>
+void
+test_active_slot_table()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+
+  using namespace WeakForms;
+
+  const FE_Q<dim>   fe(1);
+  const QGauss<dim> qf_cell(2);
+
+  const internal::AD_SD_CacheSlot slot =
+    AD_SD_Functor_Cache::get_slot("ad_sd_functor_cache_02");
+
+  // Without a user cache, the table is owned by the ScratchData object.
+  {
+    MeshWorker::ScratchData<dim> scratch_data(fe, qf_cell, update_values);
+    MeshWorker::ScratchData<dim> other_scratch_data(scratch_data);
+
+    const internal::AD_SD_CacheSlotTable *const unbound_table =
+      &AD_SD_Functor_Cache::get_slot_table(scratch_data);
+
+    AD_SD_Functor_Cache::bind_user_cache_to_thread(scratch_data);
+    AssertThrow(&AD_SD_Functor_Cache::get_slot_table(scratch_data) ==
+                  unbound_table,
+                ExcMessage("The bound table differs from the unbound one."));
+    AssertThrow(&AD_SD_Functor_Cache::get_slot_table(other_scratch_data) !=
+                  unbound_table,
+                ExcMessage("An unbound ScratchData resolved the bound table."));
+    AD_SD_Functor_Cache::get_slot_table(scratch_data)
+      .template get_or_add_object<unsigned int>(slot, 1u);
+    AD_SD_Functor_Cache::unbind_user_cache_from_thread(
+      scratch_data, AD_SD_Functor_Cache::get_cache(scratch_data));
+
+    AssertThrow(AD_SD_Functor_Cache::get_slot_table(scratch_data)
+                    .template get_object<unsigned int>(slot) == 1u,
+                ExcInternalError());
+    deallog << "No user cache: OK" << std::endl;
+  }
+
+  // With a user cache, the table belongs to the entry that is bound to the
+  // thread, and it persists between bindings.
+  {
+    MeshWorker::ScratchData<dim> scratch_data(fe, qf_cell, update_values);
+    AD_SD_Functor_Cache          user_cache(1);
+    AD_SD_Functor_Cache::initialize(scratch_data, &user_cache);
+
+    const MeshWorker::ScratchData<dim> &const_scratch_data = scratch_data;
+    for (unsigned int i = 0; i < 2; ++i)
+      {
+        AD_SD_Functor_Cache::bind_user_cache_to_thread(scratch_data);
+
+        internal::AD_SD_CacheSlotTable &slot_table =
+          AD_SD_Functor_Cache::get_slot_table(scratch_data);
+        AssertThrow(&AD_SD_Functor_Cache::get_slot_table(const_scratch_data) ==
+                      &slot_table,
+                    ExcInternalError());
+
+        unsigned int &n_bindings =
+          slot_table.template get_or_add_object<unsigned int>(slot, 0u);
+        ++n_bindings;
+        AssertThrow(n_bindings == i + 1,
+                    ExcMessage("The user cache did not persist."));
+
+        AD_SD_Functor_Cache::unbind_user_cache_from_thread(
+          scratch_data, AD_SD_Functor_Cache::get_cache(scratch_data));
+      }
+    deallog << "User cache: OK" << std::endl;
+  }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  test_slot_registry();
+  test_active_slot_table<2>();
+  test_active_slot_table<3>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,182 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that assembling two systems concurrently as tasks leads to the same
+// systems as assembling them one after the other.
+// - Cell and boundary contributions
+// - With a solution vector
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/thread_management.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FE_Q<dim, spacedim>  fe(2);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 4, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  Vector<double> solution(dof_handler.n_dofs());
+  for (unsigned int i = 0; i < solution.size(); ++i)
+    solution(i) = 1.0 + 0.01 * i;
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  // Subsystem A
+  Assembler assembler_a;
+  assembler_a +=
+    bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+    bilinear_form(test.value(), coeff_func, trial.value()).dA() -
+    linear_form(test.value(), coeff_func).dV();
+
+  // Subsystem B
+  Assembler assembler_b;
+  assembler_b += bilinear_form(test.value(), coeff_func, trial.value()).dV() -
+                 linear_form(test.value(), coeff_func).dA();
+
+  SparseMatrix<double> system_matrix_a(sparsity_pattern);
+  SparseMatrix<double> system_matrix_b(sparsity_pattern);
+  Vector<double>       system_vector_a(dof_handler.n_dofs());
+  Vector<double>       system_vector_b(dof_handler.n_dofs());
+  {
+    Threads::Task<void> task_a =
+      assembler_a.assemble_system_async(system_matrix_a,
+                                        system_vector_a,
+                                        solution,
+                                        constraints,
+                                        dof_handler,
+                                        qf_cell,
+                                        qf_face);
+    Threads::Task<void> task_b =
+      assembler_b.assemble_system_async(system_matrix_b,
+                                        system_vector_b,
+                                        constraints,
+                                        dof_handler,
+                                        qf_cell,
+                                        qf_face);
+    task_a.join();
+    task_b.join();
+  }
+
+  const auto verify = [&](const Assembler &           assembler,
+                          const SparseMatrix<double> &system_matrix,
+                          const Vector<double> &      system_vector)
+  {
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_vector_reference(dof_handler.n_dofs());
+    assembler.assemble_system(system_matrix_reference,
+                              system_vector_reference,
+                              solution,
+                              constraints,
+                              dof_handler,
+                              qf_cell,
+                              qf_face);
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix.begin(),
+              it2 = system_matrix_reference.begin();
+         it1 != system_matrix.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+
+    for (unsigned int i = 0; i < system_vector.size(); ++i)
+      AssertThrow(std::abs(system_vector(i) - system_vector_reference(i)) <
+                    tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_vector(i),
+                                           system_vector_reference(i)));
+  };
+
+  verify(assembler_a, system_matrix_a, system_vector_a);
+  verify(assembler_b, system_matrix_b, system_vector_b);
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,225 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that assembly directly into a block matrix, for which the local
+// contributions are distributed block-wise, leads to the same system as
+// assembly into a standard sparse matrix.
+// - Three-field problem (u, p, J), with the couplings of step-44
+// - Homogeneous constraints on part of the boundary
+// - Hanging node constraints
+// - Cells with and without constrained DoFs, which are distributed as a
+//   whole and block-wise respectively
+
+#include <deal.II/base/function.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/block_sparse_matrix.h>
+#include <deal.II/lac/block_sparsity_pattern.h>
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/numerics/vector_tools.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Displacement (vector) + pressure (scalar) + dilatation (scalar)
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2),
+                                   dim,
+                                   FE_Q<dim, spacedim>(1),
+                                   1,
+                                   FE_Q<dim, spacedim>(1),
+                                   1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  const unsigned int u_component = 0;
+  const unsigned int p_component = dim;
+  const unsigned int J_component = dim + 1;
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0, true);
+  triangulation.last_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  std::vector<unsigned int> block_component(dim + 2, 0);
+  block_component[p_component] = 1;
+  block_component[J_component] = 2;
+  DoFRenumbering::component_wise(dof_handler, block_component);
+  const std::vector<types::global_dof_index> dofs_per_block =
+    DoFTools::count_dofs_per_fe_block(dof_handler, block_component);
+
+  AffineConstraints<double> constraints;
+  DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+  {
+    const FEValuesExtractors::Vector u_fe(u_component);
+    VectorTools::interpolate_boundary_values(
+      dof_handler,
+      0,
+      Functions::ZeroFunction<spacedim>(fe.n_components()),
+      constraints,
+      fe.component_mask(u_fe));
+  }
+  constraints.close();
+
+  // Make sure that both the block-wise distribution and the distribution
+  // of entire local matrices are exercised.
+  {
+    unsigned int n_constrained_cells   = 0;
+    unsigned int n_unconstrained_cells = 0;
+
+    std::vector<types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      {
+        cell->get_dof_indices(local_dof_indices);
+        if (std::any_of(local_dof_indices.begin(),
+                        local_dof_indices.end(),
+                        [&constraints](const types::global_dof_index i)
+                        { return constraints.is_constrained(i); }))
+          ++n_constrained_cells;
+        else
+          ++n_unconstrained_cells;
+      }
+
+    AssertThrow(n_constrained_cells > 0 && n_unconstrained_cells > 0,
+                ExcInternalError());
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor_u(u_component,
+                                                        "u",
+                                                        "\\mathbf{u}");
+  const SubSpaceExtractors::Scalar subspace_extractor_p(p_component, "p", "p");
+  const SubSpaceExtractors::Scalar subspace_extractor_J(J_component, "J", "J");
+
+  const auto test_u  = test[subspace_extractor_u];
+  const auto trial_u = trial[subspace_extractor_u];
+  const auto test_p  = test[subspace_extractor_p];
+  const auto trial_p = trial[subspace_extractor_p];
+  const auto test_J  = test[subspace_extractor_J];
+  const auto trial_J = trial[subspace_extractor_J];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  MatrixBasedAssembler<dim, spacedim> assembler;
+  assembler +=
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+    bilinear_form(test_u.divergence(), coeff_func, trial_p.value()).dV() +
+    bilinear_form(test_p.value(), coeff_func, trial_u.divergence()).dV() -
+    bilinear_form(test_p.value(), coeff_func, trial_J.value()).dV() -
+    bilinear_form(test_J.value(), coeff_func, trial_p.value()).dV() +
+    bilinear_form(test_J.value(), coeff_func, trial_J.value()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA() -
+    linear_form(test_p.value(), coeff_func).dV() -
+    linear_form(test_J.value(), coeff_func).dV();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  BlockSparsityPattern block_sparsity_pattern;
+  {
+    BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
+    assembler.make_sparsity_pattern(dof_handler, constraints, dsp, false);
+    block_sparsity_pattern.copy_from(dsp);
+  }
+
+  SparseMatrix<double> system_matrix(sparsity_pattern);
+  Vector<double>       system_rhs(dof_handler.n_dofs());
+  assembler.assemble_system(
+    system_matrix, system_rhs, constraints, dof_handler, qf_cell, qf_face);
+
+  BlockSparseMatrix<double> block_system_matrix(block_sparsity_pattern);
+  BlockVector<double>       block_system_rhs(dofs_per_block);
+  assembler.assemble_system(block_system_matrix,
+                            block_system_rhs,
+                            constraints,
+                            dof_handler,
+                            qf_cell,
+                            qf_face);
+
+  constexpr double tol = 1e-12;
+  for (auto it = system_matrix.begin(); it != system_matrix.end(); ++it)
+    AssertThrow(std::abs(it->value() -
+                         block_system_matrix.el(it->row(), it->column())) < tol,
+                ExcMatrixEntriesNotEqual(it->row(),
+                                         it->column(),
+                                         it->value(),
+                                         block_system_matrix.el(it->row(),
+                                                                it->column())));
+
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    AssertThrow(std::abs(system_rhs(i) - block_system_rhs(i)) < tol,
+                ExcVectorEntriesNotEqual(i,
+                                         system_rhs(i),
+                                         block_system_rhs(i)));
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,274 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that the boundary worker uses the cell FEValues of the cell that it
+// is working on, when these are reused between the faces of a cell.
+// - hp mesh, on which neighboring cells have a different number of DoFs
+// - Cells with several boundary faces
+// - Assembler with only boundary forms, so there is no cell worker that
+//   initializes the cell FEValues
+// - Cell and boundary forms, assembled for batches of cells at a time
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_dgq.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/hp/q_collection.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  hp::FECollection<dim, spacedim> fe_collection;
+  hp::QCollection<spacedim>       qf_collection_cell;
+  hp::QCollection<spacedim - 1>   qf_collection_face;
+  for (unsigned int degree = 1; degree <= 2; ++degree)
+    {
+      fe_collection.push_back(FE_DGQ<dim, spacedim>(degree));
+      qf_collection_cell.push_back(QGauss<spacedim>(3));
+      qf_collection_face.push_back(QGauss<spacedim - 1>(3));
+    }
+
+  // Each corner cell has dim boundary faces.
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  for (const auto &cell : dof_handler.active_cell_iterators())
+    cell->set_active_fe_index(cell->active_cell_index() % 2);
+  dof_handler.distribute_dofs(fe_collection);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const auto coeff_value = [](const Point<spacedim> &p)
+  { return 2.0 + p[0]; };
+  const auto rhs_value = [](const Point<spacedim> &p)
+  { return 0.5 + p[dim - 1]; };
+
+  // Reference: Cell and boundary contributions computed by hand.
+  const auto assemble_reference = [&](SparseMatrix<double> &system_matrix,
+                                      Vector<double> &      system_rhs,
+                                      const bool            include_cells)
+  {
+    hp::FEValues<dim, spacedim>     hp_fe_values(fe_collection,
+                                             qf_collection_cell,
+                                             update_values |
+                                               update_quadrature_points |
+                                               update_JxW_values);
+    hp::FEFaceValues<dim, spacedim> hp_fe_face_values(
+      fe_collection,
+      qf_collection_face,
+      update_values | update_quadrature_points | update_JxW_values);
+
+    std::vector<dealii::types::global_dof_index> dof_indices;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      {
+        const unsigned int n_dofs = cell->get_fe().dofs_per_cell;
+        FullMatrix<double> cell_matrix(n_dofs, n_dofs);
+        Vector<double>     cell_rhs(n_dofs);
+        dof_indices.resize(n_dofs);
+        cell->get_dof_indices(dof_indices);
+
+        if (include_cells)
+          {
+            hp_fe_values.reinit(cell);
+            const FEValues<dim, spacedim> &fe_values =
+              hp_fe_values.get_present_fe_values();
+            for (const unsigned int q : fe_values.quadrature_point_indices())
+              for (unsigned int i = 0; i < n_dofs; ++i)
+                for (unsigned int j = 0; j < n_dofs; ++j)
+                  cell_matrix(i, j) +=
+                    fe_values.shape_value(i, q) *
+                    coeff_value(fe_values.quadrature_point(q)) *
+                    fe_values.shape_value(j, q) * fe_values.JxW(q);
+          }
+
+        for (const unsigned int face : cell->face_indices())
+          {
+            if (!cell->at_boundary(face))
+              continue;
+
+            hp_fe_face_values.reinit(cell, face);
+            const FEFaceValues<dim, spacedim> &fe_face_values =
+              hp_fe_face_values.get_present_fe_values();
+            for (const unsigned int q :
+                 fe_face_values.quadrature_point_indices())
+              for (unsigned int i = 0; i < n_dofs; ++i)
+                {
+                  for (unsigned int j = 0; j < n_dofs; ++j)
+                    cell_matrix(i, j) +=
+                      fe_face_values.shape_value(i, q) *
+                      coeff_value(fe_face_values.quadrature_point(q)) *
+                      fe_face_values.shape_value(j, q) *
+                      fe_face_values.JxW(q);
+                  cell_rhs(i) +=
+                    fe_face_values.shape_value(i, q) *
+                    rhs_value(fe_face_values.quadrature_point(q)) *
+                    fe_face_values.JxW(q);
+                }
+          }
+
+        constraints.distribute_local_to_global(
+          cell_matrix, cell_rhs, dof_indices, system_matrix, system_rhs);
+      }
+  };
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const ScalarFunctor rhs("s", "s");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [&coeff_value](const FEValuesBase<dim, spacedim> &fe_values,
+                   const unsigned int                 q_point)
+    { return coeff_value(fe_values.quadrature_point(q_point)); });
+  const auto rhs_func = rhs.template value<double, dim, spacedim>(
+    [&rhs_value](const FEValuesBase<dim, spacedim> &fe_values,
+                 const unsigned int                 q_point)
+    { return rhs_value(fe_values.quadrature_point(q_point)); });
+
+  const auto verify = [&](const SparseMatrix<double> &system_matrix,
+                          const Vector<double> &      system_rhs,
+                          const SparseMatrix<double> &system_matrix_reference,
+                          const Vector<double> &      system_rhs_reference)
+  {
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix.begin(),
+              it2 = system_matrix_reference.begin();
+         it1 != system_matrix.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(it1->row(),
+                                             it1->column(),
+                                             it1->value(),
+                                             it2->value()));
+      }
+
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      AssertThrow(std::abs(system_rhs(i) - system_rhs_reference(i)) < tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_rhs(i),
+                                           system_rhs_reference(i)));
+  };
+
+  {
+    LogStream::Prefix prefix("Boundary only");
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_rhs_reference(dof_handler.n_dofs());
+    assemble_reference(system_matrix_reference, system_rhs_reference, false);
+
+    MatrixBasedAssembler<dim, spacedim> assembler;
+    assembler += bilinear_form(test.value(), coeff_func, trial.value()).dA();
+    assembler -= linear_form(test.value(), rhs_func).dA();
+
+    SparseMatrix<double> system_matrix(sparsity_pattern);
+    Vector<double>       system_rhs(dof_handler.n_dofs());
+    assembler.assemble_system(system_matrix,
+                              system_rhs,
+                              constraints,
+                              dof_handler,
+                              qf_collection_cell,
+                              qf_collection_face);
+
+    verify(system_matrix,
+           system_rhs,
+           system_matrix_reference,
+           system_rhs_reference);
+    deallog << "OK" << std::endl;
+  }
+
+  {
+    LogStream::Prefix prefix("Cell batches");
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_rhs_reference(dof_handler.n_dofs());
+    assemble_reference(system_matrix_reference, system_rhs_reference, true);
+
+    MatrixBasedAssembler<dim, spacedim> assembler;
+    assembler.set_cell_batch_flag(true);
+    assembler += bilinear_form(test.value(), coeff_func, trial.value()).dV();
+    assembler += bilinear_form(test.value(), coeff_func, trial.value()).dA();
+    assembler -= linear_form(test.value(), rhs_func).dA();
+
+    SparseMatrix<double> system_matrix(sparsity_pattern);
+    Vector<double>       system_rhs(dof_handler.n_dofs());
+    assembler.assemble_system(system_matrix,
+                              system_rhs,
+                              constraints,
+                              dof_handler,
+                              qf_collection_cell,
+                              qf_collection_face);
+
+    verify(system_matrix,
+           system_rhs,
+           system_matrix_reference,
+           system_rhs_reference);
+    deallog << "OK" << std::endl;
+  }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
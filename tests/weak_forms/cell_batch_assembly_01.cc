@@ -0,0 +1,198 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that assembling the cell contributions for batches of cells at a
+// time leads to the same system as assembling them one cell at a time.
+// - Multi-field problem, with a number of cells that is not a multiple of
+//   the vectorization width
+// - Cell and boundary contributions, for both bilinear and linear forms
+// - Fused and unfused integrals
+// - Symmetric and non-symmetric global system
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Displacement (vector) + pressure (scalar)
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2),
+                                   dim,
+                                   FE_Q<dim, spacedim>(1),
+                                   1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0);
+  GridTools::distort_random(0.1, triangulation, true, 1);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor_u(0, "u", "\\mathbf{u}");
+  const SubSpaceExtractors::Scalar   subspace_extractor_p(dim, "p", "p");
+
+  const auto test_u  = test[subspace_extractor_u];
+  const auto trial_u = trial[subspace_extractor_u];
+  const auto test_p  = test[subspace_extractor_p];
+  const auto trial_p = trial[subspace_extractor_p];
+
+  const ScalarFunctor                  coeff("c", "c");
+  const ScalarFunctor                  rhs("s", "s");
+  const SymmetricTensorFunctor<4, dim> coeff_C("C", "C");
+
+  // Functors that vary from one cell to the next, so that the values in
+  // each vectorization lane differ.
+  const auto coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &fe_values, const unsigned int q_point)
+    { return 2.0 + fe_values.quadrature_point(q_point)[0]; });
+  const auto rhs_func = rhs.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &fe_values, const unsigned int q_point)
+    { return 0.5 + fe_values.quadrature_point(q_point)[dim - 1]; });
+  const auto coeff_C_func = coeff_C.template value<double, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &fe_values, const unsigned int q_point)
+    {
+      return (1.0 + fe_values.quadrature_point(q_point).norm()) *
+             Physics::Elasticity::StandardTensors<dim>::S;
+    });
+
+  const auto form_1 = bilinear_form(test_u.symmetric_gradient(),
+                                    coeff_C_func,
+                                    trial_u.symmetric_gradient())
+                        .dV();
+  const auto form_2 =
+    bilinear_form(test_u.divergence(), coeff_func, trial_p.value()).dV();
+  const auto form_3 =
+    bilinear_form(test_p.value(), coeff_func, trial_u.divergence()).dV();
+  const auto form_4 =
+    bilinear_form(test_p.gradient(), coeff_func, trial_p.gradient()).dV();
+  const auto form_5 =
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+  const auto form_6 = linear_form(test_p.value(), rhs_func).dV();
+  const auto form_7 = linear_form(test_u.divergence(), rhs_func).dV();
+
+  const auto assemble = [&](SparseMatrix<double> &system_matrix,
+                            Vector<double> &      system_rhs,
+                            const bool            use_cell_batches,
+                            const bool            symmetric)
+  {
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+    assembler.set_cell_batch_flag(use_cell_batches);
+    if (symmetric)
+      assembler.symmetrize();
+    assembler += form_1 + form_2 + form_3;
+    assembler += fuse(form_4 + form_5 - form_6);
+    assembler -= form_7;
+    assembler.assemble_system(
+      system_matrix, system_rhs, constraints, dof_handler, qf_cell, qf_face);
+  };
+
+  for (const bool symmetric : {false, true})
+    {
+      SparseMatrix<double> system_matrix_batch(sparsity_pattern);
+      SparseMatrix<double> system_matrix_standard(sparsity_pattern);
+      Vector<double>       system_rhs_batch(dof_handler.n_dofs());
+      Vector<double>       system_rhs_standard(dof_handler.n_dofs());
+      assemble(system_matrix_batch, system_rhs_batch, true, symmetric);
+      assemble(system_matrix_standard, system_rhs_standard, false, symmetric);
+
+      constexpr double tol = 1e-12;
+      for (auto it1 = system_matrix_batch.begin(),
+                it2 = system_matrix_standard.begin();
+           it1 != system_matrix_batch.end();
+           ++it1, ++it2)
+        {
+          Assert(it2 != system_matrix_standard.end(), ExcInternalError());
+          AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                      ExcMatrixEntriesNotEqual(it1->row(),
+                                               it1->column(),
+                                               it1->value(),
+                                               it2->value()));
+        }
+
+      for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+        AssertThrow(std::abs(system_rhs_batch(i) - system_rhs_standard(i)) <
+                      tol,
+                    ExcVectorEntriesNotEqual(i,
+                                             system_rhs_batch(i),
+                                             system_rhs_standard(i)));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
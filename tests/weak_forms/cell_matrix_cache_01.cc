@@ -0,0 +1,179 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that caching the solution-independent local cell matrices leads to
+// the same system as recomputing all contributions in each assembly call.
+// - Solution-dependent and solution-independent cell contributions
+// - Boundary contributions
+// - Change of the solution, refinement of the mesh, and movement of the mesh
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const FieldSolution<dim, spacedim> field_solution;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u   = test[subspace_extractor];
+  const auto trial_u  = trial[subspace_extractor];
+  const auto grad_u_h = field_solution[subspace_extractor].gradient();
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  const auto assemble = [&](MatrixBasedAssembler<dim,
+                                                 spacedim,
+                                                 double,
+                                                 use_vectorization> &assembler)
+  {
+    assembler +=
+      bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+      bilinear_form(test_u.value(), grad_u_h, trial_u.value()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+  };
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization>
+    assembler_cached;
+  assembler_cached.set_cell_matrix_cache_flag(true);
+  assemble(assembler_cached);
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization>
+    assembler_reference;
+  assemble(assembler_reference);
+
+  const auto verify = [&](const double solution_scale)
+  {
+    SparsityPattern sparsity_pattern;
+    {
+      DynamicSparsityPattern dsp(dof_handler.n_dofs());
+      DoFTools::make_sparsity_pattern(dof_handler, dsp);
+      sparsity_pattern.copy_from(dsp);
+    }
+
+    Vector<double> solution(dof_handler.n_dofs());
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      solution(i) = solution_scale * std::sin(1.0 * i);
+
+    SparseMatrix<double> system_matrix_cached(sparsity_pattern);
+    assembler_cached.assemble_matrix(system_matrix_cached,
+                                     solution,
+                                     constraints,
+                                     dof_handler,
+                                     qf_cell,
+                                     qf_face);
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    assembler_reference.assemble_matrix(system_matrix_reference,
+                                        solution,
+                                        constraints,
+                                        dof_handler,
+                                        qf_cell,
+                                        qf_face);
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix_cached.begin(),
+              it2 = system_matrix_reference.begin();
+         it1 != system_matrix_cached.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+  };
+
+  // Fill the cache, and then reuse it with a different solution.
+  dof_handler.distribute_dofs(fe);
+  verify(1.0);
+  verify(0.5);
+
+  // The cache must be invalidated when the mesh changes.
+  triangulation.refine_global(1);
+  dof_handler.distribute_dofs(fe);
+  verify(0.25);
+
+  // The cache must also be invalidated when the vertices are moved.
+  GridTools::scale(2.0, triangulation);
+  verify(0.25);
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,175 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that overlapping the exchange of off-process contributions with the
+// assembly leads to the same distributed RHS vector as the standard assembly.
+// - Cell and boundary contributions
+// - Two RHS vectors that are assembled in a single loop, whose exchanges are
+//   in flight at the same time
+
+#include <deal.II/base/index_set.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/distributed/shared_tria.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/grid/grid_generator.h>
+
+#include <deal.II/lac/la_parallel_vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include <array>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+
+  using namespace WeakForms;
+
+  const MPI_Comm mpi_communicator = MPI_COMM_WORLD;
+
+  const FE_Q<dim, spacedim>  fe(2);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  parallel::shared::Triangulation<dim, spacedim> triangulation(
+    mpi_communicator,
+    Triangulation<dim, spacedim>::none,
+    false,
+    parallel::shared::Triangulation<dim, spacedim>::partition_zorder);
+  GridGenerator::subdivided_hyper_cube(triangulation, 4, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  const IndexSet &locally_owned_dofs = dof_handler.locally_owned_dofs();
+  IndexSet        locally_relevant_dofs;
+  DoFTools::extract_locally_relevant_dofs(dof_handler, locally_relevant_dofs);
+
+  AffineConstraints<double> constraints(locally_relevant_dofs);
+  constraints.close();
+
+  const TestFunction<dim, spacedim> test;
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+  using VectorType = LinearAlgebra::distributed::Vector<double>;
+
+  const auto assemble = [&](const bool overlap_communication)
+  {
+    Assembler assembler;
+    assembler.set_communication_overlap_flag(overlap_communication);
+    assembler += linear_form(test.value(), coeff_func).dV() +
+                 linear_form(test.value(), coeff_func).dA();
+
+    VectorType system_vector(locally_owned_dofs,
+                             locally_relevant_dofs,
+                             mpi_communicator);
+    assembler.assemble_rhs_vector(
+      system_vector, constraints, dof_handler, qf_cell, qf_face);
+    return system_vector;
+  };
+
+  const auto verify = [&](const VectorType &vector,
+                          const VectorType &vector_reference)
+  {
+    constexpr double tol = 1e-12;
+    for (const auto i : locally_owned_dofs)
+      AssertThrow(std::abs(vector(i) - vector_reference(i)) < tol,
+                  ExcVectorEntriesNotEqual(i, vector(i), vector_reference(i)));
+  };
+
+  const VectorType system_vector_reference = assemble(false);
+  verify(assemble(true), system_vector_reference);
+
+  // The second slot holds twice the cell contributions of the first slot,
+  // and no boundary contributions.
+  {
+    Assembler assembler;
+    assembler.set_communication_overlap_flag(true);
+    assembler.add(linear_form(test.value(), coeff_func).dV() +
+                    linear_form(test.value(), coeff_func).dA(),
+                  0);
+    assembler.add(linear_form(test.value(), coeff_func).dV() +
+                    linear_form(test.value(), coeff_func).dV(),
+                  1);
+
+    std::array<VectorType, 2> system_vectors;
+    for (auto &system_vector : system_vectors)
+      system_vector.reinit(locally_owned_dofs,
+                           locally_relevant_dofs,
+                           mpi_communicator);
+    assembler.assemble_systems(
+      std::array<std::nullptr_t *, 1>{{nullptr}},
+      std::array<VectorType *, 2>{{&system_vectors[0], &system_vectors[1]}},
+      constraints,
+      dof_handler,
+      qf_cell,
+      qf_face);
+
+    Assembler assembler_reference;
+    assembler_reference += linear_form(test.value(), coeff_func).dV() +
+                           linear_form(test.value(), coeff_func).dV();
+    VectorType system_vector_reference_1(locally_owned_dofs,
+                                         locally_relevant_dofs,
+                                         mpi_communicator);
+    assembler_reference.assemble_rhs_vector(system_vector_reference_1,
+                                            constraints,
+                                            dof_handler,
+                                            qf_cell,
+                                            qf_face);
+
+    verify(system_vectors[0], system_vector_reference);
+    verify(system_vectors[1], system_vector_reference_1);
+  }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+  mpi_initlog();
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,179 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the diagonal and the row-sum lumped matrix that are assembled
+// directly are the same as those extracted from the assembled matrix.
+// - Laplace + mass + boundary mass (vector-valued finite element)
+// - Locally refined mesh, with hanging node and boundary constraints
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0, true);
+  GridTools::distort_random(0.1, triangulation, true, 1);
+  triangulation.begin_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+  DoFTools::make_zero_boundary_constraints(dof_handler, 0, constraints);
+  constraints.close();
+  AssertThrow(constraints.n_constraints() > 0, ExcInternalError());
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+  assembler +=
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+
+  SparseMatrix<double> system_matrix(sparsity_pattern);
+  assembler.assemble_matrix(
+    system_matrix, constraints, dof_handler, qf_cell, qf_face);
+
+  Vector<double> diagonal(dof_handler.n_dofs());
+  assembler.assemble_diagonal(
+    diagonal, constraints, dof_handler, qf_cell, qf_face);
+
+  Vector<double> lumped(dof_handler.n_dofs());
+  assembler.assemble_lumped(lumped, constraints, dof_handler, qf_cell, qf_face);
+
+  Vector<double> ones(dof_handler.n_dofs());
+  Vector<double> row_sums(dof_handler.n_dofs());
+  ones = 1.0;
+  system_matrix.vmult(row_sums, ones);
+
+  // The rows of the condensed matrix that belong to constrained DoFs only
+  // hold an arbitrary diagonal entry, while the directly assembled diagonal
+  // and row sums are the identity on them.
+  const double tol = 1e-12 * std::max(1.0, system_matrix.linfty_norm());
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    {
+      if (constraints.is_constrained(i))
+        {
+          AssertThrow(std::abs(diagonal(i) - 1.0) < tol,
+                      ExcVectorEntriesNotEqual(i, diagonal(i), 1.0));
+          AssertThrow(std::abs(lumped(i) - 1.0) < tol,
+                      ExcVectorEntriesNotEqual(i, lumped(i), 1.0));
+          continue;
+        }
+
+      AssertThrow(std::abs(diagonal(i) - system_matrix.diag_element(i)) < tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           diagonal(i),
+                                           system_matrix.diag_element(i)));
+      AssertThrow(std::abs(lumped(i) - row_sums(i)) < tol,
+                  ExcVectorEntriesNotEqual(i, lumped(i), row_sums(i)));
+    }
+
+  // The vector is not reset, so assembling into it once more accumulates
+  // all of the contributions, including those for the constrained DoFs.
+  Vector<double> diagonal_2(diagonal);
+  assembler.assemble_diagonal(
+    diagonal_2, constraints, dof_handler, qf_cell, qf_face);
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    AssertThrow(std::abs(diagonal_2(i) - 2.0 * diagonal(i)) < 2.0 * tol,
+                ExcVectorEntriesNotEqual(i, diagonal_2(i), 2.0 * diagonal(i)));
+
+  // The assembler must be left in a state in which the full matrix is
+  // assembled again.
+  SparseMatrix<double> system_matrix_2(sparsity_pattern);
+  assembler.assemble_matrix(
+    system_matrix_2, constraints, dof_handler, qf_cell, qf_face);
+  for (auto it1 = system_matrix.begin(), it2 = system_matrix_2.begin();
+       it1 != system_matrix.end();
+       ++it1, ++it2)
+    AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                ExcMatrixEntriesNotEqual(
+                  it1->row(), it1->column(), it1->value(), it2->value()));
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,146 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the element-by-element application of the operator gives the
+// same result as multiplying by the assembled matrix.
+// - Laplace + mass + boundary mass (vector-valued finite element)
+// - Homogeneous Dirichlet constraints
+
+#include <deal.II/base/function.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/numerics/vector_tools.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+  GridTools::distort_random(0.1, triangulation, true, 1);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  VectorTools::interpolate_boundary_values(dof_handler,
+                                           0,
+                                           Functions::ZeroFunction<spacedim>(
+                                             fe.n_components()),
+                                           constraints);
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+  assembler +=
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+
+  SparseMatrix<double> system_matrix(sparsity_pattern);
+  assembler.assemble_matrix(
+    system_matrix, constraints, dof_handler, qf_cell, qf_face);
+
+  Vector<double> src(dof_handler.n_dofs());
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    src(i) = 1.0 + 0.25 * std::sin(1.0 * i);
+
+  Vector<double> dst(dof_handler.n_dofs());
+  system_matrix.vmult(dst, src);
+
+  Vector<double> dst_ebe(dof_handler.n_dofs());
+  dst_ebe = 1.0; // Must be overwritten
+  assembler.apply(dst_ebe, src, constraints, dof_handler, qf_cell, qf_face);
+
+  const double tol = 1e-12 * std::max(1.0, dst.l2_norm());
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    {
+      // The operator acts as the identity on constrained DoFs.
+      const double expected = (constraints.is_constrained(i) ? src(i) : dst(i));
+      AssertThrow(std::abs(dst_ebe(i) - expected) < tol,
+                  ExcVectorEntriesNotEqual(i, dst_ebe(i), expected));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,196 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that fusing the contributions of several forms leads to the same
+// system as adding each form individually.
+// - Bilinear and linear forms
+// - Cell and boundary contributions
+// - Addition, subtraction and negation of integrals
+// - Fused composites that are added to and subtracted from the assembler
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/mixed_operators.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FE_Q<dim, spacedim>  fe(1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const ScalarFunctor rhs("s", "s");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+  const auto rhs_func = rhs.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 0.5; });
+
+  const auto form_1 =
+    bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV();
+  const auto form_2 =
+    bilinear_form(test.value(), coeff_func, trial.value()).dV();
+  const auto form_3 =
+    bilinear_form(test.value(), coeff_func, trial.value()).dA();
+  const auto form_4 = linear_form(test.value(), rhs_func).dV();
+  const auto form_5 = linear_form(test.value(), coeff_func).dA();
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  const auto verify = [&](const auto &add_forms_fused,
+                          const auto &add_forms_unfused)
+  {
+    SparseMatrix<double> system_matrix_fused(sparsity_pattern);
+    Vector<double>       system_rhs_fused(dof_handler.n_dofs());
+    {
+      Assembler assembler;
+      add_forms_fused(assembler);
+      assembler.assemble_system(system_matrix_fused,
+                                system_rhs_fused,
+                                constraints,
+                                dof_handler,
+                                qf_cell,
+                                qf_face);
+    }
+
+    SparseMatrix<double> system_matrix_unfused(sparsity_pattern);
+    Vector<double>       system_rhs_unfused(dof_handler.n_dofs());
+    {
+      Assembler assembler;
+      add_forms_unfused(assembler);
+      assembler.assemble_system(system_matrix_unfused,
+                                system_rhs_unfused,
+                                constraints,
+                                dof_handler,
+                                qf_cell,
+                                qf_face);
+    }
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix_fused.begin(),
+              it2 = system_matrix_unfused.begin();
+         it1 != system_matrix_fused.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_unfused.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      AssertThrow(std::abs(system_rhs_fused(i) - system_rhs_unfused(i)) < tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_rhs_fused(i),
+                                           system_rhs_unfused(i)));
+  };
+
+  // The fused composite is added
+  verify(
+    [&](Assembler &assembler)
+    { assembler += fuse(form_1 + form_2 - form_3 - (form_4 + form_5)); },
+    [&](Assembler &assembler)
+    {
+      assembler += form_1;
+      assembler += form_2;
+      assembler -= form_3;
+      assembler -= form_4;
+      assembler -= form_5;
+    });
+
+  // The fused composite is subtracted
+  verify(
+    [&](Assembler &assembler)
+    {
+      assembler -= fuse(form_1 - form_3 + form_5);
+      assembler += form_2;
+    },
+    [&](Assembler &assembler)
+    {
+      assembler -= form_1;
+      assembler += form_3;
+      assembler -= form_5;
+      assembler += form_2;
+    });
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,176 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that assembling the cells by color, with concurrent writes into the
+// global system, leads to the same system as the standard assembly.
+// - Cell and boundary contributions
+// - Hanging node constraints
+// - The coloring is reused, and then recomputed after mesh refinement
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FE_Q<dim, spacedim>  fe(2);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0);
+  triangulation.begin_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  AffineConstraints<double> constraints;
+  SparsityPattern           sparsity_pattern;
+
+  const auto setup_system = [&]()
+  {
+    dof_handler.distribute_dofs(fe);
+
+    constraints.clear();
+    DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+    constraints.close();
+
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+    sparsity_pattern.copy_from(dsp);
+  };
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  const auto add_forms = [&](Assembler &assembler)
+  {
+    assembler +=
+      bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+      bilinear_form(test.value(), coeff_func, trial.value()).dV() +
+      bilinear_form(test.value(), coeff_func, trial.value()).dA() -
+      linear_form(test.value(), coeff_func).dV() -
+      linear_form(test.value(), coeff_func).dA();
+  };
+
+  Assembler assembler_colored;
+  assembler_colored.set_graph_coloring_flag(true);
+  add_forms(assembler_colored);
+
+  Assembler assembler_reference;
+  add_forms(assembler_reference);
+
+  const auto verify = [&]()
+  {
+    SparseMatrix<double> system_matrix(sparsity_pattern);
+    Vector<double>       system_vector(dof_handler.n_dofs());
+    assembler_colored.assemble_system(
+      system_matrix, system_vector, constraints, dof_handler, qf_cell, qf_face);
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_vector_reference(dof_handler.n_dofs());
+    assembler_reference.assemble_system(system_matrix_reference,
+                                        system_vector_reference,
+                                        constraints,
+                                        dof_handler,
+                                        qf_cell,
+                                        qf_face);
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix.begin(),
+              it2 = system_matrix_reference.begin();
+         it1 != system_matrix.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+
+    for (unsigned int i = 0; i < system_vector.size(); ++i)
+      AssertThrow(std::abs(system_vector(i) - system_vector_reference(i)) <
+                    tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_vector(i),
+                                           system_vector_reference(i)));
+  };
+
+  setup_system();
+  verify();
+
+  // Assemble again with the cached coloring
+  verify();
+
+  // Refine the mesh, which invalidates the coloring
+  triangulation.last_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+  setup_system();
+  verify();
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,289 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that the pooled interface data of the copy data gives the same
+// results as creating new interface data for each interface.
+// - Interfaces with several different numbers of DoFs
+// - Copy data that is presized for all interfaces
+// - DG assembly on an hp mesh, twice with the same assembler so that the
+//   second call uses the presized copy data
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_dgq.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/hp/fe_collection.h>
+#include <deal.II/hp/fe_values.h>
+#include <deal.II/hp/q_collection.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/spaces.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+void
+test_copy_data()
+{
+  LogStream::Prefix prefix("Copy data");
+
+  using CopyData = WeakForms::internal::CopyDataWithInterfaceSupport<double>;
+
+  // The numbers of DoFs of the interfaces of each cell.
+  const std::vector<std::vector<unsigned int>> cell_interface_dofs = {
+    {8, 13}, {13, 18, 8}, {18}, {8, 8, 13, 13}, {}, {18, 13}};
+
+  const auto verify = [&](CopyData &copy_data)
+  {
+    for (const std::vector<unsigned int> &interface_dofs :
+         cell_interface_dofs)
+      {
+        copy_data.reset(4);
+        AssertThrow(copy_data.n_interface_data() == 0, ExcInternalError());
+
+        for (unsigned int i = 0; i < interface_dofs.size(); ++i)
+          {
+            const unsigned int n_dofs = interface_dofs[i];
+            typename CopyData::InterfaceData &data =
+              copy_data.add_interface_data(n_dofs);
+            AssertThrow(copy_data.n_interface_data() == i + 1,
+                        ExcInternalError());
+
+            // This is what the interface data used to be before it was
+            // pooled: A new object for each interface.
+            typename CopyData::InterfaceData reference;
+            reference.reset(n_dofs);
+
+            AssertThrow(data.n_dofs() == n_dofs,
+                        ExcDimensionMismatch(data.n_dofs(), n_dofs));
+            AssertThrow(data.matrices[0].m() == reference.matrices[0].m() &&
+                          data.matrices[0].n() == reference.matrices[0].n(),
+                        ExcInternalError());
+            AssertThrow(data.matrices[0].all_zero(),
+                        ExcMessage("The pooled matrix was not cleared."));
+            AssertThrow(data.vectors[0].size() == reference.vectors[0].size(),
+                        ExcInternalError());
+            AssertThrow(data.vectors[0].all_zero(),
+                        ExcMessage("The pooled vector was not cleared."));
+            AssertThrow(data.local_dof_indices[0].size() ==
+                          reference.local_dof_indices[0].size(),
+                        ExcInternalError());
+
+            // Dirty the data, so that the next user has to clear it.
+            for (unsigned int r = 0; r < n_dofs; ++r)
+              {
+                data.vectors[0][r]           = 1.0 + r;
+                data.local_dof_indices[0][r] = r;
+                for (unsigned int c = 0; c < n_dofs; ++c)
+                  data.matrices[0](r, c) = 1.0 + r + c;
+              }
+          }
+
+        // The interface data that was added remains in the order that it
+        // was added in.
+        for (unsigned int i = 0; i < interface_dofs.size(); ++i)
+          AssertThrow(copy_data.get_interface_data(i).n_dofs() ==
+                        interface_dofs[i],
+                      ExcDimensionMismatch(
+                        copy_data.get_interface_data(i).n_dofs(),
+                        interface_dofs[i]));
+      }
+  };
+
+  {
+    CopyData copy_data(4);
+    verify(copy_data);
+    deallog << "Empty: OK" << std::endl;
+  }
+
+  {
+    CopyData sample_copy_data(4);
+    sample_copy_data.reserve_interface_data(4, 18);
+    CopyData copy_data(sample_copy_data);
+    verify(copy_data);
+    verify(copy_data);
+    deallog << "Presized: OK" << std::endl;
+  }
+}
+
+
+template <int dim, int spacedim = dim>
+void
+test_assembly()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Neighbouring cells with different elements lead to interfaces with
+  // several different numbers of DoFs.
+  hp::FECollection<dim, spacedim> fe_collection;
+  hp::QCollection<spacedim>       qf_collection_cell;
+  hp::QCollection<spacedim - 1>   qf_collection_face;
+  for (unsigned int degree = 1; degree <= 2; ++degree)
+    {
+      fe_collection.push_back(FE_DGQ<dim, spacedim>(degree));
+      qf_collection_cell.push_back(QGauss<spacedim>(3));
+      qf_collection_face.push_back(QGauss<spacedim - 1>(3));
+    }
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  for (const auto &cell : dof_handler.active_cell_iterators())
+    cell->set_active_fe_index((cell->active_cell_index() % 3 == 0) ? 1 : 0);
+  dof_handler.distribute_dofs(fe_collection);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_flux_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  // Reference: Interface contributions computed face by face.
+  SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+  {
+    hp::FEFaceValues<dim, spacedim> fe_face_values(fe_collection,
+                                                   qf_collection_face,
+                                                   update_values |
+                                                     update_JxW_values);
+    hp::FEFaceValues<dim, spacedim> fe_face_values_neighbor(
+      fe_collection, qf_collection_face, update_values);
+
+    std::vector<dealii::types::global_dof_index> dof_indices;
+    std::vector<dealii::types::global_dof_index> dof_indices_neighbor;
+    std::vector<dealii::types::global_dof_index> interface_dof_indices;
+
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      for (const unsigned int face : cell->face_indices())
+        {
+          if (cell->at_boundary(face))
+            continue;
+
+          // Visit each interface only once.
+          const auto neighbor = cell->neighbor(face);
+          if (neighbor->active_cell_index() < cell->active_cell_index())
+            continue;
+
+          fe_face_values.reinit(cell, face);
+          fe_face_values_neighbor.reinit(neighbor,
+                                         cell->neighbor_of_neighbor(face));
+          const FEFaceValues<dim, spacedim> &fe_values =
+            fe_face_values.get_present_fe_values();
+          const FEFaceValues<dim, spacedim> &fe_values_neighbor =
+            fe_face_values_neighbor.get_present_fe_values();
+
+          dof_indices.resize(fe_values.dofs_per_cell);
+          dof_indices_neighbor.resize(fe_values_neighbor.dofs_per_cell);
+          cell->get_dof_indices(dof_indices);
+          neighbor->get_dof_indices(dof_indices_neighbor);
+
+          interface_dof_indices = dof_indices;
+          interface_dof_indices.insert(interface_dof_indices.end(),
+                                       dof_indices_neighbor.begin(),
+                                       dof_indices_neighbor.end());
+          const unsigned int n_interface_dofs = interface_dof_indices.size();
+
+          const auto jump = [&](const unsigned int i, const unsigned int q)
+          {
+            return (i < fe_values.dofs_per_cell ?
+                      fe_values.shape_value(i, q) :
+                      -fe_values_neighbor.shape_value(
+                        i - fe_values.dofs_per_cell, q));
+          };
+
+          FullMatrix<double> interface_matrix(n_interface_dofs,
+                                              n_interface_dofs);
+          for (const unsigned int q : fe_values.quadrature_point_indices())
+            for (unsigned int i = 0; i < n_interface_dofs; ++i)
+              for (unsigned int j = 0; j < n_interface_dofs; ++j)
+                interface_matrix(i, j) +=
+                  jump(i, q) * jump(j, q) * fe_values.JxW(q);
+
+          constraints.distribute_local_to_global(interface_matrix,
+                                                 interface_dof_indices,
+                                                 system_matrix_reference);
+        }
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  MatrixBasedAssembler<dim, spacedim> assembler;
+  assembler +=
+    bilinear_form(test.jump_in_values(), trial.jump_in_values()).dI();
+
+  // The first assembly call records the capacity that the copy data
+  // requires, and the second starts out with copy data of that size.
+  for (unsigned int assembly_call = 0; assembly_call < 2; ++assembly_call)
+    {
+      SparseMatrix<double> system_matrix(sparsity_pattern);
+      assembler.assemble_matrix(system_matrix,
+                                constraints,
+                                dof_handler,
+                                qf_collection_cell,
+                                qf_collection_face);
+
+      constexpr double tol = 1e-12;
+      for (auto it1 = system_matrix.begin(),
+                it2 = system_matrix_reference.begin();
+           it1 != system_matrix.end();
+           ++it1, ++it2)
+        {
+          Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+          AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                      ExcMatrixEntriesNotEqual(it1->row(),
+                                               it1->column(),
+                                               it1->value(),
+                                               it2->value()));
+        }
+
+      deallog << "Assembly call " << assembly_call << ": OK" << std::endl;
+    }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  test_copy_data();
+  test_assembly<2>();
+  test_assembly<3>();
+
+  deallog << "OK" << std::endl;
+}
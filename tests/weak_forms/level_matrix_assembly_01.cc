@@ -0,0 +1,253 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the multigrid level and interface matrices that are assembled
+// from the cells on each level match those assembled by hand, in the same
+// way as is done in step-16.
+// - Cell and boundary contributions
+// - Locally refined mesh, with refinement edges and boundary constraints
+
+#include <deal.II/base/mg_level_object.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <deal.II/multigrid/mg_constrained_dofs.h>
+#include <deal.II/multigrid/mg_tools.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FE_Q<dim, spacedim>  fe(2);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation(
+    Triangulation<dim, spacedim>::limit_level_difference_at_vertices);
+  GridGenerator::hyper_cube(triangulation, 0.0, 1.0);
+  triangulation.refine_global(2);
+  triangulation.begin_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+  dof_handler.distribute_mg_dofs();
+
+  MGConstrainedDoFs mg_constrained_dofs;
+  mg_constrained_dofs.initialize(dof_handler);
+  mg_constrained_dofs.make_zero_boundary_constraints(dof_handler, {0});
+
+  const unsigned int n_levels = triangulation.n_global_levels();
+
+  MGLevelObject<SparsityPattern> level_sparsity_patterns(0, n_levels - 1);
+  MGLevelObject<SparsityPattern> interface_sparsity_patterns(0, n_levels - 1);
+  for (unsigned int level = 0; level < n_levels; ++level)
+    {
+      DynamicSparsityPattern dsp(dof_handler.n_dofs(level));
+      MGTools::make_sparsity_pattern(dof_handler, dsp, level);
+      level_sparsity_patterns[level].copy_from(dsp);
+
+      DynamicSparsityPattern dsp_interface(dof_handler.n_dofs(level));
+      MGTools::make_interface_sparsity_pattern(dof_handler,
+                                               mg_constrained_dofs,
+                                               dsp_interface,
+                                               level);
+      interface_sparsity_patterns[level].copy_from(dsp_interface);
+    }
+
+  const auto initialize_matrices =
+    [&](MGLevelObject<SparseMatrix<double>> &level_matrices,
+        MGLevelObject<SparseMatrix<double>> &interface_matrices)
+  {
+    level_matrices.resize(0, n_levels - 1);
+    interface_matrices.resize(0, n_levels - 1);
+    for (unsigned int level = 0; level < n_levels; ++level)
+      {
+        level_matrices[level].reinit(level_sparsity_patterns[level]);
+        interface_matrices[level].reinit(interface_sparsity_patterns[level]);
+      }
+  };
+
+  const double coeff_value = 2.0;
+
+  // Assembly with the weak forms
+  MGLevelObject<SparseMatrix<double>> level_matrices;
+  MGLevelObject<SparseMatrix<double>> interface_matrices;
+  initialize_matrices(level_matrices, interface_matrices);
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [coeff_value](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return coeff_value; });
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+  assembler +=
+    bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+    bilinear_form(test.value(), coeff_func, trial.value()).dV() +
+    bilinear_form(test.value(), coeff_func, trial.value()).dA();
+
+  assembler.assemble_level_matrices(level_matrices,
+                                    interface_matrices,
+                                    mg_constrained_dofs,
+                                    dof_handler,
+                                    qf_cell,
+                                    qf_face);
+
+  // Assembly by hand
+  MGLevelObject<SparseMatrix<double>> level_matrices_reference;
+  MGLevelObject<SparseMatrix<double>> interface_matrices_reference;
+  initialize_matrices(level_matrices_reference, interface_matrices_reference);
+  {
+    FEValues<dim, spacedim> fe_values(fe,
+                                      qf_cell,
+                                      update_values | update_gradients |
+                                        update_JxW_values);
+
+    FEFaceValues<dim, spacedim> fe_face_values(fe,
+                                               qf_face,
+                                               update_values |
+                                                 update_JxW_values);
+
+    const unsigned int n_dofs_per_cell = fe.dofs_per_cell;
+    FullMatrix<double> cell_matrix(n_dofs_per_cell, n_dofs_per_cell);
+    std::vector<types::global_dof_index> local_dof_indices(n_dofs_per_cell);
+
+    for (unsigned int level = 0; level < n_levels; ++level)
+      {
+        IndexSet locally_relevant_level_dofs;
+        DoFTools::extract_locally_relevant_level_dofs(
+          dof_handler, level, locally_relevant_level_dofs);
+
+        AffineConstraints<double> boundary_constraints;
+        boundary_constraints.reinit(locally_relevant_level_dofs);
+        boundary_constraints.add_lines(
+          mg_constrained_dofs.get_refinement_edge_indices(level));
+        boundary_constraints.add_lines(
+          mg_constrained_dofs.get_boundary_indices(level));
+        boundary_constraints.close();
+
+        for (const auto &cell : dof_handler.mg_cell_iterators_on_level(level))
+          {
+            cell_matrix = 0;
+
+            fe_values.reinit(cell);
+            for (const unsigned int q : fe_values.quadrature_point_indices())
+              for (const unsigned int i : fe_values.dof_indices())
+                for (const unsigned int j : fe_values.dof_indices())
+                  cell_matrix(i, j) +=
+                    coeff_value *
+                    (fe_values.shape_grad(i, q) * fe_values.shape_grad(j, q) +
+                     fe_values.shape_value(i, q) *
+                       fe_values.shape_value(j, q)) *
+                    fe_values.JxW(q);
+
+            for (const unsigned int face : cell->face_indices())
+              if (cell->at_boundary(face))
+                {
+                  fe_face_values.reinit(cell, face);
+                  for (const unsigned int q :
+                       fe_face_values.quadrature_point_indices())
+                    for (const unsigned int i : fe_face_values.dof_indices())
+                      for (const unsigned int j : fe_face_values.dof_indices())
+                        cell_matrix(i, j) += coeff_value *
+                                             fe_face_values.shape_value(i, q) *
+                                             fe_face_values.shape_value(j, q) *
+                                             fe_face_values.JxW(q);
+                }
+
+            cell->get_mg_dof_indices(local_dof_indices);
+            boundary_constraints.distribute_local_to_global(
+              cell_matrix, local_dof_indices, level_matrices_reference[level]);
+
+            for (unsigned int i = 0; i < n_dofs_per_cell; ++i)
+              for (unsigned int j = 0; j < n_dofs_per_cell; ++j)
+                if (mg_constrained_dofs.is_interface_matrix_entry(
+                      level, local_dof_indices[i], local_dof_indices[j]))
+                  interface_matrices_reference[level].add(local_dof_indices[i],
+                                                          local_dof_indices[j],
+                                                          cell_matrix(i, j));
+          }
+      }
+  }
+
+  const auto verify = [](const SparseMatrix<double> &matrix,
+                         const SparseMatrix<double> &matrix_reference)
+  {
+    constexpr double tol = 1e-12;
+    for (auto it1 = matrix.begin(), it2 = matrix_reference.begin();
+         it1 != matrix.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+  };
+
+  for (unsigned int level = 0; level < n_levels; ++level)
+    {
+      verify(level_matrices[level], level_matrices_reference[level]);
+      verify(interface_matrices[level], interface_matrices_reference[level]);
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,161 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that computing the local matrix with the GEMM kernel leads to the
+// same system as the standard kernel.
+// - Vector-valued finite element, with scalar, vector and tensor-valued
+//   shape function data
+// - Cell and boundary contributions
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  const ScalarFunctor                  coeff("c", "c");
+  const TensorFunctor<2, dim>          coeff_T("T", "T");
+  const SymmetricTensorFunctor<4, dim> coeff_C("C", "C");
+
+  const auto coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+  const auto coeff_T_func = coeff_T.template value<double, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    {
+      Tensor<2, dim> T(unit_symmetric_tensor<dim>());
+      T[0][dim - 1] += 0.5;
+      return T;
+    });
+  const auto coeff_C_func = coeff_C.template value<double, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0 * Physics::Elasticity::StandardTensors<dim>::S; });
+
+  const auto form_1 = bilinear_form(test_u.symmetric_gradient(),
+                                    coeff_C_func,
+                                    trial_u.symmetric_gradient())
+                        .dV();
+  const auto form_2 =
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV();
+  const auto form_3 =
+    bilinear_form(test_u.value(), coeff_T_func, trial_u.value()).dV();
+  const auto form_4 =
+    bilinear_form(test_u.divergence(), coeff_func, trial_u.divergence()).dV();
+  const auto form_5 =
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+
+  const auto assemble = [&](SparseMatrix<double> &system_matrix,
+                            const bool            use_gemm_kernel)
+  {
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+    assembler.set_local_gemm_kernel_flag(use_gemm_kernel);
+    assembler += form_1 + form_2 + form_3 - form_4 + form_5;
+    assembler.assemble_matrix(
+      system_matrix, constraints, dof_handler, qf_cell, qf_face);
+  };
+
+  SparseMatrix<double> system_matrix_gemm(sparsity_pattern);
+  SparseMatrix<double> system_matrix_standard(sparsity_pattern);
+  assemble(system_matrix_gemm, true);
+  assemble(system_matrix_standard, false);
+
+  constexpr double tol = 1e-12;
+  for (auto it1 = system_matrix_gemm.begin(),
+            it2 = system_matrix_standard.begin();
+       it1 != system_matrix_gemm.end();
+       ++it1, ++it2)
+    {
+      Assert(it2 != system_matrix_standard.end(), ExcInternalError());
+      AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                  ExcMatrixEntriesNotEqual(
+                    it1->row(), it1->column(), it1->value(), it2->value()));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,273 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the action of the matrix-free assembler is the same as that
+// of a matrix assembled with the matrix-based assembler
+// - Laplace + mass + boundary mass (scalar-valued finite element)
+// - Linear elasticity (vector-valued finite element)
+// - Spatially varying coefficients
+// - Hanging node and homogeneous Dirichlet constraints
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+#include <deal.II/fe/mapping_q1.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/la_parallel_vector.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/physics/elasticity/standard_tensors.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/assembler_matrix_free.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, int fe_degree, int n_components, typename AssemblerType>
+void
+verify_action(const MatrixFreeAssembler<dim,
+                                        fe_degree,
+                                        fe_degree + 1,
+                                        n_components> &matrix_free_assembler,
+              const AssemblerType &                    matrix_based_assembler,
+              const DoFHandler<dim> &                  dof_handler,
+              const AffineConstraints<double> &        constraints)
+{
+  using namespace WeakForms;
+
+  const QGauss<dim>     qf_cell(fe_degree + 1);
+  const QGauss<dim - 1> qf_face(fe_degree + 1);
+
+  SparsityPattern      sparsity_pattern;
+  SparseMatrix<double> system_matrix;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+    sparsity_pattern.copy_from(dsp);
+    system_matrix.reinit(sparsity_pattern);
+  }
+  matrix_based_assembler.assemble_matrix(
+    system_matrix, constraints, dof_handler, qf_cell, qf_face);
+
+  LinearAlgebra::distributed::Vector<double> src_mf;
+  LinearAlgebra::distributed::Vector<double> dst_mf;
+  matrix_free_assembler.initialize_dof_vector(src_mf);
+  matrix_free_assembler.initialize_dof_vector(dst_mf);
+
+  Vector<double> src(dof_handler.n_dofs());
+  Vector<double> dst(dof_handler.n_dofs());
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    {
+      src(i)    = 1.0 + 0.25 * std::sin(1.0 * i);
+      src_mf(i) = src(i);
+    }
+
+  system_matrix.vmult(dst, src);
+  matrix_free_assembler.vmult(dst_mf, src_mf);
+
+  AssertThrow(matrix_free_assembler.m() == dof_handler.n_dofs(),
+              ExcDimensionMismatch(matrix_free_assembler.m(),
+                                   dof_handler.n_dofs()));
+
+  // The rows of the unconstrained DoFs are those of the condensed system
+  // matrix. The matrix-free operator acts as the identity on DoFs with
+  // homogeneous Dirichlet constraints, while the rows of DoFs with hanging
+  // node constraints are not part of the condensed system.
+  const double tol = 1e-10 * std::max(1.0, dst.l2_norm());
+  for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+    {
+      double expected = dst(i);
+      if (constraints.is_constrained(i))
+        {
+          if (!constraints.get_constraint_entries(i)->empty())
+            continue;
+          expected = src(i);
+        }
+
+      AssertThrow(std::abs(expected - dst_mf(i)) < tol,
+                  ExcMessage("Matrix-free and matrix-based actions differ at "
+                             "row " +
+                             Utilities::to_string(i) + ": " +
+                             Utilities::to_string(expected) + " vs " +
+                             Utilities::to_string(dst_mf(i))));
+    }
+}
+
+
+template <int dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+  constexpr int fe_degree = 2;
+
+  const MappingQ1<dim> mapping;
+  Triangulation<dim>   triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 3, 0.0, 1.0, true);
+  GridTools::distort_random(0.1, triangulation, true, 1);
+  triangulation.begin_active()->set_refine_flag();
+  triangulation.execute_coarsening_and_refinement();
+
+  // Hanging node constraints, and homogeneous Dirichlet constraints on one
+  // side of the domain only, so that the boundary integrals still
+  // contribute to unconstrained rows.
+  AffineConstraints<double> constraints;
+  const auto                make_constraints =
+    [&constraints](const DoFHandler<dim> &dof_handler)
+  {
+    constraints.clear();
+    DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+    DoFTools::make_zero_boundary_constraints(dof_handler, 0, constraints);
+    constraints.close();
+  };
+
+  // Laplace + mass + boundary mass (scalar-valued finite element)
+  {
+    std::cout << "Scalar-valued finite element" << std::endl;
+
+    const FE_Q<dim> fe(fe_degree);
+    DoFHandler<dim> dof_handler(triangulation);
+    dof_handler.distribute_dofs(fe);
+    make_constraints(dof_handler);
+
+    const TestFunction<dim>  test;
+    const TrialSolution<dim> trial;
+    const ScalarFunctor      coeff("c", "c");
+    const ScalarFunctor      coeff_bc("k", "k");
+
+    // The coefficients vary in space, so that any mismatch between the
+    // quadrature points of FEValues and those of FEEvaluation is detected.
+    const auto coeff_func = coeff.template value<double, dim, dim>(
+      [](const FEValuesBase<dim, dim> &fe_values, const unsigned int q_point)
+      {
+        const Point<dim> &p = fe_values.quadrature_point(q_point);
+        return 1.5 + p[0] + 0.5 * p[dim - 1] * p[dim - 1];
+      });
+    const auto coeff_bc_func = coeff_bc.template value<double, dim, dim>(
+      [](const FEValuesBase<dim, dim> &fe_values, const unsigned int q_point)
+      { return 2.0 + fe_values.quadrature_point(q_point)[dim - 1]; });
+
+    MatrixBasedAssembler<dim> matrix_based_assembler;
+    matrix_based_assembler +=
+      bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+      bilinear_form(test.value(), coeff_func, trial.value()).dV() +
+      bilinear_form(test.value(), coeff_bc_func, trial.value()).dA();
+
+    MatrixFreeAssembler<dim, fe_degree> matrix_free_assembler;
+    matrix_free_assembler +=
+      bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+      bilinear_form(test.value(), coeff_func, trial.value()).dV() +
+      bilinear_form(test.value(), coeff_bc_func, trial.value()).dA();
+    matrix_free_assembler.initialize(mapping, dof_handler, constraints);
+
+    verify_action(matrix_free_assembler,
+                  matrix_based_assembler,
+                  dof_handler,
+                  constraints);
+  }
+
+  // Linear elasticity (vector-valued finite element)
+  {
+    std::cout << "Vector-valued finite element" << std::endl;
+
+    const FESystem<dim> fe(FE_Q<dim>(fe_degree), dim);
+    DoFHandler<dim>     dof_handler(triangulation);
+    dof_handler.distribute_dofs(fe);
+    make_constraints(dof_handler);
+
+    const TestFunction<dim>          test;
+    const TrialSolution<dim>         trial;
+    const SubSpaceExtractors::Vector subspace_extractor(0, "u", "\\mathbf{u}");
+    const SymmetricTensorFunctor<4, dim> coeff("C", "C");
+    const ScalarFunctor                  coeff_vol("K", "K");
+
+    const auto test_ss  = test[subspace_extractor];
+    const auto trial_ss = trial[subspace_extractor];
+
+    const auto coeff_func = coeff.template value<double, dim>(
+      [](const FEValuesBase<dim, dim> &fe_values, const unsigned int q_point)
+      {
+        return (2.0 + fe_values.quadrature_point(q_point)[0]) *
+               Physics::Elasticity::StandardTensors<dim>::S;
+      });
+    const auto coeff_vol_func = coeff_vol.template value<double, dim, dim>(
+      [](const FEValuesBase<dim, dim> &fe_values, const unsigned int q_point)
+      { return 3.0 + fe_values.quadrature_point(q_point).norm(); });
+
+    MatrixBasedAssembler<dim> matrix_based_assembler;
+    matrix_based_assembler +=
+      bilinear_form(test_ss.symmetric_gradient(),
+                    coeff_func,
+                    trial_ss.symmetric_gradient())
+        .dV() +
+      bilinear_form(test_ss.divergence(), coeff_vol_func, trial_ss.divergence())
+        .dV() -
+      bilinear_form(test_ss.value(), coeff_vol_func, trial_ss.value()).dA();
+
+    MatrixFreeAssembler<dim, fe_degree, fe_degree + 1, dim>
+      matrix_free_assembler;
+    matrix_free_assembler +=
+      bilinear_form(test_ss.symmetric_gradient(),
+                    coeff_func,
+                    trial_ss.symmetric_gradient())
+        .dV() +
+      bilinear_form(test_ss.divergence(), coeff_vol_func, trial_ss.divergence())
+        .dV() -
+      bilinear_form(test_ss.value(), coeff_vol_func, trial_ss.value()).dA();
+    matrix_free_assembler.initialize(mapping, dof_handler, constraints);
+
+    verify_action(matrix_free_assembler,
+                  matrix_based_assembler,
+                  dof_handler,
+                  constraints);
+  }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,371 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that assembling several matrices and vectors in a single mesh loop,
+// with the forms associated with different slots, leads to the same systems
+// as assembling each of them individually.
+// - Cell and boundary contributions
+// - A slot without a vector
+// - Slots without a system matrix or vector, which are skipped
+// - Block matrices of different slots with different block sparsity
+//   patterns
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_renumbering.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/block_sparse_matrix.h>
+#include <deal.II/lac/block_sparsity_pattern.h>
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FE_Q<dim, spacedim>  fe(2);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+  const ScalarFunctor damping("d", "d");
+  const auto damping_func = damping.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 0.5; });
+
+  // Mass matrix and body force
+  const auto forms_0 =
+    bilinear_form(test.value(), coeff_func, trial.value()).dV() -
+    linear_form(test.value(), coeff_func).dV();
+  // Stiffness matrix and traction
+  const auto forms_1 =
+    bilinear_form(test.gradient(), coeff_func, trial.gradient()).dV() +
+    bilinear_form(test.value(), coeff_func, trial.value()).dA() -
+    linear_form(test.value(), coeff_func).dA();
+  // Damping matrix
+  const auto forms_2 =
+    bilinear_form(test.value(), damping_func, trial.value()).dV();
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  Assembler assembler;
+  assembler.add(forms_0, 0);
+  assembler.add(forms_1, 1);
+  assembler.add(forms_2, 2);
+
+  std::array<SparseMatrix<double>, 3> system_matrices;
+  std::array<Vector<double>, 2>       system_vectors;
+  for (auto &system_matrix : system_matrices)
+    system_matrix.reinit(sparsity_pattern);
+  for (auto &system_vector : system_vectors)
+    system_vector.reinit(dof_handler.n_dofs());
+
+  assembler.assemble_systems(std::array<SparseMatrix<double> *, 3>{
+                               {&system_matrices[0],
+                                &system_matrices[1],
+                                &system_matrices[2]}},
+                             std::array<Vector<double> *, 2>{
+                               {&system_vectors[0], &system_vectors[1]}},
+                             constraints,
+                             dof_handler,
+                             qf_cell,
+                             qf_face);
+
+  const auto verify_matrix = [](const SparseMatrix<double> &matrix,
+                                const SparseMatrix<double> &matrix_reference)
+  {
+    constexpr double tol = 1e-12;
+    for (auto it1 = matrix.begin(), it2 = matrix_reference.begin();
+         it1 != matrix.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+  };
+
+  const auto verify_vector = [](const Vector<double> &vector,
+                                const Vector<double> &vector_reference)
+  {
+    constexpr double tol = 1e-12;
+    for (unsigned int i = 0; i < vector.size(); ++i)
+      AssertThrow(std::abs(vector(i) - vector_reference(i)) < tol,
+                  ExcVectorEntriesNotEqual(i, vector(i), vector_reference(i)));
+  };
+
+  const auto verify_system = [&](const auto &       forms,
+                                 const unsigned int slot,
+                                 const bool         has_vector)
+  {
+    Assembler assembler_reference;
+    assembler_reference += forms;
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_vector_reference(dof_handler.n_dofs());
+    assembler_reference.assemble_system(system_matrix_reference,
+                                        system_vector_reference,
+                                        constraints,
+                                        dof_handler,
+                                        qf_cell,
+                                        qf_face);
+
+    verify_matrix(system_matrices[slot], system_matrix_reference);
+    if (has_vector)
+      verify_vector(system_vectors[slot], system_vector_reference);
+  };
+
+  verify_system(forms_0, 0, true);
+  verify_system(forms_1, 1, true);
+  verify_system(forms_2, 2, false);
+
+  // Only the slots with a system matrix or vector are assembled.
+  {
+    SparseMatrix<double> system_matrix(sparsity_pattern);
+    Vector<double>       system_vector(dof_handler.n_dofs());
+    assembler.assemble_systems(
+      std::array<SparseMatrix<double> *, 3>{{&system_matrix, nullptr, nullptr}},
+      std::array<Vector<double> *, 2>{{&system_vector, nullptr}},
+      constraints,
+      dof_handler,
+      qf_cell,
+      qf_face);
+
+    verify_matrix(system_matrix, system_matrices[0]);
+    verify_vector(system_vector, system_vectors[0]);
+  }
+
+  deallog << "OK" << std::endl;
+}
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run_block()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Displacement (vector) + pressure (scalar)
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2),
+                                   dim,
+                                   FE_Q<dim, spacedim>(1),
+                                   1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  const unsigned int u_component = 0;
+  const unsigned int p_component = dim;
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  std::vector<unsigned int> block_component(dim + 1, 0);
+  block_component[p_component] = 1;
+  DoFRenumbering::component_wise(dof_handler, block_component);
+  const std::vector<types::global_dof_index> dofs_per_block =
+    DoFTools::count_dofs_per_fe_block(dof_handler, block_component);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor_u(u_component,
+                                                        "u",
+                                                        "\\mathbf{u}");
+  const SubSpaceExtractors::Scalar subspace_extractor_p(p_component, "p", "p");
+
+  const auto test_u  = test[subspace_extractor_u];
+  const auto trial_u = trial[subspace_extractor_u];
+  const auto test_p  = test[subspace_extractor_p];
+  const auto trial_p = trial[subspace_extractor_p];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  // Mass matrix, without any coupling between the fields
+  const auto forms_0 =
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+    bilinear_form(test_p.value(), coeff_func, trial_p.value()).dV() -
+    linear_form(test_p.value(), coeff_func).dV();
+  // Stiffness matrix, with the fields coupled to one another
+  const auto forms_1 =
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+    bilinear_form(test_u.divergence(), coeff_func, trial_p.value()).dV() +
+    bilinear_form(test_p.value(), coeff_func, trial_u.divergence()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA() -
+    linear_form(test_u.divergence(), coeff_func).dV();
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  // The block sparsity pattern of each slot only holds the couplings of its
+  // own forms.
+  std::array<Assembler, 2>            assemblers_reference;
+  std::array<BlockSparsityPattern, 2> block_sparsity_patterns;
+  assemblers_reference[0] += forms_0;
+  assemblers_reference[1] += forms_1;
+  for (unsigned int slot = 0; slot < 2; ++slot)
+    {
+      BlockDynamicSparsityPattern dsp(dofs_per_block, dofs_per_block);
+      assemblers_reference[slot].make_sparsity_pattern(dof_handler,
+                                                       constraints,
+                                                       dsp,
+                                                       false);
+      block_sparsity_patterns[slot].copy_from(dsp);
+    }
+  AssertThrow(block_sparsity_patterns[0].block(0, 1).n_nonzero_elements() ==
+                0,
+              ExcInternalError());
+  AssertThrow(block_sparsity_patterns[1].block(0, 1).n_nonzero_elements() >
+                0,
+              ExcInternalError());
+
+  Assembler assembler;
+  assembler.add(forms_0, 0);
+  assembler.add(forms_1, 1);
+
+  std::array<BlockSparseMatrix<double>, 2> system_matrices;
+  std::array<BlockVector<double>, 2>       system_vectors;
+  for (unsigned int slot = 0; slot < 2; ++slot)
+    {
+      system_matrices[slot].reinit(block_sparsity_patterns[slot]);
+      system_vectors[slot].reinit(dofs_per_block);
+    }
+
+  assembler.assemble_systems(
+    std::array<BlockSparseMatrix<double> *, 2>{
+      {&system_matrices[0], &system_matrices[1]}},
+    std::array<BlockVector<double> *, 2>{
+      {&system_vectors[0], &system_vectors[1]}},
+    constraints,
+    dof_handler,
+    qf_cell,
+    qf_face);
+
+  constexpr double tol = 1e-12;
+  for (unsigned int slot = 0; slot < 2; ++slot)
+    {
+      BlockSparseMatrix<double> system_matrix_reference(
+        block_sparsity_patterns[slot]);
+      BlockVector<double> system_vector_reference(dofs_per_block);
+      assemblers_reference[slot].assemble_system(system_matrix_reference,
+                                                 system_vector_reference,
+                                                 constraints,
+                                                 dof_handler,
+                                                 qf_cell,
+                                                 qf_face);
+
+      for (unsigned int I = 0; I < 2; ++I)
+        for (unsigned int J = 0; J < 2; ++J)
+          for (auto it1 = system_matrices[slot].block(I, J).begin(),
+                    it2 = system_matrix_reference.block(I, J).begin();
+               it1 != system_matrices[slot].block(I, J).end();
+               ++it1, ++it2)
+            AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                        ExcMatrixEntriesNotEqual(it1->row(),
+                                                 it1->column(),
+                                                 it1->value(),
+                                                 it2->value()));
+
+      for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+        AssertThrow(std::abs(system_vectors[slot](i) -
+                             system_vector_reference(i)) < tol,
+                    ExcVectorEntriesNotEqual(i,
+                                             system_vectors[slot](i),
+                                             system_vector_reference(i)));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  run_block<2, false>();
+  run_block<3, false>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,193 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that reassembling the system matrix over a subset of cells leads to
+// the same system as a full reassembly, when only the contributions from
+// those cells have changed.
+// - Cell and boundary contributions
+// - Cells selected by an explicit list, and by a predicate
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 4, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  // A material coefficient that is constant on each cell.
+  std::vector<double> material(triangulation.n_active_cells(), 1.0);
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [&material](const FEValuesBase<dim, spacedim> &fe_values,
+                const unsigned int)
+    { return material[fe_values.get_cell()->active_cell_index()]; });
+
+  const auto assemble = [&](MatrixBasedAssembler<dim,
+                                                 spacedim,
+                                                 double,
+                                                 use_vectorization> &assembler)
+  {
+    assembler +=
+      bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+  };
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization>
+    assembler_partial;
+  assembler_partial.set_local_matrix_history_flag(true);
+  assemble(assembler_partial);
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization>
+    assembler_reference;
+  assemble(assembler_reference);
+
+  SparseMatrix<double> system_matrix_partial(sparsity_pattern);
+  assembler_partial.assemble_matrix(
+    system_matrix_partial, constraints, dof_handler, qf_cell, qf_face);
+
+  const auto verify = [&]()
+  {
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    assembler_reference.assemble_matrix(
+      system_matrix_reference, constraints, dof_handler, qf_cell, qf_face);
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix_partial.begin(),
+              it2 = system_matrix_reference.begin();
+         it1 != system_matrix_partial.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_reference.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+  };
+
+  // Change the material on every other cell, and reassemble only those.
+  {
+    std::vector<typename DoFHandler<dim, spacedim>::active_cell_iterator>
+      cells;
+    for (const auto &cell : dof_handler.active_cell_iterators())
+      if (cell->active_cell_index() % 2 == 0)
+        {
+          material[cell->active_cell_index()] = 3.0;
+          cells.push_back(cell);
+        }
+
+    assembler_partial.reassemble_matrix(system_matrix_partial,
+                                        constraints,
+                                        dof_handler,
+                                        CellSelection<dim, spacedim>(cells),
+                                        qf_cell,
+                                        qf_face);
+    verify();
+  }
+
+  // Change the material on one half of the domain, which overlaps with the
+  // previously selected cells.
+  {
+    const auto is_selected =
+      [](const typename Triangulation<dim, spacedim>::active_cell_iterator
+           &cell) { return cell->center()[0] < 0.5; };
+    for (const auto &cell : triangulation.active_cell_iterators())
+      if (is_selected(cell))
+        material[cell->active_cell_index()] = 0.5;
+
+    assembler_partial.reassemble_matrix(
+      system_matrix_partial,
+      constraints,
+      dof_handler,
+      CellSelection<dim, spacedim>(is_selected),
+      qf_cell,
+      qf_face);
+    verify();
+  }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,190 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that the scratch data that persists from one assembly call to the
+// next leads to the same system as that which is rebuilt for each call.
+// - Repeated assembly
+// - Change of quadrature rule between calls
+// - Change of DoF distribution between calls
+// - Cell and boundary contributions
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  const ScalarFunctor      coeff("c", "c");
+  const VectorFunctor<dim> rhs("s", "s");
+  const auto coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &fe_values, const unsigned int q_point)
+    { return 2.0 + fe_values.quadrature_point(q_point)[0]; });
+  const auto rhs_func = rhs.template value<double, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    {
+      Tensor<1, dim> s;
+      s[0] = 0.5;
+      return s;
+    });
+
+  const auto add_forms = [&](auto &assembler)
+  {
+    assembler +=
+      bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+    assembler -= linear_form(test_u.value(), rhs_func).dV();
+  };
+
+  MatrixBasedAssembler<dim, spacedim, double, use_vectorization>
+    persistent_assembler;
+  persistent_assembler.set_persistent_scratch_data_flag(true);
+  add_forms(persistent_assembler);
+
+  const auto verify = [&](const Quadrature<spacedim> &    qf_cell,
+                          const Quadrature<spacedim - 1> &qf_face)
+  {
+    AffineConstraints<double> constraints;
+    constraints.close();
+
+    SparsityPattern sparsity_pattern;
+    {
+      DynamicSparsityPattern dsp(dof_handler.n_dofs());
+      DoFTools::make_sparsity_pattern(dof_handler, dsp);
+      sparsity_pattern.copy_from(dsp);
+    }
+
+    SparseMatrix<double> system_matrix_persistent(sparsity_pattern);
+    Vector<double>       system_rhs_persistent(dof_handler.n_dofs());
+    persistent_assembler.assemble_system(system_matrix_persistent,
+                                         system_rhs_persistent,
+                                         constraints,
+                                         dof_handler,
+                                         qf_cell,
+                                         qf_face);
+
+    SparseMatrix<double> system_matrix_fresh(sparsity_pattern);
+    Vector<double>       system_rhs_fresh(dof_handler.n_dofs());
+    {
+      MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+      add_forms(assembler);
+      assembler.assemble_system(system_matrix_fresh,
+                                system_rhs_fresh,
+                                constraints,
+                                dof_handler,
+                                qf_cell,
+                                qf_face);
+    }
+
+    constexpr double tol = 1e-12;
+    for (auto it1 = system_matrix_persistent.begin(),
+              it2 = system_matrix_fresh.begin();
+         it1 != system_matrix_persistent.end();
+         ++it1, ++it2)
+      {
+        Assert(it2 != system_matrix_fresh.end(), ExcInternalError());
+        AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it1->row(), it1->column(), it1->value(), it2->value()));
+      }
+
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      AssertThrow(std::abs(system_rhs_persistent(i) - system_rhs_fresh(i)) <
+                    tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_rhs_persistent(i),
+                                           system_rhs_fresh(i)));
+  };
+
+  dof_handler.distribute_dofs(fe);
+
+  // Repeated assembly
+  verify(QGauss<spacedim>(fe.degree + 1), QGauss<spacedim - 1>(fe.degree + 1));
+  verify(QGauss<spacedim>(fe.degree + 1), QGauss<spacedim - 1>(fe.degree + 1));
+
+  // Change of quadrature rule
+  verify(QGauss<spacedim>(fe.degree + 2), QGauss<spacedim - 1>(fe.degree + 1));
+  verify(QGauss<spacedim>(fe.degree + 2), QGauss<spacedim - 1>(fe.degree + 2));
+
+  // Change of DoF distribution
+  triangulation.refine_global(1);
+  dof_handler.distribute_dofs(fe);
+  verify(QGauss<spacedim>(fe.degree + 2), QGauss<spacedim - 1>(fe.degree + 2));
+
+  persistent_assembler.clear_scratch_data();
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,178 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the shape function data that is shared between several forms
+// during assembly leads to the same system as assembling each form
+// individually.
+// - Multi-field problem, with overlapping subspaces
+// - Cell and boundary contributions
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Displacement (vector) + pressure (scalar)
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2),
+                                   dim,
+                                   FE_Q<dim, spacedim>(1),
+                                   1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  SparsityPattern sparsity_pattern;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern.copy_from(dsp);
+  }
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor_u(0, "u", "\\mathbf{u}");
+  const SubSpaceExtractors::Scalar   subspace_extractor_u0(0, "u0", "u_{0}");
+  const SubSpaceExtractors::Scalar   subspace_extractor_p(dim, "p", "p");
+
+  const auto test_u   = test[subspace_extractor_u];
+  const auto trial_u  = trial[subspace_extractor_u];
+  const auto test_u0  = test[subspace_extractor_u0];
+  const auto trial_u0 = trial[subspace_extractor_u0];
+  const auto test_p   = test[subspace_extractor_p];
+  const auto trial_p  = trial[subspace_extractor_p];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  // The same set of forms, each of which shares some shape function data
+  // with at least one of the others.
+  const auto form_1 =
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV();
+  const auto form_2 = bilinear_form(test_u.symmetric_gradient(),
+                                    coeff_func,
+                                    trial_u.symmetric_gradient())
+                        .dV();
+  const auto form_3 =
+    bilinear_form(test_u.divergence(), coeff_func, trial_p.value()).dV();
+  const auto form_4 =
+    bilinear_form(test_p.value(), coeff_func, trial_u.divergence()).dV();
+  const auto form_5 =
+    bilinear_form(test_p.value(), coeff_func, trial_p.value()).dV();
+  const auto form_6 =
+    bilinear_form(test_u0.gradient(), coeff_func, trial_u0.gradient()).dV();
+  const auto form_7 =
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+  const auto form_8 =
+    bilinear_form(test_u0.value(), coeff_func, trial_p.value()).dA();
+
+  SparseMatrix<double> system_matrix_combined(sparsity_pattern);
+  {
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+    assembler += form_1 + form_2 + form_3 + form_4 + form_5 + form_6 +
+                 form_7 + form_8;
+    assembler.assemble_matrix(
+      system_matrix_combined, constraints, dof_handler, qf_cell, qf_face);
+  }
+
+  SparseMatrix<double> system_matrix_individual(sparsity_pattern);
+  {
+    const auto assemble = [&](const auto &form)
+    {
+      MatrixBasedAssembler<dim, spacedim, double, use_vectorization> assembler;
+      assembler += form;
+      assembler.assemble_matrix(
+        system_matrix_individual, constraints, dof_handler, qf_cell, qf_face);
+    };
+
+    assemble(form_1);
+    assemble(form_2);
+    assemble(form_3);
+    assemble(form_4);
+    assemble(form_5);
+    assemble(form_6);
+    assemble(form_7);
+    assemble(form_8);
+  }
+
+  constexpr double tol = 1e-12;
+  for (auto it1 = system_matrix_combined.begin(),
+            it2 = system_matrix_individual.begin();
+       it1 != system_matrix_combined.end();
+       ++it1, ++it2)
+    {
+      Assert(it2 != system_matrix_individual.end(), ExcInternalError());
+      AssertThrow(std::abs(it1->value() - it2->value()) < tol,
+                  ExcMatrixEntriesNotEqual(
+                    it1->row(), it1->column(), it1->value(), it2->value()));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,270 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that the solution extraction data, which references the solution
+// names held by the solution storage, associates each solution vector with
+// the correct ScratchData object.
+// - Several solution vectors, with names that are passed to the solution
+//   storage as a temporary
+// - One solution vector that is associated with an external DoFHandler
+// - Cell and boundary contributions
+
+#include <deal.II/base/function.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <deal.II/numerics/vector_tools.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/solution_storage.h>
+#include <weak_forms/spaces.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+  using SolutionStorage_t =
+    SolutionStorage<Vector<double>, DoFHandler<dim, spacedim>>;
+
+  const FE_Q<dim, spacedim>  fe(1);
+  const FE_Q<dim, spacedim>  fe_external(2);
+  const QGauss<spacedim>     qf_cell(3);
+  const QGauss<spacedim - 1> qf_face(3);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+  DoFHandler<dim, spacedim> dof_handler_external(triangulation);
+  dof_handler_external.distribute_dofs(fe_external);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  // Each solution field is different, so that using the wrong one for any
+  // form is detected.
+  Vector<double> solution(dof_handler.n_dofs());
+  Vector<double> solution_old(dof_handler.n_dofs());
+  Vector<double> solution_external(dof_handler_external.n_dofs());
+  VectorTools::interpolate(dof_handler,
+                           ScalarFunctionFromFunctionObject<spacedim>(
+                             [](const Point<spacedim> &p)
+                             { return 1.0 + p[0]; }),
+                           solution);
+  VectorTools::interpolate(dof_handler,
+                           ScalarFunctionFromFunctionObject<spacedim>(
+                             [](const Point<spacedim> &p)
+                             { return 2.0 - p[dim - 1]; }),
+                           solution_old);
+  VectorTools::interpolate(dof_handler_external,
+                           ScalarFunctionFromFunctionObject<spacedim>(
+                             [](const Point<spacedim> &p)
+                             { return 0.5 + p[0] * p[dim - 1]; }),
+                           solution_external);
+
+  // The names only live as long as the solution storage that copies them.
+  const auto create_solution_names = []()
+  { return std::vector<std::string>{"u", "u_old", "g"}; };
+  const SolutionStorage_t solution_storage(
+    {&solution, &solution_old, &solution_external},
+    {nullptr, &dof_handler, &dof_handler_external},
+    create_solution_names());
+
+  {
+    LogStream::Prefix prefix("Extraction data");
+
+    MeshWorker::ScratchData<dim, spacedim> scratch_data(fe,
+                                                        qf_cell,
+                                                        update_values,
+                                                        qf_face,
+                                                        update_values);
+    const FEValues<dim, spacedim> &fe_values =
+      scratch_data.reinit(dof_handler.begin_active());
+    solution_storage.initialize(scratch_data, fe_values, dof_handler);
+
+    const std::vector<SolutionExtractionData<dim, spacedim>>
+      solution_extraction_data =
+        solution_storage.get_solution_extraction_data(scratch_data,
+                                                      dof_handler);
+    const std::vector<std::string> solution_names = create_solution_names();
+
+    AssertThrow(solution_extraction_data.size() == solution_names.size(),
+                ExcDimensionMismatch(solution_extraction_data.size(),
+                                     solution_names.size()));
+    for (unsigned int t = 0; t < solution_extraction_data.size(); ++t)
+      {
+        const SolutionExtractionData<dim, spacedim> &data =
+          solution_extraction_data[t];
+        const bool is_external = (t == 2);
+
+        AssertThrow(data.solution_index == t, ExcInternalError());
+        AssertThrow(data.solution_name == solution_names[t],
+                    ExcMessage("Unexpected solution name \"" +
+                               data.solution_name + "\"."));
+        AssertThrow(data.uses_external_dofhandler == is_external,
+                    ExcInternalError());
+        AssertThrow((&data.get_scratch_data() == &scratch_data) ==
+                      !is_external,
+                    ExcMessage("Unexpected ScratchData object."));
+      }
+
+    deallog << "OK" << std::endl;
+  }
+
+  {
+    LogStream::Prefix prefix("Assembly");
+
+    // Reference: Contributions computed by hand.
+    Vector<double> system_rhs_reference(dof_handler.n_dofs());
+    {
+      const UpdateFlags update_flags = update_values | update_JxW_values;
+      FEValues<dim, spacedim>     fe_values(fe, qf_cell, update_flags);
+      FEValues<dim, spacedim>     fe_values_external(fe_external,
+                                                 qf_cell,
+                                                 update_values);
+      FEFaceValues<dim, spacedim> fe_face_values(fe, qf_face, update_flags);
+      FEFaceValues<dim, spacedim> fe_face_values_external(fe_external,
+                                                          qf_face,
+                                                          update_values);
+
+      std::vector<double> values(qf_cell.size());
+      std::vector<double> values_old(qf_cell.size());
+      std::vector<double> values_external(qf_cell.size());
+      std::vector<double> face_values_old(qf_face.size());
+      std::vector<double> face_values_external(qf_face.size());
+
+      Vector<double> cell_rhs(fe.dofs_per_cell);
+      std::vector<dealii::types::global_dof_index> dof_indices(
+        fe.dofs_per_cell);
+      for (const auto &cell : dof_handler.active_cell_iterators())
+        {
+          const typename DoFHandler<dim, spacedim>::active_cell_iterator
+            cell_external(&triangulation,
+                          cell->level(),
+                          cell->index(),
+                          &dof_handler_external);
+
+          cell_rhs = 0;
+          fe_values.reinit(cell);
+          fe_values_external.reinit(cell_external);
+          fe_values.get_function_values(solution, values);
+          fe_values.get_function_values(solution_old, values_old);
+          fe_values_external.get_function_values(solution_external,
+                                                 values_external);
+          for (const unsigned int q : fe_values.quadrature_point_indices())
+            for (const unsigned int i : fe_values.dof_indices())
+              cell_rhs(i) +=
+                fe_values.shape_value(i, q) *
+                (values[q] + values_old[q] + values_external[q]) *
+                fe_values.JxW(q);
+
+          for (const unsigned int face : cell->face_indices())
+            {
+              if (!cell->at_boundary(face))
+                continue;
+
+              fe_face_values.reinit(cell, face);
+              fe_face_values_external.reinit(cell_external, face);
+              fe_face_values.get_function_values(solution_old,
+                                                 face_values_old);
+              fe_face_values_external.get_function_values(
+                solution_external, face_values_external);
+              for (const unsigned int q :
+                   fe_face_values.quadrature_point_indices())
+                for (const unsigned int i : fe_face_values.dof_indices())
+                  cell_rhs(i) +=
+                    fe_face_values.shape_value(i, q) *
+                    (face_values_old[q] + face_values_external[q]) *
+                    fe_face_values.JxW(q);
+            }
+
+          cell->get_dof_indices(dof_indices);
+          constraints.distribute_local_to_global(cell_rhs,
+                                                 dof_indices,
+                                                 system_rhs_reference);
+        }
+    }
+
+    const TestFunction<dim, spacedim>  test;
+    const FieldSolution<dim, spacedim> field_solution;
+
+    constexpr WeakForms::types::solution_index solution_index_u     = 0;
+    constexpr WeakForms::types::solution_index solution_index_u_old = 1;
+    constexpr WeakForms::types::solution_index solution_index_g     = 2;
+
+    const auto u     = field_solution.template value<solution_index_u>();
+    const auto u_old = field_solution.template value<solution_index_u_old>();
+    const auto g     = field_solution.template value<solution_index_g>();
+
+    MatrixBasedAssembler<dim, spacedim> assembler;
+    assembler -= linear_form(test.value(), u).dV();
+    assembler -= linear_form(test.value(), u_old).dV();
+    assembler -= linear_form(test.value(), g).dV();
+    assembler -= linear_form(test.value(), u_old).dA();
+    assembler -= linear_form(test.value(), g).dA();
+
+    Vector<double> system_rhs(dof_handler.n_dofs());
+    assembler.assemble_rhs_vector(system_rhs,
+                                  solution_storage,
+                                  constraints,
+                                  dof_handler,
+                                  qf_cell,
+                                  qf_face);
+
+    constexpr double tol = 1e-12;
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      AssertThrow(std::abs(system_rhs(i) - system_rhs_reference(i)) < tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_rhs(i),
+                                           system_rhs_reference(i)));
+
+    deallog << "OK" << std::endl;
+  }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
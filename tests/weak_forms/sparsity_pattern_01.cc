@@ -0,0 +1,198 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that the sparsity pattern that is derived from the added forms
+// omits the uncoupled blocks, and can hold the assembled system.
+// - Three-field problem (u, p, J), with the couplings of step-44
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  // Displacement (vector) + pressure (scalar) + dilatation (scalar)
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2),
+                                   dim,
+                                   FE_Q<dim, spacedim>(1),
+                                   1,
+                                   FE_Q<dim, spacedim>(1),
+                                   1);
+  const QGauss<spacedim>     qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1> qf_face(fe.degree + 1);
+
+  const unsigned int u_component = 0;
+  const unsigned int p_component = dim;
+  const unsigned int J_component = dim + 1;
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  AffineConstraints<double> constraints;
+  constraints.close();
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor_u(u_component,
+                                                        "u",
+                                                        "\\mathbf{u}");
+  const SubSpaceExtractors::Scalar subspace_extractor_p(p_component, "p", "p");
+  const SubSpaceExtractors::Scalar subspace_extractor_J(J_component, "J", "J");
+
+  const auto test_u  = test[subspace_extractor_u];
+  const auto trial_u = trial[subspace_extractor_u];
+  const auto test_p  = test[subspace_extractor_p];
+  const auto trial_p = trial[subspace_extractor_p];
+  const auto test_J  = test[subspace_extractor_J];
+  const auto trial_J = trial[subspace_extractor_J];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  MatrixBasedAssembler<dim, spacedim> assembler;
+  assembler +=
+    bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+    bilinear_form(test_u.divergence(), coeff_func, trial_p.value()).dV() +
+    bilinear_form(test_p.value(), coeff_func, trial_u.divergence()).dV() -
+    bilinear_form(test_p.value(), coeff_func, trial_J.value()).dV() -
+    bilinear_form(test_J.value(), coeff_func, trial_p.value()).dV() +
+    bilinear_form(test_J.value(), coeff_func, trial_J.value()).dV() +
+    bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA();
+
+  // Check the coupling table
+  {
+    const Table<2, DoFTools::Coupling> couplings =
+      assembler.compute_coupling_table(dof_handler);
+
+    const auto is_coupled = [](const unsigned int i, const unsigned int j)
+    {
+      const unsigned int p = dim;
+      const unsigned int J = dim + 1;
+      if (i < p && j < p)
+        return true;
+      if ((i < p && j == p) || (i == p && j < p))
+        return true;
+      if ((i == p && j == J) || (i == J && j == p) || (i == J && j == J))
+        return true;
+      return false;
+    };
+
+    for (unsigned int i = 0; i < fe.n_components(); ++i)
+      for (unsigned int j = 0; j < fe.n_components(); ++j)
+        AssertThrow((couplings(i, j) == DoFTools::always) == is_coupled(i, j),
+                    ExcMessage("Unexpected coupling between components " +
+                               Utilities::to_string(i) + " and " +
+                               Utilities::to_string(j)));
+
+    const Table<2, DoFTools::Coupling> face_couplings =
+      assembler.compute_face_coupling_table(dof_handler);
+    for (unsigned int i = 0; i < fe.n_components(); ++i)
+      for (unsigned int j = 0; j < fe.n_components(); ++j)
+        AssertThrow(face_couplings(i, j) == DoFTools::none,
+                    ExcMessage("Unexpected face coupling."));
+  }
+
+  SparsityPattern sparsity_pattern_full;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp);
+    sparsity_pattern_full.copy_from(dsp);
+  }
+
+  SparsityPattern sparsity_pattern_forms;
+  {
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    assembler.make_sparsity_pattern(dof_handler, constraints, dsp);
+    sparsity_pattern_forms.copy_from(dsp);
+  }
+
+  AssertThrow(sparsity_pattern_forms.n_nonzero_elements() <
+                sparsity_pattern_full.n_nonzero_elements(),
+              ExcMessage("Expected the zero blocks to be omitted."));
+
+  SparseMatrix<double> system_matrix_full(sparsity_pattern_full);
+  SparseMatrix<double> system_matrix_forms(sparsity_pattern_forms);
+  assembler.assemble_matrix(
+    system_matrix_full, constraints, dof_handler, qf_cell, qf_face);
+  assembler.assemble_matrix(
+    system_matrix_forms, constraints, dof_handler, qf_cell, qf_face);
+
+  constexpr double tol = 1e-12;
+  for (auto it = system_matrix_full.begin(); it != system_matrix_full.end();
+       ++it)
+    {
+      AssertThrow(std::abs(it->value()) < tol ||
+                    sparsity_pattern_forms.exists(it->row(), it->column()),
+                  ExcMessage("Missing entry in the derived sparsity pattern."));
+      AssertThrow(std::abs(it->value() -
+                           system_matrix_forms.el(it->row(), it->column())) <
+                    tol,
+                  ExcMatrixEntriesNotEqual(it->row(),
+                                           it->column(),
+                                           it->value(),
+                                           system_matrix_forms.el(
+                                             it->row(), it->column())));
+    }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
@@ -0,0 +1,174 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+
+// Check that a deep tree of unary and binary operators, which is evaluated
+// one quadrature point (or batch of quadrature points) at a time, gives
+// the same result as evaluating each node at all quadrature points.
+
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/meshworker/scratch_data.h>
+
+#include <weak_forms/binary_operators.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/types.h>
+#include <weak_forms/unary_operators.h>
+
+#include "../weak_forms_tests.h"
+
+
+template <int dim, int spacedim = dim, typename NumberType = double>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  const FE_Q<dim, spacedim> fe(1);
+  const QGauss<spacedim>    qf_cell(fe.degree + 2);
+
+  Triangulation<dim, spacedim> triangulation;
+  GridGenerator::hyper_cube(triangulation);
+
+  DoFHandler<dim, spacedim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  const UpdateFlags update_flags_cell =
+    update_quadrature_points | update_values | update_gradients;
+  MeshWorker::ScratchData<dim, spacedim> scratch_data(fe,
+                                                      qf_cell,
+                                                      update_flags_cell);
+
+  const auto                         cell      = dof_handler.begin_active();
+  const FEValuesBase<dim, spacedim> &fe_values = scratch_data.reinit(cell);
+
+  using namespace WeakForms;
+
+  // A deformation gradient that differs at each quadrature point.
+  const TensorFunctor<2, spacedim> F_functor("F", "F");
+  const auto                       F = F_functor.template value<double, dim>(
+    [](const FEValuesBase<dim, spacedim> &fe_values_q,
+       const unsigned int                 q_point)
+    {
+      const Point<spacedim> &p = fe_values_q.quadrature_point(q_point);
+      Tensor<2, spacedim>    t = unit_symmetric_tensor<spacedim>();
+      for (unsigned int i = 0; i < spacedim; ++i)
+        for (unsigned int j = 0; j < spacedim; ++j)
+          t[i][j] += 0.1 * (i + 1) * p[j];
+      return t;
+    });
+
+  const auto fused = transpose(determinant(F) * invert(F)) + F;
+
+  const auto tolerance = [](const double reference)
+  { return 1e-12 * std::max(1.0, std::abs(reference)); };
+
+  {
+    LogStream::Prefix prefix("Scalar");
+
+    const auto values = fused.template operator()<NumberType>(fe_values);
+
+    // Evaluate each branch of the tree at all quadrature points, and
+    // combine them here.
+    const auto values_F     = F.template operator()<NumberType>(fe_values);
+    const auto values_det_F =
+      determinant(F).template operator()<NumberType>(fe_values);
+    const auto values_inv_F =
+      invert(F).template operator()<NumberType>(fe_values);
+
+    AssertThrow(values.size() == fe_values.n_quadrature_points,
+                ExcDimensionMismatch(values.size(),
+                                     fe_values.n_quadrature_points));
+    for (const unsigned int q_point : fe_values.quadrature_point_indices())
+      {
+        const Tensor<2, spacedim, NumberType> reference =
+          transpose(values_det_F[q_point] * values_inv_F[q_point]) +
+          values_F[q_point];
+        AssertThrow((values[q_point] - reference).norm() <=
+                      tolerance(reference.norm()),
+                    ExcMessage("Fused and unfused evaluation differ."));
+      }
+
+    deallog << "OK" << std::endl;
+  }
+
+  {
+    LogStream::Prefix prefix("Vectorized");
+
+    constexpr std::size_t width =
+      dealii::internal::VectorizedArrayWidthSpecifier<double>::max_width;
+
+    for (unsigned int q_point_start = 0;
+         q_point_start < fe_values.n_quadrature_points;
+         q_point_start += width)
+      {
+        const unsigned int q_point_end =
+          std::min<unsigned int>(q_point_start + width,
+                                 fe_values.n_quadrature_points);
+        const types::vectorized_qp_range_t q_point_range(q_point_start,
+                                                         q_point_end);
+
+        const auto values =
+          fused.template operator()<NumberType, width>(fe_values,
+                                                       q_point_range);
+
+        const auto values_F = F.template operator()<NumberType>(fe_values);
+        const auto values_det_F =
+          determinant(F).template operator()<NumberType>(fe_values);
+        const auto values_inv_F =
+          invert(F).template operator()<NumberType>(fe_values);
+
+        for (unsigned int v = 0; v < q_point_range.size(); ++v)
+          {
+            const unsigned int                    q_point = q_point_range[v];
+            const Tensor<2, spacedim, NumberType> reference =
+              transpose(values_det_F[q_point] * values_inv_F[q_point]) +
+              values_F[q_point];
+
+            for (unsigned int i = 0; i < spacedim; ++i)
+              for (unsigned int j = 0; j < spacedim; ++j)
+                AssertThrow(std::abs(values[i][j][v] - reference[i][j]) <=
+                              tolerance(reference.norm()),
+                            ExcMessage("Fused and unfused evaluation differ."));
+          }
+      }
+
+    deallog << "OK" << std::endl;
+  }
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2>();
+  run<3>();
+
+  deallog << "OK" << std::endl;
+}
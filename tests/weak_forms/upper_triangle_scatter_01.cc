@@ -0,0 +1,212 @@
+// ---------------------------------------------------------------------
+//
+// Copyright (C) 2021 - 2022 by Jean-Paul Pelteret
+//
+// This file is part of the Weak forms for deal.II library.
+//
+// The Weak forms for deal.II library is free software; you can use it,
+// redistribute it, and/or modify it under the terms of the GNU Lesser
+// General Public License as published by the Free Software Foundation;
+// either version 3.0 of the License, or (at your option) any later
+// version. The full text of the license can be found in the file LICENSE
+// at the top level of the Weak forms for deal.II distribution.
+//
+// ---------------------------------------------------------------------
+
+
+// Check that assembling only the upper triangle of a symmetric system
+// matrix gives the same entries as the upper triangle of the full system
+// matrix, and that no entries are written to the lower triangle.
+// - Laplace + mass + boundary mass (vector-valued finite element)
+// - Homogeneous Dirichlet constraints (matrix only)
+// - Locally refined mesh, with hanging node and inhomogeneous Dirichlet
+//   constraints (matrix and RHS vector)
+
+#include <deal.II/base/function.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_system.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/numerics/vector_tools.h>
+
+#include <weak_forms/assembler_matrix_based.h>
+#include <weak_forms/bilinear_forms.h>
+#include <weak_forms/functors.h>
+#include <weak_forms/linear_forms.h>
+#include <weak_forms/spaces.h>
+#include <weak_forms/subspace_extractors.h>
+#include <weak_forms/symbolic_operators.h>
+
+#include "../weak_forms_tests.h"
+#include "wf_common_tests/utilities.h"
+
+
+template <int dim, bool use_vectorization, int spacedim = dim>
+void
+run()
+{
+  LogStream::Prefix prefix("Dim " + Utilities::to_string(dim));
+  std::cout << "Dim: " << dim << std::endl;
+
+  using namespace WeakForms;
+
+  const FESystem<dim, spacedim> fe(FE_Q<dim, spacedim>(2), dim);
+  const QGauss<spacedim>        qf_cell(fe.degree + 1);
+  const QGauss<spacedim - 1>    qf_face(fe.degree + 1);
+
+  const TestFunction<dim, spacedim>  test;
+  const TrialSolution<dim, spacedim> trial;
+  const SubSpaceExtractors::Vector   subspace_extractor(0, "u", "\\mathbf{u}");
+
+  const auto test_u  = test[subspace_extractor];
+  const auto trial_u = trial[subspace_extractor];
+
+  const ScalarFunctor coeff("c", "c");
+  const auto          coeff_func = coeff.template value<double, dim, spacedim>(
+    [](const FEValuesBase<dim, spacedim> &, const unsigned int)
+    { return 2.0; });
+
+  using Assembler =
+    MatrixBasedAssembler<dim, spacedim, double, use_vectorization>;
+
+  const auto add_forms = [&](Assembler &assembler)
+  {
+    assembler +=
+      bilinear_form(test_u.gradient(), coeff_func, trial_u.gradient()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dV() +
+      bilinear_form(test_u.value(), coeff_func, trial_u.value()).dA() -
+      linear_form(test_u.divergence(), coeff_func).dV();
+    assembler.symmetrize();
+  };
+
+  const auto verify = [&](const bool                refine_locally,
+                          const Function<spacedim> &boundary_function,
+                          const bool                assemble_vector)
+  {
+    Triangulation<dim, spacedim> triangulation;
+    GridGenerator::subdivided_hyper_cube(triangulation, 2, 0.0, 1.0);
+    GridTools::distort_random(0.1, triangulation, true, 1);
+    if (refine_locally)
+      {
+        triangulation.begin_active()->set_refine_flag();
+        triangulation.execute_coarsening_and_refinement();
+      }
+
+    DoFHandler<dim, spacedim> dof_handler(triangulation);
+    dof_handler.distribute_dofs(fe);
+
+    AffineConstraints<double> constraints;
+    DoFTools::make_hanging_node_constraints(dof_handler, constraints);
+    VectorTools::interpolate_boundary_values(dof_handler,
+                                             0,
+                                             boundary_function,
+                                             constraints);
+    constraints.close();
+
+    DynamicSparsityPattern dsp(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false);
+
+    SparsityPattern sparsity_pattern;
+    sparsity_pattern.copy_from(dsp);
+
+    // Only keep the entries of the upper triangle.
+    SparsityPattern sparsity_pattern_upper;
+    {
+      DynamicSparsityPattern dsp_upper(dof_handler.n_dofs());
+      for (const auto &entry : dsp)
+        if (entry.row() <= entry.column())
+          dsp_upper.add(entry.row(), entry.column());
+      sparsity_pattern_upper.copy_from(dsp_upper);
+    }
+
+    const auto assemble = [&](Assembler &           assembler,
+                              SparseMatrix<double> &system_matrix,
+                              Vector<double> &      system_vector)
+    {
+      if (assemble_vector)
+        assembler.assemble_system(system_matrix,
+                                  system_vector,
+                                  constraints,
+                                  dof_handler,
+                                  qf_cell,
+                                  qf_face);
+      else
+        assembler.assemble_matrix(
+          system_matrix, constraints, dof_handler, qf_cell, qf_face);
+    };
+
+    SparseMatrix<double> system_matrix_reference(sparsity_pattern);
+    Vector<double>       system_vector_reference(dof_handler.n_dofs());
+    {
+      Assembler assembler;
+      add_forms(assembler);
+      assemble(assembler, system_matrix_reference, system_vector_reference);
+    }
+
+    SparseMatrix<double> system_matrix_upper(sparsity_pattern_upper);
+    Vector<double>       system_vector_upper(dof_handler.n_dofs());
+    {
+      Assembler assembler;
+      add_forms(assembler);
+      assembler.set_upper_triangle_scatter_flag(true);
+      assemble(assembler, system_matrix_upper, system_vector_upper);
+    }
+
+    constexpr double tol = 1e-12;
+    for (auto it = system_matrix_reference.begin();
+         it != system_matrix_reference.end();
+         ++it)
+      {
+        if (it->row() > it->column())
+          continue;
+
+        const double value_upper =
+          system_matrix_upper.el(it->row(), it->column());
+        AssertThrow(std::abs(it->value() - value_upper) < tol,
+                    ExcMatrixEntriesNotEqual(
+                      it->row(), it->column(), it->value(), value_upper));
+      }
+
+    for (unsigned int i = 0; i < dof_handler.n_dofs(); ++i)
+      AssertThrow(std::abs(system_vector_upper(i) -
+                           system_vector_reference(i)) < tol,
+                  ExcVectorEntriesNotEqual(i,
+                                           system_vector_upper(i),
+                                           system_vector_reference(i)));
+  };
+
+  verify(false, Functions::ZeroFunction<spacedim>(fe.n_components()), false);
+  verify(true,
+         Functions::ConstantFunction<spacedim>(0.5, fe.n_components()),
+         true);
+
+  deallog << "OK" << std::endl;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  initlog();
+  Utilities::MPI::MPI_InitFinalize mpi_initialization(
+    argc, argv, testing_max_num_threads());
+
+  run<2, false>();
+  run<3, false>();
+  run<2, true>();
+  run<3, true>();
+
+  deallog << "OK" << std::endl;
+}